@@ -7,11 +7,13 @@
 #include <plugin_api.h>
 #include <reading.h>
 
+#include <atomic>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -21,10 +23,18 @@
 
 #include "iec61850_client_config.hpp"
 #include "iec61850_client_connection.hpp"
+#include "iec61850_command_tracker.hpp"
 
 #define BACKUP_CONNECTION_TIMEOUT 5000
 
 class IEC61850Client;
+class IEC61850ModelCache;
+class IEC61850EntryIdStore;
+class IEC61850SpecRegistry;
+class IEC61850Reactor;
+class IEC61850PivotCommand;
+class IEC61850CommandBatch;
+class IEC61850SettingBatch;
 
 class PivotTimestamp
 {
@@ -104,9 +114,47 @@ class IEC61850
     bool operation (const std::string& operation, int count,
                     PLUGIN_PARAMETER** params);
 
+    /* returns false when the plugin has to be restarted instead */
+    bool reconfigure (const std::string& protocol_stack,
+                      const std::string& exchanged_data,
+                      const std::string& tls_configuration);
+
+    /* result of a command of a batch, queues the commands waiting for it,
+     * returns the batch when it is finished */
+    std::shared_ptr<IEC61850CommandBatch>
+    batchStepDone (uint64_t batchId, size_t step, bool confirmed);
+
+    /* sends the queued commands of the batches, called from the supervision
+     * of the clients and never from a libiec61850 callback */
+    void runReadyBatchSteps ();
+
   private:
     IEC61850ClientConfig* m_config = new IEC61850ClientConfig ();
-    ;
+    std::vector<IEC61850ClientConfig*> m_configs;
+
+    void deleteConfigs ();
+    /* also resolves the exchange definition of the command */
+    IEC61850Client* clientForCommand (IEC61850PivotCommand& command);
+
+    /* pending is set when the result of the command comes later through
+     * the acknowledgements */
+    bool pivotCommand (const std::string& commandJson, uint64_t batchId = 0,
+                       size_t step = 0, bool* pending = nullptr);
+
+    bool startBatch (const std::string& batchJson);
+    void runBatchSteps (uint64_t batchId,
+                        const std::shared_ptr<IEC61850CommandBatch>& batch,
+                        const std::vector<size_t>& steps);
+
+    /* the settings of a batch belong to the IED of a single client */
+    bool startSettingBatch (const std::string& batchJson);
+
+    std::mutex m_batchLock;
+    std::unordered_map<uint64_t, std::shared_ptr<IEC61850CommandBatch> >
+        m_batches;
+    /* batch id and step of the commands whose dependencies are done */
+    std::vector<std::pair<uint64_t, size_t> > m_readySteps;
+    uint64_t m_nextBatchId = 1;
 
     std::string m_asset;
 
@@ -114,6 +162,11 @@ class IEC61850
         = nullptr; // Callback function used to send data to south service
     void* m_data;  // Ingest function data
     IEC61850Client* m_client = nullptr;
+    std::vector<IEC61850Client*> m_clients;
+    /* guards m_configs, m_clients and m_client between reconfigure and the
+     * commands */
+    std::mutex m_clientsLock;
+    IEC61850Reactor* m_reactor = nullptr;
 
     FRIEND_TESTS
 };
@@ -121,7 +174,8 @@ class IEC61850
 class IEC61850Client
 {
   public:
-    explicit IEC61850Client (IEC61850* iec61850, IEC61850ClientConfig* config);
+    explicit IEC61850Client (IEC61850* iec61850, IEC61850ClientConfig* config,
+                             IEC61850Reactor* reactor = nullptr);
 
     ~IEC61850Client ();
 
@@ -134,19 +188,79 @@ class IEC61850Client
 
     void prepareConnections ();
 
-    void handleValue (std::string objRef, MmsValue* mmsValue,
+    /* objRef is the dataset entry, LD/LN.DO[FC] or LD/LN.DO.attr[FC] */
+    void handleValue (const char* objRef, size_t length, MmsValue* mmsValue,
                       uint64_t timestamp);
     void handleAllValues ();
 
-    bool handleOperation (Datapoint* operation);
+    /* commandJson is echoed in the acknowledgements of a control, the
+     * result of a control of a batch is reported to the plugin */
+    bool handleOperation (const IEC61850PivotCommand& command,
+                          const std::string& commandJson,
+                          uint64_t batchId = 0, size_t step = 0);
+
+    /* GI on the RCBs through the active connection, all when empty */
+    void requestGI (const std::vector<std::string>& rcbRefs);
+
+    /* newConfig replaces the configuration without a new association, the
+     * old one is deleted once no callback uses it anymore */
+    void applyConfig (IEC61850ClientConfig* newConfig,
+                      const IEC61850ConfigDiff& diff);
+
+    /* around the libiec61850 callbacks reading the configuration */
+    void
+    enterCallback ()
+    {
+        m_callbacks++;
+    };
+
+    void
+    leaveCallback ()
+    {
+        m_callbacks--;
+    };
 
     void logIedClientError (IedClientError err, const std::string& info) const;
 
-    void sendCommandAck (const std::string& label, ControlModel mode,
-                         bool terminated);
+    /* a negative acknowledgement carries Confirmation.stVal true */
+    void sendCommandAck (uint64_t commandId, ControlModel mode,
+                         bool terminated, bool negative = false);
+
+    /* result of all the commands of a batch */
+    void sendBatchAck (const IEC61850CommandBatch& batch);
+
+    /* adds the setting written by a SPG, ING or ASG command to batch */
+    bool addSetting (IEC61850SettingBatch& batch,
+                     const IEC61850PivotCommand& command);
+
+    bool writeSettings (const std::shared_ptr<IEC61850SettingBatch>& batch);
 
-    bool firstTimeConnect = true;                     
-    MmsValue* lastEntryId = nullptr;
+    /* result of all the settings of a batch */
+    void sendSettingBatchAck (const IEC61850SettingBatch& batch);
+
+    IEC61850CommandTracker&
+    commandTracker ()
+    {
+        return m_commandTracker;
+    };
+
+    IEC61850ModelCache*
+    modelCache ()
+    {
+        return m_modelCache;
+    };
+
+    IEC61850SpecRegistry*
+    specRegistry ()
+    {
+        return m_specRegistry;
+    };
+
+    IEC61850EntryIdStore*
+    entryIdStore ()
+    {
+        return m_entryIdStore;
+    };
 
   private:
     std::shared_ptr<std::vector<IEC61850ClientConnection*> > m_connections
@@ -169,9 +283,39 @@ class IEC61850Client
     std::mutex connectionsMutex;
     std::mutex statusMutex;
 
+    /* libiec61850 callbacks in progress */
+    std::atomic<int> m_callbacks{ 0 };
+    /* replaced by applyConfig, guarded by connectionsMutex */
+    std::vector<IEC61850ClientConfig*> m_retiredConfigs;
+
+    /* deletes the replaced configurations when no callback runs */
+    void releaseRetiredConfigs ();
+    void deleteRetiredConfigs ();
+
     std::thread* m_monitoringThread = nullptr;
     void _monitoringThread ();
 
+    static std::vector<std::string>
+    rcbReferences (const IEC61850ClientConfig* config);
+
+    void startConnections ();
+    void superviseConnections ();
+    void deleteConnections ();
+
+    int m_tryConnectionIdx = -1;
+    uint64_t m_tryConnectionDeadline = 0;
+
+    IEC61850Reactor* m_reactor = nullptr;
+    int m_supervisionTask = -1;
+
+    IEC61850ModelCache* m_modelCache = nullptr;
+    IEC61850EntryIdStore* m_entryIdStore = nullptr;
+
+    /* outlives the connections, the types of the definitions are kept
+     * across reconnects while the model revisions are unchanged and
+     * released when a definition is replaced */
+    IEC61850SpecRegistry* m_specRegistry;
+
     bool m_started = false;
 
     IEC61850ClientConfig* m_config;
@@ -188,51 +332,51 @@ class IEC61850Client
     template <class T>
     void addValueDp (Datapoint* cdcDp, CDCTYPE type, T value) const;
 
-    void m_handleMonitoringData (const std::string& objRef,
+    /* mmsValue is read with fc when it is nullptr */
+    void m_handleMonitoringData (DataExchangeDefinition* def,
                                  std::vector<Datapoint*>& datapoints,
-                                 const std::string& label, CDCTYPE type,
                                  MmsValue* mmsValue,
                                  const std::string& variable,
                                  FunctionalConstraint fc, uint64_t timestamp);
     Quality extractQuality (MmsValue* mmsvalue,
-                            MmsVariableSpecification* varSpec,
+                            const IEC61850SpecType* specType,
                             const std::string& attribute);
     uint64_t extractTimestamp (MmsValue* mmsvalue,
-                               MmsVariableSpecification* varSpec,
+                               const IEC61850SpecType* specType,
                                const std::string& attribute);
     bool processDatapoint (CDCTYPE type, std::vector<Datapoint*>& datapoints,
                            const std::string& label, const std::string& objRef,
                            MmsValue* mmsvalue,
-                           MmsVariableSpecification* varSpec, Quality quality,
+                           const IEC61850SpecType* specType, Quality quality,
                            uint64_t timestamp, const std::string& attribute);
     void cleanUpMmsValue (MmsValue* originalMmsVal, MmsValue* usedMmsVal);
     bool processBooleanType (std::vector<Datapoint*>& datapoints,
                              const std::string& label,
                              const std::string& objRef, MmsValue* mmsvalue,
-                             MmsVariableSpecification* varSpec,
+                             const IEC61850SpecType* specType,
                              Quality quality, uint64_t timestamp,
                              const std::string& attribute,
                              const char* elementName);
     bool processBSCType (std::vector<Datapoint*>& datapoints,
                          const std::string& label, const std::string& objRef,
-                         MmsValue* mmsvalue, MmsVariableSpecification* varSpec,
+                         MmsValue* mmsvalue, const IEC61850SpecType* specType,
                          Quality quality, uint64_t timestamp,
                          const std::string& attribute,
                          const char* elementName);
     bool processAnalogType (std::vector<Datapoint*>& datapoints,
                             const std::string& label,
                             const std::string& objRef, MmsValue* mmsvalue,
-                            MmsVariableSpecification* varSpec, Quality quality,
+                            const IEC61850SpecType* specType, Quality quality,
                             uint64_t timestamp, const std::string& attribute,
                             const char* elementName);
     bool processIntegerType (std::vector<Datapoint*>& datapoints,
                              const std::string& label,
                              const std::string& objRef, MmsValue* mmsvalue,
-                             MmsVariableSpecification* varSpec,
+                             const IEC61850SpecType* specType,
                              Quality quality, uint64_t timestamp,
                              const std::string& attribute,
                              const char* elementName);
-    std::unordered_map<std::string, Datapoint*> m_outstandingCommands;
+    IEC61850CommandTracker m_commandTracker;
     FRIEND_TESTS
 };
 
@@ -0,0 +1,123 @@
+#ifndef IEC61850_ASYNC_PIPELINE_H
+#define IEC61850_ASYNC_PIPELINE_H
+
+#include <deque>
+#include <functional>
+#include <libiec61850/iec61850_client.h>
+#include <libiec61850/mms_client_connection.h>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * Result of an asynchronous request. Whatever the completion handler does
+ * not take (by setting the member to nullptr) is released afterwards.
+ */
+struct IEC61850AsyncResult
+{
+    IedClientError err = IED_ERROR_OK;
+    MmsValue* value = nullptr;
+    MmsVariableSpecification* spec = nullptr;
+    LinkedList directory = nullptr;
+    bool isDeletable = false;
+    ClientReportControlBlock rcb = nullptr;
+    ClientDataSet dataSet = nullptr;
+    /* MmsValue access result of each variable of a write */
+    LinkedList accessResults = nullptr;
+
+    void release ();
+};
+
+/*
+ * Window of asynchronous MMS requests.
+ *
+ * Requests are queued and sent as long as less than "window" requests are
+ * outstanding. Completions are collected from the libiec61850 handlers and
+ * run by poll() on the thread driving the connection, where they may
+ * submit the requests depending on them.
+ *
+ * The connection the requests are sent on has to be destroyed before the
+ * pipeline, libiec61850 may complete aborted requests until then.
+ */
+class IEC61850AsyncPipeline
+{
+  public:
+    /* sends the request with the handler parameter, returns the invoke id */
+    using Issue = std::function<uint32_t (IedClientError* err, void* parameter)>;
+    using Done = std::function<void (IEC61850AsyncResult& result)>;
+
+    explicit IEC61850AsyncPipeline (int window);
+    ~IEC61850AsyncPipeline ();
+
+    void submit (const Issue& issue, const Done& done);
+
+    /* returns true while requests are queued, outstanding or completed */
+    bool poll ();
+
+    bool idle ();
+
+    /* drops queued requests, late completions of outstanding ones are
+     * discarded */
+    void abort ();
+
+    /* releases the aborted requests, once the connection they were sent on
+     * is destroyed and cannot complete them anymore */
+    void releaseOrphans ();
+
+    void
+    setWindow (int window)
+    {
+        m_window = window < 1 ? 1 : window;
+    };
+
+    static void readObjectHandler (uint32_t invokeId, void* parameter,
+                                   IedClientError err, MmsValue* value);
+
+    static void variableSpecHandler (uint32_t invokeId, void* parameter,
+                                     IedClientError err,
+                                     MmsVariableSpecification* spec);
+
+    static void dataSetDirectoryHandler (uint32_t invokeId, void* parameter,
+                                         IedClientError err,
+                                         LinkedList dataSetDirectory,
+                                         bool isDeletable);
+
+    static void readDataSetHandler (uint32_t invokeId, void* parameter,
+                                    IedClientError err, ClientDataSet dataSet);
+
+    static void rcbValuesHandler (uint32_t invokeId, void* parameter,
+                                  IedClientError err,
+                                  ClientReportControlBlock rcb);
+
+    static void genericHandler (uint32_t invokeId, void* parameter,
+                                IedClientError err);
+
+    static void writeMultipleVariablesHandler (uint32_t invokeId,
+                                               void* parameter,
+                                               MmsError mmsError,
+                                               LinkedList accessResults);
+
+  private:
+    struct Request
+    {
+        IEC61850AsyncPipeline* pipeline;
+        Issue issue;
+        Done done;
+        IEC61850AsyncResult result;
+        bool aborted = false;
+    };
+
+    void complete (Request* request);
+
+    size_t m_window;
+
+    std::deque<Request*> m_queue;
+    std::unordered_set<Request*> m_outstanding;
+    /* aborted but still outstanding in libiec61850 */
+    std::unordered_set<Request*> m_orphans;
+    std::vector<Request*> m_completed;
+
+    std::mutex m_lock;
+};
+
+#endif /* IEC61850_ASYNC_PIPELINE_H */
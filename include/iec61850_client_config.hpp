@@ -1,6 +1,7 @@
 #ifndef IEC61850_CLIENT_CONFIG_H
 #define IEC61850_CLIENT_CONFIG_H
 
+#include "iec61850_definition_index.hpp"
 #include "iec61850_utility.hpp"
 #include "libiec61850/iec61850_client.h"
 #include "rapidjson/document.h"
@@ -10,23 +11,37 @@
 #include <map>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #define FRIEND_TESTS                                                          \
     FRIEND_TEST (ConnectionHandlingTest, SingleConnection);                   \
     FRIEND_TEST (ConnectionHandlingTest, SingleConnectionTLS);                \
     FRIEND_TEST (ConnectionHandlingTest, SingleConnectionReconnect);          \
+    FRIEND_TEST (ConnectionHandlingTest, SingleConnectionReactor);            \
     FRIEND_TEST (ControlTest, SingleCommandDirectNormal);                     \
     FRIEND_TEST (ControlTest, DoubleCommandDirectNormal);                     \
     FRIEND_TEST (ControlTest, SingleCommandDirectEnhanced);                   \
+    FRIEND_TEST (ControlTest, SingleCommandSelectOperateLatency);             \
     FRIEND_TEST (ControlTest, SingleCommandSetValue);                         \
     FRIEND_TEST (ControlTest, WriteOperations);                               \
+    FRIEND_TEST (ControlTest, CommandSoak);                                   \
+    FRIEND_TEST (ControlTest, WriteSoak);                                     \
+    FRIEND_TEST (ControlTest, LazyControlObject);                             \
+    FRIEND_TEST (ControlTest, OperateFailedNegativeAck);                      \
+    FRIEND_TEST (ControlTest, TerminationErrorNegativeAck);                   \
+    FRIEND_TEST (ControlTest, OperateAfterSelectNegativeAck);                 \
+    FRIEND_TEST (ControlTest, CommandBatch);                                  \
+    FRIEND_TEST (ControlTest, ReconfigureRetiresControl);                     \
+    FRIEND_TEST (ControlTest, SettingBatch);                                  \
     FRIEND_TEST (ReportingTest, ReportingWithStaticDataset);                  \
     FRIEND_TEST (ReportingTest, ReportingWithDynamicDataset);                 \
     FRIEND_TEST (ReportingTest, ReportingUpdateQuality);                      \
     FRIEND_TEST (ReportingTest, ReportingGI);                                 \
+    FRIEND_TEST (ReportingTest, ReportingRequestGI);                          \
     FRIEND_TEST (ReportingTest, ReportingSetpointCommand);                    \
     FRIEND_TEST (ReportingTest, ReconfigureDynamicDataset);                   \
+    FRIEND_TEST (ReportingTest, ReconfigureInPlace);                          \
     FRIEND_TEST (ReportingTest, ReportingChangeValueMultipleTimes);           \
     FRIEND_TEST (ReportingTest, ReportingIndividualAttributes);               \
     FRIEND_TEST (SpontDataTest, Polling);                                     \
@@ -51,6 +66,9 @@
     FRIEND_TEST (ConfigTest, ProtocolConfigReportNoDataref);                  \
     FRIEND_TEST (ConfigTest, ProtocolConfigNoTrgroups);                       \
     FRIEND_TEST (ConfigTest, ProtocolConfigBuftmIntgpd);                      \
+    FRIEND_TEST (ConfigTest, ProtocolConfigMultipleIeds);                     \
+    FRIEND_TEST (ConfigTest, ProtocolConfigBringUp);                          \
+    FRIEND_TEST (ConfigTest, ProtocolConfigCommandTimeouts);                  \
     FRIEND_TEST (ConnectionHandlingTest, TwoConnectionsBackup);
 
 typedef enum
@@ -110,19 +128,42 @@ struct RedGroup
     bool tls;
 };
 
+/* when the control objects of a connection are created */
+typedef enum
+{
+    CONTROLS_AT_BRINGUP,
+    /* on the first command on the object */
+    CONTROLS_LAZY,
+    /* in the background once the connection is up, or on first command */
+    CONTROLS_PREWARM
+} CONTROLOBJECTS;
+
+/* supervision of a command in ms, 0 disables a timeout */
+struct CommandTimeouts
+{
+    int select = 10000;
+    int actCon = 10000;
+    int actTerm = 30000;
+};
+
+struct IEC61850SpecType;
+
 struct DataExchangeDefinition
 {
     std::string objRef;
     CDCTYPE cdcType;
     std::string label;
     std::string id;
-    MmsVariableSpecification* spec;
+    /* shared with the other data objects of the same type */
+    const IEC61850SpecType* spec = nullptr;
     bool hasIntValue = true;
     union{
      int intVal;
      float floatVal;
     } lastValue;
     bool valueSet = false;
+    /* not in a dataset, read by the polling */
+    bool polled = true;
 };
 
 struct ReportSubscription
@@ -142,10 +183,32 @@ struct Dataset
     bool dynamic;
 };
 
+/* what changed between two configurations of the same IED */
+struct IEC61850ConfigDiff
+{
+    /* connection, TLS or bring-up settings changed -> new association */
+    bool restart = false;
+
+    /* new or changed, including RCBs whose dataset changed */
+    std::unordered_set<std::string> changedRcbs;
+    std::unordered_set<std::string> removedRcbs;
+    std::unordered_set<std::string> changedDatasets;
+    std::unordered_set<std::string> removedDatasets;
+    bool exchangeChanged = false;
+
+    bool
+    empty () const
+    {
+        return !restart && changedRcbs.empty () && removedRcbs.empty ()
+               && changedDatasets.empty () && removedDatasets.empty ()
+               && !exchangeChanged;
+    };
+};
+
 class IEC61850ClientConfig
 {
   public:
-    IEC61850ClientConfig () { m_exchangeDefinitions.clear (); };
+    IEC61850ClientConfig () = default;
     ~IEC61850ClientConfig ();
 
     int
@@ -154,9 +217,16 @@ class IEC61850ClientConfig
         return 1;
     };
 
+    static std::vector<IEC61850ClientConfig*>
+    importIedConfigs (const std::string& protocolConfig,
+                      const std::string& exchangeConfig,
+                      const std::string& tlsConfig);
+
     void importProtocolConfig (const std::string& protocolConfig);
+    void importProtocolStack (const rapidjson::Value& protocolStack);
     void importJsonConnectionOsiConfig (const rapidjson::Value& connOsiConfig,
                                         RedGroup& iedConnectionParam);
+    void importCommandTimeouts (const rapidjson::Value& timeouts);
     void
     importJsonConnectionOsiSelectors (const rapidjson::Value& connOsiConfig,
                                       OsiParameters* osiParams);
@@ -169,9 +239,17 @@ class IEC61850ClientConfig
     OsiSelectorSize parseOsiSelector (std::string& inputOsiSelector,
                                       uint8_t* selectorValue,
                                       const uint8_t selectorSize);
-    void importExchangeConfig (const std::string& exchangeConfig);
+    bool importExchangeConfig (const std::string& exchangeConfig);
+    static bool
+    importExchangeConfig (const std::string& exchangeConfig,
+                          const std::vector<IEC61850ClientConfig*>& configs);
+    void addExchangeDefinition (const std::string& label,
+                                const std::string& pivotId,
+                                const std::string& objRef, CDCTYPE cdcType);
     void importTlsConfig (const std::string& tlsConfig);
 
+    IEC61850ConfigDiff diff (const IEC61850ClientConfig& newConfig) const;
+
     std::vector<std::shared_ptr<RedGroup> >&
     GetConnections ()
     {
@@ -198,26 +276,82 @@ class IEC61850ClientConfig
         return m_caCertificates;
     };
 
+    /* TLS renegotiation interval in ms, 0 disables renegotiation */
+    int
+    tlsRenegotiationTime () const
+    {
+        return m_tlsRenegotiationTime;
+    };
+
+    /* lifetime of resumable TLS sessions in s, 0 disables resumption */
+    int
+    tlsSessionResumptionInterval () const
+    {
+        return m_tlsSessionResumptionInterval;
+    };
+
+    const std::string&
+    iedName () const
+    {
+        return m_iedName;
+    };
+
     static bool isValidIPAddress (const std::string& addrStr);
 
     static int getCdcTypeFromString (const std::string& cdc);
 
-    std::unordered_map<std::string, std::shared_ptr<DataExchangeDefinition> >&
-    ExchangeDefinition ()
+    /* in import order */
+    const std::vector<std::shared_ptr<DataExchangeDefinition> >&
+    ExchangeDefinition () const
     {
-        return m_exchangeDefinitions;
+        return m_definitionIndex.definitions ();
     };
 
     static int GetTypeIdByName (const std::string& name);
 
     std::string* checkExchangeDataLayer (int typeId, std::string& objRef);
 
+    /* the returned definitions live as long as the configuration */
+    DataExchangeDefinition*
+    getExchangeDefinitionByLabel (const std::string& label) const
+    {
+        return m_definitionIndex.get (IEC61850DefinitionIndex::LABEL, label);
+    };
+    DataExchangeDefinition*
+    getExchangeDefinitionByPivotId (const std::string& pivotId) const
+    {
+        return m_definitionIndex.get (IEC61850DefinitionIndex::PIVOT_ID,
+                                      pivotId);
+    };
+    DataExchangeDefinition*
+    getExchangeDefinitionByPivotId (const char* pivotId, size_t len) const
+    {
+        return m_definitionIndex.get (IEC61850DefinitionIndex::PIVOT_ID,
+                                      pivotId, len);
+    };
+    DataExchangeDefinition*
+    getExchangeDefinitionByObjRef (const std::string& objRef) const
+    {
+        return m_definitionIndex.get (IEC61850DefinitionIndex::OBJ_REF,
+                                      objRef);
+    };
+    DataExchangeDefinition*
+    getExchangeDefinitionByObjRef (const char* objRef, size_t len) const
+    {
+        return m_definitionIndex.get (IEC61850DefinitionIndex::OBJ_REF,
+                                      objRef, len);
+    };
+    /* for holders that may outlive the configuration, nullptr if none */
     std::shared_ptr<DataExchangeDefinition>
-    getExchangeDefinitionByLabel (const std::string& label);
-    std::shared_ptr<DataExchangeDefinition>
-    getExchangeDefinitionByPivotId (const std::string& pivotId);
-    std::shared_ptr<DataExchangeDefinition>
-    getExchangeDefinitionByObjRef (const std::string& objRef);
+    sharedExchangeDefinitionByObjRef (const std::string& objRef) const
+    {
+        uint32_t id = m_definitionIndex.find (
+            IEC61850DefinitionIndex::OBJ_REF, objRef.data (), objRef.size ());
+
+        return id < m_definitionIndex.size ()
+                   ? m_definitionIndex.definitions ()[id]
+                   : nullptr;
+    };
 
     const std::unordered_map<std::string,
                              std::shared_ptr<ReportSubscription> >&
@@ -230,13 +364,6 @@ class IEC61850ClientConfig
     {
         return m_datasets;
     };
-    const std::unordered_map<std::string,
-                             std::shared_ptr<DataExchangeDefinition> >&
-    polledDatapoints () const
-    {
-        return m_polledDatapoints;
-    };
-
     long
     getPollingInterval () const
     {
@@ -249,22 +376,111 @@ class IEC61850ClientConfig
         return m_backupConnectionTimeout;
     };
 
+    int
+    reactorThreads () const
+    {
+        return m_reactorThreads;
+    };
+
+    bool
+    modelCacheEnabled () const
+    {
+        return m_modelCacheEnabled;
+    };
+
+    /* ICD, CID or SCD file describing the IED model, empty if none */
+    const std::string&
+    sclFile () const
+    {
+        return m_sclFile;
+    };
+
+    int
+    bringUpWindow () const
+    {
+        return m_bringUpWindow;
+    };
+
+    bool
+    keepDatasets () const
+    {
+        return m_keepDatasets;
+    };
+
+    CONTROLOBJECTS
+    controlObjects () const
+    {
+        return m_controlObjects;
+    };
+
+    /* minimum time between two GIs triggered by sequence gaps on an RCB,
+     * 0 disables them */
+    int
+    resyncGiInterval () const
+    {
+        return m_resyncGiInterval;
+    };
+
+    /* maximum number of outstanding GIs per connection */
+    int
+    giConcurrency () const
+    {
+        return m_giConcurrency;
+    };
+
+    /* minimum time between two GIs of a connection in ms */
+    int
+    giSpacing () const
+    {
+        return m_giSpacing;
+    };
+
+    /* deadlines of the commands of a cdc */
+    const CommandTimeouts&
+    commandTimeouts (int cdcType) const
+    {
+        if (cdcType < 0 || cdcType > ING)
+            return m_commandTimeouts[ING + 1];
+
+        return m_commandTimeouts[cdcType];
+    };
+
+    /* prefixes of the logical devices whose RCBs are interrogated first */
+    const std::vector<std::string>&
+    giPriorities () const
+    {
+        return m_giPriorities;
+    };
+
   private:
+    friend class ExchangeConfigHandler;
+    friend class IEC61850ConfigSnapshot;
+
+    static std::shared_ptr<DataExchangeDefinition>
+    createExchangeDefinition (CDCTYPE cdcType);
+    static void initExchangeDefinition (DataExchangeDefinition& def,
+                                        CDCTYPE cdcType);
+
+    /* restores the definitions from the snapshot or compiles a new one */
+    static void importExchangeConfigSnapshot (
+        const std::string& exchangeConfig,
+        const std::vector<IEC61850ClientConfig*>& configs,
+        const std::string& iedNames);
+
     static bool isMessageTypeMatching (int expectedType, int rcvdType);
 
+    static IEC61850ClientConfig*
+    findIedConfig (const std::vector<IEC61850ClientConfig*>& configs,
+                   const std::string& iedName);
+
+    std::string m_iedName;
+
     std::vector<std::shared_ptr<RedGroup> > m_connections;
 
     void deleteExchangeDefinitions ();
 
-    std::unordered_map<std::string, std::shared_ptr<DataExchangeDefinition> >
-        m_polledDatapoints;
     std::unordered_map<std::string, std::shared_ptr<Dataset> > m_datasets;
-    std::unordered_map<std::string, std::shared_ptr<DataExchangeDefinition> >
-        m_exchangeDefinitions;
-    std::unordered_map<std::string, std::shared_ptr<DataExchangeDefinition> >
-        m_exchangeDefinitionsPivotId;
-    std::unordered_map<std::string, std::shared_ptr<DataExchangeDefinition> >
-        m_exchangeDefinitionsObjRef;
+    IEC61850DefinitionIndex m_definitionIndex;
 
     std::unordered_map<std::string, std::shared_ptr<ReportSubscription> >
         m_reportSubscriptions;
@@ -276,10 +492,33 @@ class IEC61850ClientConfig
     std::string m_ownCertificate = "";
     std::vector<std::string> m_remoteCertificates;
     std::vector<std::string> m_caCertificates;
+    int m_tlsRenegotiationTime = 60000;
+    int m_tlsSessionResumptionInterval = 21600;
 
     uint64_t m_backupConnectionTimeout = 5000;
 
     long pollingInterval = 0;
+
+    int m_reactorThreads = 0;
+
+    bool m_modelCacheEnabled = false;
+
+    std::string m_sclFile;
+
+    int m_bringUpWindow = 8;
+
+    bool m_keepDatasets = false;
+
+    CONTROLOBJECTS m_controlObjects = CONTROLS_AT_BRINGUP;
+
+    int m_resyncGiInterval = 10000;
+
+    int m_giConcurrency = 4;
+    int m_giSpacing = 50;
+    std::vector<std::string> m_giPriorities;
+
+    /* by cdc, the last one holds the defaults */
+    CommandTimeouts m_commandTimeouts[ING + 2];
     FRIEND_TESTS
 };
 
@@ -4,11 +4,20 @@
 #include "datapoint.h"
 #include "iec61850_client_config.hpp"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <functional>
 #include <libiec61850/iec61850_client.h>
 #include <mutex>
 #include <thread>
+#include <unordered_set>
 
+class IEC61850AsyncPipeline;
 class IEC61850Client;
+class IEC61850GiScheduler;
+class IEC61850ModelCache;
+class IEC61850Reactor;
+class IEC61850SettingBatch;
+class IEC61850TimerWheel;
 
 class IEC61850ClientConnection
 {
@@ -16,12 +25,14 @@ class IEC61850ClientConnection
     IEC61850ClientConnection (IEC61850Client* client,
                               IEC61850ClientConfig* config,
                               const std::string& ip, int tcpPort, bool tls,
-                              OsiParameters* osiParameters);
+                              OsiParameters* osiParameters,
+                              IEC61850Reactor* reactor = nullptr);
 
     ~IEC61850ClientConnection ();
 
     void Start ();
     void Stop ();
+    bool tick ();
     void Activate ();
 
     void Disconnect ();
@@ -61,14 +72,20 @@ class IEC61850ClientConnection
                                                const char* objRef,
                                                FunctionalConstraint fc);
 
-    bool operate (const std::string& objRef, DatapointValue value);
+    /* commandId is tracked by the client until the last acknowledgement */
+    bool operate (const std::string& objRef, DatapointValue value,
+                  uint64_t commandId);
 
     static void writeHandler (uint32_t invokeId, void* parameter,
                               IedClientError err);
 
-    bool writeValue (Datapoint* operation, const std::string& objRef, DatapointValue value,
+    bool writeValue (const std::string& objRef, DatapointValue value,
                      CDCTYPE type);
 
+    /* writes the settings per LD, the client acknowledges the batch once
+     * every LD is done */
+    bool writeSettings (const std::shared_ptr<IEC61850SettingBatch>& batch);
+
     const std::string&
     IP ()
     {
@@ -80,8 +97,46 @@ class IEC61850ClientConnection
         return m_tcpPort;
     };
 
+    /* ms from connection attempt to first report, 0 if none received yet */
+    uint64_t
+    timeToFirstReport () const
+    {
+        return m_timeToFirstReport;
+    };
+
+    /* SeqNum/SubSeqNum tracking of the reports of one RCB */
+    struct ReportSequence
+    {
+        uint32_t modulus = 256;
+        bool valid = false;
+        uint16_t seqNum = 0;
+        uint16_t subSeqNum = 0;
+        bool moreSegments = false;
+
+        uint64_t gaps = 0;
+        uint64_t lastResyncTime = 0;
+        bool resyncPending = false;
+
+        /* returns true when reports were lost before this one */
+        bool update (uint16_t newSeqNum, bool hasSubSeqNum,
+                     uint16_t newSubSeqNum, bool moreSegmentsFollow);
+    };
+
+    /* number of sequence gaps detected on an RCB since start */
+    uint64_t sequenceGaps (const std::string& rcbRef);
+
+    /* queues a GI on the RCBs, on every RCB when rcbRefs is empty */
+    void requestGI (const std::vector<std::string>& rcbRefs);
+
+    /* switches to newConfig, only what changed is set up again on the
+     * current association */
+    void applyConfig (IEC61850ClientConfig* newConfig,
+                      const IEC61850ConfigDiff& diff);
+
   private:
     bool prepareConnection ();
+    TLSConfiguration m_createTlsConfig ();
+    std::string m_tlsSignature ();
     bool
     UseTLS ()
     {
@@ -96,6 +151,9 @@ class IEC61850ClientConnection
     IEC61850ClientConfig* m_config;
 
     static void reportCallbackFunction (void* parameter, ClientReport report);
+    static void handleReport (IEC61850ClientConnection* con,
+                              LinkedList dataSetDirectory,
+                              ClientReport report);
 
     static void writeVariableHandler (uint32_t invokeId, void* parameter,
                                       MmsError err,
@@ -104,7 +162,9 @@ class IEC61850ClientConnection
     using ConState = enum {
         CON_STATE_IDLE,
         CON_STATE_CONNECTING,
+        CON_STATE_BRINGUP,
         CON_STATE_CONNECTED,
+        CON_STATE_CLOSING,
         CON_STATE_CLOSED,
         CON_STATE_WAIT_FOR_RECONNECT,
         CON_STATE_FATAL_ERROR
@@ -116,31 +176,180 @@ class IEC61850ClientConnection
         CONTROL_IDLE,
         CONTROL_WAIT_FOR_SELECT,
         CONTROL_WAIT_FOR_SELECT_WITH_VALUE,
-        CONTROL_SELECTED,
         CONTROL_WAIT_FOR_ACT_CON,
         CONTROL_WAIT_FOR_ACT_TERM
     };
 
-    using ControlObjectStruct = struct
+    struct ControlObjectStruct;
+
+    /* parameter of the callbacks of one command */
+    struct ControlContext
+    {
+        IEC61850ClientConnection* connection;
+        ControlObjectStruct* cos;
+        /* responses to an older command of the object are ignored */
+        uint64_t commandId;
+    };
+
+    /* contexts of an object, reused in turn by its commands */
+    static const int CONTROL_CONTEXTS = 4;
+
+    struct ControlObjectStruct
     {
         ControlObjectClient client;
         OperationState state;
         ControlModel mode;
         MmsValue* value;
         std::string label;
+        CDCTYPE cdcType;
+        /* command in progress, a second one on the object is rejected */
+        std::atomic<uint64_t> commandId{ 0 };
+        /* select and operate requests whose response is outstanding */
+        std::atomic<int> requests{ 0 };
+        ControlContext contexts[CONTROL_CONTEXTS];
+        unsigned int nextContext = 0;
     };
 
     std::unordered_map<std::string, ControlObjectStruct*> m_controlObjects;
+    /* removed by a reconfiguration, destroyed once no response is
+     * outstanding or with the connection */
+    std::vector<ControlObjectStruct*> m_retiredControls;
+    /* guards m_controlObjects and m_retiredControls against the lookups of
+     * operate */
+    std::mutex m_controlLock;
+
+    /* command on an object not created yet, sent once it is */
+    struct LazyCommand
+    {
+        std::string objRef;
+        DatapointValue value;
+        uint64_t commandId;
+    };
+
+    /* queued by operate, guarded by m_controlLock */
+    std::vector<LazyCommand> m_lazyCommands;
+    /* objects being created, with what waits for them */
+    std::unordered_map<std::string,
+                       std::vector<std::function<void (ControlObjectStruct*)> > >
+        m_pendingControls;
     std::vector<std::pair<IEC61850ClientConnection*, LinkedList>*>
         m_connDataSetDirectoryPairs;
-    std::vector<std::pair<IEC61850ClientConnection*, ControlObjectStruct*>*>
-        m_connControlPairs;
+
+    /* parameter of the callback of a write, with a value of each written
+     * type */
+    struct WriteContext
+    {
+        IEC61850ClientConnection* connection = nullptr;
+        MmsValue* booleanValue = nullptr;
+        MmsValue* integerValue = nullptr;
+        MmsValue* floatValue = nullptr;
+        MmsValue* value = nullptr;
+        std::atomic<bool> busy{ false };
+    };
+
+    /* maximum number of writes in progress on the connection */
+    static const int WRITE_CONTEXTS = 16;
+
+    WriteContext m_writeContexts[WRITE_CONTEXTS];
+    WriteContext* m_acquireWriteContext ();
+
+    /* variables of one multi-variable write request */
+    static const size_t SETTINGS_PER_REQUEST = 32;
+
+    /* setting batches in progress, acknowledged on a lost connection */
+    std::vector<std::shared_ptr<IEC61850SettingBatch> > m_settingBatches;
+    void m_writeLdSettings (const std::shared_ptr<IEC61850SettingBatch>& batch,
+                            const std::string& domain,
+                            const std::vector<size_t>& settings,
+                            const std::function<void ()>& done);
+    void m_editLdSettings (const std::shared_ptr<IEC61850SettingBatch>& batch,
+                           const std::string& domain,
+                           const std::vector<size_t>& settings);
+    void
+    m_confirmLdSettings (const std::shared_ptr<IEC61850SettingBatch>& batch,
+                         const std::vector<size_t>& settings,
+                         const std::string& sgcbRef);
+    void m_writeSgcb (const std::string& reference,
+                      const std::shared_ptr<MmsValue>& value,
+                      const std::function<void (bool)>& done);
+    void m_ldSettingsDone (const std::shared_ptr<IEC61850SettingBatch>& batch);
+
+    /* bring-up after association, run as asynchronous requests */
+    struct RcbBringUp
+    {
+        std::shared_ptr<ReportSubscription> rs;
+        ClientReportControlBlock rcb = nullptr;
+        LinkedList directory = nullptr;
+        /* kept when the RCB is enabled again after a rejected EntryID */
+        std::pair<IEC61850ClientConnection*, LinkedList>* reportParameter
+            = nullptr;
+        bool enabled = false;
+        bool failed = false;
+    };
+
+    IEC61850AsyncPipeline* m_pipeline;
+    std::vector<std::shared_ptr<RcbBringUp> > m_rcbBringUps;
+    std::unordered_set<std::string> m_pendingDatasets;
+    std::unordered_set<std::string> m_recreatedDatasets;
+    /* directories already verified during this bring-up */
+    std::unordered_map<std::string, std::vector<std::string> >
+        m_datasetDirectories;
+    int m_pendingSpecs = 0;
+    uint64_t m_bringUpStartTime = 0;
+
+    /* nullptr for a full bring-up, the changes for a reconfiguration */
+    std::shared_ptr<IEC61850ConfigDiff> m_bringUpDiff;
+
+    void m_startBringUp (
+        const std::shared_ptr<IEC61850ConfigDiff>& diff = nullptr,
+        const std::vector<std::string>& disabledRcbs = {},
+        const std::vector<std::string>& deletedDatasets = {});
+    void m_submitBringUp ();
+    void m_finishBringUp ();
+    void m_releaseBringUp ();
+
+    /* reports are disabled before the association is closed, blocking in
+     * thread mode, through the pipeline in reactor mode */
+    void m_disableReports ();
+    void m_startClosing ();
 
     void m_initialiseControlObjects ();
+    /* created is called with nullptr when the object cannot be created */
+    void m_createControlObject (
+        const std::shared_ptr<DataExchangeDefinition>& def,
+        const std::function<void (ControlObjectStruct*)>& created);
+    ControlObjectStruct*
+    m_addControlObject (const std::shared_ptr<DataExchangeDefinition>& def,
+                        ControlModel model, MmsVariableSpecification* coSpec);
+    void m_createLazyControls ();
+    /* the retired control objects without outstanding response */
+    void m_destroyRetiredControls ();
+    /* negative acknowledgement of a command queued for its object */
+    void m_rejectCommand (const std::string& objRef, uint64_t commandId);
+    bool m_operate (ControlObjectStruct* co, const std::string& objRef,
+                    DatapointValue value, uint64_t commandId);
     void m_configDatasets ();
+    void m_createDataset (const std::shared_ptr<Dataset>& dataset);
+    void m_datasetReady (const std::string& datasetRef);
     void m_configRcb ();
+    void m_readRcbValues (const std::shared_ptr<RcbBringUp>& rcb);
+    void m_readRcbDirectory (const std::shared_ptr<RcbBringUp>& rcb);
+    void m_enableRcbs ();
     void m_setVarSpecs ();
+    void
+    m_fetchSpec (const std::string& objRef, FunctionalConstraint fc,
+                 const std::function<void (MmsVariableSpecification*)>& handler);
+    void m_fetchDataSpec (
+        const std::string& objRef, FunctionalConstraint fc,
+        const std::function<void (MmsVariableSpecification*)>& handler);
+    void m_setSpecType (const std::shared_ptr<DataExchangeDefinition>& def,
+                        const MmsVariableSpecification* spec);
     void m_setOsiConnectionParameters ();
+    void m_checkModelCache ();
+    std::string datasetCacheKey (const std::string& datasetRef);
+
+    IEC61850ModelCache* m_modelCache = nullptr;
+    bool m_modelCacheValid = false;
 
     OsiParameters* m_osiParameters;
     int m_tcpPort;
@@ -152,16 +361,36 @@ class IEC61850ClientConnection
     bool m_useTls = false;
 
     TLSConfiguration m_tlsConfig = nullptr;
+    std::string m_tlsConfigSignature;
 
     std::mutex m_conLock;
     std::mutex m_reportLock;
 
+    /* by RCB reference, guarded by m_reportLock */
+    std::unordered_map<std::string, ReportSequence> m_reportSequences;
+    void m_checkReportSequence (ClientReport report);
+    void m_resyncRcbs ();
+
+    IEC61850GiScheduler* m_giScheduler;
+    void m_sendGis ();
+
+    /* deadline of the current step of each command, by command id */
+    IEC61850TimerWheel* m_commandTimers;
+    void m_checkCommandTimeouts ();
+
     uint64_t m_delayExpirationTime;
 
+    uint64_t m_connectStartTime = 0;
+    std::atomic<uint64_t> m_timeToFirstReport{ 0 };
+
     uint64_t m_nextPollingTime = 0;
 
     std::thread* m_conThread = nullptr;
     void _conThread ();
+    void handleConnectionState ();
+
+    IEC61850Reactor* m_reactor = nullptr;
+    int m_reactorTask = -1;
 
     bool m_connect = false;
     bool m_disconnect = false;
@@ -169,13 +398,23 @@ class IEC61850ClientConnection
     static void controlActionHandler (uint32_t invokeId, void* parameter,
                                       IedClientError err,
                                       ControlActionType type, bool success);
+    static void handleControlAction (ControlContext* context,
+                                     ControlActionType type, bool success);
 
     void sendActCon (const ControlObjectStruct* cos);
-
-    void sendActTerm (const ControlObjectStruct* cos);
+    /* releases the object, then sends the positive acknowledgement that
+     * completes its command, ActTerm when terminated */
+    void m_completeControl (ControlObjectStruct* cos, bool terminated);
+    /* enters state and arms the timeout of the step for the cdc */
+    void m_superviseControl (ControlObjectStruct* cos, OperationState state);
+    /* releases the object with a negative acknowledgement of commandId,
+     * false if the command is no longer in progress */
+    bool m_abortControl (ControlObjectStruct* cos, uint64_t commandId);
 
     static void commandTerminationHandler (void* parameter,
                                            ControlObjectClient connection);
+    static void handleCommandTermination (ControlContext* context,
+                                          ControlObjectClient connection);
 
     static void logControlErrors (ControlAddCause addCause,
                                   ControlLastApplError lastApplError,
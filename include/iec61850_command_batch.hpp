@@ -0,0 +1,88 @@
+#ifndef IEC61850_COMMAND_BATCH_H
+#define IEC61850_COMMAND_BATCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+ * Commands of a PivotCommandBatch operation and their ordering.
+ *
+ * {"PivotCommandBatch":{"Identifier":"BAY1", "Sequential":false,
+ *   "Commands":[{"Id":"Q0", "GTIC":{...}},
+ *               {"Id":"Q1", "After":["Q0"], "GTIC":{...}}]}}
+ *
+ * A command is sent once the commands it comes after (listed before it)
+ * are confirmed, the others are sent at once. With Sequential every
+ * command also comes after the previous one. When a command fails the
+ * commands depending on it are skipped.
+ *
+ * Not synchronised, the plugin serialises the calls of a batch.
+ */
+class IEC61850CommandBatch
+{
+  public:
+    enum StepState
+    {
+        PENDING,
+        RUNNING,
+        CONFIRMED,
+        FAILED,
+        SKIPPED
+    };
+
+    struct Step
+    {
+        std::string key;
+        /* PivotCommand of the step */
+        std::string json;
+        std::vector<size_t> dependents;
+        int waitingFor = 0;
+        StepState state = PENDING;
+    };
+
+    /* false if the batch is malformed */
+    bool parse (const std::string& json);
+
+    /* false if the key is already used or a step of after is unknown */
+    bool addStep (const std::string& key, const std::string& json,
+                  const std::vector<std::string>& after);
+
+    /* steps that can be sent now, they are then running */
+    std::vector<size_t> start ();
+
+    /* result of a running step, returns the steps that can be sent now */
+    std::vector<size_t> done (size_t step, bool confirmed);
+
+    bool finished () const;
+
+    size_t count (StepState state) const;
+
+    const Step&
+    step (size_t index) const
+    {
+        return m_steps[index];
+    };
+
+    size_t
+    size () const
+    {
+        return m_steps.size ();
+    };
+
+    const std::string&
+    identifier () const
+    {
+        return m_identifier;
+    };
+
+  private:
+    std::vector<size_t> ready ();
+    void skipDependents (size_t step);
+
+    std::string m_identifier;
+    std::vector<Step> m_steps;
+    size_t m_finished = 0;
+};
+
+#endif /* IEC61850_COMMAND_BATCH_H */
@@ -0,0 +1,85 @@
+#ifndef IEC61850_COMMAND_TRACKER_H
+#define IEC61850_COMMAND_TRACKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/*
+ * Commands sent and not yet acknowledged, by command id.
+ *
+ * Ids are a sequence shared by all the commands of a client, so any
+ * number of commands can be in flight on different objects. The commands
+ * are spread over independently locked shards because they are added by
+ * the operation thread and completed from the libiec61850 callbacks of
+ * every connection.
+ */
+class IEC61850CommandTracker
+{
+  public:
+    static const uint64_t NO_COMMAND = 0;
+
+    struct Command
+    {
+        std::string label;
+        /* echoed in the acknowledgements */
+        std::string json;
+        /* step of a command batch, batchId 0 if none */
+        uint64_t batchId = 0;
+        size_t step = 0;
+    };
+
+    /* called when a command of a batch is removed, confirmed by the last
+     * positive acknowledgement */
+    using CompletionHandler
+        = std::function<void (const Command& command, bool confirmed)>;
+
+    /* set before the first command is added */
+    void
+    setCompletionHandler (const CompletionHandler& handler)
+    {
+        m_completionHandler = handler;
+    };
+
+    uint64_t add (const std::string& label, const std::string& json,
+                  uint64_t batchId = 0, size_t step = 0);
+
+    /* copies the command, false if it is not tracked (anymore) */
+    bool get (uint64_t id, Command& command) const;
+
+    bool remove (uint64_t id, bool confirmed = false);
+
+    size_t size () const;
+
+  private:
+    static const size_t SHARD_COUNT = 16;
+
+    struct Shard
+    {
+        mutable std::mutex lock;
+        std::unordered_map<uint64_t, Command> commands;
+    };
+
+    const Shard&
+    shard (uint64_t id) const
+    {
+        return m_shards[id % SHARD_COUNT];
+    };
+
+    Shard&
+    shard (uint64_t id)
+    {
+        return m_shards[id % SHARD_COUNT];
+    };
+
+    CompletionHandler m_completionHandler;
+
+    std::atomic<uint64_t> m_nextId{ 1 };
+    Shard m_shards[SHARD_COUNT];
+};
+
+#endif /* IEC61850_COMMAND_TRACKER_H */
@@ -0,0 +1,80 @@
+#ifndef IEC61850_CONFIG_SNAPSHOT_H
+#define IEC61850_CONFIG_SNAPSHOT_H
+
+#include "iec61850_client_config.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Compiled image of the exchanged_data configuration.
+ *
+ * The image holds the exchange definitions of every IED configuration, a
+ * string table and the lookup tables of their definition index. It is
+ * tagged with a hash of the JSON it was compiled from and is loaded
+ * through a read-only mapping, so an unchanged configuration is restored
+ * without parsing JSON or hashing any key. The definitions are allocated
+ * in one block per configuration, their strings are copied from the
+ * string table.
+ *
+ * Only exchanged_data is compiled. Datasets, report subscriptions and the
+ * rest of protocol_stack are imported from the JSON on every start, the
+ * datasets then mark the definitions they report as not polled.
+ */
+class IEC61850ConfigSnapshot
+{
+  public:
+    explicit IEC61850ConfigSnapshot (const std::string& fileName);
+
+    static std::string snapshotFileName (const std::string& iedNames);
+
+    /* identifies the exchanged_data and how it is split between the IEDs */
+    static uint64_t configHash (const std::string& exchangeConfig,
+                                const std::vector<IEC61850ClientConfig*>& configs);
+
+    /* false if there is no valid image for this hash and set of IEDs */
+    bool load (uint64_t hash,
+               const std::vector<IEC61850ClientConfig*>& configs);
+    bool save (uint64_t hash,
+               const std::vector<IEC61850ClientConfig*>& configs);
+
+  private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t configHash;
+        uint64_t checksum;
+        uint64_t size;
+        uint32_t configCount;
+        uint32_t stringTableSize;
+    };
+
+    struct ConfigHeader
+    {
+        uint32_t definitionCount;
+        uint32_t capacities[IEC61850DefinitionIndex::KEY_COUNT];
+    };
+
+    struct Definition
+    {
+        uint32_t label;
+        uint32_t labelLength;
+        uint32_t pivotId;
+        uint32_t pivotIdLength;
+        uint32_t objRef;
+        uint32_t objRefLength;
+        int32_t cdcType;
+        uint32_t reserved;
+    };
+
+    static uint64_t checksum (const uint8_t* data, size_t size,
+                              uint64_t hash);
+
+    bool restore (const uint8_t* data, size_t size,
+                  const std::vector<IEC61850ClientConfig*>& configs);
+
+    std::string m_fileName;
+};
+
+#endif /* IEC61850_CONFIG_SNAPSHOT_H */
@@ -0,0 +1,116 @@
+#ifndef IEC61850_DEFINITION_INDEX_H
+#define IEC61850_DEFINITION_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct DataExchangeDefinition;
+
+/*
+ * Lookup index of the exchange definitions of a configuration.
+ *
+ * Definitions get a dense id in import order. There is one flat open
+ * addressing table of ids per key (label, pivot id, object reference)
+ * so a lookup is a hash of the key plus a few linear probes, without
+ * allocating or touching any reference count. Keys can be looked up
+ * from any character range, not only from a std::string.
+ *
+ * The index keeps the definitions alive. Returned pointers stay valid
+ * until clear () is called or the index is destroyed.
+ */
+class IEC61850DefinitionIndex
+{
+  public:
+    enum Key
+    {
+        LABEL = 0,
+        PIVOT_ID,
+        OBJ_REF,
+        KEY_COUNT
+    };
+
+    static const uint32_t INVALID_ID = 0xffffffff;
+
+    struct Slot
+    {
+        uint32_t hash;
+        uint32_t id;
+    };
+
+    void clear ();
+
+    /* the first definition added for a key wins, like a map insert */
+    uint32_t add (const std::shared_ptr<DataExchangeDefinition>& def);
+
+    uint32_t find (Key key, const char* str, size_t len) const;
+
+    DataExchangeDefinition*
+    get (Key key, const char* str, size_t len) const
+    {
+        return definition (find (key, str, len));
+    };
+
+    DataExchangeDefinition*
+    get (Key key, const std::string& str) const
+    {
+        return definition (find (key, str.data (), str.size ()));
+    };
+
+    DataExchangeDefinition*
+    definition (uint32_t id) const
+    {
+        return id < m_definitions.size () ? m_definitions[id].get ()
+                                          : nullptr;
+    };
+
+    size_t
+    size () const
+    {
+        return m_definitions.size ();
+    };
+
+    /* by id */
+    const std::vector<std::shared_ptr<DataExchangeDefinition> >&
+    definitions () const
+    {
+        return m_definitions;
+    };
+
+    /* raw table of a key, so it can be stored along with the definitions */
+    const std::vector<Slot>&
+    table (Key key) const
+    {
+        return m_tables[key].slots;
+    };
+
+    /*
+     * Replaces the content of the index by stored definitions and tables,
+     * without hashing any key. Fails if a table is not consistent.
+     */
+    bool restore (
+        std::vector<std::shared_ptr<DataExchangeDefinition> >& definitions,
+        const Slot* const tables[KEY_COUNT],
+        const uint32_t capacities[KEY_COUNT]);
+
+  private:
+    struct Table
+    {
+        std::vector<Slot> slots;
+        size_t used = 0;
+    };
+
+    static uint32_t hashKey (const char* str, size_t len);
+    static const std::string& keyOf (const DataExchangeDefinition& def,
+                                     Key key);
+
+    bool insert (Table& table, Key key, uint32_t hash, uint32_t id);
+    void grow (Table& table, Key key);
+
+    std::vector<std::shared_ptr<DataExchangeDefinition> > m_definitions;
+    Table m_tables[KEY_COUNT];
+};
+
+#endif /* IEC61850_DEFINITION_INDEX_H */
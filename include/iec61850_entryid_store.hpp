@@ -0,0 +1,82 @@
+#ifndef IEC61850_ENTRYID_STORE_H
+#define IEC61850_ENTRYID_STORE_H
+
+#include <cstdint>
+#include <libiec61850/mms_value.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define ENTRYID_MAX_RCB_REF 130
+#define ENTRYID_MAX_SIZE 16
+
+/*
+ * Last EntryID received for each buffered report control block.
+ *
+ * The records live in a memory mapped file so that every update is
+ * persistent as soon as it is written, even if the process crashes. Each
+ * record has two slots written alternately, each with a sequence number
+ * and a checksum, so a torn write never loses the previous EntryID.
+ * Without a usable file the store is kept in memory only.
+ */
+class IEC61850EntryIdStore
+{
+  public:
+    explicit IEC61850EntryIdStore (const std::string& fileName);
+    ~IEC61850EntryIdStore ();
+
+    static std::string storeFileName (const std::string& iedName,
+                                      const std::string& ip, int port);
+
+    /* maps the records of rcbRefs, keeping the EntryIDs already received,
+     * also when the store is in memory only, or stored in the file */
+    bool open (const std::vector<std::string>& rcbRefs);
+
+    /* returns a copy owned by the caller or nullptr when unknown */
+    MmsValue* get (const std::string& rcbRef);
+    void set (const std::string& rcbRef, const MmsValue* entryId);
+    void clear (const std::string& rcbRef);
+
+    void flush ();
+
+  private:
+    struct Slot
+    {
+        uint32_t seq;
+        uint32_t size;
+        uint8_t entryId[ENTRYID_MAX_SIZE];
+        uint32_t checksum;
+    };
+
+    struct Record
+    {
+        char rcbRef[ENTRYID_MAX_RCB_REF];
+        Slot slots[2];
+    };
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;
+    };
+
+    static uint32_t checksum (const Slot& slot);
+    static const Slot* currentSlot (const Record& record);
+    void write (Record& record, const uint8_t* entryId, uint32_t size);
+    void close ();
+
+    std::string m_fileName;
+
+    void* m_map = nullptr;
+    size_t m_mapSize = 0;
+    std::vector<Record> m_memory;
+
+    Record* m_records = nullptr;
+    std::unordered_map<std::string, Record*> m_index;
+
+    std::mutex m_lock;
+};
+
+#endif /* IEC61850_ENTRYID_STORE_H */
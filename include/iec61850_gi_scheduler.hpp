@@ -0,0 +1,63 @@
+#ifndef IEC61850_GI_SCHEDULER_H
+#define IEC61850_GI_SCHEDULER_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * Spreads the general interrogations of the RCBs of a connection over
+ * time.
+ *
+ * At most "concurrency" GIs are outstanding and two GIs are sent at least
+ * "spacing" ms apart. RCBs of the logical devices listed in the priorities
+ * (by name prefix, first match wins) are served before the others, in the
+ * order of the list. Within a priority the GIs are served in the order
+ * they were requested.
+ */
+class IEC61850GiScheduler
+{
+  public:
+    IEC61850GiScheduler (int concurrency, uint64_t spacingMs,
+                         const std::vector<std::string>& priorities);
+
+    /* a GI already waiting for the RCB is not queued twice */
+    void request (const std::string& rcbRef);
+
+    /* RCBs whose GI is to be sent now, they are then outstanding */
+    std::vector<std::string> due (uint64_t currentTime);
+
+    void done (const std::string& rcbRef);
+
+    void clear ();
+
+    size_t pending ();
+    size_t outstanding ();
+
+  private:
+    struct Entry
+    {
+        std::string rcbRef;
+        int priority;
+        uint64_t order;
+    };
+
+    int priority (const std::string& rcbRef) const;
+
+    int m_concurrency;
+    uint64_t m_spacing;
+    std::vector<std::string> m_priorities;
+
+    std::vector<Entry> m_queue;
+    std::unordered_set<std::string> m_queued;
+    std::unordered_set<std::string> m_outstanding;
+    uint64_t m_nextOrder = 0;
+    uint64_t m_lastSent = 0;
+    bool m_sent = false;
+
+    std::mutex m_lock;
+};
+
+#endif /* IEC61850_GI_SCHEDULER_H */
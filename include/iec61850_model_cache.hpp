@@ -0,0 +1,74 @@
+#ifndef IEC61850_MODEL_CACHE_H
+#define IEC61850_MODEL_CACHE_H
+
+#include "iec61850_client_config.hpp"
+#include <libiec61850/iec61850_client.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * On-disk cache of the model information discovered online (variable
+ * specifications, control models, dataset directories).
+ *
+ * The cache is only valid for the revisions it was built for. The
+ * revisions are the LLN0.NamPlt.configRev/paramRev values of every
+ * logical device used by the configuration.
+ */
+class IEC61850ModelCache
+{
+  public:
+    using Revisions = std::map<std::string, std::string>;
+
+    explicit IEC61850ModelCache (const std::string& fileName);
+    ~IEC61850ModelCache ();
+
+    static std::string cacheFileName (const std::string& iedName,
+                                      const std::string& ip, int port);
+
+    bool load ();
+    bool save ();
+
+    bool matches (const Revisions& revisions);
+    void reset (const Revisions& revisions);
+
+    /* returns a copy owned by the caller or nullptr */
+    MmsVariableSpecification* getSpec (const std::string& objRef,
+                                       FunctionalConstraint fc);
+    void setSpec (const std::string& objRef, FunctionalConstraint fc,
+                  const MmsVariableSpecification* spec);
+
+    bool getCtlModel (const std::string& objRef, ControlModel& model);
+    void setCtlModel (const std::string& objRef, ControlModel model);
+
+    bool getDatasetDirectory (const std::string& datasetRef,
+                              std::vector<std::string>& entries);
+    void setDatasetDirectory (const std::string& datasetRef,
+                              const std::vector<std::string>& entries);
+
+    static MmsVariableSpecification*
+    copySpec (const MmsVariableSpecification* spec);
+
+  private:
+    void clear ();
+
+    static std::string specKey (const std::string& objRef,
+                                FunctionalConstraint fc);
+
+    std::string m_fileName;
+    bool m_loaded = false;
+    bool m_dirty = false;
+
+    Revisions m_revisions;
+    std::unordered_map<std::string, MmsVariableSpecification*> m_specs;
+    std::unordered_map<std::string, int> m_ctlModels;
+    std::unordered_map<std::string, std::vector<std::string> > m_datasets;
+
+    std::mutex m_lock;
+
+    FRIEND_TESTS
+};
+
+#endif /* IEC61850_MODEL_CACHE_H */
@@ -0,0 +1,67 @@
+#ifndef IEC61850_PIVOT_COMMAND_H
+#define IEC61850_PIVOT_COMMAND_H
+
+#include "iec61850_client_config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * PivotCommand operation decoded in one pass over its JSON.
+ *
+ * Only the elements needed to send the command are extracted, no
+ * Datapoint tree is built. The JSON is parsed in place, so the strings of
+ * the command point into the decoded buffer, which has to outlive the
+ * command.
+ */
+class IEC61850PivotCommand
+{
+  public:
+    struct Value
+    {
+        enum Type
+        {
+            NONE,
+            INTEGER,
+            FLOAT,
+            STRING
+        };
+
+        Type type = NONE;
+        long intValue = 0;
+        double floatValue = 0;
+        const char* str = nullptr;
+        size_t length = 0;
+    };
+
+    /* json is modified, false on a syntax error */
+    bool decode (char* json);
+
+    /* ctlVal, setVal or setMag.f depending on the cdc */
+    const Value& value () const;
+
+    const char* identifier = nullptr;
+    size_t identifierLength = 0;
+
+    /* first cdc element of the command, -1 if none */
+    int cdcType = -1;
+    const char* cdcName = nullptr;
+
+    Value ctlVal;
+    Value setVal;
+    Value setMag;
+
+    /* resolved from the identifier by the plugin before dispatching */
+    const DataExchangeDefinition* def = nullptr;
+
+  private:
+    friend class PivotCommandHandler;
+
+    void reset ();
+
+    /* backing store when the parser cannot hand out in situ strings */
+    std::string m_identifier;
+    std::string m_str;
+};
+
+#endif /* IEC61850_PIVOT_COMMAND_H */
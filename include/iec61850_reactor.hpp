@@ -0,0 +1,77 @@
+#ifndef IEC61850_REACTOR_H
+#define IEC61850_REACTOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Small pool of event loop threads driving many connections.
+ *
+ * Tasks are polled in a loop by the worker they are assigned to. A task
+ * returns true when it has more work pending so the worker does not back
+ * off. Tasks registered with the same affinity key always run on the same
+ * worker, which serializes them without additional locking.
+ */
+class IEC61850Reactor
+{
+  public:
+    using Task = std::function<bool ()>;
+
+    explicit IEC61850Reactor (int threads);
+    ~IEC61850Reactor ();
+
+    void start ();
+    void stop ();
+
+    /*
+     * intervalMs == 0 -> task is called on every loop iteration.
+     * addTask and removeTask must not be called from a reactor task.
+     */
+    int addTask (const Task& task, uint64_t intervalMs, const void* affinity);
+    void removeTask (int taskId);
+
+    int
+    Threads () const
+    {
+        return (int)m_workers.size ();
+    };
+
+  private:
+    struct ReactorTask
+    {
+        int id;
+        Task task;
+        uint64_t intervalMs;
+        uint64_t nextRun;
+    };
+
+    struct Worker
+    {
+        std::thread* thread = nullptr;
+        std::mutex lock;
+        std::vector<ReactorTask> tasks;
+    };
+
+    struct Affinity
+    {
+        Worker* worker;
+        int tasks;
+    };
+
+    std::vector<Worker*> m_workers;
+    std::unordered_map<int, const void*> m_taskAffinities;
+    std::unordered_map<const void*, Affinity> m_affinities;
+    std::mutex m_taskLock;
+    int m_nextTaskId = 0;
+    std::atomic<bool> m_started{ false };
+
+    Worker* workerForAffinity (const void* affinity);
+    void _workerThread (Worker* worker);
+};
+
+#endif /* IEC61850_REACTOR_H */
@@ -0,0 +1,123 @@
+#ifndef IEC61850_SCL_MODEL_H
+#define IEC61850_SCL_MODEL_H
+
+#include "iec61850_client_config.hpp"
+#include "iec61850_model_cache.hpp"
+#include <libiec61850/iec61850_client.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Data model of an IED read from its SCL file (ICD, CID or SCD).
+ *
+ * The model provides offline what the bring-up otherwise reads from the
+ * server: variable specifications, control models, static dataset
+ * directories and the configRev of every logical device. It is used to
+ * fill the model cache, so that a connection only has to check configRev
+ * before using it.
+ */
+class IEC61850SclModel
+{
+  public:
+    /*
+     * iedName selects the IED of an SCD. A file with a single IED is used
+     * whatever the name, the first IED is used if iedName is empty.
+     */
+    bool load (const std::string& fileName, const std::string& iedName);
+    bool parse (const std::string& scl, const std::string& iedName);
+
+    /* LLN0.NamPlt.configRev of every logical device, by LD name */
+    const IEC61850ModelCache::Revisions&
+    revisions () const
+    {
+        return m_revisions;
+    };
+
+    /* returns a specification owned by the caller or nullptr */
+    MmsVariableSpecification* getSpec (const std::string& objRef,
+                                       FunctionalConstraint fc) const;
+
+    bool getCtlModel (const std::string& objRef, ControlModel& model) const;
+
+    bool getDatasetDirectory (const std::string& datasetRef,
+                              std::vector<std::string>& entries) const;
+
+    /*
+     * Replaces the content of the cache by the model information used by
+     * the configuration. Fails if the configRev of a logical device used
+     * by the configuration is unknown.
+     */
+    bool seed (IEC61850ModelCache& cache,
+               const IEC61850ClientConfig& config) const;
+
+    /* configRev of the logical devices used by the configuration */
+    bool configRevisions (const IEC61850ClientConfig& config,
+                          IEC61850ModelCache::Revisions& revisions) const;
+
+  private:
+    struct XmlElement
+    {
+        std::string name;
+        std::vector<std::pair<std::string, std::string> > attributes;
+        std::string text;
+        std::vector<XmlElement> children;
+
+        const std::string& attribute (const char* name) const;
+    };
+
+    struct Attribute
+    {
+        std::string name;
+        /* functional constraint of a DA, empty for a BDA or an SDO */
+        std::string fc;
+        std::string bType;
+        std::string type;
+        int count = 0;
+        bool subDataObject = false;
+        std::string value;
+    };
+
+    struct DataObjectType
+    {
+        std::string cdc;
+        std::vector<Attribute> attributes;
+    };
+
+    static bool parseXml (const std::string& xml, XmlElement& root);
+
+    void importTemplates (const XmlElement& templates);
+    void importIed (const XmlElement& ied);
+    void importLogicalNode (const std::string& ldName,
+                            const XmlElement& ln);
+
+    MmsVariableSpecification*
+    createDataObjectSpec (const std::string& name, const std::string& type,
+                          const std::string& fc, bool& valid) const;
+    MmsVariableSpecification*
+    createAttributeSpec (const Attribute& attribute, const std::string& fc,
+                         bool& valid) const;
+    /* valid is cleared when a type of the model cannot be mapped to MMS */
+    MmsVariableSpecification* createBasicSpec (const std::string& name,
+                                               const Attribute& attribute,
+                                               const std::string& fc,
+                                               bool& valid) const;
+
+    static bool parseCtlModel (const std::string& value,
+                               ControlModel& model);
+
+    std::string m_iedName;
+
+    std::unordered_map<std::string, std::vector<Attribute> > m_lnodeTypes;
+    std::unordered_map<std::string, DataObjectType> m_doTypes;
+    std::unordered_map<std::string, std::vector<Attribute> > m_daTypes;
+
+    /* logical node reference -> LNodeType id */
+    std::unordered_map<std::string, std::string> m_lns;
+    std::unordered_map<std::string, int> m_ctlModels;
+    std::unordered_map<std::string, std::vector<std::string> > m_datasets;
+    IEC61850ModelCache::Revisions m_revisions;
+};
+
+#endif /* IEC61850_SCL_MODEL_H */
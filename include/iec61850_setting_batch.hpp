@@ -0,0 +1,88 @@
+#ifndef IEC61850_SETTING_BATCH_H
+#define IEC61850_SETTING_BATCH_H
+
+#include "datapoint.h"
+#include "iec61850_client_config.hpp"
+#include <cstddef>
+#include <libiec61850/mms_value.h>
+#include <string>
+#include <vector>
+
+/*
+ * Settings of a PivotSettingBatch operation.
+ *
+ * {"PivotSettingBatch":{"Identifier":"PROFILE1", "SettingGroup":2,
+ *   "Settings":[{"GTIC":{"Identifier":"SP1", "AsgTyp":{...}}}, ...]}}
+ *
+ * The settings of an LD are written with multi-variable MMS write
+ * requests. With SettingGroup they are written in an edit session of the
+ * group (SGCB EditSG, the SE values, then CnfEdit), an LD whose settings
+ * are not all accepted is not confirmed.
+ */
+class IEC61850SettingBatch
+{
+  public:
+    struct Setting
+    {
+        /* label of the exchanged data, reported in the acknowledgement */
+        std::string label;
+        std::string objRef;
+        CDCTYPE type;
+        MmsValue* value = nullptr;
+
+        /* MMS domain and item of the written attribute */
+        std::string domain;
+        std::string item;
+
+        /* access result of the write */
+        bool accepted = false;
+        /* in effect, i.e. accepted and the edit session confirmed */
+        bool written = false;
+    };
+
+    IEC61850SettingBatch () = default;
+    ~IEC61850SettingBatch ();
+
+    IEC61850SettingBatch (const IEC61850SettingBatch&) = delete;
+    IEC61850SettingBatch& operator= (const IEC61850SettingBatch&) = delete;
+
+    /* commands receives the PivotCommand of each setting, false if the
+     * batch is malformed */
+    bool parse (const std::string& json, std::vector<std::string>& commands);
+
+    /* false if the type is not a setting or objRef not a data object
+     * reference */
+    bool add (const std::string& label, const std::string& objRef,
+              CDCTYPE type, const DatapointValue& value);
+
+    /* domain and item id of reference with the functional constraint fc,
+     * e.g. LD/LN.DO.setVal, SE -> LD, LN$SE$DO$setVal */
+    static bool mmsReference (const std::string& reference, const char* fc,
+                              std::string& domain, std::string& item);
+
+    size_t written () const;
+
+    const std::string&
+    identifier () const
+    {
+        return m_identifier;
+    };
+
+    /* 0 when the settings are written without edit session */
+    int
+    settingGroup () const
+    {
+        return m_settingGroup;
+    };
+
+    std::vector<Setting> settings;
+
+    /* LDs whose settings are not written yet */
+    size_t pendingLds = 0;
+
+  private:
+    std::string m_identifier;
+    int m_settingGroup = 0;
+};
+
+#endif /* IEC61850_SETTING_BATCH_H */
@@ -0,0 +1,66 @@
+#ifndef IEC61850_SPEC_REGISTRY_H
+#define IEC61850_SPEC_REGISTRY_H
+
+#include <libiec61850/iec61850_client.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/*
+ * Variable specification shared by all the data objects with the same
+ * type. The element indexes are resolved once so that values can be
+ * decoded without looking up the children by name.
+ */
+struct IEC61850SpecType
+{
+    MmsVariableSpecification* spec = nullptr;
+
+    int quality = -1;
+    int timestamp = -1;
+    /* stVal, mag, mxVal or valWTr */
+    int value = -1;
+    /* AnalogueValue components of value */
+    int valueF = -1;
+    int valueI = -1;
+    /* ValWithTrans components of value */
+    int posVal = -1;
+    int transInd = -1;
+
+    std::string signature;
+    int refCount = 0;
+
+    /* returns nullptr when the index is unknown or value is not a structure */
+    static MmsValue* element (MmsValue* value, int index);
+};
+
+/*
+ * Interns structurally identical variable specifications. The top level
+ * name is not part of the type signature so GGIO1.Ind1..Ind64 share one
+ * type.
+ */
+class IEC61850SpecRegistry
+{
+  public:
+    IEC61850SpecRegistry () = default;
+    ~IEC61850SpecRegistry ();
+
+    /* spec is copied when its type is not known yet, the caller keeps it */
+    const IEC61850SpecType* intern (const MmsVariableSpecification* spec);
+    void release (const IEC61850SpecType* type);
+
+    size_t size ();
+
+    static std::string signature (const MmsVariableSpecification* spec);
+
+  private:
+    static void appendSignature (std::string& sig,
+                                 const MmsVariableSpecification* spec);
+    static int childIndex (const MmsVariableSpecification* spec,
+                           const char* name);
+    static void compile (IEC61850SpecType* type);
+
+    std::unordered_map<std::string, IEC61850SpecType*> m_types;
+    std::mutex m_lock;
+};
+
+#endif /* IEC61850_SPEC_REGISTRY_H */
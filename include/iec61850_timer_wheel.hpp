@@ -0,0 +1,70 @@
+#ifndef IEC61850_TIMER_WHEEL_H
+#define IEC61850_TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Hashed timer wheel for deadlines in ms.
+ *
+ * A timer is identified by its key, scheduling a key again replaces its
+ * timer. Scheduling and cancelling are O(1), expire only visits the slots
+ * passed since its last call, so the cost does not grow with the number
+ * of timers that complete in time. Deadlines further away than one turn
+ * of the wheel stay in their slot until they are due.
+ */
+class IEC61850TimerWheel
+{
+  public:
+    struct Timer
+    {
+        uint64_t key;
+        /* passed back on expiry, e.g. what the timer supervises */
+        int tag;
+        uint64_t deadline;
+    };
+
+    IEC61850TimerWheel (uint64_t resolutionMs, size_t slotCount);
+
+    void schedule (uint64_t key, int tag, uint64_t deadline);
+
+    void cancel (uint64_t key);
+
+    /* timers whose deadline is reached, they are removed from the wheel */
+    std::vector<Timer> expire (uint64_t currentTime);
+
+    void clear ();
+
+    size_t size ();
+
+  private:
+    struct Entry
+    {
+        Timer timer;
+        uint64_t generation;
+    };
+
+    struct SlotEntry
+    {
+        uint64_t key;
+        uint64_t generation;
+    };
+
+    uint64_t m_resolution;
+    std::vector<std::vector<SlotEntry> > m_slots;
+
+    /* timers by key, slot entries of replaced or cancelled timers are
+     * dropped when their slot is visited */
+    std::unordered_map<uint64_t, Entry> m_timers;
+    uint64_t m_nextGeneration = 0;
+
+    uint64_t m_currentTick = 0;
+    bool m_started = false;
+
+    std::mutex m_lock;
+};
+
+#endif /* IEC61850_TIMER_WHEEL_H */
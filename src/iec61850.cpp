@@ -1,6 +1,10 @@
 #include "iec61850_client_config.hpp"
 #include "plugin_api.h"
 #include <iec61850.hpp>
+#include <iec61850_command_batch.hpp>
+#include <iec61850_pivot_command.hpp>
+#include <iec61850_reactor.hpp>
+#include <iec61850_setting_batch.hpp>
 
 static bool
 isCommandType (CDCTYPE type)
@@ -14,7 +18,21 @@ isWriteType (CDCTYPE type)
     return type >= SPG;
 }
 
-IEC61850::~IEC61850 () { delete m_config; }
+IEC61850::~IEC61850 () { deleteConfigs (); }
+
+void
+IEC61850::deleteConfigs ()
+{
+    for (auto config : m_configs)
+    {
+        if (config != m_config)
+            delete config;
+    }
+    m_configs.clear ();
+
+    delete m_config;
+    m_config = nullptr;
+}
 
 void
 IEC61850::registerIngest (void* data, INGEST_CB cb)
@@ -28,13 +46,101 @@ IEC61850::setJsonConfig (const std::string& protocol_stack,
                          const std::string& exchanged_data,
                          const std::string& tls_configuration)
 {
-    if (m_config)
-        delete m_config;
+    deleteConfigs ();
+
+    m_configs = IEC61850ClientConfig::importIedConfigs (
+        protocol_stack, exchanged_data, tls_configuration);
+    m_config = m_configs.front ();
+}
+
+bool
+IEC61850::reconfigure (const std::string& protocol_stack,
+                       const std::string& exchanged_data,
+                       const std::string& tls_configuration)
+{
+    {
+        std::lock_guard<std::mutex> lock (m_clientsLock);
+
+        if (!m_client)
+            return false;
+    }
+
+    std::vector<IEC61850ClientConfig*> newConfigs
+        = IEC61850ClientConfig::importIedConfigs (
+            protocol_stack, exchanged_data, tls_configuration);
+
+    bool sameIeds = !newConfigs.empty ()
+                    && newConfigs.size () == m_configs.size ()
+                    && newConfigs.front ()->reactorThreads ()
+                           == m_config->reactorThreads ();
+
+    for (size_t i = 0; sameIeds && i < newConfigs.size (); i++)
+    {
+        if (newConfigs[i]->iedName () != m_configs[i]->iedName ())
+            sameIeds = false;
+    }
+
+    if (!sameIeds)
+    {
+        for (auto config : newConfigs)
+            delete config;
 
-    m_config = new IEC61850ClientConfig ();
-    m_config->importExchangeConfig (exchanged_data);
-    m_config->importProtocolConfig (protocol_stack);
-    m_config->importTlsConfig (tls_configuration);
+        return false;
+    }
+
+    /* replaced clients are stopped outside the lock, their threads may
+     * wait for it */
+    std::vector<IEC61850Client*> oldClients;
+    std::vector<IEC61850ClientConfig*> oldConfigs;
+    std::vector<IEC61850Client*> newClients;
+
+    {
+        std::lock_guard<std::mutex> lock (m_clientsLock);
+
+        for (size_t i = 0; i < newConfigs.size (); i++)
+        {
+            IEC61850ConfigDiff diff = m_configs[i]->diff (*newConfigs[i]);
+
+            if (diff.restart)
+            {
+                Iec61850Utility::log_info (
+                    "Connection settings of %s changed -> restart client",
+                    newConfigs[i]->iedName ().c_str ());
+
+                oldClients.push_back (m_clients[i]);
+                oldConfigs.push_back (m_configs[i]);
+
+                m_clients[i]
+                    = new IEC61850Client (this, newConfigs[i], m_reactor);
+                newClients.push_back (m_clients[i]);
+            }
+            else
+            {
+                /* the client deletes the old configuration once its
+                 * callbacks are done with it */
+                m_clients[i]->applyConfig (newConfigs[i], diff);
+            }
+        }
+
+        m_configs = newConfigs;
+        m_config = m_configs.front ();
+        m_client = m_clients.front ();
+    }
+
+    for (auto client : oldClients)
+    {
+        client->stop ();
+        delete client;
+    }
+
+    /* nothing refers to them once their client is gone */
+    for (auto config : oldConfigs)
+        delete config;
+
+    for (auto client : newClients)
+        client->start ();
+
+    return true;
 }
 
 void
@@ -42,7 +148,21 @@ IEC61850::start ()
 {
     Iec61850Utility::log_info ("Starting iec61850");
 
-    m_client = new IEC61850Client (this, m_config);
+    if (m_config->reactorThreads () > 0)
+    {
+        m_reactor = new IEC61850Reactor (m_config->reactorThreads ());
+        m_reactor->start ();
+    }
+
+    if (m_configs.empty ())
+        m_configs.push_back (m_config);
+
+    for (auto config : m_configs)
+    {
+        m_clients.push_back (new IEC61850Client (this, config, m_reactor));
+    }
+
+    m_client = m_clients.front ();
 
     // LCOV_EXCL_START
     if (!m_client)
@@ -52,19 +172,46 @@ IEC61850::start ()
     }
     // LCOV_EXCL_STOP
 
-    m_client->start ();
+    for (auto client : m_clients)
+    {
+        client->start ();
+    }
 }
 
 void
 IEC61850::stop ()
 {
-    if (!m_client)
-        return;
+    std::vector<IEC61850Client*> clients;
+
+    {
+        std::lock_guard<std::mutex> lock (m_clientsLock);
 
-    m_client->stop ();
+        if (!m_client)
+            return;
 
-    delete m_client;
-    m_client = nullptr;
+        /* batches cut short by the stop are not acknowledged */
+        m_client = nullptr;
+        clients.swap (m_clients);
+    }
+
+    for (auto client : clients)
+    {
+        client->stop ();
+        delete client;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock (m_batchLock);
+        m_batches.clear ();
+        m_readySteps.clear ();
+    }
+
+    if (m_reactor)
+    {
+        m_reactor->stop ();
+        delete m_reactor;
+        m_reactor = nullptr;
+    }
 }
 
 void
@@ -77,91 +224,294 @@ IEC61850::ingest (const std::string& assetName,
     }
 }
 
-static Datapoint*
-getCdc (Datapoint* dp)
+bool
+IEC61850::pivotCommand (const std::string& commandJson, uint64_t batchId,
+                        size_t step, bool* pending)
 {
-    DatapointValue& dpv = dp->getData ();
+    /* decoded in place, the original is kept for the acknowledgements */
+    std::string buffer = commandJson;
+    IEC61850PivotCommand command;
 
-    if (dpv.getType () != DatapointValue::T_DP_DICT)
+    if (!command.decode (&buffer[0]))
     {
-        Iec61850Utility::log_error ("Datapoint is not a dictionary %s",
-                                    dp->getName ().c_str ());
+        Iec61850Utility::log_error ("Failed to parse command content");
+        return false;
     }
 
-    std::vector<Datapoint*> const* datapoints = dpv.getDpVec ();
+    if (command.cdcType == -1)
+    {
+        Iec61850Utility::log_warn ("Received pivot object has no cdc");
+        return false;
+    }
 
-    for (Datapoint* child : *datapoints)
+    if (!isCommandType ((CDCTYPE)command.cdcType)
+        && !isWriteType ((CDCTYPE)command.cdcType))
     {
-        if (IEC61850ClientConfig::getCdcTypeFromString (child->getName ())
-            != -1)
-        {
-            return child;
-        }
+        Iec61850Utility::log_warn ("Not a command object %s -> ignore",
+                                   command.cdcName);
+        return false;
     }
 
-    return nullptr;
+    bool res = clientForCommand (command)->handleOperation (
+        command, commandJson, batchId, step);
+
+    /* writes are not acknowledged */
+    if (pending)
+        *pending = res && isCommandType ((CDCTYPE)command.cdcType);
+
+    return res;
 }
 
 bool
-IEC61850::operation (const std::string& operation, int count,
-                     PLUGIN_PARAMETER** params)
+IEC61850::startBatch (const std::string& batchJson)
 {
-    if (m_client == nullptr)
-    {
-        Iec61850Utility::log_error (
-            "operation called but plugin is not yet initialized");
+    auto batch = std::make_shared<IEC61850CommandBatch> ();
 
+    if (!batch->parse (batchJson))
+    {
+        Iec61850Utility::log_error ("Invalid command batch");
         return false;
     }
 
-    if (operation == "PivotCommand")
+    uint64_t batchId;
+    std::vector<size_t> steps;
+
     {
-        std::string commandContentJSON = params[0]->value;
-        Datapoint* commandContent = nullptr;
+        std::lock_guard<std::mutex> lock (m_batchLock);
 
-        DatapointValue temp ((long)1);
-        std::unique_ptr<Datapoint> parserDp (new Datapoint ("Parser", temp));
+        batchId = m_nextBatchId++;
+        m_batches[batchId] = batch;
+        steps = batch->start ();
+    }
+
+    Iec61850Utility::log_debug ("Command batch %s: %d commands, %d at once",
+                                batch->identifier ().c_str (),
+                                (int)batch->size (), (int)steps.size ());
+
+    runBatchSteps (batchId, batch, steps);
 
-        std::vector<Datapoint*>* jsonValues
-            = parserDp->parseJson (commandContentJSON);
+    return true;
+}
+
+void
+IEC61850::runBatchSteps (uint64_t batchId,
+                         const std::shared_ptr<IEC61850CommandBatch>& batch,
+                         const std::vector<size_t>& steps)
+{
+    /* independent commands are all sent before any result is awaited */
+    for (size_t step : steps)
+    {
+        std::string commandJson;
 
-        if (jsonValues)
         {
-            commandContent = jsonValues->at (0);
-            jsonValues->clear ();
-            delete jsonValues;
+            std::lock_guard<std::mutex> lock (m_batchLock);
+            commandJson = batch->step (step).json;
         }
 
-        if (!commandContent)
+        bool pending = false;
+        bool res = pivotCommand (commandJson, batchId, step, &pending);
+
+        /* a result already reported by the acknowledgements is ignored */
+        if (!pending)
         {
-            Iec61850Utility::log_error ("Failed to parse command content");
-            return false;
+            std::shared_ptr<IEC61850CommandBatch> finished
+                = batchStepDone (batchId, step, res);
+
+            if (finished && m_client)
+                m_client->sendBatchAck (*finished);
         }
+    }
+}
+
+std::shared_ptr<IEC61850CommandBatch>
+IEC61850::batchStepDone (uint64_t batchId, size_t step, bool confirmed)
+{
+    std::lock_guard<std::mutex> lock (m_batchLock);
+
+    auto it = m_batches.find (batchId);
+
+    if (it == m_batches.end ())
+        return nullptr;
+
+    /* called from the acknowledgements, the next commands are sent from
+     * the supervision once the control objects are released */
+    for (size_t next : it->second->done (step, confirmed))
+        m_readySteps.emplace_back (batchId, next);
+
+    if (!it->second->finished ())
+        return nullptr;
+
+    std::shared_ptr<IEC61850CommandBatch> batch = it->second;
+    m_batches.erase (it);
+
+    return batch;
+}
+
+void
+IEC61850::runReadyBatchSteps ()
+{
+    std::vector<std::pair<uint64_t, size_t> > ready;
+
+    {
+        std::lock_guard<std::mutex> lock (m_batchLock);
+
+        if (m_readySteps.empty ())
+            return;
+
+        ready.swap (m_readySteps);
+    }
+
+    std::lock_guard<std::mutex> lock (m_clientsLock);
+
+    if (!m_client)
+        return;
 
-        Iec61850Utility::log_debug (
-            "Received command: %s",
-            commandContent->toJSONProperty ().c_str ());
+    for (const auto& entry : ready)
+    {
+        std::shared_ptr<IEC61850CommandBatch> batch;
+
+        {
+            std::lock_guard<std::mutex> lock (m_batchLock);
+
+            auto it = m_batches.find (entry.first);
+
+            if (it == m_batches.end ())
+                continue;
+
+            batch = it->second;
+        }
+
+        runBatchSteps (entry.first, batch,
+                       std::vector<size_t> (1, entry.second));
+    }
+}
 
-        Datapoint* cdc = getCdc (commandContent);
+bool
+IEC61850::startSettingBatch (const std::string& batchJson)
+{
+    auto batch = std::make_shared<IEC61850SettingBatch> ();
+    std::vector<std::string> commands;
+
+    if (!batch->parse (batchJson, commands))
+    {
+        Iec61850Utility::log_error ("Invalid setting batch");
+        return false;
+    }
+
+    IEC61850Client* client = nullptr;
+
+    for (auto& commandJson : commands)
+    {
+        IEC61850PivotCommand command;
+
+        if (!command.decode (&commandJson[0]))
+        {
+            Iec61850Utility::log_error ("Failed to parse setting content");
+            return false;
+        }
 
-        if (!cdc)
+        if (command.cdcType == -1 || !isWriteType ((CDCTYPE)command.cdcType))
         {
-            Iec61850Utility::log_warn ("Received pivot object has no cdc");
+            Iec61850Utility::log_error ("Not a setting in batch %s",
+                                        batch->identifier ().c_str ());
             return false;
         }
 
-        int type
-            = IEC61850ClientConfig::getCdcTypeFromString (cdc->getName ());
+        IEC61850Client* settingClient = clientForCommand (command);
 
-        if (type == -1 || !isCommandType ((CDCTYPE)type) && !isWriteType((CDCTYPE)type))
+        if (client && settingClient != client)
         {
-            Iec61850Utility::log_warn ("Not a command object %s -> ignore",
-                                       cdc->toJSONProperty ().c_str ());
+            Iec61850Utility::log_error ("Settings of batch %s belong to "
+                                        "several IEDs",
+                                        batch->identifier ().c_str ());
             return false;
         }
 
-        bool res = m_client->handleOperation (commandContent);
-        return res;
+        client = settingClient;
+
+        if (!client->addSetting (*batch, command))
+            return false;
+    }
+
+    return client->writeSettings (batch);
+}
+
+IEC61850Client*
+IEC61850::clientForCommand (IEC61850PivotCommand& command)
+{
+    if (!command.identifier)
+        return m_client;
+
+    for (size_t i = 0; i < m_clients.size (); i++)
+    {
+        command.def = m_configs[i]->getExchangeDefinitionByPivotId (
+            command.identifier, command.identifierLength);
+
+        if (command.def)
+            return m_clients[i];
+    }
+
+    return m_client;
+}
+
+bool
+IEC61850::operation (const std::string& operation, int count,
+                     PLUGIN_PARAMETER** params)
+{
+    /* a reconfiguration does not replace the clients meanwhile */
+    std::lock_guard<std::mutex> lock (m_clientsLock);
+
+    if (m_client == nullptr)
+    {
+        Iec61850Utility::log_error (
+            "operation called but plugin is not yet initialized");
+
+        return false;
+    }
+
+    if (operation == "PivotCommand")
+    {
+        Iec61850Utility::log_debug ("Received command: %s",
+                                    params[0]->value.c_str ());
+
+        return pivotCommand (params[0]->value);
+    }
+
+    if (operation == "PivotCommandBatch")
+    {
+        Iec61850Utility::log_debug ("Received command batch: %s",
+                                    params[0]->value.c_str ());
+
+        return startBatch (params[0]->value);
+    }
+
+    if (operation == "PivotSettingBatch")
+    {
+        Iec61850Utility::log_debug ("Received setting batch: %s",
+                                    params[0]->value.c_str ());
+
+        return startSettingBatch (params[0]->value);
+    }
+
+    /* parameter values are RCB references, none means every RCB */
+    if (operation == "RequestGI")
+    {
+        for (size_t i = 0; i < m_clients.size (); i++)
+        {
+            std::vector<std::string> rcbRefs;
+
+            for (int p = 0; p < count; p++)
+            {
+                if (m_configs[i]->getReportSubscriptions ().count (
+                        params[p]->value))
+                    rcbRefs.push_back (params[p]->value);
+            }
+
+            if (count == 0 || !rcbRefs.empty ())
+                m_clients[i]->requestGI (rcbRefs);
+        }
+
+        return true;
     }
 
     Iec61850Utility::log_error ("Unrecognised operation %s",
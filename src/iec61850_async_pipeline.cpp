@@ -0,0 +1,255 @@
+#include "iec61850_async_pipeline.hpp"
+#include "iec61850_utility.hpp"
+
+void
+IEC61850AsyncResult::release ()
+{
+    if (value)
+        MmsValue_delete (value);
+    if (spec)
+        MmsVariableSpecification_destroy (spec);
+    if (directory)
+        LinkedList_destroy (directory);
+    if (rcb)
+        ClientReportControlBlock_destroy (rcb);
+    if (dataSet)
+        ClientDataSet_destroy (dataSet);
+    if (accessResults)
+        LinkedList_destroyDeep (accessResults,
+                                (LinkedListValueDeleteFunction)MmsValue_delete);
+
+    value = nullptr;
+    spec = nullptr;
+    directory = nullptr;
+    rcb = nullptr;
+    dataSet = nullptr;
+    accessResults = nullptr;
+}
+
+IEC61850AsyncPipeline::IEC61850AsyncPipeline (int window)
+    : m_window (window < 1 ? 1 : window)
+{
+}
+
+IEC61850AsyncPipeline::~IEC61850AsyncPipeline ()
+{
+    abort ();
+    releaseOrphans ();
+}
+
+void
+IEC61850AsyncPipeline::submit (const Issue& issue, const Done& done)
+{
+    auto request = new Request;
+    request->pipeline = this;
+    request->issue = issue;
+    request->done = done;
+
+    std::lock_guard<std::mutex> lock (m_lock);
+    m_queue.push_back (request);
+}
+
+void
+IEC61850AsyncPipeline::complete (Request* request)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    if (request->aborted)
+    {
+        m_orphans.erase (request);
+        request->result.release ();
+        delete request;
+        return;
+    }
+
+    m_outstanding.erase (request);
+    m_completed.push_back (request);
+}
+
+bool
+IEC61850AsyncPipeline::poll ()
+{
+    std::vector<Request*> completed;
+
+    {
+        std::lock_guard<std::mutex> lock (m_lock);
+        completed.swap (m_completed);
+    }
+
+    for (auto request : completed)
+    {
+        try
+        {
+            request->done (request->result);
+        }
+        // LCOV_EXCL_START
+        catch (const std::exception& e)
+        {
+            Iec61850Utility::log_error (
+                "Exception caught in request completion: %s", e.what ());
+        }
+        // LCOV_EXCL_STOP
+
+        request->result.release ();
+        delete request;
+    }
+
+    while (true)
+    {
+        Request* request;
+
+        {
+            std::lock_guard<std::mutex> lock (m_lock);
+
+            if (m_queue.empty () || m_outstanding.size () >= m_window)
+                break;
+
+            request = m_queue.front ();
+            m_queue.pop_front ();
+            m_outstanding.insert (request);
+        }
+
+        IedClientError err = IED_ERROR_OK;
+
+        request->issue (&err, request);
+
+        /* the handler is not called when the request is not sent */
+        if (err != IED_ERROR_OK)
+        {
+            request->result.err = err;
+            complete (request);
+        }
+    }
+
+    return !idle ();
+}
+
+bool
+IEC61850AsyncPipeline::idle ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+    return m_queue.empty () && m_outstanding.empty () && m_completed.empty ();
+}
+
+void
+IEC61850AsyncPipeline::abort ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    for (auto request : m_queue)
+    {
+        delete request;
+    }
+    m_queue.clear ();
+
+    for (auto request : m_completed)
+    {
+        request->result.release ();
+        delete request;
+    }
+    m_completed.clear ();
+
+    for (auto request : m_outstanding)
+    {
+        request->aborted = true;
+        m_orphans.insert (request);
+    }
+    m_outstanding.clear ();
+}
+
+void
+IEC61850AsyncPipeline::releaseOrphans ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    for (auto request : m_orphans)
+    {
+        request->result.release ();
+        delete request;
+    }
+
+    m_orphans.clear ();
+}
+
+void
+IEC61850AsyncPipeline::readObjectHandler (uint32_t invokeId, void* parameter,
+                                          IedClientError err, MmsValue* value)
+{
+    auto request = static_cast<Request*> (parameter);
+    request->result.err = err;
+    request->result.value = value;
+    request->pipeline->complete (request);
+}
+
+void
+IEC61850AsyncPipeline::variableSpecHandler (uint32_t invokeId,
+                                            void* parameter,
+                                            IedClientError err,
+                                            MmsVariableSpecification* spec)
+{
+    auto request = static_cast<Request*> (parameter);
+    request->result.err = err;
+    request->result.spec = spec;
+    request->pipeline->complete (request);
+}
+
+void
+IEC61850AsyncPipeline::dataSetDirectoryHandler (uint32_t invokeId,
+                                                void* parameter,
+                                                IedClientError err,
+                                                LinkedList dataSetDirectory,
+                                                bool isDeletable)
+{
+    auto request = static_cast<Request*> (parameter);
+    request->result.err = err;
+    request->result.directory = dataSetDirectory;
+    request->result.isDeletable = isDeletable;
+    request->pipeline->complete (request);
+}
+
+void
+IEC61850AsyncPipeline::readDataSetHandler (uint32_t invokeId, void* parameter,
+                                           IedClientError err,
+                                           ClientDataSet dataSet)
+{
+    auto request = static_cast<Request*> (parameter);
+    request->result.err = err;
+    request->result.dataSet = dataSet;
+    request->pipeline->complete (request);
+}
+
+void
+IEC61850AsyncPipeline::rcbValuesHandler (uint32_t invokeId, void* parameter,
+                                         IedClientError err,
+                                         ClientReportControlBlock rcb)
+{
+    auto request = static_cast<Request*> (parameter);
+    request->result.err = err;
+    request->result.rcb = rcb;
+    request->pipeline->complete (request);
+}
+
+void
+IEC61850AsyncPipeline::genericHandler (uint32_t invokeId, void* parameter,
+                                       IedClientError err)
+{
+    auto request = static_cast<Request*> (parameter);
+    request->result.err = err;
+    request->pipeline->complete (request);
+}
+
+void
+IEC61850AsyncPipeline::writeMultipleVariablesHandler (uint32_t invokeId,
+                                                      void* parameter,
+                                                      MmsError mmsError,
+                                                      LinkedList accessResults)
+{
+    auto request = static_cast<Request*> (parameter);
+
+    /* the MMS error is not mapped further, the access results tell which
+     * variable was rejected */
+    request->result.err
+        = mmsError == MMS_ERROR_NONE ? IED_ERROR_OK : IED_ERROR_UNKNOWN;
+    request->result.accessResults = accessResults;
+    request->pipeline->complete (request);
+}
@@ -4,46 +4,22 @@
 #include "libiec61850/mms_common.h"
 #include "libiec61850/mms_value.h"
 #include <iec61850.hpp>
+#include <iec61850_command_batch.hpp>
+#include <iec61850_entryid_store.hpp>
+#include <iec61850_model_cache.hpp>
+#include <iec61850_pivot_command.hpp>
+#include <iec61850_scl_model.hpp>
+#include <iec61850_reactor.hpp>
+#include <iec61850_setting_batch.hpp>
+#include <iec61850_spec_registry.hpp>
 #include <libiec61850/hal_thread.h>
 #include <libiec61850/iec61850_client.h>
 #include <libiec61850/iec61850_common.h>
 #include <libiec61850/mms_type_spec.h>
+#include <algorithm>
+#include <cstring>
 #include <utility>
 
-FunctionalConstraint
-stringToFunctionalConstraint (const std::string& str)
-{
-    static const std::unordered_map<std::string, FunctionalConstraint> mapping{
-        { "ST", IEC61850_FC_ST },    { "MX", IEC61850_FC_MX },
-        { "SP", IEC61850_FC_SP },    { "SV", IEC61850_FC_SV },
-        { "CF", IEC61850_FC_CF },    { "DC", IEC61850_FC_DC },
-        { "SG", IEC61850_FC_SG },    { "SE", IEC61850_FC_SE },
-        { "SR", IEC61850_FC_SR },    { "OR", IEC61850_FC_OR },
-        { "BL", IEC61850_FC_BL },    { "EX", IEC61850_FC_EX },
-        { "CO", IEC61850_FC_CO },    { "US", IEC61850_FC_US },
-        { "MS", IEC61850_FC_MS },    { "RP", IEC61850_FC_RP },
-        { "BR", IEC61850_FC_BR },    { "LG", IEC61850_FC_LG },
-        { "GO", IEC61850_FC_GO },    { "ALL", IEC61850_FC_ALL },
-        { "NONE", IEC61850_FC_NONE }
-    };
-    auto it = mapping.find (str);
-    if (it != mapping.end ())
-    {
-        return it->second;
-    }
-    else
-    {
-        return IEC61850_FC_NONE;
-    }
-}
-
-static const std::unordered_map<std::string, CDCTYPE> cdcMap
-    = { { "SpsTyp", SPS }, { "DpsTyp", DPS }, { "BscTyp", BSC },
-        { "MvTyp", MV },   { "SpcTyp", SPC }, { "DpcTyp", DPC },
-        { "ApcTyp", APC }, { "IncTyp", INC }, { "InsTyp", INS },
-        { "SpgTyp", SPG }, { "EnsTyp", ENS }, { "AsgTyp", ASG },
-        { "IngTyp", ING } };
-
 static bool
 isCommandCdcType (CDCTYPE type)
 {
@@ -68,31 +44,6 @@ getValueInt (Datapoint* dp)
     return -1;
 }
 
-static Datapoint*
-getCdc (Datapoint* dp)
-{
-    DatapointValue& dpv = dp->getData ();
-
-    if (dpv.getType () != DatapointValue::T_DP_DICT)
-    {
-        Iec61850Utility::log_error ("Datapoint is not a dictionary %s",
-                                    dp->getName ().c_str ());
-    }
-
-    std::vector<Datapoint*> const* datapoints = dpv.getDpVec ();
-
-    for (Datapoint* child : *datapoints)
-    {
-        if (IEC61850ClientConfig::getCdcTypeFromString (child->getName ())
-            != -1)
-        {
-            return child;
-        }
-    }
-
-    return nullptr;
-}
-
 static Datapoint*
 getChild (Datapoint* dp, const std::string& name)
 {
@@ -126,25 +77,6 @@ getChild (Datapoint* dp, const std::string& name)
     return childDp;
 }
 
-static std::string
-getValueStr (Datapoint* dp)
-{
-    const DatapointValue& dpv = dp->getData ();
-
-    if (dpv.getType () == DatapointValue::T_STRING)
-    {
-        return dpv.toStringValue ();
-    }
-    else
-    {
-        Iec61850Utility::log_error (
-            ("datapoint " + dp->getName () + " has mot a std::string value")
-                .c_str ());
-    }
-
-    return nullptr;
-}
-
 static Datapoint*
 createDp (const std::string& name)
 {
@@ -219,12 +151,40 @@ const std::map<PIVOTROOT, std::string> rootToStrMap
     = { { GTIM, "GTIM" }, { GTIS, "GTIS" }, { GTIC, "GTIC" } };
 
 IEC61850Client::IEC61850Client (IEC61850* iec61850,
-                                IEC61850ClientConfig* iec61850_client_config)
-    : m_config (iec61850_client_config), m_iec61850 (iec61850), firstTimeConnect(true)
+                                IEC61850ClientConfig* iec61850_client_config,
+                                IEC61850Reactor* reactor)
+    : m_config (iec61850_client_config), m_iec61850 (iec61850),
+      m_reactor (reactor), m_specRegistry (new IEC61850SpecRegistry ())
 {
+    m_commandTracker.setCompletionHandler (
+        [this] (const IEC61850CommandTracker::Command& command,
+                bool confirmed) {
+            if (!m_iec61850)
+                return;
+
+            std::shared_ptr<IEC61850CommandBatch> batch
+                = m_iec61850->batchStepDone (command.batchId, command.step,
+                                             confirmed);
+
+            if (batch)
+                sendBatchAck (*batch);
+        });
 }
 
-IEC61850Client::~IEC61850Client () { stop (); }
+IEC61850Client::~IEC61850Client ()
+{
+    stop ();
+
+    /* the types go with the registry, a restart resolves them again */
+    for (const auto& def : m_config->ExchangeDefinition ())
+        def->spec = nullptr;
+
+    deleteRetiredConfigs ();
+
+    delete m_modelCache;
+    delete m_entryIdStore;
+    delete m_specRegistry;
+}
 
 void
 IEC61850Client::stop ()
@@ -243,10 +203,16 @@ IEC61850Client::stop ()
         m_monitoringThread = nullptr;
     }
 
-    if(lastEntryId){
-        MmsValue_delete(lastEntryId);
-        lastEntryId = nullptr;
+    if (m_supervisionTask != -1)
+    {
+        m_reactor->removeTask (m_supervisionTask);
+        m_supervisionTask = -1;
+
+        deleteConnections ();
     }
+
+    if (m_entryIdStore)
+        m_entryIdStore->flush ();
 }
 
 int
@@ -544,8 +510,31 @@ IEC61850Client::start ()
 
     prepareConnections ();
     m_started = true;
-    m_monitoringThread
-        = new std::thread (&IEC61850Client::_monitoringThread, this);
+
+    if (m_reactor)
+    {
+        startConnections ();
+
+        m_supervisionTask = m_reactor->addTask (
+            [this] () {
+                {
+                    std::lock_guard<std::mutex> lock (m_activeConnectionMtx);
+                    superviseConnections ();
+                }
+
+                if (m_iec61850)
+                    m_iec61850->runReadyBatchSteps ();
+
+                releaseRetiredConfigs ();
+                return false;
+            },
+            10, this);
+    }
+    else
+    {
+        m_monitoringThread
+            = new std::thread (&IEC61850Client::_monitoringThread, this);
+    }
 }
 
 void
@@ -563,10 +552,99 @@ IEC61850Client::prepareConnections ()
             osiParameters = &redgroup->osiParameters;
         auto connection = new IEC61850ClientConnection (
             this, m_config, redgroup->ipAddr, redgroup->tcpPort, redgroup->tls,
-            osiParameters);
+            osiParameters, m_reactor);
 
         m_connections->push_back (connection);
     }
+
+    if ((m_config->modelCacheEnabled () || !m_config->sclFile ().empty ())
+        && !m_modelCache && !m_config->GetConnections ().empty ())
+    {
+        const auto& redgroup = m_config->GetConnections ().front ();
+
+        m_modelCache = new IEC61850ModelCache (
+            IEC61850ModelCache::cacheFileName (
+                m_config->iedName (), redgroup->ipAddr, redgroup->tcpPort));
+        bool loaded = m_modelCache->load ();
+
+        if (!m_config->sclFile ().empty ())
+        {
+            IEC61850SclModel sclModel;
+            IEC61850ModelCache::Revisions revisions;
+
+            if (sclModel.load (m_config->sclFile (), m_config->iedName ())
+                && sclModel.configRevisions (*m_config, revisions)
+                && (!loaded || !m_modelCache->matches (revisions))
+                && sclModel.seed (*m_modelCache, *m_config))
+            {
+                Iec61850Utility::log_info ("Model cache seeded from %s",
+                                           m_config->sclFile ().c_str ());
+            }
+        }
+    }
+
+    if (!m_entryIdStore && !m_config->GetConnections ().empty ())
+    {
+        const auto& redgroup = m_config->GetConnections ().front ();
+
+        m_entryIdStore = new IEC61850EntryIdStore (
+            IEC61850EntryIdStore::storeFileName (
+                m_config->iedName (), redgroup->ipAddr, redgroup->tcpPort));
+        m_entryIdStore->open (rcbReferences (m_config));
+    }
+}
+
+std::vector<std::string>
+IEC61850Client::rcbReferences (const IEC61850ClientConfig* config)
+{
+    std::vector<std::string> rcbRefs;
+
+    for (const auto& entry : config->getReportSubscriptions ())
+        rcbRefs.push_back (entry.first);
+
+    std::sort (rcbRefs.begin (), rcbRefs.end ());
+
+    return rcbRefs;
+}
+
+void
+IEC61850Client::applyConfig (IEC61850ClientConfig* newConfig,
+                             const IEC61850ConfigDiff& diff)
+{
+    std::lock_guard<std::mutex> lock (connectionsMutex);
+
+    if (m_connections)
+    {
+        for (auto connection : *m_connections)
+            connection->applyConfig (newConfig, diff);
+    }
+
+    /* a report may still be decoded with it */
+    m_retiredConfigs.push_back (m_config);
+    m_config = newConfig;
+
+    if (m_entryIdStore
+        && (!diff.changedRcbs.empty () || !diff.removedRcbs.empty ()))
+        m_entryIdStore->open (rcbReferences (m_config));
+}
+
+void
+IEC61850Client::releaseRetiredConfigs ()
+{
+    std::lock_guard<std::mutex> lock (connectionsMutex);
+
+    /* a callback started after applyConfig reads the new configuration */
+    if (m_callbacks == 0)
+        deleteRetiredConfigs ();
+}
+
+void
+IEC61850Client::deleteRetiredConfigs ()
+{
+    for (auto config : m_retiredConfigs)
+        delete config;
+
+    m_retiredConfigs.clear ();
 }
 
 void
@@ -580,81 +658,77 @@ IEC61850Client::updateConnectionStatus (ConnectionStatus newState)
 }
 
 void
-IEC61850Client::_monitoringThread ()
+IEC61850Client::startConnections ()
 {
-    uint64_t qualityUpdateTimeout = 500; /* 500 ms */
-    uint64_t qualityUpdateTimer = 0;
-    bool qualityUpdated = false;
-    bool firstConnected = false;
-
-    if (m_started)
+    std::lock_guard<std::mutex> lock (m_activeConnectionMtx);
+    for (auto clientConnection : *m_connections)
     {
-        std::lock_guard<std::mutex> lock (m_activeConnectionMtx);
-        for (auto clientConnection : *m_connections)
-        {
-            clientConnection->Start ();
-        }
+        clientConnection->Start ();
     }
 
     updateConnectionStatus (ConnectionStatus::NOT_CONNECTED);
+}
 
-    uint64_t backupConnectionStartTime
-        = Hal_getTimeInMs () + BACKUP_CONNECTION_TIMEOUT;
-
-    while (m_started)
+void
+IEC61850Client::superviseConnections ()
+{
+    if (m_tryConnectionIdx >= 0)
     {
-        std::lock_guard<std::mutex> lock (m_activeConnectionMtx);
+        IEC61850ClientConnection* clientConnection
+            = (*m_connections)[m_tryConnectionIdx];
 
-        if (m_active_connection == nullptr
-            || m_active_connection->Disconnected ())
+        if (clientConnection->Connected ())
         {
-            bool foundOpenConnections = false;
-            for (auto clientConnection : *m_connections)
-            {
-                backupConnectionStartTime
-                    = Hal_getTimeInMs () + BACKUP_CONNECTION_TIMEOUT;
+            m_tryConnectionIdx = -1;
+            return;
+        }
 
-                foundOpenConnections = true;
+        if (Hal_getTimeInMs () < m_tryConnectionDeadline)
+            return;
 
-                clientConnection->Connect ();
+        clientConnection->Disconnect ();
+        m_active_connection = nullptr;
 
-                m_active_connection = clientConnection;
+        m_tryConnectionIdx++;
 
-                Iec61850Utility::log_debug ("Trying connection %s:%d",
-                                            clientConnection->IP ().c_str (),
-                                            clientConnection->Port ());
+        if (m_tryConnectionIdx >= (int)m_connections->size ())
+        {
+            m_tryConnectionIdx = -1;
+            return;
+        }
+    }
+    else if (m_active_connection != nullptr
+             && !m_active_connection->Disconnected ())
+    {
+        return;
+    }
+    else if (m_connections->empty ())
+    {
+        return;
+    }
+    else
+    {
+        m_tryConnectionIdx = 0;
+    }
 
-                auto start = std::chrono::high_resolution_clock::now ();
-                auto timeout = std::chrono::milliseconds (
-                    m_config->backupConnectionTimeout ());
+    IEC61850ClientConnection* clientConnection
+        = (*m_connections)[m_tryConnectionIdx];
 
-                while (!clientConnection->Connected ())
-                {
-                    auto now = std::chrono::high_resolution_clock::now ();
-                    if (now - start > timeout)
-                    {
-                        clientConnection->Disconnect ();
-                        m_active_connection = nullptr;
-                        break;
-                    }
-                    Thread_sleep (10);
-                }
+    m_tryConnectionDeadline
+        = Hal_getTimeInMs () + m_config->backupConnectionTimeout ();
 
-                if (m_active_connection)
-                {
-                    break;
-                }
-            }
-        }
-        else
-        {
-            backupConnectionStartTime
-                = Hal_getTimeInMs () + BACKUP_CONNECTION_TIMEOUT;
-        }
+    clientConnection->Connect ();
 
-        Thread_sleep (100);
-    }
+    m_active_connection = clientConnection;
 
+    Iec61850Utility::log_debug ("Trying connection %s:%d",
+                                clientConnection->IP ().c_str (),
+                                clientConnection->Port ());
+}
+
+void
+IEC61850Client::deleteConnections ()
+{
     for (auto& clientConnection : *m_connections)
     {
         std::lock_guard<std::mutex> lock (m_activeConnectionMtx);
@@ -662,6 +736,34 @@ IEC61850Client::_monitoringThread ()
     }
 
     m_connections->clear ();
+    m_active_connection = nullptr;
+    m_tryConnectionIdx = -1;
+}
+
+void
+IEC61850Client::_monitoringThread ()
+{
+    if (m_started)
+    {
+        startConnections ();
+    }
+
+    while (m_started)
+    {
+        {
+            std::lock_guard<std::mutex> lock (m_activeConnectionMtx);
+            superviseConnections ();
+        }
+
+        if (m_iec61850)
+            m_iec61850->runReadyBatchSteps ();
+
+        releaseRetiredConfigs ();
+
+        Thread_sleep (10);
+    }
+
+    deleteConnections ();
 }
 
 void
@@ -686,92 +788,90 @@ IEC61850Client::handleAllValues ()
     std::vector<std::string> labels;
     std::vector<Datapoint*> datapoints;
 
-    for (const auto& pair : m_config->polledDatapoints ())
+    for (const auto& def : m_config->ExchangeDefinition ())
     {
-        const std::shared_ptr<DataExchangeDefinition> def = pair.second;
-
-        CDCTYPE typeId = def->cdcType;
+        if (!def->polled)
+            continue;
 
-        labels.push_back (def->label);
         FunctionalConstraint fc = def->cdcType == MV || def->cdcType == APC
                                       ? IEC61850_FC_MX
                                       : IEC61850_FC_ST;
 
-        m_handleMonitoringData (def->objRef, datapoints, def->label, typeId,
-                                nullptr, "", fc, 0);
+        size_t count = datapoints.size ();
+
+        m_handleMonitoringData (def.get (), datapoints, nullptr, "", fc, 0);
+
+        /* a value that could not be read has no datapoint */
+        if (datapoints.size () > count)
+            labels.push_back (def->label);
     }
     sendData (datapoints, labels);
 }
 
 void
-IEC61850Client::handleValue (std::string objRef, MmsValue* mmsValue,
-                             uint64_t timestamp)
+IEC61850Client::handleValue (const char* objRef, size_t length,
+                             MmsValue* mmsValue, uint64_t timestamp)
 {
-    std::vector<std::string> labels;
-    std::vector<Datapoint*> datapoints;
-
-    Iec61850Utility::log_debug ("Handle value %s", objRef.c_str ());
+    Iec61850Utility::log_debug ("Handle value %.*s", (int)length, objRef);
 
-    size_t secondDotPos = objRef.find ('.', objRef.find ('.') + 1);
-    size_t bracketPos = objRef.find ('[');
+    /* LD/LN.DO[FC] or LD/LN.DO.attribute[FC] */
+    auto bracket = (const char*)memchr (objRef, '[', length);
 
-    if (bracketPos == std::string::npos)
+    if (!bracket)
     {
         Iec61850Utility::log_error (
-            "String parsing failed in handleValue for objRef: %s",
-            objRef.c_str ());
+            "String parsing failed in handleValue for objRef: %.*s",
+            (int)length, objRef);
         return;
     }
 
-    std::string extracted;
-    std::string fcString;
-    FunctionalConstraint fcValue = IEC61850_FC_NONE;
-
-    if (secondDotPos != std::string::npos)
-    {
-        extracted
-            = objRef.substr (secondDotPos + 1, bracketPos - secondDotPos - 1);
-    }
-
-    fcString
-        = objRef.substr (bracketPos + 1, objRef.find (']') - bracketPos - 1);
-    fcValue = stringToFunctionalConstraint (fcString);
-    if (secondDotPos != std::string::npos)
-    {
-        objRef.erase (secondDotPos);
-    }
-    else
-    {
-        objRef.erase (bracketPos);
-    }
+    auto firstDot = (const char*)memchr (objRef, '.', bracket - objRef);
+    auto secondDot
+        = firstDot ? (const char*)memchr (firstDot + 1, '.',
+                                          bracket - firstDot - 1)
+                   : nullptr;
+    const char* doEnd = secondDot ? secondDot : bracket;
 
-    const std::shared_ptr<DataExchangeDefinition> def
-        = m_config->getExchangeDefinitionByObjRef (objRef);
+    DataExchangeDefinition* def
+        = m_config->getExchangeDefinitionByObjRef (objRef, doEnd - objRef);
 
     if (!def)
     {
-        Iec61850Utility::log_debug ("No exchange definition found for %s",
-                                    objRef.c_str ());
+        Iec61850Utility::log_debug ("No exchange definition found for %.*s",
+                                    (int)(doEnd - objRef), objRef);
         return;
     }
 
-    CDCTYPE typeId = def->cdcType;
+    /* q, t or the value when the entry is an attribute, short enough not
+     * to be allocated */
+    std::string attribute;
+
+    if (secondDot)
+        attribute.assign (secondDot + 1, bracket - secondDot - 1);
 
-    labels.push_back (def->label);
+    std::vector<Datapoint*> datapoints;
+
+    /* the functional constraint only matters when the value is read */
+    m_handleMonitoringData (def, datapoints, mmsValue, attribute,
+                            IEC61850_FC_NONE, timestamp);
+
+    if (datapoints.empty ())
+        return;
 
-    m_handleMonitoringData (def->objRef, datapoints, def->label, typeId,
-                            mmsValue, extracted, fcValue, timestamp);
     Iec61850Utility::log_debug ("Send %s",
                                 datapoints[0]->toJSONProperty ().c_str ());
-    sendData (datapoints, labels);
+    m_iec61850->ingest (def->label, datapoints);
 }
 
 void
 IEC61850Client::m_handleMonitoringData (
-    const std::string& objRef, std::vector<Datapoint*>& datapoints,
-    const std::string& label, CDCTYPE type, MmsValue* mmsVal,
-    const std::string& attribute, FunctionalConstraint fc, uint64_t timestamp)
+    DataExchangeDefinition* def, std::vector<Datapoint*>& datapoints,
+    MmsValue* mmsVal, const std::string& attribute, FunctionalConstraint fc,
+    uint64_t timestamp)
 {
+    const std::string& objRef = def->objRef;
+    const std::string& label = def->label;
+
     if (!m_active_connection)
     {
         Iec61850Utility::log_error ("No active connection");
@@ -790,8 +890,7 @@ IEC61850Client::m_handleMonitoringData (
         return;
     }
 
-    auto def = m_config->getExchangeDefinitionByObjRef (objRef);
-    if (!def || !def->spec)
+    if (!def->spec)
     {
         Iec61850Utility::log_error ("Invalid definition/spec for %s",
                                     objRef.c_str ());
@@ -820,7 +919,7 @@ IEC61850Client::m_handleMonitoringData (
             return;
         }
     }
-    if (!processDatapoint (type, datapoints, label, objRef, mmsvalue,
+    if (!processDatapoint (def->cdcType, datapoints, label, objRef, mmsvalue,
                            def->spec, quality, ts, attribute))
     {
         Iec61850Utility::log_error ("Error processing datapoint %s",
@@ -832,11 +931,11 @@ IEC61850Client::m_handleMonitoringData (
 
 Quality
 IEC61850Client::extractQuality (MmsValue* mmsvalue,
-                                MmsVariableSpecification* varSpec,
+                                const IEC61850SpecType* specType,
                                 const std::string& attribute)
 {
     MmsValue const* qualityMms
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)"q");
+        = IEC61850SpecType::element (mmsvalue, specType->quality);
     return (!qualityMms && attribute != "q")
                ? QUALITY_VALIDITY_GOOD
                : Quality_fromMmsValue ( attribute == "q" ? mmsvalue : qualityMms);
@@ -844,11 +943,11 @@ IEC61850Client::extractQuality (MmsValue* mmsvalue,
 
 uint64_t
 IEC61850Client::extractTimestamp (MmsValue* mmsvalue,
-                                  MmsVariableSpecification* varSpec,
+                                  const IEC61850SpecType* specType,
                                   const std::string& attribute)
 {
     MmsValue const* timestampMms
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)"t");
+        = IEC61850SpecType::element (mmsvalue, specType->timestamp);
     return (!timestampMms && attribute != "t")
                ? PivotTimestamp::GetCurrentTimeInMs ()
                : MmsValue_getUtcTimeInMs (timestampMms);
@@ -858,7 +957,7 @@ bool
 IEC61850Client::processDatapoint (
     CDCTYPE type, std::vector<Datapoint*>& datapoints,
     const std::string& label, const std::string& objRef, MmsValue* mmsvalue,
-    MmsVariableSpecification* varSpec, Quality quality, uint64_t timestamp,
+    const IEC61850SpecType* specType, Quality quality, uint64_t timestamp,
     const std::string& attribute)
 {    
     switch (type)
@@ -866,24 +965,26 @@ IEC61850Client::processDatapoint (
     case SPC:
     case SPS:
         return processBooleanType (datapoints, label, objRef, mmsvalue,
-                                   varSpec, quality, timestamp, attribute,
+                                   specType, quality, timestamp, attribute,
                                    "stVal");
     case BSC:
-        return processBSCType (datapoints, label, objRef, mmsvalue, varSpec,
+        return processBSCType (datapoints, label, objRef, mmsvalue, specType,
                                quality, timestamp, attribute, "valWTr");
     case MV:
-        return processAnalogType (datapoints, label, objRef, mmsvalue, varSpec,
-                                  quality, timestamp, attribute, "mag");
+        return processAnalogType (datapoints, label, objRef, mmsvalue,
+                                  specType, quality, timestamp, attribute,
+                                  "mag");
     case APC:
-        return processAnalogType (datapoints, label, objRef, mmsvalue, varSpec,
-                                  quality, timestamp, attribute, "mxVal");
+        return processAnalogType (datapoints, label, objRef, mmsvalue,
+                                  specType, quality, timestamp, attribute,
+                                  "mxVal");
     case ENS:
     case INS:
     case DPS:
     case DPC:
     case INC:
         return processIntegerType (datapoints, label, objRef, mmsvalue,
-                                   varSpec, quality, timestamp, attribute,
+                                   specType, quality, timestamp, attribute,
                                    "stVal");
     default:
         return false;
@@ -902,11 +1003,11 @@ bool
 IEC61850Client::processBooleanType (
     std::vector<Datapoint*>& datapoints, const std::string& label,
     const std::string& objRef, MmsValue* mmsvalue,
-    MmsVariableSpecification* varSpec, Quality quality, uint64_t timestamp,
+    const IEC61850SpecType* specType, Quality quality, uint64_t timestamp,
     const std::string& attribute, const char* elementName)
 {
     MmsValue const* element
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)elementName);
+        = IEC61850SpecType::element (mmsvalue, specType->value);
     if (!element)
     {
         if (attribute == elementName)
@@ -934,13 +1035,13 @@ bool
 IEC61850Client::processBSCType (std::vector<Datapoint*>& datapoints,
                                 const std::string& label,
                                 const std::string& objRef, MmsValue* mmsvalue,
-                                MmsVariableSpecification* varSpec,
+                                const IEC61850SpecType* specType,
                                 Quality quality, uint64_t timestamp,
                                 const std::string& attribute,
                                 const char* elementName)
 {
     MmsValue* element
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)elementName);
+        = IEC61850SpecType::element (mmsvalue, specType->value);
     if (!element)
     {
         if (attribute == elementName)
@@ -955,12 +1056,10 @@ IEC61850Client::processBSCType (std::vector<Datapoint*>& datapoints,
         }
     }
 
-    varSpec = MmsVariableSpecification_getChildSpecificationByName (
-        varSpec, elementName, nullptr);
     MmsValue const* posVal
-        = MmsValue_getSubElement (element, varSpec, (char*)"posVal");
+        = IEC61850SpecType::element (element, specType->posVal);
     MmsValue const* transInd
-        = MmsValue_getSubElement (element, varSpec, (char*)"transInd");
+        = IEC61850SpecType::element (element, specType->transInd);
 
     if (!posVal || !transInd)
     {
@@ -985,11 +1084,11 @@ bool
 IEC61850Client::processAnalogType (
     std::vector<Datapoint*>& datapoints, const std::string& label,
     const std::string& objRef, MmsValue* mmsvalue,
-    MmsVariableSpecification* varSpec, Quality quality, uint64_t timestamp,
+    const IEC61850SpecType* specType, Quality quality, uint64_t timestamp,
     const std::string& attribute, const char* elementName)
 {
     MmsValue* element
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)elementName);
+        = IEC61850SpecType::element (mmsvalue, specType->value);
     if (!element)
     {
         if (attribute == elementName)
@@ -1005,9 +1104,7 @@ IEC61850Client::processAnalogType (
     }
 
     auto def = m_config->getExchangeDefinitionByObjRef (objRef);
-    varSpec = MmsVariableSpecification_getChildSpecificationByName (
-        varSpec, elementName, nullptr);
-    MmsValue* f = MmsValue_getSubElement (element, varSpec, (char*)"f");
+    MmsValue* f = IEC61850SpecType::element (element, specType->valueF);
 
     if (f)
     {
@@ -1020,7 +1117,7 @@ IEC61850Client::processAnalogType (
         return true;
     }
 
-    MmsValue* i = MmsValue_getSubElement (element, varSpec, (char*)"i");
+    MmsValue* i = IEC61850SpecType::element (element, specType->valueI);
     if (i)
     {
         long value = MmsValue_toInt32 (i);
@@ -1041,11 +1138,11 @@ bool
 IEC61850Client::processIntegerType (
     std::vector<Datapoint*>& datapoints, const std::string& label,
     const std::string& objRef, MmsValue* mmsvalue,
-    MmsVariableSpecification* varSpec, Quality quality, uint64_t timestamp,
+    const IEC61850SpecType* specType, Quality quality, uint64_t timestamp,
     const std::string& attribute, const char* elementName)
 {
     MmsValue const* element
-        = MmsValue_getSubElement (mmsvalue, varSpec, (char*)elementName);
+        = IEC61850SpecType::element (mmsvalue, specType->value);
     if (!element)
     {
         if (attribute == elementName)
@@ -1218,110 +1315,201 @@ IEC61850Client::addValueDp (Datapoint* cdcDp, CDCTYPE type, T value) const
     }
 }
 
-bool
-IEC61850Client::handleOperation (Datapoint* operation)
+void
+IEC61850Client::requestGI (const std::vector<std::string>& rcbRefs)
 {
+    std::lock_guard<std::mutex> lock (m_activeConnectionMtx);
 
-    Datapoint* identifierDp = getChild (operation, "Identifier");
+    if (!m_active_connection)
+    {
+        Iec61850Utility::log_warn ("No active connection -> GI not sent");
+        return;
+    }
+
+    m_active_connection->requestGI (rcbRefs);
+}
 
-    if (!identifierDp
-        || identifierDp->getData ().getType () != DatapointValue::T_STRING)
+static DatapointValue
+commandValue (const IEC61850PivotCommand::Value& value)
+{
+    switch (value.type)
+    {
+    case IEC61850PivotCommand::Value::FLOAT:
+        return DatapointValue (value.floatValue);
+    case IEC61850PivotCommand::Value::STRING:
+        return DatapointValue (std::string (value.str, value.length));
+    default:
+        return DatapointValue (value.intValue);
+    }
+}
+
+bool
+IEC61850Client::handleOperation (const IEC61850PivotCommand& command,
+                                 const std::string& commandJson,
+                                 uint64_t batchId, size_t step)
+{
+    if (!command.identifier)
     {
         Iec61850Utility::log_warn ("Operation has no identifier");
         return false;
     }
 
-    std::string id = getValueStr (identifierDp);
-
-    const std::shared_ptr<DataExchangeDefinition> def
-        = m_config->getExchangeDefinitionByPivotId (id);
+    const DataExchangeDefinition* def = command.def;
 
     if (!def)
     {
         Iec61850Utility::log_warn (
-            "No exchange definition found for pivot id %s", id.c_str ());
+            "No exchange definition found for pivot id %.*s",
+            (int)command.identifierLength, command.identifier);
         return false;
     }
 
-    std::string label = def->label;
-
-    std::string objRef = def->objRef;
-
-    Datapoint* cdcDp = getCdc (operation);
-
-    if (!cdcDp)
+    if (command.cdcType == -1)
     {
         Iec61850Utility::log_error ("Operation has no cdc");
         return false;
     }
 
-    Datapoint* valueDp;
+    const IEC61850PivotCommand::Value& value = command.value ();
 
-    if (cdcDp->getName () == "AsgTyp")
+    if (value.type == IEC61850PivotCommand::Value::NONE)
     {
-        Datapoint* magDp = getChild (cdcDp, "setMag");
-        if (!magDp)
-        {
+        if (command.cdcType == ASG)
             Iec61850Utility::log_error ("ASG operation has no setMag");
-            return false;
-        }
-        valueDp = getChild (magDp, "f");
+        else
+            Iec61850Utility::log_error ("Operation has no value");
+        return false;
     }
-    else if (cdcDp->getName () == "IngTyp" || cdcDp->getName () == "SpgTyp")
+
+    /* e.g. a client restarted by a reconfiguration and not started yet */
+    if (!m_active_connection)
+    {
+        Iec61850Utility::log_warn ("No connection for operation on %s",
+                                   def->objRef.c_str ());
+        return false;
+    }
+
+    bool res;
+
+    if (command.cdcType == ING || command.cdcType == SPG
+        || command.cdcType == ASG)
     {
-        valueDp = getChild (cdcDp, "setVal");
+        res = m_active_connection->writeValue (def->objRef,
+                                               commandValue (value),
+                                               (CDCTYPE)command.cdcType);
     }
     else
     {
-        valueDp = getChild (cdcDp, "ctlVal");
+        uint64_t commandId
+            = m_commandTracker.add (def->label, commandJson, batchId, step);
+
+        res = m_active_connection->operate (def->objRef, commandValue (value),
+                                            commandId);
+
+        if (!res)
+            m_commandTracker.remove (commandId);
     }
 
-    if (!valueDp)
+    return res;
+}
+
+bool
+IEC61850Client::addSetting (IEC61850SettingBatch& batch,
+                            const IEC61850PivotCommand& command)
+{
+    const DataExchangeDefinition* def = command.def;
+
+    if (!def)
     {
-        Iec61850Utility::log_error ("Operation has no value");
+        Iec61850Utility::log_warn (
+            "No exchange definition found for pivot id %.*s",
+            (int)command.identifierLength, command.identifier);
         return false;
     }
 
-    bool res;
+    const IEC61850PivotCommand::Value& value = command.value ();
 
-    DatapointValue value = valueDp->getData ();
+    if (value.type == IEC61850PivotCommand::Value::NONE)
+    {
+        Iec61850Utility::log_error ("Setting %s has no value",
+                                    def->label.c_str ());
+        return false;
+    }
 
-    if (cdcDp->getName () == "IngTyp" || cdcDp->getName () == "SpgTyp"
-        || cdcDp->getName () == "AsgTyp")
+    if (!batch.add (def->label, def->objRef, (CDCTYPE)command.cdcType,
+                    commandValue (value)))
     {
-        res = m_active_connection->writeValue (operation, objRef, value,
-                                               cdcMap.at (cdcDp->getName ()));
+        Iec61850Utility::log_error ("Invalid setting %s - %s",
+                                    def->label.c_str (), def->objRef.c_str ());
+        return false;
     }
-    else
+
+    return true;
+}
+
+bool
+IEC61850Client::writeSettings (
+    const std::shared_ptr<IEC61850SettingBatch>& batch)
+{
+    std::lock_guard<std::mutex> lock (m_activeConnectionMtx);
+
+    if (!m_active_connection)
     {
-        res = m_active_connection->operate (objRef, value);
-        m_outstandingCommands[label] = operation;
+        Iec61850Utility::log_warn ("No active connection -> settings %s not "
+                                   "written",
+                                   batch->identifier ().c_str ());
+        return false;
     }
 
-    return res;
+    return m_active_connection->writeSettings (batch);
+}
+
+static Datapoint*
+parseCommand (const std::string& commandJson)
+{
+    DatapointValue temp ((long)1);
+    std::unique_ptr<Datapoint> parserDp (new Datapoint ("Parser", temp));
+
+    std::vector<Datapoint*>* jsonValues = parserDp->parseJson (commandJson);
+
+    if (!jsonValues)
+        return nullptr;
+
+    Datapoint* command = jsonValues->empty () ? nullptr : jsonValues->at (0);
+
+    for (size_t i = 1; i < jsonValues->size (); i++)
+        delete jsonValues->at (i);
+
+    delete jsonValues;
+
+    return command;
 }
 
 void
-IEC61850Client::sendCommandAck (const std::string& label, ControlModel mode,
-                                bool terminated)
+IEC61850Client::sendCommandAck (uint64_t commandId, ControlModel mode,
+                                bool terminated, bool negative)
 {
-    if (m_outstandingCommands.empty ())
+    IEC61850CommandTracker::Command outstanding;
+
+    if (!m_commandTracker.get (commandId, outstanding))
     {
-        Iec61850Utility::log_error ("No outstanding commands");
+        Iec61850Utility::log_error ("No outstanding command with id %llu",
+                                    (unsigned long long)commandId);
         return;
     }
 
-    auto it = m_outstandingCommands.find (label);
-    if (it == m_outstandingCommands.end ())
+    std::unique_ptr<Datapoint> operation (parseCommand (outstanding.json));
+
+    if (!operation)
     {
-        Iec61850Utility::log_error (
-            "No outstanding command with label %s found", label.c_str ());
+        Iec61850Utility::log_error ("Failed to parse command content");
+        m_commandTracker.remove (commandId);
         return;
     }
 
     Datapoint* pivotRoot = createDp ("PIVOT");
     Datapoint* command
-        = addElementWithValue (pivotRoot, "GTIC", it->second->getData ());
+        = addElementWithValue (pivotRoot, "GTIC", operation->getData ());
     int cot = terminated ? 10 : 7;
     Datapoint* causeDp = nullptr;
     causeDp = getChild (command, "Cause");
@@ -1332,6 +1520,7 @@ IEC61850Client::sendCommandAck (const std::string& label, ControlModel mode,
         {
             Iec61850Utility::log_error ("Cause dp has no stVal");
             delete pivotRoot;
+            m_commandTracker.remove (commandId);
             return;
         }
         stVal->getData ().setValue ((long)cot);
@@ -1342,18 +1531,114 @@ IEC61850Client::sendCommandAck (const std::string& label, ControlModel mode,
         addElementWithValue (causeDp, "stVal", (long)cot);
     }
 
+    if (negative)
+    {
+        Datapoint* confirmationDp = getChild (command, "Confirmation");
+
+        if (!confirmationDp)
+            confirmationDp = addElement (command, "Confirmation");
+
+        Datapoint* stVal = getChild (confirmationDp, "stVal");
+
+        if (stVal)
+            stVal->getData ().setValue ((long)1);
+        else
+            addElementWithValue (confirmationDp, "stVal", (long)1);
+    }
+
     std::vector<Datapoint*> datapoints;
     std::vector<std::string> labels;
-    labels.push_back (label);
+    labels.push_back (outstanding.label);
     datapoints.push_back (pivotRoot);
     sendData (datapoints, labels);
 
-    if (terminated
+    if (terminated || negative
         || (!terminated
             && (mode == CONTROL_MODEL_SBO_NORMAL
                 || mode == CONTROL_MODEL_DIRECT_NORMAL)))
     {
-        delete m_outstandingCommands[label];
-        m_outstandingCommands.erase (label);
+        m_commandTracker.remove (commandId, !negative);
     }
 }
+
+void
+IEC61850Client::sendBatchAck (const IEC61850CommandBatch& batch)
+{
+    size_t failed = batch.count (IEC61850CommandBatch::FAILED)
+                    + batch.count (IEC61850CommandBatch::SKIPPED);
+
+    Datapoint* pivotRoot = createDp ("PIVOT");
+    Datapoint* command = addElement (pivotRoot, "GTIC");
+
+    addElementWithValue (command, "ComingFrom", (std::string) "iec61850");
+    addElementWithValue (command, "Identifier", batch.identifier ());
+
+    Datapoint* causeDp = addElement (command, "Cause");
+    addElementWithValue (causeDp, "stVal", (long)10);
+
+    Datapoint* confirmationDp = addElement (command, "Confirmation");
+    addElementWithValue (confirmationDp, "stVal", (long)(failed > 0));
+
+    Datapoint* batchDp = addElement (command, "Batch");
+    addElementWithValue (
+        batchDp, "Confirmed",
+        (long)batch.count (IEC61850CommandBatch::CONFIRMED));
+    addElementWithValue (batchDp, "Failed",
+                         (long)batch.count (IEC61850CommandBatch::FAILED));
+    addElementWithValue (batchDp, "Skipped",
+                         (long)batch.count (IEC61850CommandBatch::SKIPPED));
+
+    /* per command, in the order of the batch */
+    Datapoint* commandsDp = addElement (batchDp, "Commands");
+
+    for (size_t i = 0; i < batch.size (); i++)
+    {
+        const IEC61850CommandBatch::Step& step = batch.step (i);
+        addElementWithValue (commandsDp, step.key,
+                             (long)(step.state
+                                    == IEC61850CommandBatch::CONFIRMED));
+    }
+
+    std::vector<Datapoint*> datapoints;
+    std::vector<std::string> labels;
+    labels.push_back (batch.identifier ().empty () ? "PivotCommandBatch"
+                                                   : batch.identifier ());
+    datapoints.push_back (pivotRoot);
+    sendData (datapoints, labels);
+}
+
+void
+IEC61850Client::sendSettingBatchAck (const IEC61850SettingBatch& batch)
+{
+    size_t written = batch.written ();
+    size_t failed = batch.settings.size () - written;
+
+    Datapoint* pivotRoot = createDp ("PIVOT");
+    Datapoint* command = addElement (pivotRoot, "GTIC");
+
+    addElementWithValue (command, "ComingFrom", (std::string) "iec61850");
+    addElementWithValue (command, "Identifier", batch.identifier ());
+
+    Datapoint* causeDp = addElement (command, "Cause");
+    addElementWithValue (causeDp, "stVal", (long)10);
+
+    Datapoint* confirmationDp = addElement (command, "Confirmation");
+    addElementWithValue (confirmationDp, "stVal", (long)(failed > 0));
+
+    Datapoint* batchDp = addElement (command, "Batch");
+    addElementWithValue (batchDp, "Written", (long)written);
+    addElementWithValue (batchDp, "Failed", (long)failed);
+
+    /* per setting, in the order of the batch */
+    Datapoint* settingsDp = addElement (batchDp, "Settings");
+
+    for (const auto& setting : batch.settings)
+        addElementWithValue (settingsDp, setting.label, (long)setting.written);
+
+    std::vector<Datapoint*> datapoints;
+    std::vector<std::string> labels;
+    labels.push_back (batch.identifier ().empty () ? "PivotSettingBatch"
+                                                   : batch.identifier ());
+    datapoints.push_back (pivotRoot);
+    sendData (datapoints, labels);
+}
@@ -1,7 +1,10 @@
 #include <algorithm>
 #include <arpa/inet.h>
+#include <cstring>
 #include <iec61850.hpp>
 #include <iec61850_client_config.hpp>
+#include <iec61850_config_snapshot.hpp>
+#include <rapidjson/reader.h>
 #include <regex>
 #include <vector>
 
@@ -10,12 +13,28 @@
 #define JSON_APPLICATION_LAYER "application_layer"
 #define JSON_DATASETS "datasets"
 #define JSON_CONNECTIONS "connections"
+#define JSON_IEDS "ieds"
+#define JSON_IED_NAME "ied_name"
 #define JSON_IP "ip_addr"
 #define JSON_PORT "port"
 #define JSON_TLS "tls"
 #define JSON_DATASET_REF "dataset_ref"
 #define JSON_DATASET_ENTRIES "entries"
 #define JSON_POLLING_INTERVAL "polling_interval"
+#define JSON_REACTOR_THREADS "reactor_threads"
+#define JSON_MODEL_CACHE "model_cache"
+#define JSON_SCL_FILE "scl_file"
+#define JSON_BRINGUP_WINDOW "bringup_window"
+#define JSON_KEEP_DATASETS "keep_datasets"
+#define JSON_CONTROL_OBJECTS "control_objects"
+#define JSON_RESYNC_GI_INTERVAL "resync_gi_interval"
+#define JSON_GI_CONCURRENCY "gi_concurrency"
+#define JSON_GI_SPACING "gi_spacing"
+#define JSON_GI_PRIORITY "gi_priority"
+#define JSON_COMMAND_TIMEOUTS "command_timeouts"
+#define JSON_SELECT_TIMEOUT "select"
+#define JSON_ACT_CON_TIMEOUT "act_con"
+#define JSON_ACT_TERM_TIMEOUT "act_term"
 #define JSON_REPORT_SUBSCRIPTIONS "report_subscriptions"
 #define JSON_RCB_REF "rcb_ref"
 #define JSON_TRGOPS "trgops"
@@ -30,6 +49,7 @@
 #define JSON_PROT_NAME "name"
 #define JSON_PROT_OBJ_REF "objref"
 #define JSON_PROT_CDC "cdc"
+#define JSON_PROT_IED "ied"
 
 using namespace rapidjson;
 
@@ -58,29 +78,6 @@ IEC61850ClientConfig::getCdcTypeFromString (const std::string& cdc)
     return -1; // LCOV_EXCL_LINE
 }
 
-std::shared_ptr<DataExchangeDefinition>
-IEC61850ClientConfig::getExchangeDefinitionByLabel (const std::string& label)
-{
-    auto it = m_exchangeDefinitions.find (label);
-    if (it != m_exchangeDefinitions.end ())
-    {
-        return it->second;
-    }
-    return nullptr;
-}
-
-std::shared_ptr<DataExchangeDefinition>
-IEC61850ClientConfig::getExchangeDefinitionByPivotId (
-    const std::string& pivotId)
-{
-    auto it = m_exchangeDefinitionsPivotId.find (pivotId);
-    if (it != m_exchangeDefinitionsPivotId.end ())
-    {
-        return it->second;
-    }
-    return nullptr;
-}
-
 bool
 IEC61850ClientConfig::isValidIPAddress (const std::string& addrStr)
 {
@@ -96,10 +93,7 @@ IEC61850ClientConfig::isValidIPAddress (const std::string& addrStr)
 void
 IEC61850ClientConfig::deleteExchangeDefinitions ()
 {
-    m_exchangeDefinitions.clear ();
-    m_exchangeDefinitionsObjRef.clear ();
-    m_exchangeDefinitionsPivotId.clear ();
-    m_polledDatapoints.clear ();
+    m_definitionIndex.clear ();
 }
 
 IEC61850ClientConfig::~IEC61850ClientConfig ()
@@ -131,7 +125,13 @@ IEC61850ClientConfig::importProtocolConfig (const std::string& protocolConfig)
         return;
     }
 
-    const Value& protocolStack = document[JSON_PROTOCOL_STACK];
+    importProtocolStack (document[JSON_PROTOCOL_STACK]);
+}
+
+void
+IEC61850ClientConfig::importProtocolStack (const rapidjson::Value& protocolStack)
+{
+    m_protocolConfigComplete = false;
 
     if (!protocolStack.HasMember (JSON_TRANSPORT_LAYER)
         || !protocolStack[JSON_TRANSPORT_LAYER].IsObject ())
@@ -143,6 +143,12 @@ IEC61850ClientConfig::importProtocolConfig (const std::string& protocolConfig)
 
     const Value& transportLayer = protocolStack[JSON_TRANSPORT_LAYER];
 
+    if (transportLayer.HasMember (JSON_IED_NAME)
+        && transportLayer[JSON_IED_NAME].IsString ())
+    {
+        m_iedName = transportLayer[JSON_IED_NAME].GetString ();
+    }
+
     if (!transportLayer.HasMember (JSON_CONNECTIONS)
         || !transportLayer[JSON_CONNECTIONS].IsArray ())
     {
@@ -237,6 +243,177 @@ IEC61850ClientConfig::importProtocolConfig (const std::string& protocolConfig)
         pollingInterval = intVal;
     }
 
+    if (applicationLayer.HasMember (JSON_REACTOR_THREADS))
+    {
+        if (applicationLayer[JSON_REACTOR_THREADS].IsInt ()
+            && applicationLayer[JSON_REACTOR_THREADS].GetInt () >= 0)
+        {
+            m_reactorThreads = applicationLayer[JSON_REACTOR_THREADS].GetInt ();
+        }
+        else
+        {
+            Iec61850Utility::log_warn ("reactor_threads has invalid value -> "
+                                       "using one thread per connection");
+        }
+    }
+
+    if (applicationLayer.HasMember (JSON_MODEL_CACHE))
+    {
+        if (applicationLayer[JSON_MODEL_CACHE].IsBool ())
+        {
+            m_modelCacheEnabled = applicationLayer[JSON_MODEL_CACHE].GetBool ();
+        }
+        else
+        {
+            Iec61850Utility::log_warn (
+                "model_cache has invalid type -> model cache disabled");
+        }
+    }
+
+    if (applicationLayer.HasMember (JSON_SCL_FILE))
+    {
+        if (applicationLayer[JSON_SCL_FILE].IsString ())
+        {
+            m_sclFile = applicationLayer[JSON_SCL_FILE].GetString ();
+        }
+        else
+        {
+            Iec61850Utility::log_warn (
+                "scl_file has invalid type -> SCL model not used");
+        }
+    }
+
+    if (applicationLayer.HasMember (JSON_BRINGUP_WINDOW))
+    {
+        if (applicationLayer[JSON_BRINGUP_WINDOW].IsInt ()
+            && applicationLayer[JSON_BRINGUP_WINDOW].GetInt () > 0)
+        {
+            m_bringUpWindow = applicationLayer[JSON_BRINGUP_WINDOW].GetInt ();
+        }
+        else
+        {
+            Iec61850Utility::log_warn (
+                "bringup_window has invalid value -> using default (%d)",
+                m_bringUpWindow);
+        }
+    }
+
+    if (applicationLayer.HasMember (JSON_KEEP_DATASETS))
+    {
+        if (applicationLayer[JSON_KEEP_DATASETS].IsBool ())
+        {
+            m_keepDatasets = applicationLayer[JSON_KEEP_DATASETS].GetBool ();
+        }
+        else
+        {
+            Iec61850Utility::log_warn (
+                "keep_datasets has invalid type -> datasets are deleted "
+                "on disconnect");
+        }
+    }
+
+    if (applicationLayer.HasMember (JSON_CONTROL_OBJECTS))
+    {
+        static const std::unordered_map<std::string, CONTROLOBJECTS> modes
+            = { { "bringup", CONTROLS_AT_BRINGUP },
+                { "lazy", CONTROLS_LAZY },
+                { "prewarm", CONTROLS_PREWARM } };
+
+        const Value& controlObjects = applicationLayer[JSON_CONTROL_OBJECTS];
+
+        if (controlObjects.IsString ()
+            && modes.count (controlObjects.GetString ()))
+        {
+            m_controlObjects = modes.at (controlObjects.GetString ());
+        }
+        else
+        {
+            Iec61850Utility::log_warn (
+                "control_objects has invalid value -> created at bring-up");
+        }
+    }
+
+    if (applicationLayer.HasMember (JSON_RESYNC_GI_INTERVAL))
+    {
+        if (applicationLayer[JSON_RESYNC_GI_INTERVAL].IsInt ()
+            && applicationLayer[JSON_RESYNC_GI_INTERVAL].GetInt () >= 0)
+        {
+            m_resyncGiInterval
+                = applicationLayer[JSON_RESYNC_GI_INTERVAL].GetInt ();
+        }
+        else
+        {
+            Iec61850Utility::log_warn (
+                "resync_gi_interval has invalid value -> using default (%d)",
+                m_resyncGiInterval);
+        }
+    }
+
+    if (applicationLayer.HasMember (JSON_GI_CONCURRENCY))
+    {
+        if (applicationLayer[JSON_GI_CONCURRENCY].IsInt ()
+            && applicationLayer[JSON_GI_CONCURRENCY].GetInt () > 0)
+        {
+            m_giConcurrency = applicationLayer[JSON_GI_CONCURRENCY].GetInt ();
+        }
+        else
+        {
+            Iec61850Utility::log_warn (
+                "gi_concurrency has invalid value -> using default (%d)",
+                m_giConcurrency);
+        }
+    }
+
+    if (applicationLayer.HasMember (JSON_GI_SPACING))
+    {
+        if (applicationLayer[JSON_GI_SPACING].IsInt ()
+            && applicationLayer[JSON_GI_SPACING].GetInt () >= 0)
+        {
+            m_giSpacing = applicationLayer[JSON_GI_SPACING].GetInt ();
+        }
+        else
+        {
+            Iec61850Utility::log_warn (
+                "gi_spacing has invalid value -> using default (%d)",
+                m_giSpacing);
+        }
+    }
+
+    if (applicationLayer.HasMember (JSON_GI_PRIORITY))
+    {
+        if (applicationLayer[JSON_GI_PRIORITY].IsArray ())
+        {
+            m_giPriorities.clear ();
+
+            for (const auto& ld : applicationLayer[JSON_GI_PRIORITY].GetArray ())
+            {
+                if (ld.IsString ())
+                    m_giPriorities.push_back (ld.GetString ());
+                else
+                    Iec61850Utility::log_warn (
+                        "gi_priority element is not a string -> ignore");
+            }
+        }
+        else
+        {
+            Iec61850Utility::log_warn (
+                "gi_priority is not an array -> no GI priorities");
+        }
+    }
+
+    if (applicationLayer.HasMember (JSON_COMMAND_TIMEOUTS))
+    {
+        if (applicationLayer[JSON_COMMAND_TIMEOUTS].IsObject ())
+        {
+            importCommandTimeouts (applicationLayer[JSON_COMMAND_TIMEOUTS]);
+        }
+        else
+        {
+            Iec61850Utility::log_warn ("command_timeouts is not an object -> "
+                                       "using default timeouts");
+        }
+    }
+
     if (applicationLayer.HasMember (JSON_DATASETS)
         && applicationLayer[JSON_DATASETS].IsArray ())
     {
@@ -279,11 +456,11 @@ IEC61850ClientConfig::importProtocolConfig (const std::string& protocolConfig)
                             extractedObjRef.erase (bracketPos);
                         }
 
-                        const std::shared_ptr<DataExchangeDefinition> def
+                        DataExchangeDefinition* def
                             = getExchangeDefinitionByObjRef (extractedObjRef);
 
                         if (def){
-                            m_polledDatapoints.erase (extractedObjRef);
+                            def->polled = false;
                             Iec61850Utility::log_debug (
                             "%s won't be polled", extractedObjRef.c_str());
                         }
@@ -395,6 +572,198 @@ IEC61850ClientConfig::importProtocolConfig (const std::string& protocolConfig)
     m_protocolConfigComplete = true;
 }
 
+std::vector<IEC61850ClientConfig*>
+IEC61850ClientConfig::importIedConfigs (const std::string& protocolConfig,
+                                        const std::string& exchangeConfig,
+                                        const std::string& tlsConfig)
+{
+    std::vector<IEC61850ClientConfig*> configs;
+
+    Document document;
+
+    if (!document.Parse (protocolConfig.c_str ()).HasParseError ()
+        && document.IsObject () && document.HasMember (JSON_PROTOCOL_STACK)
+        && document[JSON_PROTOCOL_STACK].IsObject ()
+        && document[JSON_PROTOCOL_STACK].HasMember (JSON_IEDS)
+        && document[JSON_PROTOCOL_STACK][JSON_IEDS].IsArray ())
+    {
+        const Value& protocolStack = document[JSON_PROTOCOL_STACK];
+
+        std::vector<const Value*> stacks;
+
+        if (protocolStack.HasMember (JSON_TRANSPORT_LAYER))
+            stacks.push_back (&protocolStack);
+
+        for (const Value& ied : protocolStack[JSON_IEDS].GetArray ())
+        {
+            if (!ied.IsObject ())
+            {
+                Iec61850Utility::log_error (
+                    "IED configuration is not an object -> ignore");
+                continue;
+            }
+            stacks.push_back (&ied);
+        }
+
+        try
+        {
+            for (const Value* stack : stacks)
+            {
+                auto config = new IEC61850ClientConfig ();
+                configs.push_back (config);
+
+                if (!stack->HasMember (JSON_TRANSPORT_LAYER)
+                    || !(*stack)[JSON_TRANSPORT_LAYER].IsObject ()
+                    || !(*stack)[JSON_TRANSPORT_LAYER].HasMember (
+                        JSON_IED_NAME)
+                    || !(*stack)[JSON_TRANSPORT_LAYER][JSON_IED_NAME]
+                            .IsString ())
+                {
+                    Iec61850Utility::log_warn ("IED %d has no ied_name",
+                                               (int)configs.size () - 1);
+                    continue;
+                }
+
+                config->m_iedName
+                    = (*stack)[JSON_TRANSPORT_LAYER][JSON_IED_NAME]
+                          .GetString ();
+
+                if (findIedConfig (configs, config->m_iedName) != config)
+                {
+                    Iec61850Utility::log_warn (
+                        "IED name %s is used more than once",
+                        config->m_iedName.c_str ());
+                }
+            }
+
+            if (!configs.empty ())
+            {
+                std::string iedNames;
+
+                for (auto config : configs)
+                {
+                    iedNames += (iedNames.empty () ? "" : "_")
+                                + config->m_iedName;
+                }
+
+                importExchangeConfigSnapshot (exchangeConfig, configs,
+                                              iedNames);
+
+                for (size_t i = 0; i < configs.size (); i++)
+                {
+                    configs[i]->importProtocolStack (*stacks[i]);
+                    configs[i]->importTlsConfig (tlsConfig);
+                }
+
+                return configs;
+            }
+        }
+        catch (...)
+        {
+            for (auto config : configs)
+            {
+                delete config;
+            }
+            throw;
+        }
+    }
+
+    auto config = new IEC61850ClientConfig ();
+    configs.push_back (config);
+
+    std::string iedName;
+
+    if (document.IsObject () && document.HasMember (JSON_PROTOCOL_STACK)
+        && document[JSON_PROTOCOL_STACK].IsObject ()
+        && document[JSON_PROTOCOL_STACK].HasMember (JSON_TRANSPORT_LAYER)
+        && document[JSON_PROTOCOL_STACK][JSON_TRANSPORT_LAYER].IsObject ()
+        && document[JSON_PROTOCOL_STACK][JSON_TRANSPORT_LAYER].HasMember (
+            JSON_IED_NAME)
+        && document[JSON_PROTOCOL_STACK][JSON_TRANSPORT_LAYER][JSON_IED_NAME]
+               .IsString ())
+    {
+        iedName = document[JSON_PROTOCOL_STACK][JSON_TRANSPORT_LAYER]
+                          [JSON_IED_NAME]
+                              .GetString ();
+    }
+
+    try
+    {
+        importExchangeConfigSnapshot (exchangeConfig, configs, iedName);
+        config->importProtocolConfig (protocolConfig);
+        config->importTlsConfig (tlsConfig);
+    }
+    catch (...)
+    {
+        delete config;
+        throw;
+    }
+
+    return configs;
+}
+
+static void
+importTimeout (const Value& timeouts, const char* name, const char* key,
+               int& timeout)
+{
+    if (!timeouts.HasMember (key))
+        return;
+
+    if (timeouts[key].IsInt () && timeouts[key].GetInt () >= 0)
+    {
+        timeout = timeouts[key].GetInt ();
+    }
+    else
+    {
+        Iec61850Utility::log_warn ("%s.%s has invalid value -> using %d", name,
+                                   key, timeout);
+    }
+}
+
+static void
+importTimeouts (const Value& timeouts, const char* name,
+                CommandTimeouts& commandTimeouts)
+{
+    importTimeout (timeouts, name, JSON_SELECT_TIMEOUT,
+                   commandTimeouts.select);
+    importTimeout (timeouts, name, JSON_ACT_CON_TIMEOUT,
+                   commandTimeouts.actCon);
+    importTimeout (timeouts, name, JSON_ACT_TERM_TIMEOUT,
+                   commandTimeouts.actTerm);
+}
+
+void
+IEC61850ClientConfig::importCommandTimeouts (const Value& timeouts)
+{
+    /* the timeouts at the top level apply to every cdc */
+    CommandTimeouts defaults;
+    importTimeouts (timeouts, JSON_COMMAND_TIMEOUTS, defaults);
+
+    for (auto& commandTimeouts : m_commandTimeouts)
+        commandTimeouts = defaults;
+
+    for (auto it = timeouts.MemberBegin (); it != timeouts.MemberEnd (); ++it)
+    {
+        std::string name = it->name.GetString ();
+
+        if (name == JSON_SELECT_TIMEOUT || name == JSON_ACT_CON_TIMEOUT
+            || name == JSON_ACT_TERM_TIMEOUT)
+            continue;
+
+        auto cdc = cdcMap.find (name);
+
+        if (cdc == cdcMap.end () || !it->value.IsObject ())
+        {
+            Iec61850Utility::log_warn (
+                "command_timeouts.%s is not a cdc -> ignore", name.c_str ());
+            continue;
+        }
+
+        importTimeouts (it->value, name.c_str (),
+                        m_commandTimeouts[cdc->second]);
+    }
+}
+
 void
 IEC61850ClientConfig::importJsonConnectionOsiConfig (
     const rapidjson::Value& connOsiConfig, RedGroup& iedConnectionParam)
@@ -647,164 +1016,640 @@ IEC61850ClientConfig::parseOsiSelector(std::string& inputOsiSelector, uint8_t* s
     }
 }
 
-void
+bool
 IEC61850ClientConfig::importExchangeConfig (const std::string& exchangeConfig)
 {
-    m_exchangeConfigComplete = false;
+    return importExchangeConfig (exchangeConfig,
+                                 std::vector<IEC61850ClientConfig*>{ this });
+}
 
-    deleteExchangeDefinitions ();
+/*
+ * SAX handler streaming the exchanged_data datapoints into the configs.
+ *
+ * Only the datapoint being read is buffered (in reused strings) and it is
+ * added as soon as its object ends, so the import does not build a DOM of
+ * the whole configuration. The checks and their order are the same as for
+ * the former DOM based import: an invalid datapoint stops the import and
+ * keeps the datapoints already added.
+ */
+class ExchangeConfigHandler
+    : public BaseReaderHandler<UTF8<>, ExchangeConfigHandler>
+{
+  public:
+    explicit ExchangeConfigHandler (
+        const std::vector<IEC61850ClientConfig*>& configs)
+        : m_configs (configs)
+    {
+    }
 
-    Document document;
+    bool StartObject ();
+    bool EndObject (SizeType memberCount);
+    bool StartArray ();
+    bool EndArray (SizeType elementCount);
+    bool Key (const char* str, SizeType len, bool copy);
+    bool String (const char* str, SizeType len, bool copy);
+    bool Default ();
 
-    if (document.Parse (exchangeConfig.c_str ()).HasParseError ())
+    /* checks the mandatory elements once the whole document is read */
+    bool complete () const;
+
+  private:
+    enum State
     {
-        Iec61850Utility::log_fatal (
-            "Parsing error in data exchange configuration");
+        ROOT,
+        DOCUMENT,
+        EXCHANGE,
+        DATAPOINTS,
+        DATAPOINT,
+        PROTOCOLS,
+        PROTOCOL,
+        DONE
+    };
+
+    enum Field
+    {
+        FIELD_NONE,
+        FIELD_EXCHANGED_DATA,
+        FIELD_DATAPOINTS,
+        FIELD_LABEL,
+        FIELD_PIVOT_ID,
+        FIELD_PROTOCOLS,
+        FIELD_PROT_NAME,
+        FIELD_PROT_OBJ_REF,
+        FIELD_PROT_CDC,
+        FIELD_PROT_IED
+    };
+
+    struct Protocol
+    {
+        bool hasName;
+        bool hasObjRef;
+        bool hasCdc;
+        bool hasIed;
+        std::string name;
+        std::string objRef;
+        std::string cdc;
+        std::string ied;
+    };
+
+    bool value (bool isObject, bool isArray, const char* str, SizeType len);
+    bool addDatapoint ();
+
+    Protocol&
+    currentProtocol ()
+    {
+        return m_protocols[m_protocolCount - 1];
+    };
 
-        return;
+    static bool
+    keyIs (const char* str, SizeType len, const char* key)
+    {
+        return len == strlen (key) && memcmp (str, key, len) == 0;
+    };
+
+    const std::vector<IEC61850ClientConfig*>& m_configs;
+
+    State m_state = ROOT;
+    Field m_field = FIELD_NONE;
+    int m_skipDepth = 0;
+
+    bool m_exchangeDataFound = false;
+    bool m_datapointsFound = false;
+
+    bool m_hasLabel = false;
+    bool m_hasPivotId = false;
+    bool m_hasProtocols = false;
+    std::string m_label;
+    std::string m_pivotId;
+    std::vector<Protocol> m_protocols;
+    size_t m_protocolCount = 0;
+};
+
+bool
+ExchangeConfigHandler::value (bool isObject, bool isArray, const char* str,
+                              SizeType len)
+{
+    Field field = m_field;
+    m_field = FIELD_NONE;
+
+    bool skip = false;
+
+    switch (m_state)
+    {
+    case ROOT:
+        if (!isObject)
+        {
+            Iec61850Utility::log_error (
+                "NO DOCUMENT OBJECT FOR EXCHANGED DATA");
+            return false;
+        }
+        m_state = DOCUMENT;
+        return true;
+
+    case DOCUMENT:
+        if (field != FIELD_EXCHANGED_DATA)
+        {
+            skip = true;
+            break;
+        }
+        if (!isObject)
+        {
+            Iec61850Utility::log_error ("EXCHANGED DATA NOT AN OBJECT");
+            return false;
+        }
+        m_exchangeDataFound = true;
+        m_state = EXCHANGE;
+        return true;
+
+    case EXCHANGE:
+        if (field != FIELD_DATAPOINTS)
+        {
+            skip = true;
+            break;
+        }
+        if (!isArray)
+        {
+            Iec61850Utility::log_error ("NO EXCHANGED DATA DATAPOINTS");
+            return false;
+        }
+        m_datapointsFound = true;
+        m_state = DATAPOINTS;
+        return true;
+
+    case DATAPOINTS:
+        if (!isObject)
+        {
+            Iec61850Utility::log_error ("DATAPOINT NOT AN OBJECT");
+            return false;
+        }
+        m_hasLabel = false;
+        m_hasPivotId = false;
+        m_hasProtocols = false;
+        m_protocolCount = 0;
+        m_state = DATAPOINT;
+        return true;
+
+    case DATAPOINT:
+        if (field == FIELD_LABEL)
+        {
+            m_hasLabel = str != nullptr;
+            if (str)
+                m_label.assign (str, len);
+        }
+        else if (field == FIELD_PIVOT_ID)
+        {
+            m_hasPivotId = str != nullptr;
+            if (str)
+                m_pivotId.assign (str, len);
+        }
+        else if (field == FIELD_PROTOCOLS)
+        {
+            m_hasProtocols = isArray;
+            m_protocolCount = 0;
+            if (isArray)
+            {
+                m_state = PROTOCOLS;
+                return true;
+            }
+        }
+        skip = true;
+        break;
+
+    case PROTOCOLS:
+        if (m_protocolCount == m_protocols.size ())
+            m_protocols.push_back (Protocol ());
+
+        m_protocolCount++;
+        currentProtocol ().hasName = false;
+        currentProtocol ().hasObjRef = false;
+        currentProtocol ().hasCdc = false;
+        currentProtocol ().hasIed = false;
+
+        if (isObject)
+        {
+            m_state = PROTOCOL;
+            return true;
+        }
+        skip = true;
+        break;
+
+    case PROTOCOL: {
+        Protocol& protocol = currentProtocol ();
+
+        if (str && field == FIELD_PROT_NAME)
+        {
+            protocol.hasName = true;
+            protocol.name.assign (str, len);
+        }
+        else if (str && field == FIELD_PROT_OBJ_REF)
+        {
+            protocol.hasObjRef = true;
+            protocol.objRef.assign (str, len);
+        }
+        else if (str && field == FIELD_PROT_CDC)
+        {
+            protocol.hasCdc = true;
+            protocol.cdc.assign (str, len);
+        }
+        else if (str && field == FIELD_PROT_IED)
+        {
+            protocol.hasIed = true;
+            protocol.ied.assign (str, len);
+        }
+        skip = true;
+        break;
     }
 
-    if (!document.IsObject ())
+    case DONE:
+        break;
+    }
+
+    if (skip && (isObject || isArray))
+        m_skipDepth = 1;
+
+    return true;
+}
+
+bool
+ExchangeConfigHandler::StartObject ()
+{
+    if (m_skipDepth > 0)
     {
-        Iec61850Utility::log_error ("NO DOCUMENT OBJECT FOR EXCHANGED DATA");
-        return;
+        m_skipDepth++;
+        return true;
     }
-    if (!document.HasMember (JSON_EXCHANGED_DATA)
-        || !document[JSON_EXCHANGED_DATA].IsObject ())
+
+    return value (true, false, nullptr, 0);
+}
+
+bool
+ExchangeConfigHandler::StartArray ()
+{
+    if (m_skipDepth > 0)
     {
-        Iec61850Utility::log_error ("EXCHANGED DATA NOT AN OBJECT");
-        return;
+        m_skipDepth++;
+        return true;
     }
 
-    const Value& exchangeData = document[JSON_EXCHANGED_DATA];
+    return value (false, true, nullptr, 0);
+}
 
-    if (!exchangeData.HasMember (JSON_DATAPOINTS)
-        || !exchangeData[JSON_DATAPOINTS].IsArray ())
+bool
+ExchangeConfigHandler::String (const char* str, SizeType len, bool copy)
+{
+    if (m_skipDepth > 0)
+        return true;
+
+    return value (false, false, str, len);
+}
+
+bool
+ExchangeConfigHandler::Default ()
+{
+    if (m_skipDepth > 0)
+        return true;
+
+    return value (false, false, nullptr, 0);
+}
+
+bool
+ExchangeConfigHandler::Key (const char* str, SizeType len, bool copy)
+{
+    if (m_skipDepth > 0)
+        return true;
+
+    m_field = FIELD_NONE;
+
+    switch (m_state)
     {
-        Iec61850Utility::log_error ("NO EXCHANGED DATA DATAPOINTS");
-        return;
+    case DOCUMENT:
+        if (keyIs (str, len, JSON_EXCHANGED_DATA))
+            m_field = FIELD_EXCHANGED_DATA;
+        break;
+    case EXCHANGE:
+        if (keyIs (str, len, JSON_DATAPOINTS))
+            m_field = FIELD_DATAPOINTS;
+        break;
+    case DATAPOINT:
+        if (keyIs (str, len, JSON_LABEL))
+            m_field = FIELD_LABEL;
+        else if (keyIs (str, len, JSON_PIVOT_ID))
+            m_field = FIELD_PIVOT_ID;
+        else if (keyIs (str, len, JSON_PROTOCOLS))
+            m_field = FIELD_PROTOCOLS;
+        break;
+    case PROTOCOL:
+        if (keyIs (str, len, JSON_PROT_NAME))
+            m_field = FIELD_PROT_NAME;
+        else if (keyIs (str, len, JSON_PROT_OBJ_REF))
+            m_field = FIELD_PROT_OBJ_REF;
+        else if (keyIs (str, len, JSON_PROT_CDC))
+            m_field = FIELD_PROT_CDC;
+        else if (keyIs (str, len, JSON_PROT_IED))
+            m_field = FIELD_PROT_IED;
+        break;
+    default:
+        break;
     }
 
-    const Value& datapoints = exchangeData[JSON_DATAPOINTS];
+    return true;
+}
 
-    for (const Value& datapoint : datapoints.GetArray ())
+bool
+ExchangeConfigHandler::EndObject (SizeType memberCount)
+{
+    if (m_skipDepth > 0)
     {
-        if (!datapoint.IsObject ())
+        m_skipDepth--;
+        return true;
+    }
+
+    switch (m_state)
+    {
+    case DOCUMENT:
+        m_state = DONE;
+        break;
+    case EXCHANGE:
+        m_state = DOCUMENT;
+        break;
+    case DATAPOINT:
+        m_state = DATAPOINTS;
+        return addDatapoint ();
+    case PROTOCOL:
+        m_state = PROTOCOLS;
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+bool
+ExchangeConfigHandler::EndArray (SizeType elementCount)
+{
+    if (m_skipDepth > 0)
+    {
+        m_skipDepth--;
+        return true;
+    }
+
+    if (m_state == DATAPOINTS)
+        m_state = EXCHANGE;
+    else if (m_state == PROTOCOLS)
+        m_state = DATAPOINT;
+
+    return true;
+}
+
+bool
+ExchangeConfigHandler::addDatapoint ()
+{
+    if (!m_hasLabel)
+    {
+        Iec61850Utility::log_error ("DATAPOINT MISSING LABEL");
+        return false;
+    }
+
+    if (!m_hasPivotId)
+    {
+        Iec61850Utility::log_error ("DATAPOINT MISSING PIVOT ID");
+        return false;
+    }
+
+    if (!m_hasProtocols)
+    {
+        Iec61850Utility::log_error ("DATAPOINT MISSING PROTOCOLS ARRAY");
+        return false;
+    }
+
+    for (size_t i = 0; i < m_protocolCount; i++)
+    {
+        const Protocol& protocol = m_protocols[i];
+
+        if (!protocol.hasName)
         {
-            Iec61850Utility::log_error ("DATAPOINT NOT AN OBJECT");
-            return;
+            Iec61850Utility::log_error ("PROTOCOL MISSING NAME");
+            return false;
         }
 
-        if (!datapoint.HasMember (JSON_LABEL)
-            || !datapoint[JSON_LABEL].IsString ())
+        if (protocol.name != PROTOCOL_IEC61850)
         {
-            Iec61850Utility::log_error ("DATAPOINT MISSING LABEL");
-            return;
+            continue;
         }
-        std::string label = datapoint[JSON_LABEL].GetString ();
-
-        if (!datapoint.HasMember (JSON_PIVOT_ID)
-            || !datapoint[JSON_PIVOT_ID].IsString ())
+        if (!protocol.hasObjRef)
         {
-            Iec61850Utility::log_error ("DATAPOINT MISSING PIVOT ID");
-            return;
+            Iec61850Utility::log_error ("PROTOCOL HAS NO OBJECT REFERENCE");
+            return false;
+        }
+        if (!protocol.hasCdc)
+        {
+            Iec61850Utility::log_error ("PROTOCOL HAS NO CDC");
+            return false;
         }
 
-        std::string pivot_id = datapoint[JSON_PIVOT_ID].GetString ();
+        int typeId = IEC61850ClientConfig::getCdcTypeFromString (protocol.cdc);
 
-        if (!datapoint.HasMember (JSON_PROTOCOLS)
-            || !datapoint[JSON_PROTOCOLS].IsArray ())
+        if (typeId == -1)
         {
-            Iec61850Utility::log_error ("DATAPOINT MISSING PROTOCOLS ARRAY");
-            return;
+            Iec61850Utility::log_error ("Invalid CDC type %s, skip",
+                                        protocol.cdc.c_str ());
+            continue;
         }
-        for (const Value& protocol : datapoint[JSON_PROTOCOLS].GetArray ())
+
+        IEC61850ClientConfig* config = m_configs.front ();
+
+        if (m_configs.size () > 1 && protocol.hasIed)
         {
-            if (!protocol.HasMember (JSON_PROT_NAME)
-                || !protocol[JSON_PROT_NAME].IsString ())
-            {
-                Iec61850Utility::log_error ("PROTOCOL MISSING NAME");
-                return;
-            }
-            std::string protocolName = protocol[JSON_PROT_NAME].GetString ();
+            config
+                = IEC61850ClientConfig::findIedConfig (m_configs, protocol.ied);
 
-            if (protocolName != PROTOCOL_IEC61850)
+            if (!config)
             {
+                Iec61850Utility::log_error ("Unknown IED %s for %s -> ignore",
+                                            protocol.ied.c_str (),
+                                            m_label.c_str ());
                 continue;
             }
-            if (!protocol.HasMember (JSON_PROT_OBJ_REF)
-                || !protocol[JSON_PROT_OBJ_REF].IsString ())
+        }
+
+        config->addExchangeDefinition (m_label, m_pivotId, protocol.objRef,
+                                       static_cast<CDCTYPE> (typeId));
+    }
+
+    return true;
+}
+
+bool
+ExchangeConfigHandler::complete () const
+{
+    if (!m_exchangeDataFound)
+    {
+        Iec61850Utility::log_error ("EXCHANGED DATA NOT AN OBJECT");
+        return false;
+    }
+
+    if (!m_datapointsFound)
+    {
+        Iec61850Utility::log_error ("NO EXCHANGED DATA DATAPOINTS");
+        return false;
+    }
+
+    return true;
+}
+
+bool
+IEC61850ClientConfig::importExchangeConfig (
+    const std::string& exchangeConfig,
+    const std::vector<IEC61850ClientConfig*>& configs)
+{
+    for (auto config : configs)
+    {
+        config->m_exchangeConfigComplete = false;
+        config->deleteExchangeDefinitions ();
+    }
+
+    ExchangeConfigHandler handler (configs);
+    Reader reader;
+    StringStream stream (exchangeConfig.c_str ());
+
+    ParseResult result = reader.Parse (stream, handler);
+
+    if (result.Code () == kParseErrorTermination)
+    {
+        /* invalid datapoint, already reported by the handler */
+        return false;
+    }
+
+    if (result.IsError ())
+    {
+        int line = 1;
+        int column = 1;
+
+        for (size_t i = 0; i < result.Offset (); i++)
+        {
+            if (exchangeConfig[i] == '\n')
             {
-                Iec61850Utility::log_error (
-                    "PROTOCOL HAS NO OBJECT REFERENCE");
-                return;
+                line++;
+                column = 1;
             }
-            if (!protocol.HasMember (JSON_PROT_CDC)
-                || !protocol[JSON_PROT_CDC].IsString ())
+            else
             {
-                Iec61850Utility::log_error ("PROTOCOL HAS NO CDC");
-                return;
+                column++;
             }
+        }
 
-            const std::string objRef
-                = protocol[JSON_PROT_OBJ_REF].GetString ();
-            const std::string typeIdStr = protocol[JSON_PROT_CDC].GetString ();
+        Iec61850Utility::log_fatal (
+            "Parsing error in data exchange configuration at line %d column "
+            "%d: %s",
+            line, column, GetParseError_En (result.Code ()));
 
-            Iec61850Utility::log_info ("  address: %s type: %s label: %s \n ",
-                                       objRef.c_str (), typeIdStr.c_str (),
-                                       label.c_str ());
+        for (auto config : configs)
+        {
+            config->deleteExchangeDefinitions ();
+        }
 
-            int typeId = getCdcTypeFromString (typeIdStr);
+        return false;
+    }
 
-            if (typeId == -1)
-            {
-                Iec61850Utility::log_error ("Invalid CDC type, skip",
-                                            typeIdStr.c_str ());
-                continue;
-            }
+    if (!handler.complete ())
+        return false;
 
-            auto cdcType = static_cast<CDCTYPE> (typeId);
+    size_t definitions = 0;
 
-            auto it = m_exchangeDefinitions.find (label);
+    for (auto config : configs)
+    {
+        definitions += config->m_definitionIndex.size ();
+    }
 
-            if (it != m_exchangeDefinitions.end ())
-            {
-                Iec61850Utility::log_warn ("DataExchangeDefinition with label "
-                                           "%s already exists -> ignore",
-                                           label.c_str ());
-                continue;
-            }
+    Iec61850Utility::log_info ("Imported %d exchange definitions",
+                               (int)definitions);
 
-            auto def = std::make_shared<DataExchangeDefinition> ();
+    return true;
+}
 
-            def->objRef = objRef;
-            def->cdcType = cdcType;
-            def->label = label;
-            def->id = pivot_id;
+void
+IEC61850ClientConfig::importExchangeConfigSnapshot (
+    const std::string& exchangeConfig,
+    const std::vector<IEC61850ClientConfig*>& configs,
+    const std::string& iedNames)
+{
+    IEC61850ConfigSnapshot snapshot (
+        IEC61850ConfigSnapshot::snapshotFileName (iedNames));
 
-            if(def->cdcType == MV || def->cdcType == APC || def->cdcType == ASG){
-                def->hasIntValue = false;
-            }
+    uint64_t hash
+        = IEC61850ConfigSnapshot::configHash (exchangeConfig, configs);
 
-            m_exchangeDefinitions.insert ({ label, def });
-            m_exchangeDefinitionsPivotId.insert ({ pivot_id, def });
-            m_exchangeDefinitionsObjRef.insert ({ objRef, def });
-            m_polledDatapoints.insert ({ objRef, def });
-        }
+    if (snapshot.load (hash, configs))
+    {
+        Iec61850Utility::log_info (
+            "Exchange definitions loaded from the configuration snapshot");
+        return;
     }
+
+    /* an invalid configuration is parsed again to report its errors */
+    if (importExchangeConfig (exchangeConfig, configs))
+        snapshot.save (hash, configs);
 }
 
-std::shared_ptr<DataExchangeDefinition>
-IEC61850ClientConfig::getExchangeDefinitionByObjRef (const std::string& objRef)
+IEC61850ClientConfig*
+IEC61850ClientConfig::findIedConfig (
+    const std::vector<IEC61850ClientConfig*>& configs,
+    const std::string& iedName)
 {
-    auto it = m_exchangeDefinitionsObjRef.find (objRef);
-    if (it != m_exchangeDefinitionsObjRef.end ())
+    for (auto config : configs)
     {
-        return it->second;
+        if (config->m_iedName == iedName)
+            return config;
     }
+
     return nullptr;
 }
 
+std::shared_ptr<DataExchangeDefinition>
+IEC61850ClientConfig::createExchangeDefinition (CDCTYPE cdcType)
+{
+    auto def = std::make_shared<DataExchangeDefinition> ();
+
+    initExchangeDefinition (*def, cdcType);
+
+    return def;
+}
+
+void
+IEC61850ClientConfig::initExchangeDefinition (DataExchangeDefinition& def,
+                                              CDCTYPE cdcType)
+{
+    def.cdcType = cdcType;
+
+    if(def.cdcType == MV || def.cdcType == APC || def.cdcType == ASG){
+        def.hasIntValue = false;
+    }
+}
+
+void
+IEC61850ClientConfig::addExchangeDefinition (const std::string& label,
+                                             const std::string& pivotId,
+                                             const std::string& objRef,
+                                             CDCTYPE cdcType)
+{
+    if (getExchangeDefinitionByLabel (label))
+    {
+        Iec61850Utility::log_warn ("DataExchangeDefinition with label "
+                                   "%s already exists -> ignore",
+                                   label.c_str ());
+        return;
+    }
+
+    auto def = createExchangeDefinition (cdcType);
+
+    def->objRef = objRef;
+    def->label = label;
+    def->id = pivotId;
+
+    m_definitionIndex.add (def);
+}
+
 void
 IEC61850ClientConfig::importTlsConfig (const std::string& tlsConfig)
 {
@@ -878,4 +1723,174 @@ IEC61850ClientConfig::importTlsConfig (const std::string& tlsConfig)
             }
         }
     }
+
+    if (tlsConf.HasMember ("renegotiation_time"))
+    {
+        if (tlsConf["renegotiation_time"].IsInt ()
+            && tlsConf["renegotiation_time"].GetInt () >= 0)
+        {
+            m_tlsRenegotiationTime = tlsConf["renegotiation_time"].GetInt ();
+        }
+        else
+        {
+            Iec61850Utility::log_warn (
+                "renegotiation_time has invalid value -> using default (%d)",
+                m_tlsRenegotiationTime);
+        }
+    }
+
+    if (tlsConf.HasMember ("session_resumption_interval"))
+    {
+        if (tlsConf["session_resumption_interval"].IsInt ()
+            && tlsConf["session_resumption_interval"].GetInt () >= 0)
+        {
+            m_tlsSessionResumptionInterval
+                = tlsConf["session_resumption_interval"].GetInt ();
+        }
+        else
+        {
+            Iec61850Utility::log_warn (
+                "session_resumption_interval has invalid value -> using "
+                "default (%d)",
+                m_tlsSessionResumptionInterval);
+        }
+    }
+}
+
+static bool
+sameConnection (const RedGroup& a, const RedGroup& b)
+{
+    if (a.ipAddr != b.ipAddr || a.tcpPort != b.tcpPort || a.tls != b.tls
+        || a.isOsiParametersEnabled != b.isOsiParametersEnabled)
+        return false;
+
+    if (!a.isOsiParametersEnabled)
+        return true;
+
+    const OsiParameters& osiA = a.osiParameters;
+    const OsiParameters& osiB = b.osiParameters;
+
+    return osiA.localApTitle == osiB.localApTitle
+           && osiA.localAeQualifier == osiB.localAeQualifier
+           && osiA.remoteApTitle == osiB.remoteApTitle
+           && osiA.remoteAeQualifier == osiB.remoteAeQualifier
+           && memcmp (&osiA.localTSelector, &osiB.localTSelector,
+                      sizeof (TSelector))
+                  == 0
+           && memcmp (&osiA.remoteTSelector, &osiB.remoteTSelector,
+                      sizeof (TSelector))
+                  == 0
+           && memcmp (&osiA.localSSelector, &osiB.localSSelector,
+                      sizeof (SSelector))
+                  == 0
+           && memcmp (&osiA.remoteSSelector, &osiB.remoteSSelector,
+                      sizeof (SSelector))
+                  == 0
+           && memcmp (&osiA.localPSelector, &osiB.localPSelector,
+                      sizeof (PSelector))
+                  == 0
+           && memcmp (&osiA.remotePSelector, &osiB.remotePSelector,
+                      sizeof (PSelector))
+                  == 0;
+}
+
+IEC61850ConfigDiff
+IEC61850ClientConfig::diff (const IEC61850ClientConfig& newConfig) const
+{
+    IEC61850ConfigDiff diff;
+
+    if (m_connections.size () != newConfig.m_connections.size ())
+    {
+        diff.restart = true;
+    }
+    else
+    {
+        for (size_t i = 0; i < m_connections.size (); i++)
+        {
+            if (!sameConnection (*m_connections[i],
+                                 *newConfig.m_connections[i]))
+                diff.restart = true;
+        }
+    }
+
+    if (m_iedName != newConfig.m_iedName
+        || m_privateKey != newConfig.m_privateKey
+        || m_ownCertificate != newConfig.m_ownCertificate
+        || m_remoteCertificates != newConfig.m_remoteCertificates
+        || m_caCertificates != newConfig.m_caCertificates
+        || m_tlsRenegotiationTime != newConfig.m_tlsRenegotiationTime
+        || m_tlsSessionResumptionInterval
+               != newConfig.m_tlsSessionResumptionInterval
+        || m_backupConnectionTimeout != newConfig.m_backupConnectionTimeout
+        || m_reactorThreads != newConfig.m_reactorThreads
+        || m_modelCacheEnabled != newConfig.m_modelCacheEnabled
+        || m_sclFile != newConfig.m_sclFile
+        || m_bringUpWindow != newConfig.m_bringUpWindow
+        || m_giConcurrency != newConfig.m_giConcurrency
+        || m_giSpacing != newConfig.m_giSpacing
+        || m_giPriorities != newConfig.m_giPriorities)
+    {
+        diff.restart = true;
+    }
+
+    for (const auto& entry : m_datasets)
+    {
+        auto it = newConfig.m_datasets.find (entry.first);
+
+        if (it == newConfig.m_datasets.end ())
+            diff.removedDatasets.insert (entry.first);
+        else if (it->second->entries != entry.second->entries
+                 || it->second->dynamic != entry.second->dynamic)
+            diff.changedDatasets.insert (entry.first);
+    }
+
+    for (const auto& entry : newConfig.m_datasets)
+    {
+        if (!m_datasets.count (entry.first))
+            diff.changedDatasets.insert (entry.first);
+    }
+
+    for (const auto& entry : m_reportSubscriptions)
+    {
+        if (!newConfig.m_reportSubscriptions.count (entry.first))
+            diff.removedRcbs.insert (entry.first);
+    }
+
+    for (const auto& entry : newConfig.m_reportSubscriptions)
+    {
+        const std::shared_ptr<ReportSubscription>& rs = entry.second;
+        auto it = m_reportSubscriptions.find (entry.first);
+
+        if (it == m_reportSubscriptions.end ()
+            || it->second->datasetRef != rs->datasetRef
+            || it->second->trgops != rs->trgops
+            || it->second->buftm != rs->buftm
+            || it->second->intgpd != rs->intgpd || it->second->gi != rs->gi
+            || diff.changedDatasets.count (rs->datasetRef))
+        {
+            diff.changedRcbs.insert (entry.first);
+        }
+    }
+
+    if (m_definitionIndex.size () != newConfig.m_definitionIndex.size ())
+    {
+        diff.exchangeChanged = true;
+    }
+    else
+    {
+        for (const auto& def : newConfig.ExchangeDefinition ())
+        {
+            const DataExchangeDefinition* old
+                = getExchangeDefinitionByLabel (def->label);
+
+            if (!old || old->objRef != def->objRef
+                || old->cdcType != def->cdcType || old->id != def->id)
+            {
+                diff.exchangeChanged = true;
+                break;
+            }
+        }
+    }
+
+    return diff;
 }
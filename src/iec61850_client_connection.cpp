@@ -1,25 +1,75 @@
 #include "iec61850_client_connection.hpp"
 #include "iec61850_client_config.hpp"
 #include <algorithm>
+#include <cstring>
 #include <iec61850.hpp>
+#include <iec61850_async_pipeline.hpp>
+#include <iec61850_command_tracker.hpp>
+#include <iec61850_entryid_store.hpp>
+#include <iec61850_gi_scheduler.hpp>
+#include <iec61850_model_cache.hpp>
+#include <iec61850_reactor.hpp>
+#include <iec61850_setting_batch.hpp>
+#include <iec61850_spec_registry.hpp>
+#include <iec61850_timer_wheel.hpp>
 #include <libiec61850/hal_thread.h>
 #include <libiec61850/iec61850_client.h>
 #include <libiec61850/mms_value.h>
 #include <map>
+#include <set>
 #include <string>
+#include <sys/stat.h>
 #include <utils.h>
 #include <vector>
 
 IEC61850ClientConnection::IEC61850ClientConnection (
     IEC61850Client* client, IEC61850ClientConfig* config,
     const std::string& ip, const int tcpPort, bool tls,
-    OsiParameters* osiParameters)
+    OsiParameters* osiParameters, IEC61850Reactor* reactor)
     : m_client (client), m_config (config), m_osiParameters (osiParameters),
-      m_tcpPort (tcpPort), m_serverIp (ip), m_useTls (tls)
+      m_tcpPort (tcpPort), m_serverIp (ip), m_useTls (tls),
+      m_reactor (reactor),
+      m_pipeline (new IEC61850AsyncPipeline (config->bringUpWindow ())),
+      m_giScheduler (new IEC61850GiScheduler (
+          config->giConcurrency (), config->giSpacing (),
+          config->giPriorities ())),
+      m_commandTimers (new IEC61850TimerWheel (10, 512))
 {
+    for (auto& context : m_writeContexts)
+    {
+        context.connection = this;
+        context.booleanValue = MmsValue_newBoolean (false);
+        context.integerValue = MmsValue_newIntegerFromInt32 (0);
+        context.floatValue = MmsValue_newFloat (0.0);
+    }
 }
 
-IEC61850ClientConnection::~IEC61850ClientConnection () { Stop (); }
+IEC61850ClientConnection::~IEC61850ClientConnection ()
+{
+    Stop ();
+
+    /* outstanding requests refer to the pipeline until the connection is
+     * destroyed */
+    if (m_connection)
+    {
+        std::lock_guard<std::mutex> lock (m_conLock);
+        cleanUp ();
+    }
+
+    delete m_pipeline;
+    delete m_giScheduler;
+    delete m_commandTimers;
+
+    for (auto& context : m_writeContexts)
+    {
+        MmsValue_delete (context.booleanValue);
+        MmsValue_delete (context.integerValue);
+        MmsValue_delete (context.floatValue);
+    }
+
+    if (m_tlsConfig != nullptr)
+        TLSConfiguration_destroy (m_tlsConfig);
+}
 
 static uint64_t
 getMonotonicTimeInMs ()
@@ -39,6 +89,17 @@ getMonotonicTimeInMs ()
 void
 IEC61850ClientConnection::commandTerminationHandler (
     void* parameter, ControlObjectClient connection)
+{
+    IEC61850Client* client = ((ControlContext*)parameter)->connection->m_client;
+
+    client->enterCallback ();
+    handleCommandTermination ((ControlContext*)parameter, connection);
+    client->leaveCallback ();
+}
+
+void
+IEC61850ClientConnection::handleCommandTermination (
+    ControlContext* context, ControlObjectClient connection)
 {
     LastApplError lastApplError
         = ControlObjectClient_getLastApplError (connection);
@@ -48,17 +109,27 @@ IEC61850ClientConnection::commandTerminationHandler (
             lastApplError.addCause, lastApplError.error,
             std::string (ControlObjectClient_getObjectReference (connection)));
         Iec61850Utility::log_error ("Couldn't terminate command");
+    }
+
+    IEC61850ClientConnection* con = context->connection;
+    ControlObjectStruct* cos = context->cos;
+
+    if (context->commandId != cos->commandId)
+    {
+        Iec61850Utility::log_warn ("Termination of a previous command on %s "
+                                   "-> ignored",
+                                   cos->label.c_str ());
         return;
     }
 
-    auto connectionCosPair
-        = (std::pair<IEC61850ClientConnection*, ControlObjectStruct*>*)
-            parameter;
-    IEC61850ClientConnection* con = connectionCosPair->first;
-    ControlObjectStruct* cos = connectionCosPair->second;
+    if (lastApplError.error != CONTROL_ERROR_NO_ERROR)
+    {
+        /* CommandTermination- */
+        con->m_abortControl (cos, context->commandId);
+        return;
+    }
 
-    cos->state = CONTROL_IDLE;
-    con->sendActTerm (cos);
+    con->m_completeControl (cos, true);
 }
 
 // LCOV_EXCL_START
@@ -208,76 +279,141 @@ IEC61850ClientConnection::m_setOsiConnectionParameters ()
         osiParams.remoteTSelector);
 }
 
-void
-IEC61850ClientConnection::m_configDatasets ()
+static bool
+directoryMatches (LinkedList directory,
+                  const std::vector<std::string>& entries)
 {
-    for (const auto& pair : m_config->getDatasets ())
-    {
-        IedClientError error;
-        std::shared_ptr<Dataset> dataset = pair.second;
+    size_t i = 0;
 
-        if (dataset->dynamic)
-        {
-            bool createDataset = true;
+    for (LinkedList entry = LinkedList_getNext (directory); entry;
+         entry = LinkedList_getNext (entry), i++)
+    {
+        if (i >= entries.size () || entries[i] != (char*)entry->data)
+            return false;
+    }
 
-            Iec61850Utility::log_debug ("Create new dataset %s",
-                                        dataset->datasetRef.c_str ());
+    return i == entries.size ();
+}
 
-            bool isDeletable = false;
+void
+IEC61850ClientConnection::m_createDataset (
+    const std::shared_ptr<Dataset>& dataset)
+{
+    m_recreatedDatasets.insert (dataset->datasetRef);
 
-            LinkedList dsDir = IedConnection_getDataSetDirectory(m_connection, &error, dataset->datasetRef.c_str(), &isDeletable);
+    m_pipeline->submit (
+        [this, dataset] (IedClientError* err, void* parameter) {
+            LinkedList newDataSetEntries = LinkedList_create ();
 
-            if (error == IED_ERROR_OK)
+            for (const auto& entry : dataset->entries)
             {
-                if (isDeletable == false) {
-                    Iec61850Utility::log_error("Dataset %s already exists and cannot be deleted -> is static?", dataset->datasetRef.c_str());
-                    createDataset = false;
-                }
-                else {
-                    Iec61850Utility::log_info("Delete existing dataset %s", dataset->datasetRef.c_str());
+                LinkedList_add (newDataSetEntries, strdup (entry.c_str ()));
+            }
 
-                    if (IedConnection_deleteDataSet(m_connection, &error, dataset->datasetRef.c_str()) == false) {
-                        m_client->logIedClientError (error, "Delete Dataset");
-                        createDataset = false;
-                    }
-                }
+            uint32_t invokeId = IedConnection_createDataSetAsync (
+                m_connection, err, dataset->datasetRef.c_str (),
+                newDataSetEntries, IEC61850AsyncPipeline::genericHandler,
+                parameter);
 
-                LinkedList_destroy(dsDir);
-            }
+            LinkedList_destroyDeep (newDataSetEntries, free);
 
-            if (createDataset)
-            {
-                LinkedList newDataSetEntries = LinkedList_create ();
+            return invokeId;
+        },
+        [this, dataset] (IEC61850AsyncResult& result) {
+            if (result.err != IED_ERROR_OK)
+                m_client->logIedClientError (result.err, "Create Dataset");
+            else
+                m_datasetDirectories[dataset->datasetRef] = dataset->entries;
+
+            m_datasetReady (dataset->datasetRef);
+        });
+}
+
+void
+IEC61850ClientConnection::m_configDatasets ()
+{
+    for (const auto& pair : m_config->getDatasets ())
+    {
+        std::shared_ptr<Dataset> dataset = pair.second;
+
+        if (!dataset->dynamic
+            || (m_bringUpDiff
+                && !m_bringUpDiff->changedDatasets.count (pair.first)))
+            continue;
 
-                if (newDataSetEntries == nullptr)
+        Iec61850Utility::log_debug ("Create new dataset %s",
+                                    dataset->datasetRef.c_str ());
+
+        m_pendingDatasets.insert (dataset->datasetRef);
+
+        m_pipeline->submit (
+            [this, dataset] (IedClientError* err, void* parameter) {
+                return IedConnection_getDataSetDirectoryAsync (
+                    m_connection, err, dataset->datasetRef.c_str (),
+                    IEC61850AsyncPipeline::dataSetDirectoryHandler,
+                    parameter);
+            },
+            [this, dataset] (IEC61850AsyncResult& result) {
+                if (result.err != IED_ERROR_OK)
                 {
-                    continue;
+                    m_createDataset (dataset);
+                    return;
                 }
 
-                for (const auto& entry : dataset->entries)
+                if (directoryMatches (result.directory, dataset->entries))
                 {
-                    char* strCopy
-                        = static_cast<char*> (malloc (entry.length () + 1));
-                    if (strCopy != nullptr)
-                    {
-                        std::strcpy (strCopy, entry.c_str ());
-                        LinkedList_add (newDataSetEntries,
-                                        static_cast<void*> (strCopy));
-                    }
+                    Iec61850Utility::log_info ("Reuse existing dataset %s",
+                                               dataset->datasetRef.c_str ());
+                    m_datasetDirectories[dataset->datasetRef]
+                        = dataset->entries;
+                    m_datasetReady (dataset->datasetRef);
+                    return;
                 }
 
-                IedConnection_createDataSet (m_connection, &error,
-                                            dataset->datasetRef.c_str (),
-                                            newDataSetEntries);
-
-                if (error != IED_ERROR_OK)
+                if (!result.isDeletable)
                 {
-                    m_client->logIedClientError (error, "Create Dataset");
+                    Iec61850Utility::log_error (
+                        "Dataset %s already exists and cannot be deleted -> "
+                        "is static?",
+                        dataset->datasetRef.c_str ());
+                    m_datasetReady (dataset->datasetRef);
+                    return;
                 }
 
-                LinkedList_destroyDeep (newDataSetEntries, free);
-            }
-        }
+                Iec61850Utility::log_info ("Delete existing dataset %s",
+                                           dataset->datasetRef.c_str ());
+
+                m_pipeline->submit (
+                    [this, dataset] (IedClientError* err, void* parameter) {
+                        return IedConnection_deleteDataSetAsync (
+                            m_connection, err, dataset->datasetRef.c_str (),
+                            IEC61850AsyncPipeline::genericHandler,
+                            parameter);
+                    },
+                    [this, dataset] (IEC61850AsyncResult& result) {
+                        if (result.err != IED_ERROR_OK)
+                        {
+                            m_client->logIedClientError (result.err,
+                                                         "Delete Dataset");
+                            m_datasetReady (dataset->datasetRef);
+                            return;
+                        }
+
+                        m_createDataset (dataset);
+                    });
+            });
+    }
+}
+
+void
+IEC61850ClientConnection::m_datasetReady (const std::string& datasetRef)
+{
+    m_pendingDatasets.erase (datasetRef);
+
+    for (const auto& rcb : m_rcbBringUps)
+    {
+        if (rcb->rs->datasetRef == datasetRef)
+            m_readRcbDirectory (rcb);
     }
 }
 
@@ -294,33 +430,51 @@ IEC61850ClientConnection::reportCallbackFunction (void* parameter,
                                                   ClientReport report)
 {
     auto pair = (std::pair<IEC61850ClientConnection*, LinkedList>*)parameter;
-    IEC61850ClientConnection* con = pair->first;
-    LinkedList dataSetDirectory = pair->second;
+    IEC61850Client* client = pair->first->m_client;
+
+    /* before anything reads the configuration */
+    client->enterCallback ();
+    handleReport (pair->first, pair->second, report);
+    client->leaveCallback ();
+}
+
+void
+IEC61850ClientConnection::handleReport (IEC61850ClientConnection* con,
+                                        LinkedList dataSetDirectory,
+                                        ClientReport report)
+{
 
     MmsValue const* dataSetValues = ClientReport_getDataSetValues (report);
 
-    char buf[1024];
-    if(ClientReport_getEntryId(report) != nullptr){
-        if(con->m_client->lastEntryId !=nullptr){
-            MmsValue_delete(con->m_client->lastEntryId);
-        }
-        con->m_client->lastEntryId = MmsValue_clone(ClientReport_getEntryId(report));
-        if(con->m_client->lastEntryId!=nullptr){
-            MmsValue_printToBuffer(con->m_client->lastEntryId,buf,1024);
-        }
+    if (con->m_timeToFirstReport == 0)
+    {
+        con->m_timeToFirstReport
+            = getMonotonicTimeInMs () - con->m_connectStartTime + 1;
+
+        Iec61850Utility::log_info ("Time to first report from %s:%d: %lu ms",
+                                   con->m_serverIp.c_str (), con->m_tcpPort,
+                                   (unsigned long)con->m_timeToFirstReport);
     }
 
+    char buf[1024];
+    MmsValue* entryId = ClientReport_getEntryId (report);
+
+    if (entryId)
+        MmsValue_printToBuffer (entryId, buf, 1024);
+
     Iec61850Utility::log_debug ("received report for %s with rptId %s entryId %s",
                                 ClientReport_getRcbReference (report),
                                 ClientReport_getRptId (report),
-                                con->m_client->lastEntryId ? buf : "NULL");
+                                entryId ? buf : "NULL");
 
     if(ClientReport_hasBufOvfl(report) && ClientReport_getBufOvfl(report)){
         Iec61850Utility::log_warn("Buffer overflow bit set for report with rptId %s and entryId %s",
                                 ClientReport_getRptId (report),
-                                con->m_client->lastEntryId ? buf : "NULL");
+                                entryId ? buf : "NULL");
     }                            
 
+    con->m_checkReportSequence (report);
+
     uint64_t unixTime = 0;
 
     if (ClientReport_hasTimestamp (report))
@@ -354,41 +508,232 @@ IEC61850ClientConnection::reportCallbackFunction (void* parameter,
         Iec61850Utility::log_debug ("%s (included for reason %i)", entryName,
                                     reason);
 
-        con->m_client->handleValue (std::string (entryName), value, unixTime);
+        con->m_client->handleValue (entryName, strlen (entryName), value,
+                                    unixTime);
+    }
+
+    /* only once the values are handed over, a crash before resumes with
+     * this report */
+    IEC61850EntryIdStore* store = con->m_client->entryIdStore ();
+
+    if (entryId && store)
+        store->set (ClientReport_getRcbReference (report), entryId);
+}
+
+bool
+IEC61850ClientConnection::ReportSequence::update (uint16_t newSeqNum,
+                                                  bool hasSubSeqNum,
+                                                  uint16_t newSubSeqNum,
+                                                  bool moreSegmentsFollow)
+{
+    bool gap = false;
+
+    if (valid && moreSegments)
+    {
+        /* next segment of the same report expected */
+        gap = newSeqNum != seqNum || !hasSubSeqNum
+              || newSubSeqNum != (uint16_t)(subSeqNum + 1);
+    }
+    else
+    {
+        if (valid && newSeqNum != (seqNum + 1) % modulus)
+            gap = true;
+
+        /* first segments of a segmented report lost */
+        if (hasSubSeqNum && newSubSeqNum != 0)
+            gap = true;
+    }
+
+    valid = true;
+    seqNum = newSeqNum;
+    subSeqNum = hasSubSeqNum ? newSubSeqNum : 0;
+    moreSegments = hasSubSeqNum && moreSegmentsFollow;
+
+    if (gap)
+        gaps++;
+
+    return gap;
+}
+
+void
+IEC61850ClientConnection::m_checkReportSequence (ClientReport report)
+{
+    const char* rcbRef = ClientReport_getRcbReference (report);
+
+    if (!rcbRef || !ClientReport_hasSeqNum (report))
+        return;
+
+    std::lock_guard<std::mutex> lock (m_reportLock);
+
+    auto it = m_reportSequences.find (rcbRef);
+
+    if (it == m_reportSequences.end ())
+        return;
+
+    ReportSequence& sequence = it->second;
+
+    uint16_t lastSeqNum = sequence.seqNum;
+    bool hasSubSeqNum = ClientReport_hasSubSeqNum (report);
+
+    bool gap = sequence.update (
+        ClientReport_getSeqNum (report), hasSubSeqNum,
+        hasSubSeqNum ? ClientReport_getSubSeqNum (report) : 0,
+        ClientReport_getMoreSeqmentsFollow (report));
+
+    /* the server dropped buffered reports */
+    if (!gap && ClientReport_hasBufOvfl (report)
+        && ClientReport_getBufOvfl (report))
+    {
+        sequence.gaps++;
+        gap = true;
+    }
+
+    if (!gap)
+        return;
+
+    Iec61850Utility::log_warn (
+        "Report sequence gap on %s (SeqNum %u after %u, %lu gap(s))", rcbRef,
+        (unsigned int)sequence.seqNum, (unsigned int)lastSeqNum,
+        (unsigned long)sequence.gaps);
+
+    if (m_config->resyncGiInterval () > 0)
+        sequence.resyncPending = true;
+}
+
+uint64_t
+IEC61850ClientConnection::sequenceGaps (const std::string& rcbRef)
+{
+    std::lock_guard<std::mutex> lock (m_reportLock);
+
+    auto it = m_reportSequences.find (rcbRef);
+
+    return it == m_reportSequences.end () ? 0 : it->second.gaps;
+}
+
+/* GI on the RCBs that lost reports, at most one per resync interval */
+void
+IEC61850ClientConnection::m_resyncRcbs ()
+{
+    uint64_t currentTime = getMonotonicTimeInMs ();
+
+    std::vector<std::string> rcbRefs;
+
+    {
+        std::lock_guard<std::mutex> lock (m_reportLock);
+
+        for (auto& entry : m_reportSequences)
+        {
+            ReportSequence& sequence = entry.second;
+
+            if (!sequence.resyncPending
+                || (sequence.lastResyncTime != 0
+                    && currentTime < sequence.lastResyncTime
+                                         + m_config->resyncGiInterval ()))
+                continue;
+
+            sequence.resyncPending = false;
+            sequence.lastResyncTime = currentTime;
+            rcbRefs.push_back (entry.first);
+        }
+    }
+
+    for (const auto& rcbRef : rcbRefs)
+    {
+        Iec61850Utility::log_info ("Resynchronise %s with GI",
+                                   rcbRef.c_str ());
+        m_giScheduler->request (rcbRef);
+    }
+}
+
+void
+IEC61850ClientConnection::requestGI (const std::vector<std::string>& rcbRefs)
+{
+    if (!rcbRefs.empty ())
+    {
+        for (const auto& rcbRef : rcbRefs)
+            m_giScheduler->request (rcbRef);
+
+        return;
+    }
+
+    for (const auto& entry : m_config->getReportSubscriptions ())
+        m_giScheduler->request (entry.first);
+}
+
+void
+IEC61850ClientConnection::m_sendGis ()
+{
+    for (const auto& rcbRef : m_giScheduler->due (getMonotonicTimeInMs ()))
+    {
+        Iec61850Utility::log_debug ("Send GI on %s", rcbRef.c_str ());
+
+        m_pipeline->submit (
+            [this, rcbRef] (IedClientError* err, void* parameter) {
+                ClientReportControlBlock rcb
+                    = ClientReportControlBlock_create (rcbRef.c_str ());
+                ClientReportControlBlock_setGI (rcb, true);
+
+                uint32_t invokeId = IedConnection_setRCBValuesAsync (
+                    m_connection, err, rcb, RCB_ELEMENT_GI, false,
+                    IEC61850AsyncPipeline::genericHandler, parameter);
+
+                ClientReportControlBlock_destroy (rcb);
+
+                return invokeId;
+            },
+            [this, rcbRef] (IEC61850AsyncResult& result) {
+                m_giScheduler->done (rcbRef);
+
+                if (result.err != IED_ERROR_OK)
+                {
+                    m_client->logIedClientError (result.err, "GI " + rcbRef);
+                }
+            });
     }
+
+    m_pipeline->poll ();
 }
 
 static int
 configureRcb (const std::shared_ptr<ReportSubscription>& rs,
-              ClientReportControlBlock rcb, bool firstTimeConnect, MmsValue* lastEntryId)
+              ClientReportControlBlock rcb, MmsValue* entryId,
+              bool datasetRecreated)
 {
     uint32_t parametersMask = 0;
 
     bool isBuffered = ClientReportControlBlock_isBuffered (rcb);
 
+    /* only the attributes that differ from the values read are written */
     if (isBuffered)
     {
-        parametersMask |= RCB_ELEMENT_OPT_FLDS;
-        ClientReportControlBlock_setOptFlds(rcb,RPT_OPT_REASON_FOR_INCLUSION | RPT_OPT_ENTRY_ID | RPT_OPT_TIME_STAMP| RPT_OPT_DATA_SET);
+        int optFlds = RPT_OPT_REASON_FOR_INCLUSION | RPT_OPT_ENTRY_ID
+                      | RPT_OPT_TIME_STAMP | RPT_OPT_DATA_SET
+                      | RPT_OPT_SEQ_NUM | RPT_OPT_BUFFER_OVERFLOW;
+
+        if (ClientReportControlBlock_getOptFlds (rcb) != optFlds)
+        {
+            parametersMask |= RCB_ELEMENT_OPT_FLDS;
+            ClientReportControlBlock_setOptFlds (rcb, optFlds);
+        }
 
-        if (ClientReportControlBlock_hasResvTms(rcb))
+        if (ClientReportControlBlock_hasResvTms(rcb)
+            && ClientReportControlBlock_getResvTms (rcb) != 1000)
         {
             parametersMask |= RCB_ELEMENT_RESV_TMS;
             ClientReportControlBlock_setResvTms (rcb, 1000);
         }
 
-        if (firstTimeConnect)
+        /* resume after the last report received, purge without one */
+        if (!entryId)
         {
             parametersMask |= RCB_ELEMENT_PURGE_BUF;
             ClientReportControlBlock_setPurgeBuf (rcb, true);
         }
         else{
             char buf[1024];
-            if(lastEntryId!=nullptr){
-                MmsValue_printToBuffer(lastEntryId,buf,1024);
-            }
-            Iec61850Utility::log_debug("Reconnecting, send Entry ID %s for RCB %s", lastEntryId != nullptr ? buf : "NULL",  rs->rcbRef.c_str());
-            ClientReportControlBlock_setEntryId(rcb,lastEntryId);
+            MmsValue_printToBuffer(entryId,buf,1024);
+            Iec61850Utility::log_debug("Reconnecting, send Entry ID %s for RCB %s", buf,  rs->rcbRef.c_str());
+            ClientReportControlBlock_setEntryId(rcb,entryId);
 
             parametersMask |= RCB_ELEMENT_ENTRY_ID;
         }
@@ -397,19 +742,32 @@ configureRcb (const std::shared_ptr<ReportSubscription>& rs,
     {
         ClientReportControlBlock_setResv (rcb, true);
         parametersMask |= RCB_ELEMENT_RESV;
+
+        /* SeqNum is needed to detect lost reports */
+        int optFlds = ClientReportControlBlock_getOptFlds (rcb);
+
+        if (!(optFlds & RPT_OPT_SEQ_NUM))
+        {
+            parametersMask |= RCB_ELEMENT_OPT_FLDS;
+            ClientReportControlBlock_setOptFlds (rcb,
+                                                 optFlds | RPT_OPT_SEQ_NUM);
+        }
     }
 
-    if (rs->trgops != -1)
+    if (rs->trgops != -1
+        && ClientReportControlBlock_getTrgOps (rcb) != rs->trgops)
     {
         parametersMask |= RCB_ELEMENT_TRG_OPS;
         ClientReportControlBlock_setTrgOps (rcb, rs->trgops);
     }
-    if (rs->buftm != -1)
+    if (rs->buftm != -1
+        && ClientReportControlBlock_getBufTm (rcb) != (uint32_t)rs->buftm)
     {
         parametersMask |= RCB_ELEMENT_BUF_TM;
         ClientReportControlBlock_setBufTm (rcb, rs->buftm);
     }
-    if (rs->intgpd != -1)
+    if (rs->intgpd != -1
+        && ClientReportControlBlock_getIntgPd (rcb) != (uint32_t)rs->intgpd)
     {
         parametersMask |= RCB_ELEMENT_INTG_PD;
         ClientReportControlBlock_setIntgPd (rcb, rs->intgpd);
@@ -417,18 +775,21 @@ configureRcb (const std::shared_ptr<ReportSubscription>& rs,
 
     if (!rs->datasetRef.empty ())
     {
-        parametersMask |= RCB_ELEMENT_DATSET;
         std::string modifiedDataSetRef = rs->datasetRef;
         std::replace (modifiedDataSetRef.begin (), modifiedDataSetRef.end (),
                       '.', '$');
-        ClientReportControlBlock_setDataSetReference (
-            rcb, modifiedDataSetRef.c_str ());
-    }
 
-    if (rs->gi)
-    {
-        parametersMask |= RCB_ELEMENT_GI;
-        ClientReportControlBlock_setGI (rcb, rs->gi);
+        const char* currentDataSetRef
+            = ClientReportControlBlock_getDataSetReference (rcb);
+
+        /* a recreated dataset has to be attached again */
+        if (datasetRecreated || !currentDataSetRef
+            || modifiedDataSetRef != currentDataSetRef)
+        {
+            parametersMask |= RCB_ELEMENT_DATSET;
+            ClientReportControlBlock_setDataSetReference (
+                rcb, modifiedDataSetRef.c_str ());
+        }
     }
 
     ClientReportControlBlock_setRptEna (rcb, true);
@@ -437,16 +798,99 @@ configureRcb (const std::shared_ptr<ReportSubscription>& rs,
     return parametersMask;
 }
 
+/* dynamic datasets are keyed by their configured entries as well since
+ * changing them does not change the configRev of the IED */
+std::string
+IEC61850ClientConnection::datasetCacheKey (const std::string& datasetRef)
+{
+    auto it = m_config->getDatasets ().find (datasetRef);
+
+    if (it == m_config->getDatasets ().end () || !it->second->dynamic)
+        return datasetRef;
+
+    std::string entries;
+
+    for (const auto& entry : it->second->entries)
+    {
+        entries += entry;
+        entries += ',';
+    }
+
+    return datasetRef + "#" + std::to_string (std::hash<std::string> () (entries));
+}
+
+void
+IEC61850ClientConnection::m_readRcbDirectory (
+    const std::shared_ptr<RcbBringUp>& rcb)
+{
+    const std::shared_ptr<ReportSubscription>& rs = rcb->rs;
+    std::vector<std::string> cachedEntries;
+    std::string datasetKey = datasetCacheKey (rs->datasetRef);
+
+    auto knownDirectory = m_datasetDirectories.find (rs->datasetRef);
+
+    if (knownDirectory != m_datasetDirectories.end ())
+        cachedEntries = knownDirectory->second;
+
+    if (knownDirectory != m_datasetDirectories.end ()
+        || (m_modelCacheValid
+            && m_modelCache->getDatasetDirectory (datasetKey, cachedEntries)))
+    {
+        rcb->directory = LinkedList_create ();
+
+        for (const auto& entry : cachedEntries)
+        {
+            LinkedList_add (rcb->directory, strdup (entry.c_str ()));
+        }
+
+        m_enableRcbs ();
+        return;
+    }
+
+    m_pipeline->submit (
+        [this, rs] (IedClientError* err, void* parameter) {
+            return IedConnection_getDataSetDirectoryAsync (
+                m_connection, err, rs->datasetRef.c_str (),
+                IEC61850AsyncPipeline::dataSetDirectoryHandler, parameter);
+        },
+        [this, rcb, datasetKey] (IEC61850AsyncResult& result) {
+            if (result.err != IED_ERROR_OK)
+            {
+                Iec61850Utility::log_error (
+                    "Reading data set directory failed! %s",
+                    rcb->rs->datasetRef.c_str ());
+                rcb->failed = true;
+                return;
+            }
+
+            rcb->directory = result.directory;
+            result.directory = nullptr;
+
+            if (m_modelCache)
+            {
+                std::vector<std::string> entries;
+
+                for (LinkedList entry = LinkedList_getNext (rcb->directory);
+                     entry; entry = LinkedList_getNext (entry))
+                {
+                    entries.push_back ((char*)entry->data);
+                }
+                m_modelCache->setDatasetDirectory (datasetKey, entries);
+            }
+
+            m_enableRcbs ();
+        });
+}
+
 void
 IEC61850ClientConnection::m_configRcb ()
 {
     for (const auto& pair : m_config->getReportSubscriptions ())
     {
-        IedClientError error;
         std::shared_ptr<ReportSubscription> rs = pair.second;
-        ClientReportControlBlock rcb = nullptr;
-        ClientDataSet clientDataSet = nullptr;
-        LinkedList dataSetDirectory = nullptr;
+
+        if (m_bringUpDiff && !m_bringUpDiff->changedRcbs.count (pair.first))
+            continue;
 
         std::stringstream ss;
         ss << "reportsubscription - rcbref: " << rs->rcbRef
@@ -454,186 +898,941 @@ IEC61850ClientConnection::m_configRcb ()
            << ", buftm: " << rs->buftm << ", intgpd: " << rs->intgpd;
         Iec61850Utility::log_debug ("%s", ss.str ().c_str ());
 
-        dataSetDirectory = IedConnection_getDataSetDirectory (
-            m_connection, &error, rs->datasetRef.c_str (), nullptr);
+        auto rcb = std::make_shared<RcbBringUp> ();
+        rcb->rs = rs;
+        m_rcbBringUps.push_back (rcb);
 
-        if (error != IED_ERROR_OK)
-        {
-            Iec61850Utility::log_error (
-                "Reading data set directory failed! %s", rs->datasetRef.c_str());
-            continue;
-        }
+        m_readRcbValues (rcb);
 
-        clientDataSet = IedConnection_readDataSetValues (
-            m_connection, &error, rs->datasetRef.c_str (), nullptr);
+        /* the directory of a dynamic dataset is read once it is created */
+        if (!m_pendingDatasets.count (rs->datasetRef))
+            m_readRcbDirectory (rcb);
+    }
+}
 
-        if (clientDataSet == nullptr)
-        {
-            Iec61850Utility::log_error ("Failed to read dataset\n");
-            continue;
-        }
+void
+IEC61850ClientConnection::m_readRcbValues (
+    const std::shared_ptr<RcbBringUp>& rcb)
+{
+    const std::shared_ptr<ReportSubscription>& rs = rcb->rs;
+
+    m_pipeline->submit (
+        [this, rs] (IedClientError* err, void* parameter) {
+            return IedConnection_getRCBValuesAsync (
+                m_connection, err, rs->rcbRef.c_str (), nullptr,
+                IEC61850AsyncPipeline::rcbValuesHandler, parameter);
+        },
+        [this, rcb] (IEC61850AsyncResult& result) {
+            if (result.err != IED_ERROR_OK)
+            {
+                m_client->logIedClientError (
+                    result.err, "GetRCBValues " + rcb->rs->rcbRef);
+                rcb->failed = true;
+                return;
+            }
 
-        rcb = IedConnection_getRCBValues (m_connection, &error,
-                                          rs->rcbRef.c_str (), nullptr);
+            rcb->rcb = result.rcb;
+            result.rcb = nullptr;
+            m_enableRcbs ();
+        });
+}
 
-        if (error != IED_ERROR_OK)
-        {
-            m_client->logIedClientError(error,"GetRCBValues " + rs->rcbRef);
+/* reports are only enabled once the specifications needed to decode them
+ * are known */
+void
+IEC61850ClientConnection::m_enableRcbs ()
+{
+    if (m_pendingSpecs > 0)
+        return;
+
+    IEC61850EntryIdStore* store = m_client->entryIdStore ();
+
+    for (const auto& rcb : m_rcbBringUps)
+    {
+        if (rcb->enabled || rcb->failed || !rcb->rcb
+            || (!rcb->directory && !rcb->reportParameter))
             continue;
-        }
 
-        uint32_t parametersMask
-            = configureRcb (rs, rcb, m_client->firstTimeConnect,m_client->lastEntryId);
+        rcb->enabled = true;
 
-        auto connDataSetPair
-            = new std::pair<IEC61850ClientConnection*, LinkedList> (
-                this, dataSetDirectory);
-        m_connDataSetDirectoryPairs.push_back (connDataSetPair);
+        const std::shared_ptr<ReportSubscription>& rs = rcb->rs;
 
-        IedConnection_installReportHandler (
-            m_connection,
-            (rs->rcbRef.substr (0, rs->rcbRef.size ())).c_str (),
-            ClientReportControlBlock_getRptId (rcb), reportCallbackFunction,
-            static_cast<void*> (connDataSetPair));
+        MmsValue* entryId = store ? store->get (rs->rcbRef) : nullptr;
 
+        uint32_t parametersMask = configureRcb (
+            rs, rcb->rcb, entryId,
+            m_recreatedDatasets.count (rs->datasetRef) > 0);
 
-        IedConnection_setRCBValues (m_connection, &error, rcb, parametersMask,
-                                true);
+        if (entryId)
+            MmsValue_delete (entryId);
 
-        if (clientDataSet)
-            ClientDataSet_destroy (clientDataSet);
+        bool resume = (parametersMask & RCB_ELEMENT_ENTRY_ID) != 0;
 
-        if (rcb)
-            ClientReportControlBlock_destroy (rcb);
+        {
+            std::lock_guard<std::mutex> lock (m_reportLock);
+
+            ReportSequence& sequence = m_reportSequences[rs->rcbRef];
+            sequence.modulus
+                = ClientReportControlBlock_isBuffered (rcb->rcb) ? 65536 : 256;
+            sequence.valid = false;
+            sequence.moreSegments = false;
+            sequence.resyncPending = false;
+        }
 
-        if (error != IED_ERROR_OK)
+        if (!rcb->reportParameter)
         {
-            m_client->logIedClientError (error, "Set RCB Values");
-            return;
+            rcb->reportParameter
+                = new std::pair<IEC61850ClientConnection*, LinkedList> (
+                    this, rcb->directory);
+            m_connDataSetDirectoryPairs.push_back (rcb->reportParameter);
+            rcb->directory = nullptr;
+
+            IedConnection_installReportHandler (
+                m_connection, rs->rcbRef.c_str (),
+                ClientReportControlBlock_getRptId (rcb->rcb),
+                reportCallbackFunction,
+                static_cast<void*> (rcb->reportParameter));
         }
-    }
-}
+
+        ClientReportControlBlock block = rcb->rcb;
+        rcb->rcb = nullptr;
+
+        m_pipeline->submit (
+            [this, block, parametersMask] (IedClientError* err,
+                                           void* parameter) {
+                uint32_t invokeId = IedConnection_setRCBValuesAsync (
+                    m_connection, err, block, parametersMask, true,
+                    IEC61850AsyncPipeline::genericHandler, parameter);
+
+                ClientReportControlBlock_destroy (block);
+
+                return invokeId;
+            },
+            [this, rcb, store, resume] (IEC61850AsyncResult& result) {
+                /* the GIs are spread by the scheduler once connected, a
+                 * resumed buffer already holds every change since the last
+                 * report */
+                if (result.err == IED_ERROR_OK)
+                {
+                    if (rcb->rs->gi && !resume)
+                        m_giScheduler->request (rcb->rs->rcbRef);
+
+                    return;
+                }
+
+                m_client->logIedClientError (result.err,
+                                             "Set RCB Values "
+                                                 + rcb->rs->rcbRef);
+
+                /* the EntryID is no longer in the buffer of the server,
+                 * the RCB is enabled again with a purged buffer */
+                if (resume && store)
+                {
+                    Iec61850Utility::log_warn (
+                        "EntryID rejected for RCB %s -> purge buffer",
+                        rcb->rs->rcbRef.c_str ());
+
+                    store->clear (rcb->rs->rcbRef);
+                    rcb->enabled = false;
+                    m_readRcbValues (rcb);
+                }
+            });
+    }
+}
+
+void
+IEC61850ClientConnection::m_checkModelCache ()
+{
+    m_modelCache = nullptr;
+    m_modelCacheValid = false;
+
+    IEC61850ModelCache* cache = m_client->modelCache ();
+
+    std::set<std::string> lds;
+
+    if (cache)
+    {
+        for (const auto& def : m_config->ExchangeDefinition ())
+        {
+            const std::string& objRef = def->objRef;
+            size_t ldEnd = objRef.find ('/');
+
+            if (ldEnd != std::string::npos)
+                lds.insert (objRef.substr (0, ldEnd));
+        }
+    }
+
+    if (lds.empty ())
+    {
+        m_submitBringUp ();
+        return;
+    }
+
+    auto configRevs = std::make_shared<IEC61850ModelCache::Revisions> ();
+    auto paramRevs = std::make_shared<IEC61850ModelCache::Revisions> ();
+    auto pending = std::make_shared<int> ((int)(2 * lds.size ()));
+
+    auto done = [this, cache, lds, configRevs, paramRevs] () {
+        IEC61850ModelCache::Revisions revisions;
+
+        for (const auto& ld : lds)
+        {
+            auto configRev = configRevs->find (ld);
+
+            if (configRev == configRevs->end ())
+            {
+                Iec61850Utility::log_warn (
+                    "Cannot read configRev of %s -> model cache not used",
+                    ld.c_str ());
+                m_submitBringUp ();
+                return;
+            }
+
+            revisions[ld] = configRev->second;
+
+            auto paramRev = paramRevs->find (ld);
+
+            if (paramRev != paramRevs->end ())
+                revisions[ld] += "/" + paramRev->second;
+        }
+
+        m_modelCache = cache;
+
+        m_modelCacheValid = cache->matches (revisions);
+
+        if (m_modelCacheValid)
+        {
+            Iec61850Utility::log_info ("Using model cache for %s:%d",
+                                       m_serverIp.c_str (), m_tcpPort);
+        }
+        else
+        {
+            Iec61850Utility::log_info (
+                "Model revision changed for %s:%d -> rebuilding model cache",
+                m_serverIp.c_str (), m_tcpPort);
+            cache->reset (revisions);
+        }
+
+        m_submitBringUp ();
+    };
+
+    for (const auto& ld : lds)
+    {
+        struct RevisionRead
+        {
+            const char* name;
+            FunctionalConstraint fc;
+            std::shared_ptr<IEC61850ModelCache::Revisions> target;
+        };
+
+        for (const RevisionRead& read :
+             { RevisionRead{ "configRev", IEC61850_FC_DC, configRevs },
+               RevisionRead{ "paramRev", IEC61850_FC_ST, paramRevs } })
+        {
+            std::string objRef = ld + "/LLN0.NamPlt." + read.name;
+            auto target = read.target;
+            FunctionalConstraint fc = read.fc;
+
+            m_pipeline->submit (
+                [this, objRef, fc] (IedClientError* err, void* parameter) {
+                    return IedConnection_readObjectAsync (
+                        m_connection, err, objRef.c_str (), fc,
+                        IEC61850AsyncPipeline::readObjectHandler, parameter);
+                },
+                [ld, target, pending, done] (IEC61850AsyncResult& result) {
+                    if (result.err == IED_ERROR_OK && result.value)
+                    {
+                        char buf[256];
+                        (*target)[ld]
+                            = MmsValue_printToBuffer (result.value, buf, 256);
+                    }
+
+                    if (--(*pending) == 0)
+                        done ();
+                });
+        }
+    }
+}
+
+void
+IEC61850ClientConnection::m_fetchSpec (
+    const std::string& objRef, FunctionalConstraint fc,
+    const std::function<void (MmsVariableSpecification*)>& handler)
+{
+    if (m_modelCacheValid)
+    {
+        MmsVariableSpecification* spec = m_modelCache->getSpec (objRef, fc);
+
+        if (spec)
+        {
+            handler (spec);
+            MmsVariableSpecification_destroy (spec);
+            return;
+        }
+    }
+
+    m_pipeline->submit (
+        [this, objRef, fc] (IedClientError* err, void* parameter) {
+            return IedConnection_getVariableSpecificationAsync (
+                m_connection, err, objRef.c_str (), fc,
+                IEC61850AsyncPipeline::variableSpecHandler, parameter);
+        },
+        [this, objRef, fc, handler] (IEC61850AsyncResult& result) {
+            if (result.spec && m_modelCache)
+                m_modelCache->setSpec (objRef, fc, result.spec);
+
+            handler (result.spec);
+        });
+}
+
+void
+IEC61850ClientConnection::m_fetchDataSpec (
+    const std::string& objRef, FunctionalConstraint fc,
+    const std::function<void (MmsVariableSpecification*)>& handler)
+{
+    m_pendingSpecs++;
+
+    m_fetchSpec (objRef, fc, [this, handler] (MmsVariableSpecification* spec) {
+        handler (spec);
+
+        m_pendingSpecs--;
+        m_enableRcbs ();
+    });
+}
+
+void
+IEC61850ClientConnection::m_setSpecType (
+    const std::shared_ptr<DataExchangeDefinition>& def,
+    const MmsVariableSpecification* spec)
+{
+    IEC61850SpecRegistry* registry = m_client->specRegistry ();
+
+    registry->release (def->spec);
+    def->spec = registry->intern (spec);
+}
 
 void
 IEC61850ClientConnection::m_setVarSpecs ()
 {
-    IedClientError err;
-    for (const auto& entry : m_config->ExchangeDefinition ())
+    /* definitions grouped by logical node and functional constraint */
+    std::map<std::pair<std::string, FunctionalConstraint>,
+             std::vector<std::shared_ptr<DataExchangeDefinition> > >
+        lnGroups;
+
+    for (const auto& def : m_config->ExchangeDefinition ())
     {
-        auto def = entry.second;
+        if (def->spec)
+        {
+            /* kept across reconnects and reconfigurations while the
+             * revisions of the model are unchanged */
+            if (m_modelCacheValid)
+                continue;
+
+            /* the layout may have changed, the type is resolved again and
+             * stored in the rebuilt cache */
+            m_client->specRegistry ()->release (def->spec);
+            def->spec = nullptr;
+        }
+
         FunctionalConstraint fc = def->cdcType == MV || def->cdcType == APC
                                       ? IEC61850_FC_MX
                                       : IEC61850_FC_ST;
-        MmsVariableSpecification* spec
-            = getVariableSpec (&err, def->objRef.c_str (), fc);
-        if (spec)
+
+        size_t lnEnd = def->objRef.find ('.');
+
+        if (lnEnd == std::string::npos)
+        {
+            m_fetchDataSpec (def->objRef, fc,
+                             [this, def] (MmsVariableSpecification* spec) {
+                                 m_setSpecType (def, spec);
+                             });
+            continue;
+        }
+
+        lnGroups[{ def->objRef.substr (0, lnEnd), fc }].push_back (def);
+    }
+
+    for (const auto& group : lnGroups)
+    {
+        std::string lnRef = group.first.first;
+        FunctionalConstraint fc = group.first.second;
+        std::vector<std::shared_ptr<DataExchangeDefinition> > defs
+            = group.second;
+
+        auto setSpecs = [this, lnRef, fc,
+                         defs] (MmsVariableSpecification* lnSpec) {
+            for (const auto& def : defs)
+            {
+                MmsVariableSpecification* spec = nullptr;
+
+                if (lnSpec)
+                {
+                    std::string doName
+                        = def->objRef.substr (lnRef.size () + 1);
+                    std::replace (doName.begin (), doName.end (), '.', '$');
+
+                    spec = MmsVariableSpecification_getNamedVariableRecursive (
+                        lnSpec, doName.c_str ());
+                }
+
+                if (spec)
+                {
+                    m_setSpecType (def, spec);
+                    continue;
+                }
+
+                m_fetchDataSpec (def->objRef, fc,
+                                 [this, def] (MmsVariableSpecification* spec) {
+                                     m_setSpecType (def, spec);
+                                 });
+            }
+        };
+
+        /* a single DO is cheaper to fetch on its own than the whole LN */
+        if (defs.size () > 1)
+            m_fetchDataSpec (lnRef, fc, setSpecs);
+        else
+            setSpecs (nullptr);
+    }
+}
+
+IEC61850ClientConnection::ControlObjectStruct*
+IEC61850ClientConnection::m_addControlObject (
+    const std::shared_ptr<DataExchangeDefinition>& def, ControlModel model,
+    MmsVariableSpecification* coSpec)
+{
+    if (!coSpec)
+    {
+        if (model != CONTROL_MODEL_STATUS_ONLY)
         {
-            def->spec = spec;
+            Iec61850Utility::log_warn (
+                "Failed to create Control ObjectClient %s , %s ",
+                def->label.c_str (), def->objRef.c_str ());
         }
+        return nullptr;
+    }
+
+    auto co = new ControlObjectStruct;
+
+    co->client = ControlObjectClient_createEx (def->objRef.c_str (),
+                                               m_connection, model, coSpec);
+
+    if (!co->client)
+    {
+        if (model != CONTROL_MODEL_STATUS_ONLY)
+        {
+            Iec61850Utility::log_warn (
+                "Failed to create Control ObjectClient %s , %s ",
+                def->label.c_str (), def->objRef.c_str ());
+        }
+        delete co;
+        return nullptr;
+    }
+    co->mode = ControlObjectClient_getControlModel (co->client);
+    co->state = CONTROL_IDLE;
+    co->label = def->label;
+    co->cdcType = def->cdcType;
+    for (auto& context : co->contexts)
+        context = { this, co, IEC61850CommandTracker::NO_COMMAND };
+    switch (def->cdcType)
+    {
+    case SPC:
+    case DPC: {
+        co->value = MmsValue_newBoolean (false);
+        break;
+    }
+    case BSC: {
+        co->value = MmsValue_newBitString (2);
+        break;
+    }
+    case APC: {
+        co->value = MmsValue_newFloat (0.0);
+        break;
+    }
+    case INC: {
+        co->value = MmsValue_newIntegerFromInt32 (0);
+        break;
+    }
+    default: {
+        Iec61850Utility::log_error ("Invalid cdc type");
+        ControlObjectClient_destroy (co->client);
+        delete co;
+        return nullptr;
     }
+    }
+    Iec61850Utility::log_debug ("Added control object %s , %s ",
+                                co->label.c_str (), def->objRef.c_str ());
+
+    {
+        std::lock_guard<std::mutex> lock (m_controlLock);
+        m_controlObjects.insert ({ def->objRef, co });
+    }
+
+    return co;
 }
 
 void
 IEC61850ClientConnection::m_initialiseControlObjects ()
 {
-    for (const auto& entry : m_config->ExchangeDefinition ())
+    for (const auto& def : m_config->ExchangeDefinition ())
     {
-        auto def = entry.second;
         if (def->cdcType < SPC || def->cdcType >= SPG)
             continue;
-        IedClientError err;
-        MmsValue* temp = IedConnection_readObject (
-            m_connection, &err, (def->objRef+".ctlModel").c_str(), IEC61850_FC_ST);
-        ControlModel model = (ControlModel) MmsValue_toInt32(temp);   
-        if (err != IED_ERROR_OK)
-        {
-            m_client->logIedClientError (err, "Initialise control object");
-            continue;
-        }
-        MmsValue_delete (temp);
-        auto co = new ControlObjectStruct;
-        co->client = ControlObjectClient_create (def->objRef.c_str (), m_connection);
-        if(!co->client){
-          if(model != CONTROL_MODEL_STATUS_ONLY){
-            Iec61850Utility::log_warn ("Failed to create Control ObjectClient %s , %s ",
-                                    entry.first.c_str (), def->objRef.c_str ());
-          }
-          delete co;                           
-          continue;  
-        }
-        co->mode = ControlObjectClient_getControlModel (co->client);
-        co->state = CONTROL_IDLE;
-        co->label = entry.first;
-        switch (def->cdcType)
+
+        m_createControlObject (def, nullptr);
+    }
+}
+
+void
+IEC61850ClientConnection::m_createControlObject (
+    const std::shared_ptr<DataExchangeDefinition>& def,
+    const std::function<void (ControlObjectStruct*)>& created)
+{
+    {
+        std::lock_guard<std::mutex> lock (m_controlLock);
+
+        auto it = m_controlObjects.find (def->objRef);
+
+        if (it != m_controlObjects.end ())
         {
-        case SPC:
-        case DPC: {
-            co->value = MmsValue_newBoolean (false);
-            break;
-        }
-        case BSC: {
-            co->value = MmsValue_newBitString (2);
-            break;
-        }
-        case APC: {
-            co->value = MmsValue_newFloat (0.0);
-            break;
-        }
-        case INC: {
-            co->value = MmsValue_newIntegerFromInt32 (0);
-            break;
-        }
-        default: {
-            Iec61850Utility::log_error ("Invalid cdc type");
+            if (created)
+                created (it->second);
             return;
         }
+    }
+
+    /* a creation in progress is shared */
+    auto pending = m_pendingControls.find (def->objRef);
+
+    if (pending != m_pendingControls.end ())
+    {
+        if (created)
+            pending->second.push_back (created);
+        return;
+    }
+
+    auto& waiting = m_pendingControls[def->objRef];
+
+    if (created)
+        waiting.push_back (created);
+
+    /* ctlModel and control structure are read in parallel */
+    struct PendingControl
+    {
+        int pending = 2;
+        bool modelRead = false;
+        ControlModel model = CONTROL_MODEL_STATUS_ONLY;
+        MmsVariableSpecification* spec = nullptr;
+    };
+
+    auto control = std::make_shared<PendingControl> ();
+
+    auto done = [this, def, control] () {
+        if (--control->pending > 0)
+            return;
+
+        ControlObjectStruct* co = nullptr;
+
+        if (control->modelRead)
+            co = m_addControlObject (def, control->model, control->spec);
+
+        if (control->spec)
+            MmsVariableSpecification_destroy (control->spec);
+        control->spec = nullptr;
+
+        auto it = m_pendingControls.find (def->objRef);
+
+        if (it == m_pendingControls.end ())
+            return;
+
+        std::vector<std::function<void (ControlObjectStruct*)> > waiting;
+        waiting.swap (it->second);
+        m_pendingControls.erase (it);
+
+        for (const auto& waiter : waiting)
+            waiter (co);
+    };
+
+    if (m_modelCacheValid
+        && m_modelCache->getCtlModel (def->objRef, control->model))
+    {
+        control->modelRead = true;
+        done ();
+    }
+    else
+    {
+        std::string ctlModelRef = def->objRef + ".ctlModel";
+
+        m_pipeline->submit (
+            [this, ctlModelRef] (IedClientError* err, void* parameter) {
+                return IedConnection_readObjectAsync (
+                    m_connection, err, ctlModelRef.c_str (), IEC61850_FC_ST,
+                    IEC61850AsyncPipeline::readObjectHandler, parameter);
+            },
+            [this, def, control, done] (IEC61850AsyncResult& result) {
+                if (result.err != IED_ERROR_OK || !result.value)
+                {
+                    m_client->logIedClientError (result.err,
+                                                 "Initialise control object");
+                }
+                else
+                {
+                    control->model
+                        = (ControlModel)MmsValue_toInt32 (result.value);
+                    control->modelRead = true;
+
+                    if (m_modelCache)
+                        m_modelCache->setCtlModel (def->objRef,
+                                                   control->model);
+                }
+                done ();
+            });
+    }
+
+    m_fetchSpec (def->objRef, IEC61850_FC_CO,
+                 [control, done] (MmsVariableSpecification* spec) {
+                     control->spec = IEC61850ModelCache::copySpec (spec);
+                     done ();
+                 });
+}
+
+void
+IEC61850ClientConnection::m_rejectCommand (const std::string& objRef,
+                                           uint64_t commandId)
+{
+    Iec61850Utility::log_warn ("Command on %s failed -> negative "
+                               "acknowledgement",
+                               objRef.c_str ());
+
+    /* operate has already accepted the command */
+    m_client->sendCommandAck (commandId, CONTROL_MODEL_DIRECT_NORMAL, false,
+                              true);
+    m_client->commandTracker ().remove (commandId);
+}
+
+void
+IEC61850ClientConnection::m_createLazyControls ()
+{
+    std::vector<LazyCommand> commands;
+
+    {
+        std::lock_guard<std::mutex> lock (m_controlLock);
+        commands.swap (m_lazyCommands);
+    }
+
+    for (const auto& command : commands)
+    {
+        std::shared_ptr<DataExchangeDefinition> def
+            = m_config->sharedExchangeDefinitionByObjRef (command.objRef);
+
+        if (def && (def->cdcType < SPC || def->cdcType >= SPG))
+            def = nullptr;
+
+        std::string objRef = command.objRef;
+        DatapointValue value = command.value;
+        uint64_t commandId = command.commandId;
+
+        auto send = [this, objRef, value, commandId] (ControlObjectStruct* co) {
+            if (!co || !m_operate (co, objRef, value, commandId))
+                m_rejectCommand (objRef, commandId);
+        };
+
+        if (!def)
+        {
+            send (nullptr);
+            continue;
         }
-        Iec61850Utility::log_debug ("Added control object %s , %s ",
-                                    co->label.c_str (), def->objRef.c_str ());
-        m_controlObjects.insert ({ def->objRef, co });
+
+        m_createControlObject (def, send);
     }
 }
 
 void
-IEC61850ClientConnection::Start ()
+IEC61850ClientConnection::m_submitBringUp ()
 {
-    if (!m_started)
+    m_setVarSpecs ();
+
+    if (m_config->controlObjects () == CONTROLS_AT_BRINGUP)
+        m_initialiseControlObjects ();
+
+    m_configDatasets ();
+    m_configRcb ();
+    m_enableRcbs ();
+}
+
+void
+IEC61850ClientConnection::m_startBringUp (
+    const std::shared_ptr<IEC61850ConfigDiff>& diff,
+    const std::vector<std::string>& disabledRcbs,
+    const std::vector<std::string>& deletedDatasets)
+{
+    m_bringUpStartTime = getMonotonicTimeInMs ();
+    m_bringUpDiff = diff;
+    m_pendingSpecs = 0;
+    m_pendingDatasets.clear ();
+    m_recreatedDatasets.clear ();
+    m_datasetDirectories.clear ();
+    m_rcbBringUps.clear ();
+    m_pipeline->setWindow (m_config->bringUpWindow ());
+
+    if (disabledRcbs.empty ())
     {
-        m_started = true;
+        m_checkModelCache ();
+        return;
+    }
+
+    /* RCBs are disabled before their dataset changes */
+    auto pending = std::make_shared<int> ((int)disabledRcbs.size ());
 
-        m_conThread
-            = new std::thread (&IEC61850ClientConnection::_conThread, this);
+    for (const auto& rcbRef : disabledRcbs)
+    {
+        m_pipeline->submit (
+            [this, rcbRef] (IedClientError* err, void* parameter) {
+                ClientReportControlBlock rcb
+                    = ClientReportControlBlock_create (rcbRef.c_str ());
+                ClientReportControlBlock_setRptEna (rcb, false);
+
+                uint32_t invokeId = IedConnection_setRCBValuesAsync (
+                    m_connection, err, rcb, RCB_ELEMENT_RPT_ENA, true,
+                    IEC61850AsyncPipeline::genericHandler, parameter);
+
+                ClientReportControlBlock_destroy (rcb);
+
+                return invokeId;
+            },
+            [this, rcbRef, pending,
+             deletedDatasets] (IEC61850AsyncResult& result) {
+                if (result.err != IED_ERROR_OK)
+                    m_client->logIedClientError (result.err,
+                                                 "Disable RCB " + rcbRef);
+
+                if (--(*pending) > 0)
+                    return;
+
+                for (const auto& datasetRef : deletedDatasets)
+                {
+                    m_pipeline->submit (
+                        [this, datasetRef] (IedClientError* err,
+                                            void* parameter) {
+                            return IedConnection_deleteDataSetAsync (
+                                m_connection, err, datasetRef.c_str (),
+                                IEC61850AsyncPipeline::genericHandler,
+                                parameter);
+                        },
+                        [this, datasetRef] (IEC61850AsyncResult& result) {
+                            if (result.err != IED_ERROR_OK)
+                                m_client->logIedClientError (
+                                    result.err,
+                                    "Delete dynamic dataset " + datasetRef);
+                        });
+                }
+
+                m_checkModelCache ();
+            });
     }
 }
 
 void
-IEC61850ClientConnection::cleanUp ()
+IEC61850ClientConnection::applyConfig (IEC61850ClientConfig* newConfig,
+                                       const IEC61850ConfigDiff& diff)
 {
-    if (!m_config->ExchangeDefinition ().empty ())
+    std::lock_guard<std::mutex> lock (m_conLock);
+
+    /* an unfinished bring-up is restarted on a new association */
+    if (m_connectionState == CON_STATE_BRINGUP)
     {
-        for (const auto& def : m_config->ExchangeDefinition ())
+        cleanUp ();
+        m_connectionState = CON_STATE_IDLE;
+    }
+
+    IEC61850ClientConfig* oldConfig = m_config;
+    IEC61850SpecRegistry* registry = m_client->specRegistry ();
+
+    /* unchanged data objects keep their decoding state */
+    for (const auto& oldDef : oldConfig->ExchangeDefinition ())
+    {
+        if (!oldDef->spec)
+            continue;
+
+        auto newDef = newConfig->getExchangeDefinitionByLabel (oldDef->label);
+
+        if (newDef && !newDef->spec && newDef->objRef == oldDef->objRef
+            && newDef->cdcType == oldDef->cdcType)
+        {
+            newDef->spec = oldDef->spec;
+            newDef->lastValue = oldDef->lastValue;
+            newDef->valueSet = oldDef->valueSet;
+        }
+        else
+        {
+            registry->release (oldDef->spec);
+        }
+
+        oldDef->spec = nullptr;
+    }
+
+    std::vector<ControlObjectStruct*> removedControls;
+
+    {
+        std::lock_guard<std::mutex> lock (m_controlLock);
+
+        for (auto it = m_controlObjects.begin ();
+             it != m_controlObjects.end ();)
         {
-            if (def.second->spec)
+            auto newDef
+                = newConfig->getExchangeDefinitionByObjRef (it->first);
+
+            /* with another label or cdc the object is created again */
+            if (newDef && newDef->label == it->second->label
+                && newDef->cdcType == it->second->cdcType)
             {
-                MmsVariableSpecification_destroy (def.second->spec);
-                def.second->spec = nullptr;
+                it++;
+                continue;
             }
+
+            removedControls.push_back (it->second);
+            it = m_controlObjects.erase (it);
         }
     }
 
-    if (!m_connDataSetDirectoryPairs.empty ())
+    for (auto cos : removedControls)
+        m_abortControl (cos, cos->commandId);
+
+    /* responses may still be outstanding on the connection */
     {
-        for (const auto& entry : m_connDataSetDirectoryPairs)
+        std::lock_guard<std::mutex> lock (m_controlLock);
+        m_retiredControls.insert (m_retiredControls.end (),
+                                  removedControls.begin (),
+                                  removedControls.end ());
+    }
+
+    std::vector<std::string> disabledRcbs;
+    std::vector<std::string> deletedDatasets;
+    IEC61850EntryIdStore* store = m_client->entryIdStore ();
+
+    for (const auto& entry : oldConfig->getReportSubscriptions ())
+    {
+        const std::string& rcbRef = entry.first;
+
+        if (!diff.removedRcbs.count (rcbRef) && !diff.changedRcbs.count (rcbRef))
+            continue;
+
+        disabledRcbs.push_back (rcbRef);
+
+        if (m_connection)
+            IedConnection_uninstallReportHandler (m_connection,
+                                                  rcbRef.c_str ());
+
+        std::lock_guard<std::mutex> reportLock (m_reportLock);
+        m_reportSequences.erase (rcbRef);
+    }
+
+    /* the buffer of an RCB reporting another dataset cannot be resumed */
+    for (const auto& rcbRef : diff.changedRcbs)
+    {
+        auto newRs = newConfig->getReportSubscriptions ().at (rcbRef);
+        auto oldRs = oldConfig->getReportSubscriptions ().find (rcbRef);
+
+        if (store
+            && (oldRs == oldConfig->getReportSubscriptions ().end ()
+                || oldRs->second->datasetRef != newRs->datasetRef
+                || diff.changedDatasets.count (newRs->datasetRef)))
+            store->clear (rcbRef);
+    }
+
+    if (!m_config->keepDatasets ())
+    {
+        for (const auto& datasetRef : diff.removedDatasets)
         {
-            LinkedList dataSetDirectory = entry->second;
-            LinkedList_destroy (dataSetDirectory);
-            delete entry;
+            if (oldConfig->getDatasets ().at (datasetRef)->dynamic)
+                deletedDatasets.push_back (datasetRef);
+        }
+    }
+
+    m_config = newConfig;
+
+    bool changed = diff.exchangeChanged || !diff.changedRcbs.empty ()
+                   || !diff.changedDatasets.empty () || !disabledRcbs.empty ()
+                   || !deletedDatasets.empty ();
+
+    if (m_connectionState == CON_STATE_CONNECTED && changed)
+    {
+        Iec61850Utility::log_info ("Apply new configuration to %s:%d",
+                                   m_serverIp.c_str (), m_tcpPort);
+
+        m_startBringUp (std::make_shared<IEC61850ConfigDiff> (diff),
+                        disabledRcbs, deletedDatasets);
+        m_connectionState = CON_STATE_BRINGUP;
+    }
+}
+
+void
+IEC61850ClientConnection::m_releaseBringUp ()
+{
+    m_pipeline->abort ();
+
+    for (const auto& rcb : m_rcbBringUps)
+    {
+        if (rcb->rcb)
+            ClientReportControlBlock_destroy (rcb->rcb);
+        if (rcb->directory)
+            LinkedList_destroy (rcb->directory);
+        rcb->rcb = nullptr;
+        rcb->directory = nullptr;
+    }
+
+    m_rcbBringUps.clear ();
+    m_pendingDatasets.clear ();
+    m_pendingSpecs = 0;
+}
+
+void
+IEC61850ClientConnection::m_finishBringUp ()
+{
+    m_releaseBringUp ();
+
+    if (m_modelCache)
+        m_modelCache->save ();
+
+    Iec61850Utility::log_info ("%s %s:%d (bring-up %lu ms)",
+                               m_bringUpDiff ? "Reconfigured" : "Connected to",
+                               m_serverIp.c_str (), m_tcpPort,
+                               (unsigned long)(getMonotonicTimeInMs ()
+                                               - m_bringUpStartTime));
+
+    m_bringUpDiff = nullptr;
+
+    /* monitoring is up, the requests left run in the background */
+    if (m_config->controlObjects () == CONTROLS_PREWARM)
+        m_initialiseControlObjects ();
+}
+
+void
+IEC61850ClientConnection::Start ()
+{
+    if (!m_started)
+    {
+        m_started = true;
+
+        if (m_reactor)
+        {
+            m_reactorTask = m_reactor->addTask (
+                [this] () { return tick (); }, 0, m_client);
+        }
+        else
+        {
+            m_conThread = new std::thread (
+                &IEC61850ClientConnection::_conThread, this);
         }
-        m_connDataSetDirectoryPairs.clear ();
     }
+}
 
+void
+IEC61850ClientConnection::m_disableReports ()
+{
     for(const auto &dataset: m_config->getDatasets()){
-        if(dataset.second->dynamic){
+        /* kept datasets are reused on the next connection */
+        if(dataset.second->dynamic && !m_config->keepDatasets()){
             for(const auto &rcb : m_config->getReportSubscriptions()){
                 if(rcb.second->datasetRef == dataset.second->datasetRef){
                     IedClientError error = IED_ERROR_OK;
@@ -698,57 +1897,213 @@ IEC61850ClientConnection::cleanUp ()
             }
             ClientReportControlBlock_destroy(block);
         }
-    }   
+    }
+}
 
-    if (!m_controlObjects.empty ())
+void
+IEC61850ClientConnection::m_startClosing ()
+{
+    m_releaseBringUp ();
+
+    /* dynamic datasets are detached from their RCBs and deleted after */
+    std::vector<std::string> deletedDatasets;
+
+    if (!m_config->keepDatasets ())
     {
-        for (auto& co : m_controlObjects)
+        for (const auto& dataset : m_config->getDatasets ())
         {
-            ControlObjectStruct* cos = co.second;
-            if (cos)
+            if (!dataset.second->dynamic)
+                continue;
+
+            for (const auto& rcb : m_config->getReportSubscriptions ())
             {
-                if (cos->client)
+                if (rcb.second->datasetRef == dataset.second->datasetRef)
                 {
-                    if (cos->client)
-                        ControlObjectClient_destroy (cos->client);
-                    cos->client = nullptr;
+                    deletedDatasets.push_back (dataset.second->datasetRef);
+                    break;
                 }
-                if (cos->value)
+            }
+        }
+    }
+
+    auto deleteDatasets = [this, deletedDatasets] () {
+        for (const auto& datasetRef : deletedDatasets)
+        {
+            m_pipeline->submit (
+                [this, datasetRef] (IedClientError* err, void* parameter) {
+                    return IedConnection_deleteDataSetAsync (
+                        m_connection, err, datasetRef.c_str (),
+                        IEC61850AsyncPipeline::genericHandler, parameter);
+                },
+                [this, datasetRef] (IEC61850AsyncResult& result) {
+                    if (result.err != IED_ERROR_OK)
+                        m_client->logIedClientError (
+                            result.err, "Delete dynamic dataset " + datasetRef);
+                });
+        }
+    };
+
+    const auto& rcbs = m_config->getReportSubscriptions ();
+
+    if (rcbs.empty ())
+    {
+        deleteDatasets ();
+        return;
+    }
+
+    auto pending = std::make_shared<int> ((int)rcbs.size ());
+
+    for (const auto& entry : rcbs)
+    {
+        std::string rcbRef = entry.second->rcbRef;
+        bool detach = std::find (deletedDatasets.begin (),
+                                 deletedDatasets.end (),
+                                 entry.second->datasetRef)
+                      != deletedDatasets.end ();
+
+        m_pipeline->submit (
+            [this, rcbRef, detach] (IedClientError* err, void* parameter) {
+                ClientReportControlBlock rcb
+                    = ClientReportControlBlock_create (rcbRef.c_str ());
+                ClientReportControlBlock_setRptEna (rcb, false);
+
+                uint32_t parametersMask = RCB_ELEMENT_RPT_ENA;
+
+                if (detach)
                 {
-                    MmsValue_delete (cos->value);
-                    cos->value = nullptr;
+                    ClientReportControlBlock_setDataSetReference (rcb, "");
+                    parametersMask |= RCB_ELEMENT_DATSET;
                 }
-                delete cos;
-            }
+
+                uint32_t invokeId = IedConnection_setRCBValuesAsync (
+                    m_connection, err, rcb, parametersMask, true,
+                    IEC61850AsyncPipeline::genericHandler, parameter);
+
+                ClientReportControlBlock_destroy (rcb);
+
+                return invokeId;
+            },
+            [this, rcbRef, pending,
+             deleteDatasets] (IEC61850AsyncResult& result) {
+                if (result.err != IED_ERROR_OK)
+                    m_client->logIedClientError (result.err,
+                                                 "Disable RCB " + rcbRef);
+                else
+                    Iec61850Utility::log_debug ("Disabled RCB %s",
+                                                rcbRef.c_str ());
+
+                if (--(*pending) > 0)
+                    return;
+
+                deleteDatasets ();
+            });
+    }
+}
+
+void
+IEC61850ClientConnection::cleanUp ()
+{
+    m_releaseBringUp ();
+
+    /* batches cut short, only settings already in effect are reported as
+     * written */
+    for (const auto& batch : m_settingBatches)
+    {
+        Iec61850Utility::log_warn ("Writing settings %s interrupted",
+                                   batch->identifier ().c_str ());
+
+        if (batch->settingGroup () == 0)
+        {
+            for (auto& setting : batch->settings)
+                setting.written = setting.accepted;
         }
-        m_controlObjects.clear ();
+
+        m_client->sendSettingBatchAck (*batch);
     }
 
-    
-    if (!m_connControlPairs.empty ())
+    m_settingBatches.clear ();
+    m_bringUpDiff = nullptr;
+    m_giScheduler->clear ();
+
+    if (!m_connDataSetDirectoryPairs.empty ())
     {
-        for (auto& cc : m_connControlPairs)
+        for (const auto& entry : m_connDataSetDirectoryPairs)
         {
-            delete cc;
+            LinkedList dataSetDirectory = entry->second;
+            LinkedList_destroy (dataSetDirectory);
+            delete entry;
         }
-        m_connControlPairs.clear ();
+        m_connDataSetDirectoryPairs.clear ();
     }
 
+    /* requests issued by m_startClosing are dropped with the pipeline */
+    if (m_connectionState != CON_STATE_CLOSING)
+        m_disableReports ();
+
+    /* commands waiting for their object are rejected */
+    std::unordered_map<std::string,
+                       std::vector<std::function<void (ControlObjectStruct*)> > >
+        pendingControls;
+    pendingControls.swap (m_pendingControls);
+
+    for (const auto& entry : pendingControls)
+    {
+        for (const auto& waiter : entry.second)
+            waiter (nullptr);
+    }
+
+    std::vector<LazyCommand> lazyCommands;
+    std::vector<ControlObjectStruct*> controlObjects;
+
+    {
+        std::lock_guard<std::mutex> lock (m_controlLock);
+        lazyCommands.swap (m_lazyCommands);
+        controlObjects.swap (m_retiredControls);
+
+        for (const auto& entry : m_controlObjects)
+            controlObjects.push_back (entry.second);
+        m_controlObjects.clear ();
+    }
+
+    for (const auto& command : lazyCommands)
+        m_rejectCommand (command.objRef, command.commandId);
+
+    for (auto cos : controlObjects)
+        m_abortControl (cos, cos->commandId);
+
+    m_commandTimers->clear ();
+
     IedClientError err;
 
     if (m_connection)
     {
         IedConnection_close (m_connection);
         IedConnection_abortAsync (m_connection, &err);
+    }
+
+    /* the clients are unregistered from the connection, the contexts of
+     * the objects are used by its callbacks until it is destroyed */
+    for (auto cos : controlObjects)
+    {
+        if (cos->client)
+            ControlObjectClient_destroy (cos->client);
+        cos->client = nullptr;
+    }
+
+    if (m_connection)
+    {
         IedConnection_destroy (m_connection);
         m_connection = nullptr;
+
+        m_pipeline->releaseOrphans ();
     }
 
-    if (m_tlsConfig != nullptr)
+    for (auto cos : controlObjects)
     {
-        TLSConfiguration_destroy (m_tlsConfig);
+        if (cos->value)
+            MmsValue_delete (cos->value);
+        delete cos;
     }
-    m_tlsConfig = nullptr;
 }
 
 void
@@ -767,186 +2122,285 @@ IEC61850ClientConnection::Stop ()
         delete m_conThread;
         m_conThread = nullptr;
     }
+
+    if (m_reactorTask != -1)
+    {
+        m_reactor->removeTask (m_reactorTask);
+        m_reactorTask = -1;
+
+        std::lock_guard<std::mutex> lock (m_conLock);
+        cleanUp ();
+    }
 }
 
-bool
-IEC61850ClientConnection::prepareConnection ()
+static std::string
+certificateFile (const std::string& certificate)
 {
-    if (UseTLS ())
+    bool isPem = certificate.size () >= 4
+                 && certificate.rfind (".pem") == certificate.size () - 4;
+
+    return getDataDir ()
+           + std::string (isPem ? "/etc/certs/pem/" : "/etc/certs/")
+           + certificate;
+}
+
+/* identifies the TLS material by file name, modification time and size */
+std::string
+IEC61850ClientConnection::m_tlsSignature ()
+{
+    std::vector<std::string> files;
+
+    files.push_back (getDataDir () + std::string ("/etc/certs/")
+                     + m_config->GetPrivateKey ());
+    files.push_back (certificateFile (m_config->GetOwnCertificate ()));
+
+    for (const std::string& cert : m_config->GetRemoteCertificates ())
+        files.push_back (certificateFile (cert));
+
+    for (const std::string& cert : m_config->GetCaCertificates ())
+        files.push_back (certificateFile (cert));
+
+    std::string signature = std::to_string (m_config->tlsRenegotiationTime ())
+                            + ";"
+                            + std::to_string (
+                                m_config->tlsSessionResumptionInterval ());
+
+    for (const std::string& file : files)
+    {
+        struct stat fileStat;
+
+        signature += ";" + file;
+
+        if (stat (file.c_str (), &fileStat) == 0)
+        {
+            signature += ":" + std::to_string ((long long)fileStat.st_mtime)
+                         + ":"
+                         + std::to_string ((long long)fileStat.st_mtim.tv_nsec)
+                         + ":" + std::to_string ((long long)fileStat.st_size);
+        }
+    }
+
+    return signature;
+}
+
+TLSConfiguration
+IEC61850ClientConnection::m_createTlsConfig ()
+{
+    TLSConfiguration tlsConfig = TLSConfiguration_create ();
+
+    bool tlsConfigOk = true;
+
+    std::string certificateStore
+        = getDataDir () + std::string ("/etc/certs/");
+    std::string certificateStorePem
+        = getDataDir () + std::string ("/etc/certs/pem/");
+
+    if (m_config->GetOwnCertificate ().length () == 0
+        || m_config->GetPrivateKey ().length () == 0)
+    {
+        Iec61850Utility::log_error (
+            "No private key and/or certificate configured for client");
+        tlsConfigOk = false;
+    }
+    else
     {
-        TLSConfiguration tlsConfig = TLSConfiguration_create ();
-
-        bool tlsConfigOk = true;
+        std::string privateKeyFile
+            = certificateStore + m_config->GetPrivateKey ();
 
-        std::string certificateStore
-            = getDataDir () + std::string ("/etc/certs/");
-        std::string certificateStorePem
-            = getDataDir () + std::string ("/etc/certs/pem/");
-
-        if (m_config->GetOwnCertificate ().length () == 0
-            || m_config->GetPrivateKey ().length () == 0)
-        {
-            Iec61850Utility::log_error (
-                "No private key and/or certificate configured for client");
-            tlsConfigOk = false;
-        }
-        else
+        if (access (privateKeyFile.c_str (), R_OK) == 0)
         {
-            std::string privateKeyFile
-                = certificateStore + m_config->GetPrivateKey ();
-
-            if (access (privateKeyFile.c_str (), R_OK) == 0)
-            {
-                if (TLSConfiguration_setOwnKeyFromFile (
-                        tlsConfig, privateKeyFile.c_str (), nullptr)
-                    == false)
-                {
-                    Iec61850Utility::log_error (
-                        "Failed to load private key file: %s",
-                        privateKeyFile.c_str ());
-                    tlsConfigOk = false;
-                }
-            }
-            else
+            if (TLSConfiguration_setOwnKeyFromFile (
+                    tlsConfig, privateKeyFile.c_str (), nullptr)
+                == false)
             {
                 Iec61850Utility::log_error (
-                    "Failed to access private key file: %s",
+                    "Failed to load private key file: %s",
                     privateKeyFile.c_str ());
                 tlsConfigOk = false;
             }
+        }
+        else
+        {
+            Iec61850Utility::log_error (
+                "Failed to access private key file: %s",
+                privateKeyFile.c_str ());
+            tlsConfigOk = false;
+        }
 
-            std::string clientCert = m_config->GetOwnCertificate ();
-            bool isPemClientCertificate
-                = clientCert.rfind (".pem") == clientCert.size () - 4;
+        std::string clientCert = m_config->GetOwnCertificate ();
+        bool isPemClientCertificate
+            = clientCert.rfind (".pem") == clientCert.size () - 4;
 
-            std::string clientCertFile;
+        std::string clientCertFile;
 
-            if (isPemClientCertificate)
-                clientCertFile = certificateStorePem + clientCert;
-            else
-                clientCertFile = certificateStore + clientCert;
+        if (isPemClientCertificate)
+            clientCertFile = certificateStorePem + clientCert;
+        else
+            clientCertFile = certificateStore + clientCert;
 
-            if (access (clientCertFile.c_str (), R_OK) == 0)
-            {
-                if (TLSConfiguration_setOwnCertificateFromFile (
-                        tlsConfig, clientCertFile.c_str ())
-                    == false)
-                {
-                    Iec61850Utility::log_error (
-                        "Failed to load client certificate file: %s",
-                        clientCertFile.c_str ());
-                    tlsConfigOk = false;
-                }
-            }
-            else
+        if (access (clientCertFile.c_str (), R_OK) == 0)
+        {
+            if (TLSConfiguration_setOwnCertificateFromFile (
+                    tlsConfig, clientCertFile.c_str ())
+                == false)
             {
                 Iec61850Utility::log_error (
-                    "Failed to access client certificate file: %s",
+                    "Failed to load client certificate file: %s",
                     clientCertFile.c_str ());
                 tlsConfigOk = false;
             }
         }
-
-        if (!m_config->GetRemoteCertificates ().empty ())
+        else
         {
-            TLSConfiguration_setAllowOnlyKnownCertificates (tlsConfig, true);
+            Iec61850Utility::log_error (
+                "Failed to access client certificate file: %s",
+                clientCertFile.c_str ());
+            tlsConfigOk = false;
+        }
+    }
 
-            for (const std::string& remoteCert :
-                 m_config->GetRemoteCertificates ())
-            {
-                bool isPemRemoteCertificate
-                    = remoteCert.rfind (".pem") == remoteCert.size () - 4;
+    if (!m_config->GetRemoteCertificates ().empty ())
+    {
+        TLSConfiguration_setAllowOnlyKnownCertificates (tlsConfig, true);
 
-                std::string remoteCertFile;
+        for (const std::string& remoteCert :
+             m_config->GetRemoteCertificates ())
+        {
+            bool isPemRemoteCertificate
+                = remoteCert.rfind (".pem") == remoteCert.size () - 4;
 
-                if (isPemRemoteCertificate)
-                    remoteCertFile = certificateStorePem + remoteCert;
-                else
-                    remoteCertFile = certificateStore + remoteCert;
+            std::string remoteCertFile;
 
-                if (access (remoteCertFile.c_str (), R_OK) == 0)
-                {
-                    if (TLSConfiguration_addAllowedCertificateFromFile (
-                            tlsConfig, remoteCertFile.c_str ())
-                        == false)
-                    {
-                        Iec61850Utility::log_warn (
-                            "Failed to load remote certificate file: %s -> "
-                            "ignore certificate",
-                            remoteCertFile.c_str ());
-                    }
-                }
-                else
+            if (isPemRemoteCertificate)
+                remoteCertFile = certificateStorePem + remoteCert;
+            else
+                remoteCertFile = certificateStore + remoteCert;
+
+            if (access (remoteCertFile.c_str (), R_OK) == 0)
+            {
+                if (TLSConfiguration_addAllowedCertificateFromFile (
+                        tlsConfig, remoteCertFile.c_str ())
+                    == false)
                 {
                     Iec61850Utility::log_warn (
-                        "Failed to access remote certificate file: %s -> "
+                        "Failed to load remote certificate file: %s -> "
                         "ignore certificate",
                         remoteCertFile.c_str ());
                 }
             }
+            else
+            {
+                Iec61850Utility::log_warn (
+                    "Failed to access remote certificate file: %s -> "
+                    "ignore certificate",
+                    remoteCertFile.c_str ());
+            }
         }
-        else
-        {
-            TLSConfiguration_setAllowOnlyKnownCertificates (tlsConfig, false);
-        }
+    }
+    else
+    {
+        TLSConfiguration_setAllowOnlyKnownCertificates (tlsConfig, false);
+    }
 
-        if (m_config->GetCaCertificates ().size () > 0)
-        {
-            TLSConfiguration_setChainValidation (tlsConfig, true);
+    if (m_config->GetCaCertificates ().size () > 0)
+    {
+        TLSConfiguration_setChainValidation (tlsConfig, true);
 
-            for (const std::string& caCert : m_config->GetCaCertificates ())
-            {
-                bool isPemCaCertificate
-                    = caCert.rfind (".pem") == caCert.size () - 4;
+        for (const std::string& caCert : m_config->GetCaCertificates ())
+        {
+            bool isPemCaCertificate
+                = caCert.rfind (".pem") == caCert.size () - 4;
 
-                std::string caCertFile;
+            std::string caCertFile;
 
-                if (isPemCaCertificate)
-                    caCertFile = certificateStorePem + caCert;
-                else
-                    caCertFile = certificateStore + caCert;
+            if (isPemCaCertificate)
+                caCertFile = certificateStorePem + caCert;
+            else
+                caCertFile = certificateStore + caCert;
 
-                if (access (caCertFile.c_str (), R_OK) == 0)
-                {
-                    if (TLSConfiguration_addCACertificateFromFile (
-                            tlsConfig, caCertFile.c_str ())
-                        == false)
-                    {
-                        Iec61850Utility::log_warn (
-                            "Failed to load CA certificate file: %s -> ignore "
-                            "certificate",
-                            caCertFile.c_str ());
-                    }
-                }
-                else
+            if (access (caCertFile.c_str (), R_OK) == 0)
+            {
+                if (TLSConfiguration_addCACertificateFromFile (
+                        tlsConfig, caCertFile.c_str ())
+                    == false)
                 {
                     Iec61850Utility::log_warn (
-                        "Failed to access CA certificate file: %s -> ignore "
+                        "Failed to load CA certificate file: %s -> ignore "
                         "certificate",
                         caCertFile.c_str ());
                 }
             }
+            else
+            {
+                Iec61850Utility::log_warn (
+                    "Failed to access CA certificate file: %s -> ignore "
+                    "certificate",
+                    caCertFile.c_str ());
+            }
         }
-        else
+    }
+    else
+    {
+        TLSConfiguration_setChainValidation (tlsConfig, false);
+    }
+
+    if (!tlsConfigOk)
+    {
+        TLSConfiguration_destroy (tlsConfig);
+        return nullptr;
+    }
+
+    TLSConfiguration_setRenegotiationTime (
+        tlsConfig, m_config->tlsRenegotiationTime () > 0
+                       ? m_config->tlsRenegotiationTime ()
+                       : -1);
+
+    /* the sessions are kept in the configuration reused on reconnect */
+    if (m_config->tlsSessionResumptionInterval () > 0)
+    {
+        TLSConfiguration_enableSessionResumption (tlsConfig, true);
+        TLSConfiguration_setSessionResumptionInterval (
+            tlsConfig, m_config->tlsSessionResumptionInterval ());
+    }
+    else
+    {
+        TLSConfiguration_enableSessionResumption (tlsConfig, false);
+    }
+
+    return tlsConfig;
+}
+
+bool
+IEC61850ClientConnection::prepareConnection ()
+{
+    if (UseTLS ())
+    {
+        /* the parsed TLS material is kept until a file changes */
+        std::string tlsSignature = m_tlsSignature ();
+
+        if (m_tlsConfig && tlsSignature != m_tlsConfigSignature)
         {
-            TLSConfiguration_setChainValidation (tlsConfig, false);
+            Iec61850Utility::log_info (
+                "TLS material changed -> reload TLS configuration");
+
+            TLSConfiguration_destroy (m_tlsConfig);
+            m_tlsConfig = nullptr;
         }
 
-        if (tlsConfigOk)
+        if (!m_tlsConfig)
         {
+            m_tlsConfig = m_createTlsConfig ();
+            m_tlsConfigSignature = tlsSignature;
+        }
 
-            TLSConfiguration_setRenegotiationTime (tlsConfig, 60000);
-
-            m_connection = IedConnection_createWithTlsSupport (tlsConfig);
+        if (m_tlsConfig)
+        {
+            m_connection
+                = IedConnection_createEx (m_tlsConfig, m_reactor == nullptr);
 
-            if (m_connection)
-            {
-                m_tlsConfig = tlsConfig;
-            }
-            else
+            if (!m_connection)
             {
                 printf ("TLS configuration failed\n");
-                TLSConfiguration_destroy (tlsConfig);
             }
         }
         else
@@ -957,7 +2411,7 @@ IEC61850ClientConnection::prepareConnection ()
     }
     else
     {
-        m_connection = IedConnection_create ();
+        m_connection = IedConnection_createEx (nullptr, m_reactor == nullptr);
     }
 
     return m_connection != nullptr;
@@ -969,6 +2423,18 @@ IEC61850ClientConnection::Disconnect ()
     m_connecting = false;
     m_connected = false;
     m_connect = false;
+
+    /* the reactor worker is shared with other IEDs, the association is
+     * closed by the state machine once the reports are disabled */
+    if (m_reactor && m_connectionState != CON_STATE_CLOSING && m_connection
+        && IedConnection_getState (m_connection) == IED_STATE_CONNECTED)
+    {
+        m_startClosing ();
+        m_delayExpirationTime = getMonotonicTimeInMs () + 10000;
+        m_connectionState = CON_STATE_CLOSING;
+        return;
+    }
+
     m_connectionState = CON_STATE_IDLE;
     cleanUp ();
 }
@@ -1020,70 +2486,345 @@ IEC61850ClientConnection::controlActionHandler (uint32_t invokeId,
                                                 ControlActionType type,
                                                 bool success)
 {
-    if (success)
+    auto context = (ControlContext*)parameter;
+    ControlObjectStruct* cos = context->cos;
+    IEC61850Client* client = context->connection->m_client;
+
+    client->enterCallback ();
+    handleControlAction (context, type, success);
+    client->leaveCallback ();
+
+    /* last access, a retired object may be destroyed from now on */
+    cos->requests--;
+}
+
+void
+IEC61850ClientConnection::handleControlAction (ControlContext* context,
+                                               ControlActionType type,
+                                               bool success)
+{
+    ControlObjectStruct* cos = context->cos;
+
+    IEC61850ClientConnection* connection = context->connection;
+
+    /* e.g. the command timed out and the object took a new one */
+    if (context->commandId != cos->commandId)
+    {
+        Iec61850Utility::log_warn (
+            "Response to a previous command on %s -> ignored",
+            cos->label.c_str ());
+        return;
+    }
+
+    if (!success)
+    {
+        Iec61850Utility::log_error (
+            "Control action %d on %s failed", type,
+            ControlObjectClient_getObjectReference (cos->client));
+        connection->m_abortControl (cos, context->commandId);
+        return;
+    }
+
+    switch (type)
+    {
+    case CONTROL_ACTION_TYPE_OPERATE: {
+        if (cos->mode == CONTROL_MODEL_SBO_ENHANCED
+            || cos->mode == CONTROL_MODEL_DIRECT_ENHANCED)
+        {
+            connection->sendActCon (cos);
+            connection->m_superviseControl (cos, CONTROL_WAIT_FOR_ACT_TERM);
+        }
+        else
+        {
+            connection->m_completeControl (cos, false);
+        }
+        break;
+    }
+    case CONTROL_ACTION_TYPE_SELECT: {
+        /* operate right away, not on the next tick of the connection */
+        IedClientError error;
+        connection->m_superviseControl (cos, CONTROL_WAIT_FOR_ACT_CON);
+        cos->requests++;
+        ControlObjectClient_operateAsync (cos->client, &error, cos->value,
+                                          0, controlActionHandler, context);
+        if (error != IED_ERROR_OK)
+        {
+            cos->requests--;
+            connection->m_client->logIedClientError (
+                error, "Operate after select");
+            connection->m_abortControl (cos, context->commandId);
+        }
+        break;
+    }
+    case CONTROL_ACTION_TYPE_CANCEL: {
+        break;
+    }
+    }
+}
+
+void
+IEC61850ClientConnection::executePeriodicTasks ()
+{
+    uint64_t currentTime = getMonotonicTimeInMs ();
+    if (m_config->getPollingInterval () > 0
+        && currentTime >= m_nextPollingTime)
     {
-        auto connectionCosPair
-            = (std::pair<IEC61850ClientConnection*, ControlObjectStruct*>*)
-                parameter;
+        m_client->handleAllValues ();
+        m_nextPollingTime = currentTime + m_config->getPollingInterval ();
+    }
+
+    m_checkCommandTimeouts ();
+    m_createLazyControls ();
+    m_destroyRetiredControls ();
+}
+
+void
+IEC61850ClientConnection::m_destroyRetiredControls ()
+{
+    std::vector<ControlObjectStruct*> idle;
 
-        ControlObjectStruct* cos = connectionCosPair->second;
+    {
+        std::lock_guard<std::mutex> lock (m_controlLock);
 
-        IEC61850ClientConnection* connection = connectionCosPair->first;
-        switch (type)
+        for (auto it = m_retiredControls.begin ();
+             it != m_retiredControls.end ();)
         {
-        case CONTROL_ACTION_TYPE_OPERATE: {
-            if (cos->mode == CONTROL_MODEL_SBO_ENHANCED
-                || cos->mode == CONTROL_MODEL_DIRECT_ENHANCED)
+            if ((*it)->requests > 0)
             {
-                cos->state = CONTROL_WAIT_FOR_ACT_TERM;
+                it++;
+                continue;
             }
-            else
+
+            idle.push_back (*it);
+            it = m_retiredControls.erase (it);
+        }
+    }
+
+    for (auto cos : idle)
+    {
+        if (cos->client)
+            ControlObjectClient_destroy (cos->client);
+        if (cos->value)
+            MmsValue_delete (cos->value);
+        delete cos;
+    }
+}
+
+void
+IEC61850ClientConnection::m_checkCommandTimeouts ()
+{
+    std::vector<IEC61850TimerWheel::Timer> expired
+        = m_commandTimers->expire (getMonotonicTimeInMs ());
+
+    for (const auto& timer : expired)
+    {
+        for (const auto& entry : m_controlObjects)
+        {
+            ControlObjectStruct* cos = entry.second;
+
+            if (cos->commandId != timer.key)
+                continue;
+
+            /* a completion racing with the deadline wins */
+            if (cos->state == timer.tag && m_abortControl (cos, timer.key))
             {
-                cos->state = CONTROL_IDLE;
+                Iec61850Utility::log_warn (
+                    "Command on %s timed out in state %d -> negative "
+                    "acknowledgement",
+                    entry.first.c_str (), timer.tag);
             }
-            connection->sendActCon (cos);
             break;
         }
-        case CONTROL_ACTION_TYPE_SELECT: {
-            cos->state = CONTROL_SELECTED;
+    }
+}
+
+void
+IEC61850ClientConnection::handleConnectionState ()
+{
+    if (m_connectionState == CON_STATE_CLOSING)
+    {
+        std::lock_guard<std::mutex> lock (m_conLock);
+
+        if (IedConnection_getState (m_connection) != IED_STATE_CONNECTED
+            || !m_pipeline->poll ()
+            || getMonotonicTimeInMs () > m_delayExpirationTime)
+        {
+            cleanUp ();
+            m_connectionState = CON_STATE_IDLE;
+        }
+        return;
+    }
+
+    if (m_connect)
+    {
+        IedConnectionState newState;
+        switch (m_connectionState)
+        {
+        case CON_STATE_IDLE:
+
+        {
+
+            if (m_connection != nullptr)
+            {
+                {
+                    std::lock_guard<std::mutex> lock (m_conLock);
+                    IedConnection_destroy (m_connection);
+                    m_connection = nullptr;
+                    m_pipeline->releaseOrphans ();
+                }
+            }
+
+            if (prepareConnection ())
+            {
+                IedClientError error;
+                {
+                    std::lock_guard<std::mutex> lock (m_conLock);
+                    m_connectionState = CON_STATE_CONNECTING;
+                    m_connecting = true;
+                    m_connectStartTime = getMonotonicTimeInMs ();
+                    m_timeToFirstReport = 0;
+                    m_delayExpirationTime
+                        = getMonotonicTimeInMs () + 10000;
+                    if (m_osiParameters)
+                        m_setOsiConnectionParameters ();
+                }
+
+                IedConnection_connectAsync (m_connection, &error,
+                                            m_serverIp.c_str (),
+                                            m_tcpPort);
+                if (error == IED_ERROR_OK)
+                {
+                    Iec61850Utility::log_info (
+                        "Connecting to %s:%d", m_serverIp.c_str (),
+                        m_tcpPort);
+                }
+                else
+                {
+                    Iec61850Utility::log_error (
+                        "Failed to connect to %s:%d",
+                        m_serverIp.c_str (), m_tcpPort);
+                    {
+                        std::lock_guard<std::mutex> lock (
+                            m_conLock);
+                        m_connectionState = CON_STATE_FATAL_ERROR;
+                    }
+                }
+            }
+            else
+            {
+                {
+                    std::lock_guard<std::mutex> lock (m_conLock);
+                    m_connectionState = CON_STATE_FATAL_ERROR;
+                }
+                Iec61850Utility::log_error (
+                    "Fatal configuration error");
+            }
+        }
+        break;
+
+        case CON_STATE_CONNECTING:
+            newState = IedConnection_getState (m_connection);
+            if (newState == IED_STATE_CONNECTED)
+            {
+                std::lock_guard<std::mutex> lock (m_conLock);
+                m_startBringUp ();
+                m_connectionState = CON_STATE_BRINGUP;
+            }
+            else if (getMonotonicTimeInMs ()
+                     > m_delayExpirationTime)
+            {
+                std::lock_guard<std::mutex> lock (m_conLock);
+                Iec61850Utility::log_warn (
+                    "Timeout while connecting %d", m_tcpPort);
+                Disconnect ();
+            }
             break;
+
+        case CON_STATE_BRINGUP: {
+            std::lock_guard<std::mutex> lock (m_conLock);
+            newState = IedConnection_getState (m_connection);
+            if (newState != IED_STATE_CONNECTED)
+            {
+                Iec61850Utility::log_warn (
+                    "Connection to %s:%d lost during bring-up",
+                    m_serverIp.c_str (), m_tcpPort);
+                cleanUp ();
+                m_connectionState = CON_STATE_IDLE;
+            }
+            else if (!m_pipeline->poll ())
+            {
+                m_finishBringUp ();
+                m_connectionState = CON_STATE_CONNECTED;
+                m_connecting = false;
+                m_connected = true;
+            }
+        }
+        break;
+
+        case CON_STATE_CONNECTED: {
+            std::lock_guard<std::mutex> lock (m_conLock);
+            newState = IedConnection_getState (m_connection);
+            if (newState != IED_STATE_CONNECTED)
+            {
+                cleanUp ();
+                m_connectionState = CON_STATE_IDLE;
+            }
+            else
+            {
+                executePeriodicTasks ();
+                m_resyncRcbs ();
+                m_sendGis ();
+            }
+        }
+        break;
+
+        case CON_STATE_CLOSED: {
+            std::lock_guard<std::mutex> lock (m_conLock);
+            m_delayExpirationTime
+                = getMonotonicTimeInMs () + 10000;
+            m_connectionState = CON_STATE_WAIT_FOR_RECONNECT;
+        }
+        break;
+
+        case CON_STATE_WAIT_FOR_RECONNECT: {
+            std::lock_guard<std::mutex> lock (m_conLock);
+            if (getMonotonicTimeInMs () >= m_delayExpirationTime)
+            {
+                m_connectionState = CON_STATE_IDLE;
+            }
         }
-        case CONTROL_ACTION_TYPE_CANCEL: {
+        break;
+
+        case CON_STATE_CLOSING:
+        case CON_STATE_FATAL_ERROR:
             break;
         }
-        }
     }
 }
 
-void
-IEC61850ClientConnection::executePeriodicTasks ()
+bool
+IEC61850ClientConnection::tick ()
 {
-    uint64_t currentTime = getMonotonicTimeInMs ();
-    if (m_config->getPollingInterval () > 0
-        && currentTime >= m_nextPollingTime)
+    if (!m_started)
+        return false;
+
+    try
     {
-        m_client->handleAllValues ();
-        m_nextPollingTime = currentTime + m_config->getPollingInterval ();
+        handleConnectionState ();
     }
-
-    for (const auto& co : m_controlObjects)
+    // LCOV_EXCL_START
+    catch (const std::exception& e)
     {
-        ControlObjectStruct* cos = co.second;
+        Iec61850Utility::log_error ("Exception caught in tick: %s",
+                                    e.what ());
+    }
+    // LCOV_EXCL_STOP
 
-        auto pair = std::make_shared<
-            std::pair<IEC61850ClientConnection*, ControlObjectStruct*> > (this,
-                                                                          cos);
+    if (m_connection == nullptr)
+        return false;
 
-        if (cos->state == CONTROL_IDLE)
-            continue;
-        else if (cos->state == CONTROL_SELECTED)
-        {
-            IedClientError error;
-            ControlObjectClient_operateAsync (cos->client, &error, cos->value,
-                                              0, controlActionHandler,
-                                              pair.get ());
-        }
-    }
+    /* reactor task and state machine share the worker -> no lock needed */
+    return !IedConnection_tick (m_connection);
 }
 
 void
@@ -1093,139 +2834,10 @@ IEC61850ClientConnection::_conThread ()
     {
         while (m_started)
         {
-            {
-                if (m_connect)
-                {
-                    IedConnectionState newState;
-                    switch (m_connectionState)
-                    {
-                    case CON_STATE_IDLE:
-
-                    {
-
-                        if (m_connection != nullptr)
-                        {
-                            {
-                                std::lock_guard<std::mutex> lock (m_conLock);
-                                IedConnection_destroy (m_connection);
-                                m_connection = nullptr;
-                            }
-                        }
-
-                        if (prepareConnection ())
-                        {
-                            IedClientError error;
-                            {
-                                std::lock_guard<std::mutex> lock (m_conLock);
-                                m_connectionState = CON_STATE_CONNECTING;
-                                m_connecting = true;
-                                m_delayExpirationTime
-                                    = getMonotonicTimeInMs () + 10000;
-                                if (m_osiParameters)
-                                    m_setOsiConnectionParameters ();
-                            }
-
-                            IedConnection_connectAsync (m_connection, &error,
-                                                        m_serverIp.c_str (),
-                                                        m_tcpPort);
-                            if (error == IED_ERROR_OK)
-                            {
-                                Iec61850Utility::log_info (
-                                    "Connecting to %s:%d", m_serverIp.c_str (),
-                                    m_tcpPort);
-                            }
-                            else
-                            {
-                                Iec61850Utility::log_error (
-                                    "Failed to connect to %s:%d",
-                                    m_serverIp.c_str (), m_tcpPort);
-                                {
-                                    std::lock_guard<std::mutex> lock (
-                                        m_conLock);
-                                    m_connectionState = CON_STATE_FATAL_ERROR;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            {
-                                std::lock_guard<std::mutex> lock (m_conLock);
-                                m_connectionState = CON_STATE_FATAL_ERROR;
-                            }
-                            Iec61850Utility::log_error (
-                                "Fatal configuration error");
-                        }
-                    }
-                    break;
-
-                    case CON_STATE_CONNECTING:
-                        newState = IedConnection_getState (m_connection);
-                        if (newState == IED_STATE_CONNECTED)
-                        {
-                            {
-                                std::lock_guard<std::mutex> lock (m_conLock);
-                                m_setVarSpecs ();
-                                m_initialiseControlObjects ();
-                                m_configDatasets ();
-                                m_configRcb ();
-                                Iec61850Utility::log_info (
-                                    "Connected to %s:%d", m_serverIp.c_str (),
-                                    m_tcpPort);
-                                m_connectionState = CON_STATE_CONNECTED;
-                                m_connecting = false;
-                                m_connected = true;
-                                m_client->firstTimeConnect = false;
-                            }
-                        }
-                        else if (getMonotonicTimeInMs ()
-                                 > m_delayExpirationTime)
-                        {
-                            std::lock_guard<std::mutex> lock (m_conLock);
-                            Iec61850Utility::log_warn (
-                                "Timeout while connecting %d", m_tcpPort);
-                            Disconnect ();
-                        }
-                        break;
-
-                    case CON_STATE_CONNECTED: {
-                        std::lock_guard<std::mutex> lock (m_conLock);
-                        newState = IedConnection_getState (m_connection);
-                        if (newState != IED_STATE_CONNECTED)
-                        {
-                            cleanUp ();
-                            m_connectionState = CON_STATE_IDLE;
-                        }
-                        else
-                        {
-                            executePeriodicTasks ();
-                        }
-                    }
-                    break;
-
-                    case CON_STATE_CLOSED: {
-                        std::lock_guard<std::mutex> lock (m_conLock);
-                        m_delayExpirationTime
-                            = getMonotonicTimeInMs () + 10000;
-                        m_connectionState = CON_STATE_WAIT_FOR_RECONNECT;
-                    }
-                    break;
-
-                    case CON_STATE_WAIT_FOR_RECONNECT: {
-                        std::lock_guard<std::mutex> lock (m_conLock);
-                        if (getMonotonicTimeInMs () >= m_delayExpirationTime)
-                        {
-                            m_connectionState = CON_STATE_IDLE;
-                        }
-                    }
-                    break;
-
-                    case CON_STATE_FATAL_ERROR:
-                        break;
-                    }
-                }
-            }
+            handleConnectionState ();
 
-            Thread_sleep (50);
+            /* bring-up completions are processed by this thread */
+            Thread_sleep (m_connectionState == CON_STATE_BRINGUP ? 1 : 50);
         }
         {
             std::lock_guard<std::mutex> lock (m_conLock);
@@ -1243,30 +2855,172 @@ void
 IEC61850ClientConnection::sendActCon (
     const IEC61850ClientConnection::ControlObjectStruct* cos)
 {
-    m_client->sendCommandAck (cos->label, cos->mode, false);
+    uint64_t commandId = cos->commandId;
+
+    /* late response to a command that timed out */
+    if (commandId == IEC61850CommandTracker::NO_COMMAND)
+    {
+        Iec61850Utility::log_warn ("No command in progress on %s -> ActCon "
+                                   "ignored",
+                                   cos->label.c_str ());
+        return;
+    }
+
+    m_client->sendCommandAck (commandId, cos->mode, false);
 }
 
 void
-IEC61850ClientConnection::sendActTerm (
-    const IEC61850ClientConnection::ControlObjectStruct* cos)
+IEC61850ClientConnection::m_completeControl (ControlObjectStruct* cos,
+                                             bool terminated)
+{
+    cos->state = CONTROL_IDLE;
+
+    uint64_t commandId
+        = cos->commandId.exchange (IEC61850CommandTracker::NO_COMMAND);
+
+    /* late response to a command that timed out */
+    if (commandId == IEC61850CommandTracker::NO_COMMAND)
+    {
+        Iec61850Utility::log_warn ("No command in progress on %s -> %s "
+                                   "ignored",
+                                   cos->label.c_str (),
+                                   terminated ? "ActTerm" : "ActCon");
+        return;
+    }
+
+    m_commandTimers->cancel (commandId);
+
+    /* the object is free before the acknowledgement completes the command,
+     * a command of a batch waiting for it may take it right away */
+    m_client->sendCommandAck (commandId, cos->mode, terminated);
+
+    /* whatever became of the acknowledgement */
+    m_client->commandTracker ().remove (commandId);
+}
+
+void
+IEC61850ClientConnection::m_superviseControl (ControlObjectStruct* cos,
+                                              OperationState state)
+{
+    cos->state = state;
+
+    uint64_t commandId = cos->commandId;
+
+    if (commandId == IEC61850CommandTracker::NO_COMMAND)
+        return;
+
+    const CommandTimeouts& timeouts
+        = m_config->commandTimeouts (cos->cdcType);
+    int timeout = 0;
+
+    switch (state)
+    {
+    case CONTROL_WAIT_FOR_SELECT:
+    case CONTROL_WAIT_FOR_SELECT_WITH_VALUE:
+        timeout = timeouts.select;
+        break;
+    case CONTROL_WAIT_FOR_ACT_CON:
+        timeout = timeouts.actCon;
+        break;
+    case CONTROL_WAIT_FOR_ACT_TERM:
+        timeout = timeouts.actTerm;
+        break;
+    default:
+        break;
+    }
+
+    if (timeout > 0)
+        m_commandTimers->schedule (commandId, state,
+                                   getMonotonicTimeInMs () + timeout);
+    else
+        m_commandTimers->cancel (commandId);
+}
+
+bool
+IEC61850ClientConnection::m_abortControl (ControlObjectStruct* cos,
+                                          uint64_t commandId)
 {
-    m_client->sendCommandAck (cos->label, cos->mode, true);
+    if (commandId == IEC61850CommandTracker::NO_COMMAND
+        || !cos->commandId.compare_exchange_strong (
+            commandId, IEC61850CommandTracker::NO_COMMAND))
+        return false;
+
+    OperationState state = cos->state;
+    cos->state = CONTROL_IDLE;
+
+    m_commandTimers->cancel (commandId);
+
+    /* before ActCon the command is rejected, after it not terminated */
+    m_client->sendCommandAck (commandId, cos->mode,
+                              state == CONTROL_WAIT_FOR_ACT_TERM, true);
+
+    /* whatever became of the acknowledgement */
+    m_client->commandTracker ().remove (commandId);
+
+    return true;
 }
 
 bool
 IEC61850ClientConnection::operate (const std::string& objRef,
-                                   DatapointValue value)
+                                   DatapointValue value, uint64_t commandId)
 {
-    auto it = m_controlObjects.find (objRef);
+    ControlObjectStruct* co = nullptr;
 
-    if (it == m_controlObjects.end ())
+    {
+        std::lock_guard<std::mutex> lock (m_controlLock);
+
+        auto it = m_controlObjects.find (objRef);
+
+        if (it != m_controlObjects.end ())
+        {
+            co = it->second;
+
+            /* a reconfiguration retiring the object keeps it meanwhile */
+            co->requests++;
+        }
+        else if (m_config->controlObjects () != CONTROLS_AT_BRINGUP
+                 && m_connected)
+        {
+            /* the connection creates the object, then sends the command */
+            m_lazyCommands.push_back ({ objRef, value, commandId });
+            return true;
+        }
+    }
+
+    if (!co)
     {
         Iec61850Utility::log_error ("Control object with objRef %s not found",
                                     objRef.c_str ());
         return false;
     }
 
-    ControlObjectStruct* co = it->second;
+    bool res = m_operate (co, objRef, value, commandId);
+
+    co->requests--;
+
+    return res;
+}
+
+bool
+IEC61850ClientConnection::m_operate (ControlObjectStruct* co,
+                                     const std::string& objRef,
+                                     DatapointValue value, uint64_t commandId)
+{
+    if (co->mode == CONTROL_MODEL_STATUS_ONLY)
+    {
+        Iec61850Utility::log_warn ("Control object %s is status-only",
+                                   objRef.c_str ());
+        return false;
+    }
+
+    uint64_t idle = IEC61850CommandTracker::NO_COMMAND;
+
+    if (!co->commandId.compare_exchange_strong (idle, commandId))
+    {
+        Iec61850Utility::log_warn (
+            "Command on %s still in progress -> rejected", objRef.c_str ());
+        return false;
+    }
 
     MmsValue* mmsValue = co->value;
 
@@ -1299,46 +3053,57 @@ IEC61850ClientConnection::operate (const std::string& objRef,
         break;
     default:
         Iec61850Utility::log_error ("Invalid mms value type");
+        co->commandId = IEC61850CommandTracker::NO_COMMAND;
         return false;
     }
-    IedClientError error;
+    IedClientError error = IED_ERROR_OK;
 
-    auto connectionControlPair
-        = new std::pair<IEC61850ClientConnection*, ControlObjectStruct*> (this,
-                                                                          co);
-    m_connControlPairs.push_back (connectionControlPair);
+    ControlContext* context
+        = &co->contexts[co->nextContext++ % CONTROL_CONTEXTS];
+    context->commandId = commandId;
+
+    co->requests++;
 
     if (co->mode == CONTROL_MODEL_DIRECT_ENHANCED
         || co->mode == CONTROL_MODEL_SBO_ENHANCED)
     {
         ControlObjectClient_setCommandTerminationHandler (
-            co->client, commandTerminationHandler, connectionControlPair);
+            co->client, commandTerminationHandler, context);
     }
 
     switch (co->mode)
     {
     case CONTROL_MODEL_DIRECT_ENHANCED:
     case CONTROL_MODEL_DIRECT_NORMAL:
-        co->state = CONTROL_WAIT_FOR_ACT_CON;
+        m_superviseControl (co, CONTROL_WAIT_FOR_ACT_CON);
         ControlObjectClient_operateAsync (co->client, &error, mmsValue, 0,
-                                          controlActionHandler,
-                                          connectionControlPair);
+                                          controlActionHandler, context);
         break;
     case CONTROL_MODEL_SBO_NORMAL:
-        co->state = CONTROL_WAIT_FOR_SELECT;
+        m_superviseControl (co, CONTROL_WAIT_FOR_SELECT);
         ControlObjectClient_selectAsync (
-            co->client, &error, controlActionHandler, connectionControlPair);
+            co->client, &error, controlActionHandler, context);
         break;
     case CONTROL_MODEL_SBO_ENHANCED:
-        co->state = CONTROL_WAIT_FOR_SELECT_WITH_VALUE;
+        m_superviseControl (co, CONTROL_WAIT_FOR_SELECT_WITH_VALUE);
         ControlObjectClient_selectWithValueAsync (co->client, &error, mmsValue,
                                                   controlActionHandler,
-                                                  connectionControlPair);
+                                                  context);
         break;
     case CONTROL_MODEL_STATUS_ONLY:
         break;
     }
 
+    if (error != IED_ERROR_OK)
+    {
+        co->requests--;
+        m_client->logIedClientError (error, "Control " + objRef);
+        co->state = CONTROL_IDLE;
+        co->commandId = IEC61850CommandTracker::NO_COMMAND;
+        m_commandTimers->cancel (commandId);
+        return false;
+    }
+
     return true;
 }
 
@@ -1346,75 +3111,338 @@ void
 IEC61850ClientConnection::writeHandler (uint32_t invokeId, void* parameter,
                                         IedClientError err)
 {
-    auto pair = (std::pair<IEC61850ClientConnection*, MmsValue*>*)parameter;
+    auto context = (WriteContext*)parameter;
 
-    MmsValue* value = (MmsValue*)(pair->second);
     char valueBuffer[30];
-    MmsValue_printToBuffer (value, valueBuffer, 30);
+    MmsValue_printToBuffer (context->value, valueBuffer, 30);
 
     Iec61850Utility::log_debug ("Write data handler called - Value: %s",
                                 valueBuffer);
 
     if (err != IED_ERROR_OK)
     {
-        pair->first->m_client->logIedClientError (
+        context->connection->m_client->logIedClientError (
             err, "Write data (Value = " + std::string (valueBuffer) + ")");
     }
 
-    if (value)
+    context->busy = false;
+}
+
+IEC61850ClientConnection::WriteContext*
+IEC61850ClientConnection::m_acquireWriteContext ()
+{
+    for (auto& context : m_writeContexts)
     {
-        MmsValue_delete (value);
-    };
+        bool idle = false;
+
+        if (context.busy.compare_exchange_strong (idle, true))
+            return &context;
+    }
 
-    delete pair;
+    return nullptr;
 }
 
 bool
-IEC61850ClientConnection::writeValue (Datapoint* operation,
-                                      const std::string& objRef,
+IEC61850ClientConnection::writeValue (const std::string& objRef,
                                       DatapointValue value, CDCTYPE type)
 {
     IedClientError err;
-    MmsValue* mmsValue;
     std::string attribute;
+
+    if (type != SPG && type != ING && type != ASG)
+    {
+        Iec61850Utility::log_error ("Invalid data type for writing data - %d",
+                                    type);
+        return false;
+    }
+
+    WriteContext* context = m_acquireWriteContext ();
+
+    if (!context)
+    {
+        Iec61850Utility::log_warn ("Too many writes in progress -> write of "
+                                   "%s rejected",
+                                   objRef.c_str ());
+        return false;
+    }
+
     switch (type)
     {
     case SPG: {
         attribute = ".setVal";
-        mmsValue = MmsValue_newBoolean (value.toInt ());
+        context->value = context->booleanValue;
+        MmsValue_setBoolean (context->value, value.toInt ());
         Iec61850Utility::log_debug ("Write value %s %d", objRef.c_str (),
                                     value.toInt ());
         break;
     }
     case ING: {
         attribute = ".setVal";
-        mmsValue = MmsValue_newIntegerFromInt32 ((int)value.toInt ());
+        context->value = context->integerValue;
+        MmsValue_setInt32 (context->value, (int)value.toInt ());
         Iec61850Utility::log_debug ("Write value %s %d", objRef.c_str (),
                                     value.toInt ());
         break;
     }
-    case ASG: {
+    default: {
         attribute = ".setMag.f";
-        mmsValue = MmsValue_newFloat ((float)value.toDouble ());
+        context->value = context->floatValue;
+        MmsValue_setFloat (context->value, (float)value.toDouble ());
         Iec61850Utility::log_debug ("Write value %s %f", objRef.c_str (),
                                     (float)value.toDouble ());
         break;
     }
-    default: {
-        Iec61850Utility::log_error ("Invalid data type for writing data - %d",
-                                    type);
-        return false;
-    }
     }
 
-    auto parameter
-        = new std::pair<IEC61850ClientConnection*, MmsValue*> (this, mmsValue);
-
     IedConnection_writeObjectAsync (
         m_connection, &err, (objRef + attribute).c_str (), IEC61850_FC_SP,
-        mmsValue, writeHandler, parameter);
+        context->value, writeHandler, context);
 
-    delete operation;
+    /* no callback when the request was not sent */
+    if (err != IED_ERROR_OK)
+        context->busy = false;
 
     return err == IED_ERROR_OK;
 }
+
+bool
+IEC61850ClientConnection::writeSettings (
+    const std::shared_ptr<IEC61850SettingBatch>& batch)
+{
+    std::lock_guard<std::mutex> lock (m_conLock);
+
+    if (m_connectionState != CON_STATE_CONNECTED)
+    {
+        Iec61850Utility::log_warn ("Not connected -> settings %s not written",
+                                   batch->identifier ().c_str ());
+        return false;
+    }
+
+    /* settings of each LD, in the order of the batch */
+    std::map<std::string, std::vector<size_t> > lds;
+
+    for (size_t i = 0; i < batch->settings.size (); i++)
+        lds[batch->settings[i].domain].push_back (i);
+
+    batch->pendingLds = lds.size ();
+    m_settingBatches.push_back (batch);
+
+    Iec61850Utility::log_debug ("Write %d settings of %s in %d LDs",
+                                (int)batch->settings.size (),
+                                batch->identifier ().c_str (),
+                                (int)lds.size ());
+
+    for (const auto& ld : lds)
+    {
+        const std::vector<size_t>& settings = ld.second;
+
+        if (batch->settingGroup () > 0)
+        {
+            m_editLdSettings (batch, ld.first, settings);
+            continue;
+        }
+
+        m_writeLdSettings (batch, ld.first, settings, [this, batch,
+                                                       settings] () {
+            for (size_t i : settings)
+                batch->settings[i].written = batch->settings[i].accepted;
+
+            m_ldSettingsDone (batch);
+        });
+    }
+
+    return true;
+}
+
+void
+IEC61850ClientConnection::m_writeLdSettings (
+    const std::shared_ptr<IEC61850SettingBatch>& batch,
+    const std::string& domain, const std::vector<size_t>& settings,
+    const std::function<void ()>& done)
+{
+    auto pending = std::make_shared<size_t> (
+        (settings.size () + SETTINGS_PER_REQUEST - 1) / SETTINGS_PER_REQUEST);
+
+    for (size_t first = 0; first < settings.size ();
+         first += SETTINGS_PER_REQUEST)
+    {
+        std::vector<size_t> request (
+            settings.begin () + first,
+            settings.begin ()
+                + std::min (first + SETTINGS_PER_REQUEST, settings.size ()));
+
+        m_pipeline->submit (
+            [this, batch, domain, request] (IedClientError* err,
+                                            void* parameter) {
+                LinkedList items = LinkedList_create ();
+                LinkedList values = LinkedList_create ();
+
+                for (size_t i : request)
+                {
+                    LinkedList_add (items,
+                                    (void*)batch->settings[i].item.c_str ());
+                    LinkedList_add (values, batch->settings[i].value);
+                }
+
+                uint32_t invokeId = 0;
+                MmsError mmsError = MMS_ERROR_NONE;
+
+                /* the request is encoded before returning */
+                MmsConnection_writeMultipleVariablesAsync (
+                    IedConnection_getMmsConnection (m_connection), &invokeId,
+                    &mmsError, domain.c_str (), items, values,
+                    IEC61850AsyncPipeline::writeMultipleVariablesHandler,
+                    parameter);
+
+                LinkedList_destroyStatic (items);
+                LinkedList_destroyStatic (values);
+
+                if (mmsError != MMS_ERROR_NONE)
+                    *err = IED_ERROR_UNKNOWN;
+
+                return invokeId;
+            },
+            [this, batch, domain, request, pending,
+             done] (IEC61850AsyncResult& result) {
+                if (result.err != IED_ERROR_OK)
+                {
+                    m_client->logIedClientError (result.err,
+                                                 "Write settings of "
+                                                     + domain);
+                }
+                else
+                {
+                    LinkedList element
+                        = LinkedList_getNext (result.accessResults);
+
+                    /* a missing access result counts as a rejection */
+                    for (size_t i : request)
+                    {
+                        IEC61850SettingBatch::Setting& setting
+                            = batch->settings[i];
+
+                        MmsValue* accessResult
+                            = element ? (MmsValue*)LinkedList_getData (element)
+                                      : nullptr;
+
+                        setting.accepted
+                            = accessResult
+                              && MmsValue_getType (accessResult)
+                                     == MMS_DATA_ACCESS_ERROR
+                              && MmsValue_getDataAccessError (accessResult)
+                                     == DATA_ACCESS_ERROR_SUCCESS;
+
+                        if (!setting.accepted)
+                        {
+                            Iec61850Utility::log_warn (
+                                "Write of setting %s rejected",
+                                setting.objRef.c_str ());
+                        }
+
+                        if (element)
+                            element = LinkedList_getNext (element);
+                    }
+                }
+
+                if (--(*pending) == 0)
+                    done ();
+            });
+    }
+}
+
+void
+IEC61850ClientConnection::m_editLdSettings (
+    const std::shared_ptr<IEC61850SettingBatch>& batch,
+    const std::string& domain, const std::vector<size_t>& settings)
+{
+    std::string sgcbRef = domain + "/LLN0.SGCB";
+
+    std::shared_ptr<MmsValue> group (
+        MmsValue_newUnsignedFromUint32 (batch->settingGroup ()),
+        MmsValue_delete);
+
+    m_writeSgcb (
+        sgcbRef + ".EditSG", group,
+        [this, batch, domain, settings, sgcbRef] (bool selected) {
+            if (!selected)
+            {
+                m_ldSettingsDone (batch);
+                return;
+            }
+
+            m_writeLdSettings (batch, domain, settings,
+                               [this, batch, settings, sgcbRef] () {
+                                   m_confirmLdSettings (batch, settings,
+                                                        sgcbRef);
+                               });
+        });
+}
+
+void
+IEC61850ClientConnection::m_confirmLdSettings (
+    const std::shared_ptr<IEC61850SettingBatch>& batch,
+    const std::vector<size_t>& settings, const std::string& sgcbRef)
+{
+    bool accepted = true;
+
+    for (size_t i : settings)
+        accepted = accepted && batch->settings[i].accepted;
+
+    /* a partly accepted edit is discarded, the group stays unchanged */
+    if (!accepted)
+    {
+        Iec61850Utility::log_warn ("Edit of %s discarded", sgcbRef.c_str ());
+
+        std::shared_ptr<MmsValue> none (MmsValue_newUnsignedFromUint32 (0),
+                                        MmsValue_delete);
+
+        m_writeSgcb (sgcbRef + ".EditSG", none,
+                     [this, batch] (bool) { m_ldSettingsDone (batch); });
+        return;
+    }
+
+    std::shared_ptr<MmsValue> confirm (MmsValue_newBoolean (true),
+                                       MmsValue_delete);
+
+    m_writeSgcb (sgcbRef + ".CnfEdit", confirm,
+                 [this, batch, settings] (bool confirmed) {
+                     for (size_t i : settings)
+                         batch->settings[i].written = confirmed;
+
+                     m_ldSettingsDone (batch);
+                 });
+}
+
+void
+IEC61850ClientConnection::m_writeSgcb (
+    const std::string& reference, const std::shared_ptr<MmsValue>& value,
+    const std::function<void (bool)>& done)
+{
+    m_pipeline->submit (
+        [this, reference, value] (IedClientError* err, void* parameter) {
+            return IedConnection_writeObjectAsync (
+                m_connection, err, reference.c_str (), IEC61850_FC_SP,
+                value.get (), IEC61850AsyncPipeline::genericHandler,
+                parameter);
+        },
+        [this, reference, done] (IEC61850AsyncResult& result) {
+            if (result.err != IED_ERROR_OK)
+                m_client->logIedClientError (result.err, "Write " + reference);
+
+            done (result.err == IED_ERROR_OK);
+        });
+}
+
+void
+IEC61850ClientConnection::m_ldSettingsDone (
+    const std::shared_ptr<IEC61850SettingBatch>& batch)
+{
+    if (--batch->pendingLds > 0)
+        return;
+
+    m_settingBatches.erase (std::remove (m_settingBatches.begin (),
+                                         m_settingBatches.end (), batch),
+                            m_settingBatches.end ());
+
+    m_client->sendSettingBatchAck (*batch);
+}
@@ -0,0 +1,213 @@
+#include "iec61850_command_batch.hpp"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+using namespace rapidjson;
+
+#define JSON_BATCH "PivotCommandBatch"
+#define JSON_BATCH_IDENTIFIER "Identifier"
+#define JSON_BATCH_SEQUENTIAL "Sequential"
+#define JSON_BATCH_COMMANDS "Commands"
+#define JSON_BATCH_ID "Id"
+#define JSON_BATCH_AFTER "After"
+#define JSON_BATCH_COMMAND "GTIC"
+
+bool
+IEC61850CommandBatch::parse (const std::string& json)
+{
+    Document document;
+
+    if (document.Parse (json.c_str ()).HasParseError ()
+        || !document.IsObject () || !document.HasMember (JSON_BATCH)
+        || !document[JSON_BATCH].IsObject ())
+        return false;
+
+    const Value& batch = document[JSON_BATCH];
+
+    if (batch.HasMember (JSON_BATCH_IDENTIFIER)
+        && batch[JSON_BATCH_IDENTIFIER].IsString ())
+        m_identifier = batch[JSON_BATCH_IDENTIFIER].GetString ();
+
+    bool sequential = batch.HasMember (JSON_BATCH_SEQUENTIAL)
+                      && batch[JSON_BATCH_SEQUENTIAL].IsBool ()
+                      && batch[JSON_BATCH_SEQUENTIAL].GetBool ();
+
+    if (!batch.HasMember (JSON_BATCH_COMMANDS)
+        || !batch[JSON_BATCH_COMMANDS].IsArray ()
+        || batch[JSON_BATCH_COMMANDS].Empty ())
+        return false;
+
+    for (const auto& command : batch[JSON_BATCH_COMMANDS].GetArray ())
+    {
+        if (!command.IsObject () || !command.HasMember (JSON_BATCH_COMMAND)
+            || !command[JSON_BATCH_COMMAND].IsObject ())
+            return false;
+
+        std::string key = std::to_string (m_steps.size ());
+
+        if (command.HasMember (JSON_BATCH_ID))
+        {
+            if (!command[JSON_BATCH_ID].IsString ())
+                return false;
+
+            key = command[JSON_BATCH_ID].GetString ();
+        }
+
+        std::vector<std::string> after;
+
+        if (sequential && !m_steps.empty ())
+            after.push_back (m_steps.back ().key);
+
+        if (command.HasMember (JSON_BATCH_AFTER))
+        {
+            if (!command[JSON_BATCH_AFTER].IsArray ())
+                return false;
+
+            for (const auto& previous : command[JSON_BATCH_AFTER].GetArray ())
+            {
+                if (!previous.IsString ())
+                    return false;
+
+                after.push_back (previous.GetString ());
+            }
+        }
+
+        /* the step is sent as a PivotCommand of its own */
+        StringBuffer buffer;
+        Writer<StringBuffer> writer (buffer);
+
+        writer.StartObject ();
+        writer.Key (JSON_BATCH_COMMAND);
+        command[JSON_BATCH_COMMAND].Accept (writer);
+        writer.EndObject ();
+
+        if (!addStep (key, buffer.GetString (), after))
+            return false;
+    }
+
+    return true;
+}
+
+bool
+IEC61850CommandBatch::addStep (const std::string& key,
+                               const std::string& json,
+                               const std::vector<std::string>& after)
+{
+    size_t index = m_steps.size ();
+    std::vector<size_t> previous;
+
+    for (size_t i = 0; i < m_steps.size (); i++)
+    {
+        if (m_steps[i].key == key)
+            return false;
+    }
+
+    /* only earlier steps, so the dependencies cannot form a cycle */
+    for (const auto& previousKey : after)
+    {
+        size_t i = 0;
+
+        while (i < m_steps.size () && m_steps[i].key != previousKey)
+            i++;
+
+        if (i == m_steps.size ())
+            return false;
+
+        previous.push_back (i);
+    }
+
+    Step step;
+    step.key = key;
+    step.json = json;
+
+    for (size_t i : previous)
+    {
+        m_steps[i].dependents.push_back (index);
+        step.waitingFor++;
+    }
+
+    m_steps.push_back (step);
+
+    return true;
+}
+
+std::vector<size_t>
+IEC61850CommandBatch::ready ()
+{
+    std::vector<size_t> steps;
+
+    for (size_t i = 0; i < m_steps.size (); i++)
+    {
+        if (m_steps[i].state == PENDING && m_steps[i].waitingFor == 0)
+        {
+            m_steps[i].state = RUNNING;
+            steps.push_back (i);
+        }
+    }
+
+    return steps;
+}
+
+std::vector<size_t>
+IEC61850CommandBatch::start ()
+{
+    return ready ();
+}
+
+void
+IEC61850CommandBatch::skipDependents (size_t step)
+{
+    for (size_t dependent : m_steps[step].dependents)
+    {
+        if (m_steps[dependent].state != PENDING)
+            continue;
+
+        m_steps[dependent].state = SKIPPED;
+        m_finished++;
+
+        skipDependents (dependent);
+    }
+}
+
+std::vector<size_t>
+IEC61850CommandBatch::done (size_t step, bool confirmed)
+{
+    /* a result is only taken once */
+    if (step >= m_steps.size () || m_steps[step].state != RUNNING)
+        return {};
+
+    m_steps[step].state = confirmed ? CONFIRMED : FAILED;
+    m_finished++;
+
+    if (!confirmed)
+    {
+        skipDependents (step);
+        return {};
+    }
+
+    for (size_t dependent : m_steps[step].dependents)
+        m_steps[dependent].waitingFor--;
+
+    return ready ();
+}
+
+bool
+IEC61850CommandBatch::finished () const
+{
+    return m_finished == m_steps.size ();
+}
+
+size_t
+IEC61850CommandBatch::count (StepState state) const
+{
+    size_t steps = 0;
+
+    for (const auto& step : m_steps)
+    {
+        if (step.state == state)
+            steps++;
+    }
+
+    return steps;
+}
@@ -0,0 +1,81 @@
+#include "iec61850_command_tracker.hpp"
+
+const uint64_t IEC61850CommandTracker::NO_COMMAND;
+
+uint64_t
+IEC61850CommandTracker::add (const std::string& label,
+                             const std::string& json, uint64_t batchId,
+                             size_t step)
+{
+    uint64_t id = m_nextId++;
+
+    Shard& s = shard (id);
+    std::lock_guard<std::mutex> lock (s.lock);
+
+    Command& command = s.commands[id];
+    command.label = label;
+    command.json = json;
+    command.batchId = batchId;
+    command.step = step;
+
+    return id;
+}
+
+bool
+IEC61850CommandTracker::get (uint64_t id, Command& command) const
+{
+    const Shard& s = shard (id);
+    std::lock_guard<std::mutex> lock (s.lock);
+
+    auto it = s.commands.find (id);
+
+    if (it == s.commands.end ())
+        return false;
+
+    command = it->second;
+    return true;
+}
+
+bool
+IEC61850CommandTracker::remove (uint64_t id, bool confirmed)
+{
+    Command command;
+
+    {
+        Shard& s = shard (id);
+        std::lock_guard<std::mutex> lock (s.lock);
+
+        auto it = s.commands.find (id);
+
+        if (it == s.commands.end ())
+            return false;
+
+        command.batchId = it->second.batchId;
+        command.step = it->second.step;
+
+        if (command.batchId != 0)
+            command.label = std::move (it->second.label);
+
+        s.commands.erase (it);
+    }
+
+    /* outside the lock, the handler may send the next commands */
+    if (command.batchId != 0 && m_completionHandler)
+        m_completionHandler (command, confirmed);
+
+    return true;
+}
+
+size_t
+IEC61850CommandTracker::size () const
+{
+    size_t count = 0;
+
+    for (const auto& s : m_shards)
+    {
+        std::lock_guard<std::mutex> lock (s.lock);
+        count += s.commands.size ();
+    }
+
+    return count;
+}
@@ -0,0 +1,329 @@
+#include "iec61850_config_snapshot.hpp"
+#include "iec61850_utility.hpp"
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utils.h>
+
+#define CONFIG_SNAPSHOT_MAGIC 0x31534643 /* "CFS1" */
+#define CONFIG_SNAPSHOT_VERSION 1
+#define CONFIG_SNAPSHOT_DIR "/iec61850/"
+
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+IEC61850ConfigSnapshot::IEC61850ConfigSnapshot (const std::string& fileName)
+    : m_fileName (fileName)
+{
+}
+
+std::string
+IEC61850ConfigSnapshot::snapshotFileName (const std::string& iedNames)
+{
+    std::string name = iedNames.empty () ? "default" : iedNames;
+
+    for (char& c : name)
+    {
+        if (!isalnum (c) && c != '_' && c != '-')
+            c = '_';
+    }
+
+    std::string snapshotDir = getDataDir () + CONFIG_SNAPSHOT_DIR;
+
+    if (mkdir (snapshotDir.c_str (), 0755) != 0 && errno != EEXIST)
+    {
+        Iec61850Utility::log_warn ("Failed to create snapshot directory %s",
+                                   snapshotDir.c_str ());
+    }
+
+    return snapshotDir + "config_" + name + ".bin";
+}
+
+uint64_t
+IEC61850ConfigSnapshot::checksum (const uint8_t* data, size_t size,
+                                  uint64_t hash)
+{
+    /* FNV-1a applied to 64 bit words, the images can be large */
+    size_t i = 0;
+
+    for (; i + sizeof (uint64_t) <= size; i += sizeof (uint64_t))
+    {
+        uint64_t word;
+        memcpy (&word, data + i, sizeof (word));
+        hash ^= word;
+        hash *= FNV_PRIME;
+    }
+
+    for (; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+uint64_t
+IEC61850ConfigSnapshot::configHash (
+    const std::string& exchangeConfig,
+    const std::vector<IEC61850ClientConfig*>& configs)
+{
+    uint64_t hash = checksum (
+        reinterpret_cast<const uint8_t*> (exchangeConfig.data ()),
+        exchangeConfig.size (), FNV_OFFSET);
+
+    for (auto config : configs)
+    {
+        /* the terminating null separates the names */
+        hash = checksum (
+            reinterpret_cast<const uint8_t*> (config->m_iedName.c_str ()),
+            config->m_iedName.size () + 1, hash);
+    }
+
+    return hash;
+}
+
+bool
+IEC61850ConfigSnapshot::save (
+    uint64_t hash, const std::vector<IEC61850ClientConfig*>& configs)
+{
+    std::vector<uint8_t> payload;
+    std::string strings;
+
+    auto append = [&payload] (const void* data, size_t size) {
+        auto bytes = static_cast<const uint8_t*> (data);
+        payload.insert (payload.end (), bytes, bytes + size);
+    };
+
+    auto addString = [&strings] (const std::string& str, uint32_t& offset,
+                                 uint32_t& length) {
+        offset = (uint32_t)strings.size ();
+        length = (uint32_t)str.size ();
+        strings += str;
+    };
+
+    for (auto config : configs)
+    {
+        const IEC61850DefinitionIndex& index = config->m_definitionIndex;
+
+        ConfigHeader configHeader;
+        configHeader.definitionCount = (uint32_t)index.size ();
+
+        for (int key = 0; key < IEC61850DefinitionIndex::KEY_COUNT; key++)
+        {
+            configHeader.capacities[key] = (uint32_t)index.table (
+                (IEC61850DefinitionIndex::Key)key).size ();
+        }
+
+        append (&configHeader, sizeof (configHeader));
+
+        for (uint32_t id = 0; id < configHeader.definitionCount; id++)
+        {
+            const DataExchangeDefinition* def = index.definition (id);
+
+            Definition record;
+            memset (&record, 0, sizeof (record));
+            addString (def->label, record.label, record.labelLength);
+            addString (def->id, record.pivotId, record.pivotIdLength);
+            addString (def->objRef, record.objRef, record.objRefLength);
+            record.cdcType = def->cdcType;
+
+            append (&record, sizeof (record));
+        }
+
+        for (int key = 0; key < IEC61850DefinitionIndex::KEY_COUNT; key++)
+        {
+            const auto& table
+                = index.table ((IEC61850DefinitionIndex::Key)key);
+
+            append (table.data (),
+                    table.size () * sizeof (IEC61850DefinitionIndex::Slot));
+        }
+    }
+
+    append (strings.data (), strings.size ());
+
+    Header header;
+    memset (&header, 0, sizeof (header));
+    header.magic = CONFIG_SNAPSHOT_MAGIC;
+    header.version = CONFIG_SNAPSHOT_VERSION;
+    header.configHash = hash;
+    header.checksum = checksum (payload.data (), payload.size (), FNV_OFFSET);
+    header.size = payload.size ();
+    header.configCount = (uint32_t)configs.size ();
+    header.stringTableSize = (uint32_t)strings.size ();
+
+    std::string tmpFileName = m_fileName + ".tmp";
+    bool saved = false;
+
+    FILE* file = fopen (tmpFileName.c_str (), "wb");
+
+    if (file)
+    {
+        saved = fwrite (&header, sizeof (header), 1, file) == 1
+                && fwrite (payload.data (), 1, payload.size (), file)
+                       == payload.size ();
+
+        saved = (fclose (file) == 0) && saved
+                && rename (tmpFileName.c_str (), m_fileName.c_str ()) == 0;
+    }
+
+    if (!saved)
+    {
+        Iec61850Utility::log_warn ("Cannot write configuration snapshot %s",
+                                   m_fileName.c_str ());
+        remove (tmpFileName.c_str ());
+    }
+
+    return saved;
+}
+
+bool
+IEC61850ConfigSnapshot::restore (
+    const uint8_t* data, size_t size,
+    const std::vector<IEC61850ClientConfig*>& configs)
+{
+    auto header = reinterpret_cast<const Header*> (data);
+
+    if (header->stringTableSize > size - sizeof (Header))
+        return false;
+
+    const char* strings = reinterpret_cast<const char*> (data) + size
+                          - header->stringTableSize;
+    size_t end = size - header->stringTableSize;
+    size_t pos = sizeof (Header);
+
+    auto validString = [header] (uint32_t offset, uint32_t length) {
+        return offset <= header->stringTableSize
+               && length <= header->stringTableSize - offset;
+    };
+
+    for (auto config : configs)
+    {
+        if (end - pos < sizeof (ConfigHeader))
+            return false;
+
+        auto configHeader = reinterpret_cast<const ConfigHeader*> (data + pos);
+        pos += sizeof (ConfigHeader);
+
+        if ((end - pos) / sizeof (Definition) < configHeader->definitionCount)
+            return false;
+
+        auto records = reinterpret_cast<const Definition*> (data + pos);
+        pos += configHeader->definitionCount * sizeof (Definition);
+
+        const IEC61850DefinitionIndex::Slot*
+            tables[IEC61850DefinitionIndex::KEY_COUNT];
+
+        for (int key = 0; key < IEC61850DefinitionIndex::KEY_COUNT; key++)
+        {
+            uint32_t capacity = configHeader->capacities[key];
+
+            if ((end - pos) / sizeof (IEC61850DefinitionIndex::Slot)
+                < capacity)
+                return false;
+
+            tables[key]
+                = reinterpret_cast<const IEC61850DefinitionIndex::Slot*> (
+                    data + pos);
+            pos += capacity * sizeof (IEC61850DefinitionIndex::Slot);
+        }
+
+        /* the definitions of a configuration are allocated in one block,
+         * the index holds aliases of it */
+        auto block = std::make_shared<std::vector<DataExchangeDefinition> > (
+            configHeader->definitionCount);
+
+        std::vector<std::shared_ptr<DataExchangeDefinition> > definitions;
+        definitions.reserve (configHeader->definitionCount);
+
+        for (uint32_t i = 0; i < configHeader->definitionCount; i++)
+        {
+            const Definition& record = records[i];
+
+            if (!validString (record.label, record.labelLength)
+                || !validString (record.pivotId, record.pivotIdLength)
+                || !validString (record.objRef, record.objRefLength))
+                return false;
+
+            DataExchangeDefinition& def = (*block)[i];
+
+            IEC61850ClientConfig::initExchangeDefinition (
+                def, static_cast<CDCTYPE> (record.cdcType));
+
+            def.label.assign (strings + record.label, record.labelLength);
+            def.id.assign (strings + record.pivotId, record.pivotIdLength);
+            def.objRef.assign (strings + record.objRef, record.objRefLength);
+
+            definitions.emplace_back (block, &def);
+        }
+
+        if (!config->m_definitionIndex.restore (
+                definitions, tables, configHeader->capacities))
+            return false;
+    }
+
+    return pos == end;
+}
+
+bool
+IEC61850ConfigSnapshot::load (
+    uint64_t hash, const std::vector<IEC61850ClientConfig*>& configs)
+{
+    int fd = open (m_fileName.c_str (), O_RDONLY);
+
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void* map = MAP_FAILED;
+
+    if (fstat (fd, &st) == 0 && (size_t)st.st_size >= sizeof (Header))
+    {
+        map = mmap (nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    close (fd);
+
+    if (map == MAP_FAILED)
+        return false;
+
+    auto data = static_cast<const uint8_t*> (map);
+    auto header = static_cast<const Header*> (map);
+    size_t size = st.st_size;
+
+    bool valid = header->magic == CONFIG_SNAPSHOT_MAGIC
+                 && header->version == CONFIG_SNAPSHOT_VERSION
+                 && header->configHash == hash
+                 && header->configCount == configs.size ()
+                 && header->size == size - sizeof (Header)
+                 && header->checksum
+                        == checksum (data + sizeof (Header), header->size,
+                                     FNV_OFFSET);
+
+    for (auto config : configs)
+    {
+        config->m_exchangeConfigComplete = false;
+        config->deleteExchangeDefinitions ();
+    }
+
+    if (valid && !restore (data, size, configs))
+    {
+        Iec61850Utility::log_warn ("Invalid configuration snapshot %s",
+                                   m_fileName.c_str ());
+
+        for (auto config : configs)
+            config->deleteExchangeDefinitions ();
+
+        valid = false;
+    }
+
+    munmap (map, size);
+
+    return valid;
+}
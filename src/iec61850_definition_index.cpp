@@ -0,0 +1,186 @@
+#include "iec61850_definition_index.hpp"
+#include "iec61850_client_config.hpp"
+#include <cstring>
+
+#define INDEX_MIN_CAPACITY 16
+
+const uint32_t IEC61850DefinitionIndex::INVALID_ID;
+
+uint32_t
+IEC61850DefinitionIndex::hashKey (const char* str, size_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= (uint8_t)str[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+const std::string&
+IEC61850DefinitionIndex::keyOf (const DataExchangeDefinition& def, Key key)
+{
+    switch (key)
+    {
+    case PIVOT_ID:
+        return def.id;
+    case OBJ_REF:
+        return def.objRef;
+    default:
+        return def.label;
+    }
+}
+
+void
+IEC61850DefinitionIndex::clear ()
+{
+    m_definitions.clear ();
+
+    for (auto& table : m_tables)
+    {
+        table.slots.clear ();
+        table.used = 0;
+    }
+}
+
+bool
+IEC61850DefinitionIndex::insert (Table& table, Key key, uint32_t hash,
+                                 uint32_t id)
+{
+    const std::string& str = keyOf (*m_definitions[id], key);
+    size_t mask = table.slots.size () - 1;
+
+    for (size_t pos = hash & mask;; pos = (pos + 1) & mask)
+    {
+        Slot& slot = table.slots[pos];
+
+        if (slot.id == INVALID_ID)
+        {
+            slot.hash = hash;
+            slot.id = id;
+            table.used++;
+            return true;
+        }
+
+        if (slot.hash == hash && keyOf (*m_definitions[slot.id], key) == str)
+            return false;
+    }
+}
+
+void
+IEC61850DefinitionIndex::grow (Table& table, Key key)
+{
+    size_t capacity = table.slots.empty () ? INDEX_MIN_CAPACITY
+                                           : table.slots.size () * 2;
+
+    std::vector<Slot> slots (capacity, { 0, INVALID_ID });
+    slots.swap (table.slots);
+    table.used = 0;
+
+    for (const Slot& slot : slots)
+    {
+        if (slot.id != INVALID_ID)
+            insert (table, key, slot.hash, slot.id);
+    }
+}
+
+uint32_t
+IEC61850DefinitionIndex::add (
+    const std::shared_ptr<DataExchangeDefinition>& def)
+{
+    uint32_t id = (uint32_t)m_definitions.size ();
+
+    m_definitions.push_back (def);
+
+    for (int key = 0; key < KEY_COUNT; key++)
+    {
+        Table& table = m_tables[key];
+
+        /* keeps the load factor at or below 1/2 */
+        if ((table.used + 1) * 2 > table.slots.size ())
+            grow (table, (Key)key);
+
+        const std::string& str = keyOf (*def, (Key)key);
+
+        insert (table, (Key)key, hashKey (str.data (), str.size ()), id);
+    }
+
+    return id;
+}
+
+uint32_t
+IEC61850DefinitionIndex::find (Key key, const char* str, size_t len) const
+{
+    const Table& table = m_tables[key];
+
+    if (table.slots.empty ())
+        return INVALID_ID;
+
+    uint32_t hash = hashKey (str, len);
+    size_t mask = table.slots.size () - 1;
+
+    for (size_t pos = hash & mask;; pos = (pos + 1) & mask)
+    {
+        const Slot& slot = table.slots[pos];
+
+        if (slot.id == INVALID_ID)
+            return INVALID_ID;
+
+        if (slot.hash != hash)
+            continue;
+
+        const std::string& candidate = keyOf (*m_definitions[slot.id], key);
+
+        if (candidate.size () == len
+            && memcmp (candidate.data (), str, len) == 0)
+            return slot.id;
+    }
+}
+
+bool
+IEC61850DefinitionIndex::restore (
+    std::vector<std::shared_ptr<DataExchangeDefinition> >& definitions,
+    const Slot* const tables[KEY_COUNT], const uint32_t capacities[KEY_COUNT])
+{
+    clear ();
+
+    for (int key = 0; key < KEY_COUNT; key++)
+    {
+        uint32_t capacity = capacities[key];
+
+        if (capacity & (capacity - 1))
+            return false;
+
+        Table& table = m_tables[key];
+
+        table.slots.assign (tables[key], tables[key] + capacity);
+
+        for (const Slot& slot : table.slots)
+        {
+            if (slot.id == INVALID_ID)
+                continue;
+
+            if (slot.id >= definitions.size ())
+            {
+                clear ();
+                return false;
+            }
+
+            table.used++;
+        }
+
+        /* a full table would make the lookups of unknown keys loop */
+        if (capacity > 0 && table.used * 2 > capacity)
+        {
+            clear ();
+            return false;
+        }
+    }
+
+    m_definitions.swap (definitions);
+
+    return true;
+}
@@ -0,0 +1,301 @@
+#include "iec61850_entryid_store.hpp"
+#include "iec61850_utility.hpp"
+#include <cctype>
+#include <cstddef>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utils.h>
+
+#define ENTRYID_STORE_MAGIC 0x31444945 /* "EID1" */
+#define ENTRYID_STORE_VERSION 1
+#define ENTRYID_STORE_DIR "/iec61850/"
+
+IEC61850EntryIdStore::IEC61850EntryIdStore (const std::string& fileName)
+    : m_fileName (fileName)
+{
+}
+
+IEC61850EntryIdStore::~IEC61850EntryIdStore () { close (); }
+
+std::string
+IEC61850EntryIdStore::storeFileName (const std::string& iedName,
+                                     const std::string& ip, int port)
+{
+    std::string name = iedName + "_" + ip + "_" + std::to_string (port);
+
+    for (char& c : name)
+    {
+        if (!isalnum (c) && c != '_' && c != '-')
+            c = '_';
+    }
+
+    std::string storeDir = getDataDir () + ENTRYID_STORE_DIR;
+
+    if (mkdir (storeDir.c_str (), 0755) != 0 && errno != EEXIST)
+    {
+        Iec61850Utility::log_warn ("Failed to create EntryID directory %s",
+                                   storeDir.c_str ());
+    }
+
+    return storeDir + "entryids_" + name + ".dat";
+}
+
+uint32_t
+IEC61850EntryIdStore::checksum (const Slot& slot)
+{
+    /* FNV-1a over everything but the checksum itself */
+    uint32_t hash = 2166136261u;
+    auto data = reinterpret_cast<const uint8_t*> (&slot);
+
+    for (size_t i = 0; i < offsetof (Slot, checksum); i++)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+const IEC61850EntryIdStore::Slot*
+IEC61850EntryIdStore::currentSlot (const Record& record)
+{
+    const Slot* current = nullptr;
+
+    for (const Slot& slot : record.slots)
+    {
+        if (slot.seq == 0 || slot.size > ENTRYID_MAX_SIZE
+            || slot.checksum != checksum (slot))
+            continue;
+
+        if (!current || slot.seq > current->seq)
+            current = &slot;
+    }
+
+    return current;
+}
+
+void
+IEC61850EntryIdStore::close ()
+{
+    if (m_map)
+    {
+        msync (m_map, m_mapSize, MS_SYNC);
+        munmap (m_map, m_mapSize);
+    }
+
+    m_map = nullptr;
+    m_mapSize = 0;
+    m_records = nullptr;
+    m_memory.clear ();
+    m_index.clear ();
+}
+
+bool
+IEC61850EntryIdStore::open (const std::vector<std::string>& rcbRefs)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    /* EntryIDs received so far, then those of the previous run, by RCB */
+    std::unordered_map<std::string, Record> previous;
+
+    for (const auto& entry : m_index)
+        previous[entry.first] = *entry.second;
+
+    FILE* file = fopen (m_fileName.c_str (), "rb");
+
+    if (file)
+    {
+        Header header;
+
+        if (fread (&header, sizeof (header), 1, file) == 1
+            && header.magic == ENTRYID_STORE_MAGIC
+            && header.version == ENTRYID_STORE_VERSION)
+        {
+            Record record;
+
+            for (uint32_t i = 0; i < header.count
+                                 && fread (&record, sizeof (record), 1, file)
+                                        == 1;
+                 i++)
+            {
+                record.rcbRef[ENTRYID_MAX_RCB_REF - 1] = 0;
+                previous.insert ({ record.rcbRef, record });
+            }
+        }
+
+        fclose (file);
+    }
+
+    close ();
+
+    std::vector<Record> records (rcbRefs.size ());
+
+    for (size_t i = 0; i < rcbRefs.size (); i++)
+    {
+        auto it = previous.find (rcbRefs[i]);
+
+        if (it != previous.end ())
+        {
+            records[i] = it->second;
+        }
+        else
+        {
+            memset (&records[i], 0, sizeof (Record));
+            strncpy (records[i].rcbRef, rcbRefs[i].c_str (),
+                     ENTRYID_MAX_RCB_REF - 1);
+        }
+    }
+
+    /* the layout is rewritten atomically, updates then go to the mapping */
+    Header header = { ENTRYID_STORE_MAGIC, ENTRYID_STORE_VERSION,
+                      (uint32_t)records.size () };
+
+    std::string tmpFileName = m_fileName + ".tmp";
+    bool persistent = false;
+
+    file = fopen (tmpFileName.c_str (), "wb");
+
+    if (file)
+    {
+        persistent
+            = fwrite (&header, sizeof (header), 1, file) == 1
+              && (records.empty ()
+                  || fwrite (records.data (), sizeof (Record),
+                             records.size (), file)
+                         == records.size ());
+
+        persistent = (fclose (file) == 0) && persistent
+                     && rename (tmpFileName.c_str (), m_fileName.c_str ()) == 0;
+    }
+
+    if (persistent)
+    {
+        int fd = ::open (m_fileName.c_str (), O_RDWR);
+
+        if (fd >= 0)
+        {
+            m_mapSize = sizeof (Header) + records.size () * sizeof (Record);
+            void* map = mmap (nullptr, m_mapSize, PROT_READ | PROT_WRITE,
+                              MAP_SHARED, fd, 0);
+            ::close (fd);
+
+            if (map != MAP_FAILED)
+            {
+                m_map = map;
+                m_records = reinterpret_cast<Record*> (
+                    static_cast<uint8_t*> (map) + sizeof (Header));
+            }
+        }
+
+        persistent = m_map != nullptr;
+    }
+
+    if (!persistent)
+    {
+        Iec61850Utility::log_warn (
+            "Cannot map EntryID store %s -> EntryIDs kept in memory only",
+            m_fileName.c_str ());
+
+        m_mapSize = 0;
+        m_memory = records;
+        m_records = m_memory.data ();
+    }
+
+    for (size_t i = 0; i < rcbRefs.size (); i++)
+    {
+        m_index[rcbRefs[i]] = &m_records[i];
+    }
+
+    return persistent;
+}
+
+MmsValue*
+IEC61850EntryIdStore::get (const std::string& rcbRef)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_index.find (rcbRef);
+
+    if (it == m_index.end ())
+        return nullptr;
+
+    const Slot* slot = currentSlot (*it->second);
+
+    if (!slot || slot->size == 0)
+        return nullptr;
+
+    MmsValue* entryId = MmsValue_newOctetString (slot->size, slot->size);
+    MmsValue_setOctetString (entryId, slot->entryId, slot->size);
+
+    return entryId;
+}
+
+void
+IEC61850EntryIdStore::write (Record& record, const uint8_t* entryId,
+                             uint32_t size)
+{
+    const Slot* current = currentSlot (record);
+
+    /* the slot not holding the current value is overwritten */
+    Slot& slot = (current == &record.slots[0]) ? record.slots[1]
+                                                : record.slots[0];
+
+    Slot update;
+    memset (&update, 0, sizeof (update));
+    update.seq = current ? current->seq + 1 : 1;
+    update.size = size;
+    if (size > 0)
+        memcpy (update.entryId, entryId, size);
+    update.checksum = checksum (update);
+
+    slot = update;
+}
+
+void
+IEC61850EntryIdStore::set (const std::string& rcbRef,
+                           const MmsValue* entryId)
+{
+    if (!entryId)
+        return;
+
+    int size = MmsValue_getOctetStringSize (entryId);
+
+    if (size <= 0 || size > ENTRYID_MAX_SIZE)
+        return;
+
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_index.find (rcbRef);
+
+    if (it == m_index.end ())
+        return;
+
+    write (*it->second,
+           MmsValue_getOctetStringBuffer (const_cast<MmsValue*> (entryId)),
+           size);
+}
+
+void
+IEC61850EntryIdStore::clear (const std::string& rcbRef)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_index.find (rcbRef);
+
+    if (it != m_index.end ())
+        write (*it->second, nullptr, 0);
+}
+
+void
+IEC61850EntryIdStore::flush ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    if (m_map)
+        msync (m_map, m_mapSize, MS_ASYNC);
+}
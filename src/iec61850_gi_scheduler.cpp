@@ -0,0 +1,111 @@
+#include "iec61850_gi_scheduler.hpp"
+
+IEC61850GiScheduler::IEC61850GiScheduler (
+    int concurrency, uint64_t spacingMs,
+    const std::vector<std::string>& priorities)
+    : m_concurrency (concurrency < 1 ? 1 : concurrency), m_spacing (spacingMs),
+      m_priorities (priorities)
+{
+}
+
+int
+IEC61850GiScheduler::priority (const std::string& rcbRef) const
+{
+    std::string ld = rcbRef.substr (0, rcbRef.find ('/'));
+
+    for (size_t i = 0; i < m_priorities.size (); i++)
+    {
+        if (ld.compare (0, m_priorities[i].size (), m_priorities[i]) == 0)
+            return (int)i;
+    }
+
+    return (int)m_priorities.size ();
+}
+
+void
+IEC61850GiScheduler::request (const std::string& rcbRef)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    if (!m_queued.insert (rcbRef).second)
+        return;
+
+    m_queue.push_back ({ rcbRef, priority (rcbRef), m_nextOrder++ });
+}
+
+std::vector<std::string>
+IEC61850GiScheduler::due (uint64_t currentTime)
+{
+    std::vector<std::string> rcbRefs;
+
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    while (!m_queue.empty ()
+           && (int)m_outstanding.size () < m_concurrency
+           && (!m_sent || currentTime >= m_lastSent + m_spacing))
+    {
+        /* a new GI on an RCB waits for the previous one */
+        auto next = m_queue.end ();
+
+        for (auto it = m_queue.begin (); it != m_queue.end (); it++)
+        {
+            if (m_outstanding.count (it->rcbRef))
+                continue;
+
+            if (next == m_queue.end () || it->priority < next->priority
+                || (it->priority == next->priority && it->order < next->order))
+                next = it;
+        }
+
+        if (next == m_queue.end ())
+            break;
+
+        rcbRefs.push_back (next->rcbRef);
+        m_outstanding.insert (next->rcbRef);
+        m_queued.erase (next->rcbRef);
+        m_queue.erase (next);
+
+        m_lastSent = currentTime;
+        m_sent = true;
+
+        if (m_spacing > 0)
+            break;
+    }
+
+    return rcbRefs;
+}
+
+void
+IEC61850GiScheduler::done (const std::string& rcbRef)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    m_outstanding.erase (rcbRef);
+}
+
+void
+IEC61850GiScheduler::clear ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    m_queue.clear ();
+    m_queued.clear ();
+    m_outstanding.clear ();
+    m_sent = false;
+}
+
+size_t
+IEC61850GiScheduler::pending ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    return m_queue.size ();
+}
+
+size_t
+IEC61850GiScheduler::outstanding ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    return m_outstanding.size ();
+}
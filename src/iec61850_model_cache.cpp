@@ -0,0 +1,571 @@
+#include "iec61850_model_cache.hpp"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <utils.h>
+
+#define MODEL_CACHE_VERSION 1
+#define MODEL_CACHE_DIR "/iec61850/"
+
+#define JSON_CACHE_VERSION "version"
+#define JSON_CACHE_REVISIONS "revisions"
+#define JSON_CACHE_SPECS "specs"
+#define JSON_CACHE_CTL_MODELS "ctlModels"
+#define JSON_CACHE_DATASETS "datasets"
+
+using namespace rapidjson;
+
+/*
+ * Specifications are stored as [type, name, typeSpec] where typeSpec is
+ * the list of children for structures, [count, elementSpec] for arrays,
+ * [exponentWidth, formatWidth] for floats and the size otherwise.
+ */
+static void
+writeSpec (Writer<StringBuffer>& writer, const MmsVariableSpecification* spec)
+{
+    writer.StartArray ();
+    writer.Int (spec->type);
+    writer.String (spec->name ? spec->name : "");
+
+    switch (spec->type)
+    {
+    case MMS_STRUCTURE:
+        writer.StartArray ();
+        for (int i = 0; i < spec->typeSpec.structure.elementCount; i++)
+        {
+            writeSpec (writer, spec->typeSpec.structure.elements[i]);
+        }
+        writer.EndArray ();
+        break;
+    case MMS_ARRAY:
+        writer.StartArray ();
+        writer.Int (spec->typeSpec.array.elementCount);
+        writeSpec (writer, spec->typeSpec.array.elementTypeSpec);
+        writer.EndArray ();
+        break;
+    case MMS_FLOAT:
+        writer.StartArray ();
+        writer.Int (spec->typeSpec.floatingpoint.exponentWidth);
+        writer.Int (spec->typeSpec.floatingpoint.formatWidth);
+        writer.EndArray ();
+        break;
+    default:
+        writer.Int (spec->typeSpec.integer);
+        break;
+    }
+
+    writer.EndArray ();
+}
+
+static MmsVariableSpecification*
+readSpec (const Value& value)
+{
+    if (!value.IsArray () || value.Size () != 3 || !value[SizeType (0)].IsInt ()
+        || !value[SizeType (1)].IsString ())
+        return nullptr;
+
+    auto spec = static_cast<MmsVariableSpecification*> (
+        calloc (1, sizeof (MmsVariableSpecification)));
+
+    spec->type = static_cast<MmsType> (value[SizeType (0)].GetInt ());
+    spec->name = value[SizeType (1)].GetStringLength () > 0
+                     ? strdup (value[SizeType (1)].GetString ())
+                     : nullptr;
+
+    const Value& typeSpec = value[SizeType (2)];
+    bool valid = true;
+
+    switch (spec->type)
+    {
+    case MMS_STRUCTURE: {
+        if (!typeSpec.IsArray ())
+        {
+            valid = false;
+            break;
+        }
+
+        int count = typeSpec.Size ();
+        spec->typeSpec.structure.elements
+            = static_cast<MmsVariableSpecification**> (
+                calloc (count > 0 ? count : 1,
+                        sizeof (MmsVariableSpecification*)));
+
+        for (int i = 0; i < count; i++)
+        {
+            MmsVariableSpecification* child = readSpec (typeSpec[SizeType (i)]);
+            if (!child)
+            {
+                valid = false;
+                break;
+            }
+            spec->typeSpec.structure.elements[i] = child;
+            spec->typeSpec.structure.elementCount++;
+        }
+        break;
+    }
+    case MMS_ARRAY:
+        if (!typeSpec.IsArray () || typeSpec.Size () != 2
+            || !typeSpec[SizeType (0)].IsInt ())
+        {
+            valid = false;
+            break;
+        }
+        spec->typeSpec.array.elementTypeSpec = readSpec (typeSpec[SizeType (1)]);
+        if (!spec->typeSpec.array.elementTypeSpec)
+        {
+            valid = false;
+            break;
+        }
+        spec->typeSpec.array.elementCount = typeSpec[SizeType (0)].GetInt ();
+        break;
+    case MMS_FLOAT:
+        if (!typeSpec.IsArray () || typeSpec.Size () != 2
+            || !typeSpec[SizeType (0)].IsInt () || !typeSpec[SizeType (1)].IsInt ())
+        {
+            valid = false;
+            break;
+        }
+        spec->typeSpec.floatingpoint.exponentWidth = typeSpec[SizeType (0)].GetInt ();
+        spec->typeSpec.floatingpoint.formatWidth = typeSpec[SizeType (1)].GetInt ();
+        break;
+    default:
+        if (!typeSpec.IsInt ())
+        {
+            valid = false;
+            break;
+        }
+        spec->typeSpec.integer = typeSpec.GetInt ();
+        break;
+    }
+
+    if (!valid)
+    {
+        if (spec->type == MMS_ARRAY
+            && spec->typeSpec.array.elementTypeSpec == nullptr)
+            spec->type = MMS_BOOLEAN;
+
+        MmsVariableSpecification_destroy (spec);
+        return nullptr;
+    }
+
+    return spec;
+}
+
+MmsVariableSpecification*
+IEC61850ModelCache::copySpec (const MmsVariableSpecification* spec)
+{
+    if (!spec)
+        return nullptr;
+
+    auto copy = static_cast<MmsVariableSpecification*> (
+        calloc (1, sizeof (MmsVariableSpecification)));
+
+    copy->type = spec->type;
+    copy->name = spec->name ? strdup (spec->name) : nullptr;
+    copy->typeSpec = spec->typeSpec;
+
+    if (spec->type == MMS_STRUCTURE)
+    {
+        int count = spec->typeSpec.structure.elementCount;
+
+        copy->typeSpec.structure.elements
+            = static_cast<MmsVariableSpecification**> (
+                calloc (count > 0 ? count : 1,
+                        sizeof (MmsVariableSpecification*)));
+
+        for (int i = 0; i < count; i++)
+        {
+            copy->typeSpec.structure.elements[i]
+                = copySpec (spec->typeSpec.structure.elements[i]);
+        }
+    }
+    else if (spec->type == MMS_ARRAY)
+    {
+        copy->typeSpec.array.elementTypeSpec
+            = copySpec (spec->typeSpec.array.elementTypeSpec);
+    }
+
+    return copy;
+}
+
+IEC61850ModelCache::IEC61850ModelCache (const std::string& fileName)
+    : m_fileName (fileName)
+{
+}
+
+IEC61850ModelCache::~IEC61850ModelCache () { clear (); }
+
+std::string
+IEC61850ModelCache::cacheFileName (const std::string& iedName,
+                                   const std::string& ip, int port)
+{
+    std::string name = iedName + "_" + ip + "_" + std::to_string (port);
+
+    for (char& c : name)
+    {
+        if (!isalnum (c) && c != '_' && c != '-')
+            c = '_';
+    }
+
+    std::string cacheDir = getDataDir () + MODEL_CACHE_DIR;
+
+    if (mkdir (cacheDir.c_str (), 0755) != 0 && errno != EEXIST)
+    {
+        Iec61850Utility::log_warn ("Failed to create model cache directory %s",
+                                   cacheDir.c_str ());
+    }
+
+    return cacheDir + "model_" + name + ".json";
+}
+
+std::string
+IEC61850ModelCache::specKey (const std::string& objRef,
+                             FunctionalConstraint fc)
+{
+    return objRef + "[" + FunctionalConstraint_toString (fc) + "]";
+}
+
+void
+IEC61850ModelCache::clear ()
+{
+    for (auto& entry : m_specs)
+    {
+        MmsVariableSpecification_destroy (entry.second);
+    }
+
+    m_specs.clear ();
+    m_ctlModels.clear ();
+    m_datasets.clear ();
+    m_revisions.clear ();
+}
+
+bool
+IEC61850ModelCache::load ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    m_loaded = true;
+
+    std::ifstream file (m_fileName);
+
+    if (!file.is_open ())
+        return false;
+
+    std::stringstream content;
+    content << file.rdbuf ();
+
+    Document document;
+
+    if (document.Parse (content.str ().c_str ()).HasParseError ()
+        || !document.IsObject ())
+    {
+        Iec61850Utility::log_warn ("Model cache %s is corrupted -> ignore",
+                                   m_fileName.c_str ());
+        return false;
+    }
+
+    if (!document.HasMember (JSON_CACHE_VERSION)
+        || !document[JSON_CACHE_VERSION].IsInt ()
+        || document[JSON_CACHE_VERSION].GetInt () != MODEL_CACHE_VERSION)
+    {
+        Iec61850Utility::log_info ("Model cache %s has another version -> "
+                                   "ignore",
+                                   m_fileName.c_str ());
+        return false;
+    }
+
+    clear ();
+
+    if (document.HasMember (JSON_CACHE_REVISIONS)
+        && document[JSON_CACHE_REVISIONS].IsObject ())
+    {
+        const Value& revisions = document[JSON_CACHE_REVISIONS];
+        for (auto it = revisions.MemberBegin (); it != revisions.MemberEnd ();
+             ++it)
+        {
+            if (it->value.IsString ())
+                m_revisions[it->name.GetString ()] = it->value.GetString ();
+        }
+    }
+
+    if (document.HasMember (JSON_CACHE_SPECS)
+        && document[JSON_CACHE_SPECS].IsObject ())
+    {
+        const Value& specs = document[JSON_CACHE_SPECS];
+        for (auto it = specs.MemberBegin (); it != specs.MemberEnd (); ++it)
+        {
+            MmsVariableSpecification* spec = readSpec (it->value);
+            if (spec)
+                m_specs[it->name.GetString ()] = spec;
+        }
+    }
+
+    if (document.HasMember (JSON_CACHE_CTL_MODELS)
+        && document[JSON_CACHE_CTL_MODELS].IsObject ())
+    {
+        const Value& ctlModels = document[JSON_CACHE_CTL_MODELS];
+        for (auto it = ctlModels.MemberBegin (); it != ctlModels.MemberEnd ();
+             ++it)
+        {
+            if (it->value.IsInt ())
+                m_ctlModels[it->name.GetString ()] = it->value.GetInt ();
+        }
+    }
+
+    if (document.HasMember (JSON_CACHE_DATASETS)
+        && document[JSON_CACHE_DATASETS].IsObject ())
+    {
+        const Value& datasets = document[JSON_CACHE_DATASETS];
+        for (auto it = datasets.MemberBegin (); it != datasets.MemberEnd ();
+             ++it)
+        {
+            if (!it->value.IsArray ())
+                continue;
+
+            std::vector<std::string>& entries
+                = m_datasets[it->name.GetString ()];
+
+            for (const Value& entry : it->value.GetArray ())
+            {
+                if (entry.IsString ())
+                    entries.push_back (entry.GetString ());
+            }
+        }
+    }
+
+    m_dirty = false;
+
+    Iec61850Utility::log_info ("Loaded model cache %s (%d specifications)",
+                               m_fileName.c_str (), (int)m_specs.size ());
+
+    return true;
+}
+
+bool
+IEC61850ModelCache::save ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    if (!m_dirty)
+        return true;
+
+    StringBuffer buffer;
+    Writer<StringBuffer> writer (buffer);
+
+    writer.StartObject ();
+    writer.Key (JSON_CACHE_VERSION);
+    writer.Int (MODEL_CACHE_VERSION);
+
+    writer.Key (JSON_CACHE_REVISIONS);
+    writer.StartObject ();
+    for (const auto& revision : m_revisions)
+    {
+        writer.Key (revision.first.c_str ());
+        writer.String (revision.second.c_str ());
+    }
+    writer.EndObject ();
+
+    writer.Key (JSON_CACHE_SPECS);
+    writer.StartObject ();
+    for (const auto& spec : m_specs)
+    {
+        writer.Key (spec.first.c_str ());
+        writeSpec (writer, spec.second);
+    }
+    writer.EndObject ();
+
+    writer.Key (JSON_CACHE_CTL_MODELS);
+    writer.StartObject ();
+    for (const auto& ctlModel : m_ctlModels)
+    {
+        writer.Key (ctlModel.first.c_str ());
+        writer.Int (ctlModel.second);
+    }
+    writer.EndObject ();
+
+    writer.Key (JSON_CACHE_DATASETS);
+    writer.StartObject ();
+    for (const auto& dataset : m_datasets)
+    {
+        writer.Key (dataset.first.c_str ());
+        writer.StartArray ();
+        for (const auto& entry : dataset.second)
+        {
+            writer.String (entry.c_str ());
+        }
+        writer.EndArray ();
+    }
+    writer.EndObject ();
+
+    writer.EndObject ();
+
+    /* write to a temporary file first so a crash never leaves a torn cache */
+    std::string tmpFileName = m_fileName + ".tmp";
+
+    {
+        std::ofstream file (tmpFileName, std::ios::trunc);
+
+        if (!file.is_open ())
+        {
+            Iec61850Utility::log_warn ("Failed to write model cache %s",
+                                       tmpFileName.c_str ());
+            return false;
+        }
+
+        file.write (buffer.GetString (), buffer.GetSize ());
+
+        if (!file.good ())
+        {
+            Iec61850Utility::log_warn ("Failed to write model cache %s",
+                                       tmpFileName.c_str ());
+            return false;
+        }
+    }
+
+    if (rename (tmpFileName.c_str (), m_fileName.c_str ()) != 0)
+    {
+        Iec61850Utility::log_warn ("Failed to replace model cache %s",
+                                   m_fileName.c_str ());
+        return false;
+    }
+
+    m_dirty = false;
+
+    return true;
+}
+
+bool
+IEC61850ModelCache::matches (const Revisions& revisions)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    if (m_revisions.empty () || m_revisions.size () != revisions.size ())
+        return false;
+
+    for (const auto& entry : revisions)
+    {
+        auto it = m_revisions.find (entry.first);
+
+        if (it == m_revisions.end ())
+            return false;
+
+        if (it->second == entry.second)
+            continue;
+
+        /*
+         * a cache seeded from an SCL file only knows configRev, paramRev
+         * is then not compared
+         */
+        size_t cachedEnd = it->second.find ('/');
+        size_t end = entry.second.find ('/');
+
+        if ((cachedEnd != std::string::npos && end != std::string::npos)
+            || it->second.substr (0, cachedEnd)
+                   != entry.second.substr (0, end))
+            return false;
+    }
+
+    return true;
+}
+
+void
+IEC61850ModelCache::reset (const Revisions& revisions)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    clear ();
+    m_revisions = revisions;
+    m_dirty = true;
+}
+
+MmsVariableSpecification*
+IEC61850ModelCache::getSpec (const std::string& objRef,
+                             FunctionalConstraint fc)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_specs.find (specKey (objRef, fc));
+
+    if (it == m_specs.end ())
+        return nullptr;
+
+    return copySpec (it->second);
+}
+
+void
+IEC61850ModelCache::setSpec (const std::string& objRef,
+                             FunctionalConstraint fc,
+                             const MmsVariableSpecification* spec)
+{
+    if (!spec)
+        return;
+
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    std::string key = specKey (objRef, fc);
+
+    auto it = m_specs.find (key);
+
+    if (it != m_specs.end ())
+        MmsVariableSpecification_destroy (it->second);
+
+    m_specs[key] = copySpec (spec);
+    m_dirty = true;
+}
+
+bool
+IEC61850ModelCache::getCtlModel (const std::string& objRef,
+                                 ControlModel& model)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_ctlModels.find (objRef);
+
+    if (it == m_ctlModels.end ())
+        return false;
+
+    model = static_cast<ControlModel> (it->second);
+    return true;
+}
+
+void
+IEC61850ModelCache::setCtlModel (const std::string& objRef,
+                                 ControlModel model)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    m_ctlModels[objRef] = model;
+    m_dirty = true;
+}
+
+bool
+IEC61850ModelCache::getDatasetDirectory (const std::string& datasetRef,
+                                         std::vector<std::string>& entries)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_datasets.find (datasetRef);
+
+    if (it == m_datasets.end ())
+        return false;
+
+    entries = it->second;
+    return true;
+}
+
+void
+IEC61850ModelCache::setDatasetDirectory (
+    const std::string& datasetRef, const std::vector<std::string>& entries)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    m_datasets[datasetRef] = entries;
+    m_dirty = true;
+}
@@ -0,0 +1,402 @@
+#include "iec61850_pivot_command.hpp"
+#include "rapidjson/reader.h"
+#include <cstring>
+
+using namespace rapidjson;
+
+struct CdcName
+{
+    const char* name;
+    CDCTYPE type;
+};
+
+static const CdcName cdcNames[]
+    = { { "SpsTyp", SPS }, { "DpsTyp", DPS }, { "BscTyp", BSC },
+        { "MvTyp", MV },   { "SpcTyp", SPC }, { "DpcTyp", DPC },
+        { "ApcTyp", APC }, { "IncTyp", INC }, { "InsTyp", INS },
+        { "SpgTyp", SPG }, { "EnsTyp", ENS }, { "AsgTyp", ASG },
+        { "IngTyp", ING } };
+
+static bool
+keyIs (const char* str, SizeType len, const char* key)
+{
+    return len == strlen (key) && memcmp (str, key, len) == 0;
+}
+
+static const CdcName*
+findCdc (const char* str, SizeType len)
+{
+    /* every cdc name ends with "Typ" */
+    if (len < 4 || memcmp (str + len - 3, "Typ", 3) != 0)
+        return nullptr;
+
+    for (const auto& cdc : cdcNames)
+    {
+        if (keyIs (str, len, cdc.name))
+            return &cdc;
+    }
+
+    return nullptr;
+}
+
+class PivotCommandHandler
+    : public BaseReaderHandler<UTF8<>, PivotCommandHandler>
+{
+  public:
+    explicit PivotCommandHandler (IEC61850PivotCommand& command)
+        : m_command (command)
+    {
+    }
+
+    bool StartObject ();
+    bool EndObject (SizeType memberCount);
+    bool StartArray ();
+    bool EndArray (SizeType elementCount);
+    bool Key (const char* str, SizeType len, bool copy);
+    bool String (const char* str, SizeType len, bool copy);
+    bool Bool (bool b);
+    bool Int (int i);
+    bool Uint (unsigned u);
+    bool Int64 (int64_t i);
+    bool Uint64 (uint64_t u);
+    bool Double (double d);
+    bool Default ();
+
+  private:
+    enum State
+    {
+        ROOT,
+        DOCUMENT,
+        COMMAND,
+        CDC,
+        MAG,
+        DONE
+    };
+
+    enum Field
+    {
+        FIELD_NONE,
+        FIELD_COMMAND,
+        FIELD_IDENTIFIER,
+        FIELD_CDC,
+        FIELD_CTL_VAL,
+        FIELD_SET_VAL,
+        FIELD_SET_MAG,
+        FIELD_MAG_F
+    };
+
+    bool object ();
+    bool number (long intValue, double floatValue, bool isInteger);
+
+    IEC61850PivotCommand::Value* valueOf (Field field);
+
+    IEC61850PivotCommand& m_command;
+
+    State m_state = ROOT;
+    Field m_field = FIELD_NONE;
+    int m_skipDepth = 0;
+};
+
+IEC61850PivotCommand::Value*
+PivotCommandHandler::valueOf (Field field)
+{
+    switch (field)
+    {
+    case FIELD_CTL_VAL:
+        return &m_command.ctlVal;
+    case FIELD_SET_VAL:
+        return &m_command.setVal;
+    case FIELD_MAG_F:
+        return &m_command.setMag;
+    default:
+        return nullptr;
+    }
+}
+
+bool
+PivotCommandHandler::object ()
+{
+    Field field = m_field;
+    m_field = FIELD_NONE;
+
+    switch (field)
+    {
+    case FIELD_NONE:
+        if (m_state != ROOT)
+            break;
+        m_state = DOCUMENT;
+        return true;
+    case FIELD_COMMAND:
+        m_state = COMMAND;
+        return true;
+    case FIELD_CDC:
+        m_state = CDC;
+        return true;
+    case FIELD_SET_MAG:
+        m_state = MAG;
+        return true;
+    default:
+        break;
+    }
+
+    m_skipDepth = 1;
+    return true;
+}
+
+bool
+PivotCommandHandler::StartObject ()
+{
+    if (m_skipDepth > 0)
+    {
+        m_skipDepth++;
+        return true;
+    }
+
+    return object ();
+}
+
+bool
+PivotCommandHandler::StartArray ()
+{
+    if (m_skipDepth > 0)
+    {
+        m_skipDepth++;
+        return true;
+    }
+
+    m_field = FIELD_NONE;
+    m_skipDepth = 1;
+    return true;
+}
+
+bool
+PivotCommandHandler::EndObject (SizeType memberCount)
+{
+    if (m_skipDepth > 0)
+    {
+        m_skipDepth--;
+        return true;
+    }
+
+    switch (m_state)
+    {
+    case COMMAND:
+        m_state = DONE;
+        break;
+    case CDC:
+        m_state = COMMAND;
+        break;
+    case MAG:
+        m_state = CDC;
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+bool
+PivotCommandHandler::EndArray (SizeType elementCount)
+{
+    if (m_skipDepth > 0)
+        m_skipDepth--;
+
+    return true;
+}
+
+bool
+PivotCommandHandler::Key (const char* str, SizeType len, bool copy)
+{
+    if (m_skipDepth > 0)
+        return true;
+
+    m_field = FIELD_NONE;
+
+    switch (m_state)
+    {
+    case DOCUMENT:
+        /* the command is the first element, like GTIC */
+        m_field = FIELD_COMMAND;
+        m_state = DONE;
+        break;
+    case COMMAND:
+        if (keyIs (str, len, "Identifier"))
+        {
+            m_field = FIELD_IDENTIFIER;
+        }
+        else if (m_command.cdcType == -1)
+        {
+            const CdcName* cdc = findCdc (str, len);
+
+            if (cdc)
+            {
+                m_command.cdcType = cdc->type;
+                m_command.cdcName = cdc->name;
+                m_field = FIELD_CDC;
+            }
+        }
+        break;
+    case CDC:
+        if (keyIs (str, len, "ctlVal"))
+            m_field = FIELD_CTL_VAL;
+        else if (keyIs (str, len, "setVal"))
+            m_field = FIELD_SET_VAL;
+        else if (keyIs (str, len, "setMag"))
+            m_field = FIELD_SET_MAG;
+        break;
+    case MAG:
+        if (keyIs (str, len, "f"))
+            m_field = FIELD_MAG_F;
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+bool
+PivotCommandHandler::String (const char* str, SizeType len, bool copy)
+{
+    if (m_skipDepth > 0)
+        return true;
+
+    Field field = m_field;
+    m_field = FIELD_NONE;
+
+    if (field == FIELD_IDENTIFIER)
+    {
+        if (copy)
+        {
+            m_command.m_identifier.assign (str, len);
+            str = m_command.m_identifier.c_str ();
+        }
+
+        m_command.identifier = str;
+        m_command.identifierLength = len;
+    }
+    else if (field == FIELD_CTL_VAL)
+    {
+        /* only the steps of a BSC are strings */
+        if (copy)
+        {
+            m_command.m_str.assign (str, len);
+            str = m_command.m_str.c_str ();
+        }
+
+        m_command.ctlVal.type = IEC61850PivotCommand::Value::STRING;
+        m_command.ctlVal.str = str;
+        m_command.ctlVal.length = len;
+    }
+
+    return true;
+}
+
+bool
+PivotCommandHandler::number (long intValue, double floatValue,
+                             bool isInteger)
+{
+    if (m_skipDepth > 0)
+        return true;
+
+    Field field = m_field;
+    m_field = FIELD_NONE;
+
+    IEC61850PivotCommand::Value* value = valueOf (field);
+
+    if (value)
+    {
+        value->type = isInteger ? IEC61850PivotCommand::Value::INTEGER
+                                : IEC61850PivotCommand::Value::FLOAT;
+        value->intValue = intValue;
+        value->floatValue = floatValue;
+    }
+
+    return true;
+}
+
+bool
+PivotCommandHandler::Bool (bool b)
+{
+    return number (b ? 1 : 0, b ? 1 : 0, true);
+}
+
+bool
+PivotCommandHandler::Int (int i)
+{
+    return number (i, i, true);
+}
+
+bool
+PivotCommandHandler::Uint (unsigned u)
+{
+    return number (u, u, true);
+}
+
+bool
+PivotCommandHandler::Int64 (int64_t i)
+{
+    return number ((long)i, (double)i, true);
+}
+
+bool
+PivotCommandHandler::Uint64 (uint64_t u)
+{
+    return number ((long)u, (double)u, true);
+}
+
+bool
+PivotCommandHandler::Double (double d)
+{
+    return number ((long)d, d, false);
+}
+
+bool
+PivotCommandHandler::Default ()
+{
+    if (m_skipDepth == 0)
+        m_field = FIELD_NONE;
+
+    return true;
+}
+
+void
+IEC61850PivotCommand::reset ()
+{
+    identifier = nullptr;
+    identifierLength = 0;
+    cdcType = -1;
+    cdcName = nullptr;
+    ctlVal = Value ();
+    setVal = Value ();
+    setMag = Value ();
+    def = nullptr;
+}
+
+bool
+IEC61850PivotCommand::decode (char* json)
+{
+    reset ();
+
+    PivotCommandHandler handler (*this);
+    InsituStringStream stream (json);
+    Reader reader;
+
+    return !reader.Parse<kParseInsituFlag> (stream, handler).IsError ();
+}
+
+const IEC61850PivotCommand::Value&
+IEC61850PivotCommand::value () const
+{
+    switch (cdcType)
+    {
+    case ASG:
+        return setMag;
+    case ING:
+    case SPG:
+        return setVal;
+    default:
+        return ctlVal;
+    }
+}
@@ -0,0 +1,202 @@
+#include "iec61850_reactor.hpp"
+#include "iec61850_utility.hpp"
+#include <algorithm>
+#include <libiec61850/hal_thread.h>
+#include <time.h>
+
+#define REACTOR_IDLE_SLEEP_MS 2
+
+static uint64_t
+getMonotonicTimeInMs ()
+{
+    uint64_t timeVal = 0;
+
+    struct timespec ts;
+
+    if (clock_gettime (CLOCK_MONOTONIC, &ts) == 0)
+    {
+        timeVal = ((uint64_t)ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000);
+    }
+
+    return timeVal;
+}
+
+IEC61850Reactor::IEC61850Reactor (int threads)
+{
+    if (threads < 1)
+        threads = 1;
+
+    for (int i = 0; i < threads; i++)
+    {
+        m_workers.push_back (new Worker ());
+    }
+}
+
+IEC61850Reactor::~IEC61850Reactor ()
+{
+    stop ();
+
+    for (auto worker : m_workers)
+    {
+        delete worker;
+    }
+
+    m_workers.clear ();
+}
+
+void
+IEC61850Reactor::start ()
+{
+    if (m_started)
+        return;
+
+    m_started = true;
+
+    for (auto worker : m_workers)
+    {
+        worker->thread
+            = new std::thread (&IEC61850Reactor::_workerThread, this, worker);
+    }
+
+    Iec61850Utility::log_info ("Reactor started with %d thread(s)",
+                               (int)m_workers.size ());
+}
+
+void
+IEC61850Reactor::stop ()
+{
+    if (!m_started)
+        return;
+
+    m_started = false;
+
+    for (auto worker : m_workers)
+    {
+        if (worker->thread)
+        {
+            worker->thread->join ();
+            delete worker->thread;
+            worker->thread = nullptr;
+        }
+    }
+}
+
+IEC61850Reactor::Worker*
+IEC61850Reactor::workerForAffinity (const void* affinity)
+{
+    auto it = m_affinities.find (affinity);
+
+    if (it != m_affinities.end ())
+    {
+        it->second.tasks++;
+        return it->second.worker;
+    }
+
+    std::vector<int> load (m_workers.size (), 0);
+
+    for (const auto& entry : m_affinities)
+    {
+        auto pos = std::find (m_workers.begin (), m_workers.end (),
+                              entry.second.worker);
+        load[pos - m_workers.begin ()] += entry.second.tasks;
+    }
+
+    size_t leastLoaded
+        = std::min_element (load.begin (), load.end ()) - load.begin ();
+
+    m_affinities[affinity] = { m_workers[leastLoaded], 1 };
+
+    return m_workers[leastLoaded];
+}
+
+int
+IEC61850Reactor::addTask (const Task& task, uint64_t intervalMs,
+                          const void* affinity)
+{
+    Worker* worker;
+    int taskId;
+
+    {
+        std::lock_guard<std::mutex> lock (m_taskLock);
+        worker = workerForAffinity (affinity);
+        taskId = m_nextTaskId++;
+        m_taskAffinities[taskId] = affinity;
+    }
+
+    std::lock_guard<std::mutex> lock (worker->lock);
+    worker->tasks.push_back ({ taskId, task, intervalMs, 0 });
+
+    return taskId;
+}
+
+void
+IEC61850Reactor::removeTask (int taskId)
+{
+    Worker* worker;
+
+    {
+        std::lock_guard<std::mutex> lock (m_taskLock);
+
+        auto it = m_taskAffinities.find (taskId);
+
+        if (it == m_taskAffinities.end ())
+            return;
+
+        auto affinity = m_affinities.find (it->second);
+        worker = affinity->second.worker;
+
+        if (--affinity->second.tasks == 0)
+            m_affinities.erase (affinity);
+
+        m_taskAffinities.erase (it);
+    }
+
+    /* waits for the worker to leave the task if it is currently running */
+    std::lock_guard<std::mutex> lock (worker->lock);
+
+    worker->tasks.erase (
+        std::remove_if (worker->tasks.begin (), worker->tasks.end (),
+                        [taskId] (const ReactorTask& task) {
+                            return task.id == taskId;
+                        }),
+        worker->tasks.end ());
+}
+
+void
+IEC61850Reactor::_workerThread (Worker* worker)
+{
+    while (m_started)
+    {
+        bool busy = false;
+
+        {
+            std::lock_guard<std::mutex> lock (worker->lock);
+
+            uint64_t currentTime = getMonotonicTimeInMs ();
+
+            for (auto& task : worker->tasks)
+            {
+                if (currentTime < task.nextRun)
+                    continue;
+
+                task.nextRun = currentTime + task.intervalMs;
+
+                try
+                {
+                    if (task.task ())
+                        busy = true;
+                }
+                // LCOV_EXCL_START
+                catch (const std::exception& e)
+                {
+                    Iec61850Utility::log_error (
+                        "Exception caught in reactor task: %s", e.what ());
+                }
+                // LCOV_EXCL_STOP
+            }
+        }
+
+        if (!busy)
+            Thread_sleep (REACTOR_IDLE_SLEEP_MS);
+    }
+}
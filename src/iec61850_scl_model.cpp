@@ -0,0 +1,1084 @@
+#include "iec61850_scl_model.hpp"
+#include "iec61850_utility.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+struct BasicType
+{
+    MmsType type;
+    int size;
+};
+
+/* MMS mapping of the SCL basic types, sizes as in libiec61850 */
+static const std::unordered_map<std::string, BasicType> basicTypes
+    = { { "BOOLEAN", { MMS_BOOLEAN, 0 } },
+        { "INT8", { MMS_INTEGER, 8 } },
+        { "INT16", { MMS_INTEGER, 16 } },
+        { "INT24", { MMS_INTEGER, 24 } },
+        { "INT32", { MMS_INTEGER, 32 } },
+        { "INT64", { MMS_INTEGER, 64 } },
+        { "INT8U", { MMS_UNSIGNED, 8 } },
+        { "INT16U", { MMS_UNSIGNED, 16 } },
+        { "INT24U", { MMS_UNSIGNED, 24 } },
+        { "INT32U", { MMS_UNSIGNED, 32 } },
+        { "FLOAT32", { MMS_FLOAT, 32 } },
+        { "FLOAT64", { MMS_FLOAT, 64 } },
+        { "Enum", { MMS_INTEGER, 8 } },
+        { "Dbpos", { MMS_BIT_STRING, 2 } },
+        { "Tcmd", { MMS_BIT_STRING, 2 } },
+        { "Check", { MMS_BIT_STRING, 2 } },
+        { "Quality", { MMS_BIT_STRING, 13 } },
+        { "TrgOps", { MMS_BIT_STRING, 6 } },
+        { "OptFlds", { MMS_BIT_STRING, 10 } },
+        { "Timestamp", { MMS_UTC_TIME, 0 } },
+        { "EntryTime", { MMS_BINARY_TIME, 6 } },
+        { "EntryID", { MMS_OCTET_STRING, 8 } },
+        { "Octet64", { MMS_OCTET_STRING, -64 } },
+        { "VisString32", { MMS_VISIBLE_STRING, -32 } },
+        { "VisString64", { MMS_VISIBLE_STRING, -64 } },
+        { "VisString65", { MMS_VISIBLE_STRING, -65 } },
+        { "VisString129", { MMS_VISIBLE_STRING, -129 } },
+        { "VisString255", { MMS_VISIBLE_STRING, -255 } },
+        { "ObjRef", { MMS_VISIBLE_STRING, -129 } },
+        { "Currency", { MMS_VISIBLE_STRING, -3 } },
+        { "Unicode255", { MMS_STRING, -255 } } };
+
+static const std::unordered_map<std::string, int> ctlModels
+    = { { "status-only", CONTROL_MODEL_STATUS_ONLY },
+        { "direct-with-normal-security", CONTROL_MODEL_DIRECT_NORMAL },
+        { "sbo-with-normal-security", CONTROL_MODEL_SBO_NORMAL },
+        { "direct-with-enhanced-security", CONTROL_MODEL_DIRECT_ENHANCED },
+        { "sbo-with-enhanced-security", CONTROL_MODEL_SBO_ENHANCED } };
+
+static MmsVariableSpecification*
+newSpec (const std::string& name, MmsType type)
+{
+    auto spec = static_cast<MmsVariableSpecification*> (
+        calloc (1, sizeof (MmsVariableSpecification)));
+
+    spec->type = type;
+    spec->name = name.empty () ? nullptr : strdup (name.c_str ());
+
+    return spec;
+}
+
+static MmsVariableSpecification*
+newStructureSpec (const std::string& name,
+                  const std::vector<MmsVariableSpecification*>& elements)
+{
+    MmsVariableSpecification* spec = newSpec (name, MMS_STRUCTURE);
+
+    spec->typeSpec.structure.elementCount = (int)elements.size ();
+    spec->typeSpec.structure.elements
+        = static_cast<MmsVariableSpecification**> (calloc (
+            elements.size () + 1, sizeof (MmsVariableSpecification*)));
+
+    for (size_t i = 0; i < elements.size (); i++)
+    {
+        spec->typeSpec.structure.elements[i] = elements[i];
+    }
+
+    return spec;
+}
+
+static void
+destroySpecs (std::vector<MmsVariableSpecification*>& specs)
+{
+    for (auto spec : specs)
+        MmsVariableSpecification_destroy (spec);
+
+    specs.clear ();
+}
+
+/* minimal XML reader, enough for SCL files */
+
+static void
+skipSpaces (const char*& p, const char* end)
+{
+    while (p < end && isspace ((unsigned char)*p))
+        p++;
+}
+
+static bool
+skipPast (const char*& p, const char* end, const char* token)
+{
+    const char* found = strstr (p, token);
+
+    if (!found || found >= end)
+        return false;
+
+    p = found + strlen (token);
+    return true;
+}
+
+static void
+appendUtf8 (std::string& str, unsigned long code)
+{
+    if (code < 0x80)
+    {
+        str += (char)code;
+    }
+    else if (code < 0x800)
+    {
+        str += (char)(0xc0 | (code >> 6));
+        str += (char)(0x80 | (code & 0x3f));
+    }
+    else if (code < 0x10000)
+    {
+        str += (char)(0xe0 | (code >> 12));
+        str += (char)(0x80 | ((code >> 6) & 0x3f));
+        str += (char)(0x80 | (code & 0x3f));
+    }
+    else
+    {
+        str += (char)(0xf0 | (code >> 18));
+        str += (char)(0x80 | ((code >> 12) & 0x3f));
+        str += (char)(0x80 | ((code >> 6) & 0x3f));
+        str += (char)(0x80 | (code & 0x3f));
+    }
+}
+
+/* &#NNN; or &#xHHH; at p, returns its length or 0 */
+static size_t
+decodeCharReference (const char* p, const char* end, std::string& decoded)
+{
+    const char* q = p + 2;
+    int base = 10;
+
+    if (end - p < 4 || p[1] != '#')
+        return 0;
+
+    if (*q == 'x')
+    {
+        base = 16;
+        q++;
+    }
+
+    const char* digits = q;
+    unsigned long code = 0;
+
+    while (q < end && *q != ';')
+    {
+        if (!(base == 16 ? isxdigit ((unsigned char)*q)
+                         : isdigit ((unsigned char)*q)))
+            return 0;
+
+        code = code * base
+               + (isdigit ((unsigned char)*q)
+                      ? *q - '0'
+                      : tolower ((unsigned char)*q) - 'a' + 10);
+
+        if (code > 0x10ffff)
+            return 0;
+
+        q++;
+    }
+
+    if (q >= end || q == digits || code == 0)
+        return 0;
+
+    appendUtf8 (decoded, code);
+
+    return q + 1 - p;
+}
+
+static std::string
+decodeXml (const char* begin, const char* end)
+{
+    static const std::pair<const char*, char> entities[]
+        = { { "&amp;", '&' },
+            { "&lt;", '<' },
+            { "&gt;", '>' },
+            { "&quot;", '"' },
+            { "&apos;", '\'' } };
+
+    std::string decoded;
+    decoded.reserve (end - begin);
+
+    for (const char* p = begin; p < end; p++)
+    {
+        bool replaced = false;
+
+        if (*p == '&')
+        {
+            size_t len = decodeCharReference (p, end, decoded);
+
+            if (len > 0)
+            {
+                p += len - 1;
+                continue;
+            }
+
+            for (const auto& entity : entities)
+            {
+                size_t len = strlen (entity.first);
+
+                if ((size_t)(end - p) >= len
+                    && strncmp (p, entity.first, len) == 0)
+                {
+                    decoded += entity.second;
+                    p += len - 1;
+                    replaced = true;
+                    break;
+                }
+            }
+        }
+
+        if (!replaced)
+            decoded += *p;
+    }
+
+    return decoded;
+}
+
+static std::string
+readName (const char*& p, const char* end)
+{
+    const char* begin = p;
+
+    while (p < end && !isspace ((unsigned char)*p) && *p != '>' && *p != '/'
+           && *p != '=')
+        p++;
+
+    std::string name (begin, p);
+
+    /* namespace prefixes are ignored */
+    size_t colon = name.find (':');
+
+    return colon == std::string::npos ? name : name.substr (colon + 1);
+}
+
+template <typename Element>
+static bool
+parseElement (const char*& p, const char* end, Element& element)
+{
+    p++; /* '<' */
+    const char* name = p;
+    element.name = readName (p, end);
+    size_t nameLength = p - name;
+
+    while (true)
+    {
+        skipSpaces (p, end);
+
+        if (p >= end)
+            return false;
+
+        if (*p == '/')
+        {
+            p++;
+            if (p >= end || *p != '>')
+                return false;
+            p++;
+            return true;
+        }
+
+        if (*p == '>')
+        {
+            p++;
+            break;
+        }
+
+        std::string name = readName (p, end);
+        skipSpaces (p, end);
+
+        if (p >= end || *p != '=')
+            return false;
+
+        p++;
+        skipSpaces (p, end);
+
+        if (p >= end || (*p != '"' && *p != '\''))
+            return false;
+
+        char quote = *p++;
+        const char* valueEnd
+            = static_cast<const char*> (memchr (p, quote, end - p));
+
+        if (!valueEnd)
+            return false;
+
+        element.attributes.push_back ({ name, decodeXml (p, valueEnd) });
+        p = valueEnd + 1;
+    }
+
+    while (p < end)
+    {
+        if (*p != '<')
+        {
+            const char* textEnd
+                = static_cast<const char*> (memchr (p, '<', end - p));
+
+            if (!textEnd)
+                return false;
+
+            element.text += decodeXml (p, textEnd);
+            p = textEnd;
+        }
+        else if (strncmp (p, "</", 2) == 0)
+        {
+            /* the end tag has to close this element */
+            p += 2;
+
+            if ((size_t)(end - p) < nameLength
+                || strncmp (p, name, nameLength) != 0)
+                return false;
+
+            p += nameLength;
+            skipSpaces (p, end);
+
+            if (p >= end || *p != '>')
+                return false;
+
+            p++;
+            return true;
+        }
+        else if (strncmp (p, "<!--", 4) == 0)
+        {
+            if (!skipPast (p, end, "-->"))
+                return false;
+        }
+        else if (strncmp (p, "<![CDATA[", 9) == 0)
+        {
+            const char* begin = p + 9;
+
+            if (!skipPast (p, end, "]]>"))
+                return false;
+
+            element.text.append (begin, p - 3);
+        }
+        else if (strncmp (p, "<?", 2) == 0)
+        {
+            if (!skipPast (p, end, "?>"))
+                return false;
+        }
+        else
+        {
+            element.children.emplace_back ();
+
+            if (!parseElement (p, end, element.children.back ()))
+                return false;
+        }
+    }
+
+    return false;
+}
+
+const std::string&
+IEC61850SclModel::XmlElement::attribute (const char* name) const
+{
+    static const std::string empty;
+
+    for (const auto& attribute : attributes)
+    {
+        if (attribute.first == name)
+            return attribute.second;
+    }
+
+    return empty;
+}
+
+bool
+IEC61850SclModel::parseXml (const std::string& xml, XmlElement& root)
+{
+    const char* p = xml.c_str ();
+    const char* end = p + xml.size ();
+
+    while (true)
+    {
+        skipSpaces (p, end);
+
+        if (p >= end || *p != '<')
+            return false;
+
+        if (strncmp (p, "<?", 2) == 0)
+        {
+            if (!skipPast (p, end, "?>"))
+                return false;
+        }
+        else if (strncmp (p, "<!--", 4) == 0)
+        {
+            if (!skipPast (p, end, "-->"))
+                return false;
+        }
+        else if (strncmp (p, "<!", 2) == 0)
+        {
+            if (!skipPast (p, end, ">"))
+                return false;
+        }
+        else
+        {
+            return parseElement (p, end, root);
+        }
+    }
+}
+
+bool
+IEC61850SclModel::load (const std::string& fileName,
+                        const std::string& iedName)
+{
+    std::ifstream file (fileName);
+
+    if (!file.is_open ())
+    {
+        Iec61850Utility::log_error ("Cannot open SCL file %s",
+                                    fileName.c_str ());
+        return false;
+    }
+
+    std::stringstream content;
+    content << file.rdbuf ();
+
+    if (!parse (content.str (), iedName))
+    {
+        Iec61850Utility::log_error ("Invalid SCL file %s", fileName.c_str ());
+        return false;
+    }
+
+    return true;
+}
+
+bool
+IEC61850SclModel::parse (const std::string& scl, const std::string& iedName)
+{
+    XmlElement root;
+
+    if (!parseXml (scl, root) || root.name != "SCL")
+        return false;
+
+    const XmlElement* ied = nullptr;
+    std::vector<const XmlElement*> ieds;
+
+    for (const auto& child : root.children)
+    {
+        if (child.name == "DataTypeTemplates")
+            importTemplates (child);
+
+        if (child.name == "IED")
+        {
+            ieds.push_back (&child);
+
+            if (!ied && child.attribute ("name") == iedName)
+                ied = &child;
+        }
+    }
+
+    /* an ICD or CID describes a single IED, whatever its name */
+    if (!ied && ieds.size () == 1)
+        ied = ieds.front ();
+
+    if (!ied && iedName.empty () && !ieds.empty ())
+        ied = ieds.front ();
+
+    if (!ied)
+    {
+        Iec61850Utility::log_error ("IED %s not found in SCL file",
+                                    iedName.c_str ());
+        return false;
+    }
+
+    importIed (*ied);
+
+    return true;
+}
+
+void
+IEC61850SclModel::importTemplates (const XmlElement& templates)
+{
+    for (const auto& type : templates.children)
+    {
+        const std::string& id = type.attribute ("id");
+
+        if (type.name == "LNodeType")
+        {
+            std::vector<Attribute>& dataObjects = m_lnodeTypes[id];
+
+            for (const auto& child : type.children)
+            {
+                if (child.name != "DO")
+                    continue;
+
+                Attribute dataObject;
+                dataObject.name = child.attribute ("name");
+                dataObject.type = child.attribute ("type");
+                dataObjects.push_back (dataObject);
+            }
+        }
+        else if (type.name == "DOType" || type.name == "DAType")
+        {
+            std::vector<Attribute> attributes;
+
+            for (const auto& child : type.children)
+            {
+                if (child.name != "DA" && child.name != "SDO"
+                    && child.name != "BDA")
+                    continue;
+
+                Attribute attribute;
+                attribute.name = child.attribute ("name");
+                attribute.fc = child.attribute ("fc");
+                attribute.bType = child.attribute ("bType");
+                attribute.type = child.attribute ("type");
+                attribute.count = atoi (child.attribute ("count").c_str ());
+                attribute.subDataObject = child.name == "SDO";
+
+                for (const auto& value : child.children)
+                {
+                    if (value.name == "Val")
+                        attribute.value = value.text;
+                }
+
+                attributes.push_back (attribute);
+            }
+
+            if (type.name == "DOType")
+            {
+                m_doTypes[id].cdc = type.attribute ("cdc");
+                m_doTypes[id].attributes = attributes;
+            }
+            else
+            {
+                m_daTypes[id] = attributes;
+            }
+        }
+    }
+}
+
+void
+IEC61850SclModel::importIed (const XmlElement& ied)
+{
+    m_iedName = ied.attribute ("name");
+
+    std::vector<std::pair<std::string, const XmlElement*> > lds;
+    std::map<std::string, std::string> ldNames;
+
+    for (const auto& accessPoint : ied.children)
+    {
+        if (accessPoint.name != "AccessPoint")
+            continue;
+
+        for (const auto& server : accessPoint.children)
+        {
+            if (server.name != "Server")
+                continue;
+
+            for (const auto& ld : server.children)
+            {
+                if (ld.name != "LDevice")
+                    continue;
+
+                std::string inst = ld.attribute ("inst");
+                std::string ldName = ld.attribute ("ldName");
+
+                if (ldName.empty ())
+                    ldName = m_iedName + inst;
+
+                ldNames[inst] = ldName;
+                lds.push_back ({ ldName, &ld });
+            }
+        }
+    }
+
+    for (const auto& ld : lds)
+    {
+        for (const auto& ln : ld.second->children)
+        {
+            if (ln.name != "LN0" && ln.name != "LN")
+                continue;
+
+            importLogicalNode (ld.first, ln);
+
+            std::string lnRef = ld.first + "/" + ln.attribute ("prefix")
+                                + ln.attribute ("lnClass")
+                                + ln.attribute ("inst");
+
+            for (const auto& dataset : ln.children)
+            {
+                if (dataset.name != "DataSet")
+                    continue;
+
+                std::vector<std::string>& entries
+                    = m_datasets[lnRef + "." + dataset.attribute ("name")];
+
+                for (const auto& fcda : dataset.children)
+                {
+                    if (fcda.name != "FCDA")
+                        continue;
+
+                    auto ldName = ldNames.find (fcda.attribute ("ldInst"));
+
+                    std::string entry
+                        = (ldName != ldNames.end () ? ldName->second
+                                                    : ld.first)
+                          + "/" + fcda.attribute ("prefix")
+                          + fcda.attribute ("lnClass")
+                          + fcda.attribute ("lnInst") + "."
+                          + fcda.attribute ("doName");
+
+                    if (!fcda.attribute ("daName").empty ())
+                        entry += "." + fcda.attribute ("daName");
+
+                    entries.push_back (entry + "[" + fcda.attribute ("fc")
+                                       + "]");
+                }
+            }
+        }
+    }
+}
+
+void
+IEC61850SclModel::importLogicalNode (const std::string& ldName,
+                                     const XmlElement& ln)
+{
+    std::string lnRef = ldName + "/" + ln.attribute ("prefix")
+                        + ln.attribute ("lnClass") + ln.attribute ("inst");
+
+    m_lns[lnRef] = ln.attribute ("lnType");
+
+    ControlModel model;
+
+    /* default control models of the data object types */
+    auto lnodeType = m_lnodeTypes.find (ln.attribute ("lnType"));
+
+    if (lnodeType != m_lnodeTypes.end ())
+    {
+        for (const auto& dataObject : lnodeType->second)
+        {
+            auto doType = m_doTypes.find (dataObject.type);
+
+            if (doType == m_doTypes.end ())
+                continue;
+
+            for (const auto& attribute : doType->second.attributes)
+            {
+                if (attribute.name == "ctlModel"
+                    && parseCtlModel (attribute.value, model))
+                    m_ctlModels[lnRef + "." + dataObject.name] = model;
+            }
+        }
+    }
+
+    for (const auto& doi : ln.children)
+    {
+        if (doi.name != "DOI")
+            continue;
+
+        for (const auto& dai : doi.children)
+        {
+            if (dai.name != "DAI")
+                continue;
+
+            std::string value;
+
+            for (const auto& child : dai.children)
+            {
+                if (child.name == "Val")
+                    value = child.text;
+            }
+
+            const std::string& daName = dai.attribute ("name");
+
+            if (daName == "ctlModel" && parseCtlModel (value, model))
+            {
+                m_ctlModels[lnRef + "." + doi.attribute ("name")] = model;
+            }
+            else if (daName == "configRev" && ln.name == "LN0"
+                     && doi.attribute ("name") == "NamPlt")
+            {
+                m_revisions[ldName] = value;
+            }
+        }
+    }
+}
+
+bool
+IEC61850SclModel::parseCtlModel (const std::string& value,
+                                 ControlModel& model)
+{
+    if (value.empty ())
+        return false;
+
+    if (isdigit ((unsigned char)value[0]))
+    {
+        int intValue = atoi (value.c_str ());
+
+        if (intValue > CONTROL_MODEL_SBO_ENHANCED)
+            return false;
+
+        model = (ControlModel)intValue;
+        return true;
+    }
+
+    auto it = ctlModels.find (value);
+
+    if (it == ctlModels.end ())
+        return false;
+
+    model = (ControlModel)it->second;
+    return true;
+}
+
+MmsVariableSpecification*
+IEC61850SclModel::createBasicSpec (const std::string& name,
+                                   const Attribute& attribute,
+                                   const std::string& fc, bool& valid) const
+{
+    if (attribute.bType == "Struct")
+    {
+        auto daType = m_daTypes.find (attribute.type);
+
+        if (daType == m_daTypes.end ())
+        {
+            valid = false;
+            return nullptr;
+        }
+
+        std::vector<MmsVariableSpecification*> elements;
+
+        for (const auto& bda : daType->second)
+        {
+            MmsVariableSpecification* element
+                = createAttributeSpec (bda, fc, valid);
+
+            if (!valid)
+            {
+                destroySpecs (elements);
+                return nullptr;
+            }
+
+            elements.push_back (element);
+        }
+
+        return newStructureSpec (name, elements);
+    }
+
+    auto basicType = basicTypes.find (attribute.bType);
+
+    if (basicType == basicTypes.end ())
+    {
+        Iec61850Utility::log_debug ("Unsupported SCL basic type %s",
+                                    attribute.bType.c_str ());
+        valid = false;
+        return nullptr;
+    }
+
+    MmsVariableSpecification* spec = newSpec (name, basicType->second.type);
+
+    switch (basicType->second.type)
+    {
+    case MMS_FLOAT:
+        spec->typeSpec.floatingpoint.exponentWidth
+            = basicType->second.size == 32 ? 8 : 11;
+        spec->typeSpec.floatingpoint.formatWidth = basicType->second.size;
+        break;
+    case MMS_INTEGER:
+        spec->typeSpec.integer = basicType->second.size;
+        break;
+    case MMS_UNSIGNED:
+        spec->typeSpec.unsignedInteger = basicType->second.size;
+        break;
+    case MMS_BIT_STRING:
+        spec->typeSpec.bitString = basicType->second.size;
+        break;
+    case MMS_OCTET_STRING:
+        spec->typeSpec.octetString = basicType->second.size;
+        break;
+    case MMS_VISIBLE_STRING:
+        spec->typeSpec.visibleString = basicType->second.size;
+        break;
+    case MMS_STRING:
+        spec->typeSpec.mmsString = basicType->second.size;
+        break;
+    case MMS_BINARY_TIME:
+        spec->typeSpec.binaryTime = basicType->second.size;
+        break;
+    default:
+        break;
+    }
+
+    return spec;
+}
+
+MmsVariableSpecification*
+IEC61850SclModel::createAttributeSpec (const Attribute& attribute,
+                                       const std::string& fc,
+                                       bool& valid) const
+{
+    if (attribute.count <= 0)
+        return createBasicSpec (attribute.name, attribute, fc, valid);
+
+    MmsVariableSpecification* element
+        = createBasicSpec ("", attribute, fc, valid);
+
+    if (!valid)
+        return nullptr;
+
+    MmsVariableSpecification* spec = newSpec (attribute.name, MMS_ARRAY);
+    spec->typeSpec.array.elementCount = attribute.count;
+    spec->typeSpec.array.elementTypeSpec = element;
+
+    return spec;
+}
+
+MmsVariableSpecification*
+IEC61850SclModel::createDataObjectSpec (const std::string& name,
+                                        const std::string& type,
+                                        const std::string& fc,
+                                        bool& valid) const
+{
+    auto doType = m_doTypes.find (type);
+
+    if (doType == m_doTypes.end ())
+    {
+        valid = false;
+        return nullptr;
+    }
+
+    std::vector<MmsVariableSpecification*> elements;
+
+    for (const auto& attribute : doType->second.attributes)
+    {
+        MmsVariableSpecification* element = nullptr;
+
+        if (attribute.subDataObject)
+            element = createDataObjectSpec (attribute.name, attribute.type,
+                                            fc, valid);
+        else if (attribute.fc == fc)
+            element = createAttributeSpec (attribute, fc, valid);
+
+        if (!valid)
+        {
+            destroySpecs (elements);
+            return nullptr;
+        }
+
+        if (element)
+            elements.push_back (element);
+    }
+
+    /* like in MMS, a data object has no component without attributes */
+    if (elements.empty ())
+        return nullptr;
+
+    return newStructureSpec (name, elements);
+}
+
+MmsVariableSpecification*
+IEC61850SclModel::getSpec (const std::string& objRef,
+                           FunctionalConstraint fc) const
+{
+    size_t lnEnd = objRef.find ('.');
+
+    auto ln = m_lns.find (objRef.substr (0, lnEnd));
+
+    if (ln == m_lns.end ())
+        return nullptr;
+
+    auto lnodeType = m_lnodeTypes.find (ln->second);
+
+    if (lnodeType == m_lnodeTypes.end ())
+        return nullptr;
+
+    const char* fcName = FunctionalConstraint_toString (fc);
+
+    if (!fcName)
+        return nullptr;
+
+    bool valid = true;
+
+    if (lnEnd == std::string::npos)
+    {
+        std::vector<MmsVariableSpecification*> elements;
+
+        for (const auto& dataObject : lnodeType->second)
+        {
+            MmsVariableSpecification* element = createDataObjectSpec (
+                dataObject.name, dataObject.type, fcName, valid);
+
+            if (!valid)
+            {
+                destroySpecs (elements);
+                return nullptr;
+            }
+
+            if (element)
+                elements.push_back (element);
+        }
+
+        if (elements.empty ())
+            return nullptr;
+
+        return newStructureSpec (fcName, elements);
+    }
+
+    /* data object, possibly followed by sub data objects */
+    std::string name;
+    std::string type;
+    const std::vector<Attribute>* candidates = &lnodeType->second;
+
+    size_t start = lnEnd + 1;
+
+    while (start <= objRef.size ())
+    {
+        size_t end = objRef.find ('.', start);
+
+        if (end == std::string::npos)
+            end = objRef.size ();
+
+        name = objRef.substr (start, end - start);
+        type.clear ();
+
+        for (const auto& candidate : *candidates)
+        {
+            if (candidate.name == name
+                && (candidates == &lnodeType->second
+                    || candidate.subDataObject))
+            {
+                type = candidate.type;
+                break;
+            }
+        }
+
+        if (type.empty ())
+            return nullptr;
+
+        auto doType = m_doTypes.find (type);
+
+        if (doType == m_doTypes.end ())
+            return nullptr;
+
+        candidates = &doType->second.attributes;
+        start = end + 1;
+    }
+
+    return createDataObjectSpec (name, type, fcName, valid);
+}
+
+bool
+IEC61850SclModel::getCtlModel (const std::string& objRef,
+                               ControlModel& model) const
+{
+    auto it = m_ctlModels.find (objRef);
+
+    if (it == m_ctlModels.end ())
+        return false;
+
+    model = (ControlModel)it->second;
+    return true;
+}
+
+bool
+IEC61850SclModel::getDatasetDirectory (
+    const std::string& datasetRef, std::vector<std::string>& entries) const
+{
+    auto it = m_datasets.find (datasetRef);
+
+    if (it == m_datasets.end ())
+        return false;
+
+    entries = it->second;
+    return true;
+}
+
+bool
+IEC61850SclModel::configRevisions (
+    const IEC61850ClientConfig& config,
+    IEC61850ModelCache::Revisions& revisions) const
+{
+    revisions.clear ();
+
+    for (const auto& def : config.ExchangeDefinition ())
+    {
+        const std::string& objRef = def->objRef;
+        size_t ldEnd = objRef.find ('/');
+
+        if (ldEnd == std::string::npos)
+            continue;
+
+        std::string ld = objRef.substr (0, ldEnd);
+
+        if (revisions.count (ld))
+            continue;
+
+        auto revision = m_revisions.find (ld);
+
+        if (revision == m_revisions.end ())
+        {
+            Iec61850Utility::log_warn ("No configRev for %s in SCL file",
+                                       ld.c_str ());
+            return false;
+        }
+
+        revisions[ld] = revision->second;
+    }
+
+    return !revisions.empty ();
+}
+
+bool
+IEC61850SclModel::seed (IEC61850ModelCache& cache,
+                        const IEC61850ClientConfig& config) const
+{
+    IEC61850ModelCache::Revisions revisions;
+
+    if (!configRevisions (config, revisions))
+        return false;
+
+    cache.reset (revisions);
+
+    std::set<std::string> lns;
+
+    for (const auto& def : config.ExchangeDefinition ())
+    {
+        const std::string& objRef = def->objRef;
+        std::string lnRef = objRef.substr (0, objRef.find ('.'));
+        bool newLn = lns.insert (lnRef).second;
+
+        for (FunctionalConstraint fc :
+             { IEC61850_FC_ST, IEC61850_FC_MX, IEC61850_FC_CO })
+        {
+            MmsVariableSpecification* spec = getSpec (objRef, fc);
+
+            if (spec)
+            {
+                cache.setSpec (objRef, fc, spec);
+                MmsVariableSpecification_destroy (spec);
+            }
+
+            spec = newLn && lnRef != objRef ? getSpec (lnRef, fc) : nullptr;
+
+            if (spec)
+            {
+                cache.setSpec (lnRef, fc, spec);
+                MmsVariableSpecification_destroy (spec);
+            }
+        }
+
+        ControlModel model;
+
+        if (getCtlModel (objRef, model))
+            cache.setCtlModel (objRef, model);
+    }
+
+    for (const auto& entry : config.getReportSubscriptions ())
+    {
+        const std::string& datasetRef = entry.second->datasetRef;
+        auto dataset = config.getDatasets ().find (datasetRef);
+
+        /* dynamic datasets are created by the plugin */
+        if (dataset != config.getDatasets ().end ()
+            && dataset->second->dynamic)
+            continue;
+
+        std::vector<std::string> entries;
+
+        if (getDatasetDirectory (datasetRef, entries))
+            cache.setDatasetDirectory (datasetRef, entries);
+    }
+
+    return cache.save ();
+}
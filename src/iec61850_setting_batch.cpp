@@ -0,0 +1,163 @@
+#include "iec61850_setting_batch.hpp"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+using namespace rapidjson;
+
+#define JSON_SETTING_BATCH "PivotSettingBatch"
+#define JSON_SETTING_BATCH_IDENTIFIER "Identifier"
+#define JSON_SETTING_BATCH_GROUP "SettingGroup"
+#define JSON_SETTING_BATCH_SETTINGS "Settings"
+#define JSON_SETTING_BATCH_COMMAND "GTIC"
+
+IEC61850SettingBatch::~IEC61850SettingBatch ()
+{
+    for (auto& setting : settings)
+    {
+        if (setting.value)
+            MmsValue_delete (setting.value);
+    }
+}
+
+bool
+IEC61850SettingBatch::parse (const std::string& json,
+                             std::vector<std::string>& commands)
+{
+    Document document;
+
+    if (document.Parse (json.c_str ()).HasParseError ()
+        || !document.IsObject () || !document.HasMember (JSON_SETTING_BATCH)
+        || !document[JSON_SETTING_BATCH].IsObject ())
+        return false;
+
+    const Value& batch = document[JSON_SETTING_BATCH];
+
+    if (batch.HasMember (JSON_SETTING_BATCH_IDENTIFIER)
+        && batch[JSON_SETTING_BATCH_IDENTIFIER].IsString ())
+        m_identifier = batch[JSON_SETTING_BATCH_IDENTIFIER].GetString ();
+
+    if (batch.HasMember (JSON_SETTING_BATCH_GROUP))
+    {
+        /* setting groups are numbered from 1 */
+        if (!batch[JSON_SETTING_BATCH_GROUP].IsInt ()
+            || batch[JSON_SETTING_BATCH_GROUP].GetInt () < 1
+            || batch[JSON_SETTING_BATCH_GROUP].GetInt () > 255)
+            return false;
+
+        m_settingGroup = batch[JSON_SETTING_BATCH_GROUP].GetInt ();
+    }
+
+    if (!batch.HasMember (JSON_SETTING_BATCH_SETTINGS)
+        || !batch[JSON_SETTING_BATCH_SETTINGS].IsArray ()
+        || batch[JSON_SETTING_BATCH_SETTINGS].Empty ())
+        return false;
+
+    for (const auto& setting : batch[JSON_SETTING_BATCH_SETTINGS].GetArray ())
+    {
+        if (!setting.IsObject ()
+            || !setting.HasMember (JSON_SETTING_BATCH_COMMAND)
+            || !setting[JSON_SETTING_BATCH_COMMAND].IsObject ())
+            return false;
+
+        StringBuffer buffer;
+        Writer<StringBuffer> writer (buffer);
+
+        writer.StartObject ();
+        writer.Key (JSON_SETTING_BATCH_COMMAND);
+        setting[JSON_SETTING_BATCH_COMMAND].Accept (writer);
+        writer.EndObject ();
+
+        commands.push_back (buffer.GetString ());
+    }
+
+    return true;
+}
+
+bool
+IEC61850SettingBatch::add (const std::string& label,
+                           const std::string& objRef, CDCTYPE type,
+                           const DatapointValue& value)
+{
+    Setting setting;
+    std::string attribute;
+
+    setting.label = label;
+    setting.objRef = objRef;
+    setting.type = type;
+
+    switch (type)
+    {
+    case SPG:
+    case ING:
+        attribute = ".setVal";
+        break;
+    case ASG:
+        attribute = ".setMag.f";
+        break;
+    default:
+        return false;
+    }
+
+    /* values in an edit session are written to the SE data */
+    if (!mmsReference (objRef + attribute, m_settingGroup > 0 ? "SE" : "SP",
+                       setting.domain, setting.item))
+        return false;
+
+    switch (type)
+    {
+    case SPG:
+        setting.value = MmsValue_newBoolean (value.toInt ());
+        break;
+    case ING:
+        setting.value
+            = MmsValue_newIntegerFromInt32 ((int32_t)value.toInt ());
+        break;
+    default:
+        setting.value = MmsValue_newFloat ((float)value.toDouble ());
+        break;
+    }
+
+    settings.push_back (setting);
+
+    return true;
+}
+
+bool
+IEC61850SettingBatch::mmsReference (const std::string& reference,
+                                    const char* fc, std::string& domain,
+                                    std::string& item)
+{
+    size_t slash = reference.find ('/');
+
+    if (slash == std::string::npos || slash == 0)
+        return false;
+
+    size_t dot = reference.find ('.', slash);
+
+    if (dot == std::string::npos || dot == slash + 1
+        || dot == reference.size () - 1)
+        return false;
+
+    domain = reference.substr (0, slash);
+    item = reference.substr (slash + 1, dot - slash - 1) + "$" + fc;
+
+    for (size_t i = dot; i < reference.size (); i++)
+        item += reference[i] == '.' ? '$' : reference[i];
+
+    return true;
+}
+
+size_t
+IEC61850SettingBatch::written () const
+{
+    size_t count = 0;
+
+    for (const auto& setting : settings)
+    {
+        if (setting.written)
+            count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,207 @@
+#include "iec61850_spec_registry.hpp"
+#include "iec61850_model_cache.hpp"
+#include <libiec61850/mms_type_spec.h>
+#include <libiec61850/mms_value.h>
+#include <cstring>
+
+MmsValue*
+IEC61850SpecType::element (MmsValue* value, int index)
+{
+    if (!value || index < 0 || MmsValue_getType (value) != MMS_STRUCTURE)
+        return nullptr;
+
+    return MmsValue_getElement (value, index);
+}
+
+IEC61850SpecRegistry::~IEC61850SpecRegistry ()
+{
+    for (auto& entry : m_types)
+    {
+        MmsVariableSpecification_destroy (entry.second->spec);
+        delete entry.second;
+    }
+
+    m_types.clear ();
+}
+
+void
+IEC61850SpecRegistry::appendSignature (std::string& sig,
+                                       const MmsVariableSpecification* spec)
+{
+    sig += std::to_string ((int)spec->type);
+
+    switch (spec->type)
+    {
+    case MMS_STRUCTURE:
+        sig += '{';
+        for (int i = 0; i < spec->typeSpec.structure.elementCount; i++)
+        {
+            const MmsVariableSpecification* child
+                = spec->typeSpec.structure.elements[i];
+
+            sig += child->name ? child->name : "";
+            sig += ':';
+            appendSignature (sig, child);
+            sig += ',';
+        }
+        sig += '}';
+        break;
+
+    case MMS_ARRAY:
+        sig += '[' + std::to_string (spec->typeSpec.array.elementCount) + ']';
+        if (spec->typeSpec.array.elementTypeSpec)
+            appendSignature (sig, spec->typeSpec.array.elementTypeSpec);
+        break;
+
+    case MMS_INTEGER:
+        sig += '/' + std::to_string (spec->typeSpec.integer);
+        break;
+
+    case MMS_UNSIGNED:
+        sig += '/' + std::to_string (spec->typeSpec.unsignedInteger);
+        break;
+
+    case MMS_FLOAT:
+        sig += '/' + std::to_string (spec->typeSpec.floatingpoint.formatWidth)
+               + '.'
+               + std::to_string (spec->typeSpec.floatingpoint.exponentWidth);
+        break;
+
+    case MMS_BIT_STRING:
+        sig += '/' + std::to_string (spec->typeSpec.bitString);
+        break;
+
+    case MMS_OCTET_STRING:
+        sig += '/' + std::to_string (spec->typeSpec.octetString);
+        break;
+
+    case MMS_VISIBLE_STRING:
+        sig += '/' + std::to_string (spec->typeSpec.visibleString);
+        break;
+
+    case MMS_STRING:
+        sig += '/' + std::to_string (spec->typeSpec.mmsString);
+        break;
+
+    case MMS_BINARY_TIME:
+        sig += '/' + std::to_string (spec->typeSpec.binaryTime);
+        break;
+
+    default:
+        break;
+    }
+}
+
+std::string
+IEC61850SpecRegistry::signature (const MmsVariableSpecification* spec)
+{
+    std::string sig;
+
+    if (spec)
+        appendSignature (sig, spec);
+
+    return sig;
+}
+
+int
+IEC61850SpecRegistry::childIndex (const MmsVariableSpecification* spec,
+                                  const char* name)
+{
+    if (!spec || spec->type != MMS_STRUCTURE)
+        return -1;
+
+    for (int i = 0; i < spec->typeSpec.structure.elementCount; i++)
+    {
+        const char* childName = spec->typeSpec.structure.elements[i]->name;
+
+        if (childName && strcmp (childName, name) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+void
+IEC61850SpecRegistry::compile (IEC61850SpecType* type)
+{
+    const MmsVariableSpecification* spec = type->spec;
+
+    type->quality = childIndex (spec, "q");
+    type->timestamp = childIndex (spec, "t");
+
+    for (const char* name : { "stVal", "mag", "mxVal", "valWTr" })
+    {
+        type->value = childIndex (spec, name);
+
+        if (type->value >= 0)
+            break;
+    }
+
+    if (type->value < 0)
+        return;
+
+    const MmsVariableSpecification* valueSpec
+        = spec->typeSpec.structure.elements[type->value];
+
+    type->valueF = childIndex (valueSpec, "f");
+    type->valueI = childIndex (valueSpec, "i");
+    type->posVal = childIndex (valueSpec, "posVal");
+    type->transInd = childIndex (valueSpec, "transInd");
+}
+
+const IEC61850SpecType*
+IEC61850SpecRegistry::intern (const MmsVariableSpecification* spec)
+{
+    if (!spec)
+        return nullptr;
+
+    std::string sig = signature (spec);
+
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_types.find (sig);
+
+    if (it != m_types.end ())
+    {
+        it->second->refCount++;
+        return it->second;
+    }
+
+    auto type = new IEC61850SpecType;
+    type->spec = IEC61850ModelCache::copySpec (spec);
+    type->signature = sig;
+    type->refCount = 1;
+    compile (type);
+
+    m_types[sig] = type;
+
+    return type;
+}
+
+void
+IEC61850SpecRegistry::release (const IEC61850SpecType* type)
+{
+    if (!type)
+        return;
+
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    auto it = m_types.find (type->signature);
+
+    if (it == m_types.end () || it->second != type)
+        return;
+
+    if (--it->second->refCount > 0)
+        return;
+
+    MmsVariableSpecification_destroy (it->second->spec);
+    delete it->second;
+    m_types.erase (it);
+}
+
+size_t
+IEC61850SpecRegistry::size ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+    return m_types.size ();
+}
@@ -0,0 +1,107 @@
+#include "iec61850_timer_wheel.hpp"
+
+IEC61850TimerWheel::IEC61850TimerWheel (uint64_t resolutionMs,
+                                        size_t slotCount)
+    : m_resolution (resolutionMs < 1 ? 1 : resolutionMs),
+      m_slots (slotCount < 1 ? 1 : slotCount)
+{
+}
+
+void
+IEC61850TimerWheel::schedule (uint64_t key, int tag, uint64_t deadline)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    uint64_t tick = deadline / m_resolution;
+
+    /* overdue timers expire on the next call */
+    if (m_started && tick < m_currentTick)
+        tick = m_currentTick;
+
+    uint64_t generation = m_nextGeneration++;
+
+    m_timers[key] = { { key, tag, deadline }, generation };
+    m_slots[tick % m_slots.size ()].push_back ({ key, generation });
+}
+
+void
+IEC61850TimerWheel::cancel (uint64_t key)
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    m_timers.erase (key);
+}
+
+std::vector<IEC61850TimerWheel::Timer>
+IEC61850TimerWheel::expire (uint64_t currentTime)
+{
+    std::vector<Timer> expired;
+
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    uint64_t targetTick = currentTime / m_resolution;
+
+    if (m_started && targetTick < m_currentTick)
+        return expired;
+
+    /* on the first call and after a long pause every slot is visited */
+    uint64_t ticks = m_slots.size ();
+
+    if (m_started && targetTick - m_currentTick < ticks)
+        ticks = targetTick - m_currentTick + 1;
+
+    size_t index = targetTick % m_slots.size ();
+
+    for (uint64_t i = 0; i < ticks; i++)
+    {
+        std::vector<SlotEntry>& slot = m_slots[index];
+
+        index = (index == 0 ? m_slots.size () : index) - 1;
+
+        size_t kept = 0;
+
+        for (const SlotEntry& slotEntry : slot)
+        {
+            auto it = m_timers.find (slotEntry.key);
+
+            if (it == m_timers.end ()
+                || it->second.generation != slotEntry.generation)
+                continue;
+
+            if (it->second.timer.deadline <= currentTime)
+            {
+                expired.push_back (it->second.timer);
+                m_timers.erase (it);
+                continue;
+            }
+
+            slot[kept++] = slotEntry;
+        }
+
+        slot.resize (kept);
+    }
+
+    m_currentTick = targetTick;
+    m_started = true;
+
+    return expired;
+}
+
+void
+IEC61850TimerWheel::clear ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    m_timers.clear ();
+
+    for (auto& slot : m_slots)
+        slot.clear ();
+}
+
+size_t
+IEC61850TimerWheel::size ()
+{
+    std::lock_guard<std::mutex> lock (m_lock);
+
+    return m_timers.size ();
+}
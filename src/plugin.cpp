@@ -194,6 +194,19 @@ extern "C"
         ConfigCategory config ("newConfig", newConfig);
         auto* iec61850 = reinterpret_cast<IEC61850*> (*handle);
 
+        /* only what changed is applied while the plugin keeps running */
+        if (config.itemExists ("protocol_stack")
+            && config.itemExists ("exchanged_data")
+            && config.itemExists ("tls_conf") && config.itemExists ("asset")
+            && iec61850->reconfigure (config.getValue ("protocol_stack"),
+                                      config.getValue ("exchanged_data"),
+                                      config.getValue ("tls_conf")))
+        {
+            iec61850->setAssetName (config.getValue ("asset"));
+            Iec61850Utility::log_info ("61850 plugin reconfigured in place");
+            return;
+        }
+
         iec61850->stop ();
 
         if (config.itemExists ("protocol_stack")
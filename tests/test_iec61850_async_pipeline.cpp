@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <iec61850_async_pipeline.hpp>
+#include <vector>
+
+using namespace std;
+
+class AsyncPipelineTest : public testing::Test
+{
+  protected:
+    vector<void*> sent;
+
+    IEC61850AsyncPipeline::Issue
+    issue ()
+    {
+        return [this] (IedClientError* err, void* parameter) {
+            sent.push_back (parameter);
+            return (uint32_t)sent.size ();
+        };
+    }
+
+    void
+    completeAll ()
+    {
+        vector<void*> outstanding;
+        outstanding.swap (sent);
+
+        for (auto parameter : outstanding)
+        {
+            IEC61850AsyncPipeline::genericHandler (0, parameter,
+                                                   IED_ERROR_OK);
+        }
+    }
+};
+
+TEST_F (AsyncPipelineTest, BoundedWindow)
+{
+    IEC61850AsyncPipeline pipeline (2);
+
+    int completed = 0;
+
+    for (int i = 0; i < 5; i++)
+    {
+        pipeline.submit (issue (), [&completed] (IEC61850AsyncResult& result) {
+            ASSERT_EQ (result.err, IED_ERROR_OK);
+            completed++;
+        });
+    }
+
+    ASSERT_TRUE (pipeline.poll ());
+    ASSERT_EQ (sent.size (), 2);
+
+    /* no new request while the window is full */
+    ASSERT_TRUE (pipeline.poll ());
+    ASSERT_EQ (sent.size (), 2);
+
+    completeAll ();
+    ASSERT_EQ (completed, 0);
+
+    ASSERT_TRUE (pipeline.poll ());
+    ASSERT_EQ (completed, 2);
+    ASSERT_EQ (sent.size (), 2);
+
+    completeAll ();
+    ASSERT_TRUE (pipeline.poll ());
+    ASSERT_EQ (completed, 4);
+    ASSERT_EQ (sent.size (), 1);
+
+    completeAll ();
+    ASSERT_FALSE (pipeline.poll ());
+    ASSERT_EQ (completed, 5);
+    ASSERT_TRUE (pipeline.idle ());
+}
+
+TEST_F (AsyncPipelineTest, DependentRequests)
+{
+    IEC61850AsyncPipeline pipeline (4);
+
+    bool second = false;
+
+    pipeline.submit (issue (), [this, &pipeline,
+                                &second] (IEC61850AsyncResult& result) {
+        pipeline.submit (issue (), [&second] (IEC61850AsyncResult& result) {
+            second = true;
+        });
+    });
+
+    pipeline.poll ();
+    ASSERT_EQ (sent.size (), 1);
+    completeAll ();
+
+    /* the completion submits the dependent request which is sent at once */
+    ASSERT_TRUE (pipeline.poll ());
+    ASSERT_EQ (sent.size (), 1);
+    ASSERT_FALSE (second);
+
+    completeAll ();
+    ASSERT_FALSE (pipeline.poll ());
+    ASSERT_TRUE (second);
+}
+
+TEST_F (AsyncPipelineTest, FailedIssueAndAbort)
+{
+    IEC61850AsyncPipeline pipeline (1);
+
+    IedClientError error = IED_ERROR_OK;
+
+    pipeline.submit (
+        [] (IedClientError* err, void* parameter) {
+            *err = IED_ERROR_NOT_CONNECTED;
+            return (uint32_t)0;
+        },
+        [&error] (IEC61850AsyncResult& result) { error = result.err; });
+
+    pipeline.poll ();
+    ASSERT_FALSE (pipeline.poll ());
+    ASSERT_EQ (error, IED_ERROR_NOT_CONNECTED);
+
+    bool called = false;
+
+    pipeline.submit (issue (),
+                     [&called] (IEC61850AsyncResult& result) { called = true; });
+    pipeline.submit (issue (),
+                     [&called] (IEC61850AsyncResult& result) { called = true; });
+
+    pipeline.poll ();
+    ASSERT_EQ (sent.size (), 1);
+
+    pipeline.abort ();
+    ASSERT_TRUE (pipeline.idle ());
+
+    /* late completion of an aborted request is dropped */
+    completeAll ();
+    ASSERT_FALSE (pipeline.poll ());
+    ASSERT_FALSE (called);
+}
+
+TEST_F (AsyncPipelineTest, ReleaseOrphans)
+{
+    IEC61850AsyncPipeline pipeline (2);
+
+    bool called = false;
+
+    pipeline.submit (issue (),
+                     [&called] (IEC61850AsyncResult& result) { called = true; });
+    pipeline.submit (issue (),
+                     [&called] (IEC61850AsyncResult& result) { called = true; });
+
+    pipeline.poll ();
+    ASSERT_EQ (sent.size (), 2);
+
+    /* aborted requests stay valid until the connection is destroyed */
+    pipeline.abort ();
+    IEC61850AsyncPipeline::genericHandler (0, sent[0], IED_ERROR_OK);
+
+    /* the connection is destroyed, the other request never completes */
+    pipeline.releaseOrphans ();
+    sent.clear ();
+
+    ASSERT_FALSE (pipeline.poll ());
+    ASSERT_FALSE (called);
+}
@@ -55,6 +55,19 @@ static string protocol_config_2 = QUOTE ({
     }
 });
 
+static string protocol_config_3 = QUOTE ({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" :
+                [ { "ip_addr" : "127.0.0.1", "port" : 10002, "tls" : false } ]
+        },
+        "application_layer" : { "polling_interval" : 0, "reactor_threads" : 1 }
+    }
+});
+
 // PLUGIN DEFAULT EXCHANGED DATA CONF
 
 static string exchanged_data
@@ -256,6 +269,51 @@ TEST_F (ConnectionHandlingTest, SingleConnection)
     IedModel_destroy (model);
 }
 
+TEST_F (ConnectionHandlingTest, SingleConnectionReactor)
+{
+    iec61850->setJsonConfig (protocol_config_3, exchanged_data, tls_config);
+
+    ASSERT_EQ (iec61850->m_config->reactorThreads (), 1);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/simpleIO_direct_control.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    ASSERT_NE (iec61850->m_reactor, nullptr);
+    ASSERT_EQ (iec61850->m_client->m_monitoringThread, nullptr);
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (10);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->Connected ())
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+            break;
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_EQ (iec61850->m_client->m_active_connection->m_conThread, nullptr);
+
+    iec61850->stop ();
+
+    ASSERT_EQ (iec61850->m_reactor, nullptr);
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
 TEST_F (ConnectionHandlingTest, SingleConnectionReconnect)
 {
     iec61850->setJsonConfig (protocol_config, exchanged_data, tls_config);
@@ -366,6 +424,41 @@ TEST_F (ConnectionHandlingTest, SingleConnectionTLS)
         Thread_sleep (10);
     }
 
+    TLSConfiguration clientTlsConfig
+        = iec61850->m_client->m_active_connection->m_tlsConfig;
+    ASSERT_NE (clientTlsConfig, nullptr);
+
+    IedServer_stop (server);
+
+    Thread_sleep (2000);
+
+    IedServer_start (server, 10002);
+
+    start = std::chrono::high_resolution_clock::now ();
+    timeout = std::chrono::seconds (20);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->m_connection
+           || IedConnection_getState (
+                  iec61850->m_client->m_active_connection->m_connection)
+                  != IED_STATE_CONNECTED)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            TLSConfiguration_destroy (tlsConfig);
+            FAIL () << "Connection not reestablished within timeout";
+            break;
+        }
+        Thread_sleep (10);
+    }
+
+    /* the certificates did not change -> TLS configuration reused */
+    ASSERT_EQ (iec61850->m_client->m_active_connection->m_tlsConfig,
+               clientTlsConfig);
+
     IedServer_stop (server);
     IedServer_destroy (server);
     IedModel_destroy (model);
@@ -1,6 +1,7 @@
 #include <config_category.h>
 #include <gtest/gtest.h>
 #include <iec61850.hpp>
+#include <iec61850_timer_wheel.hpp>
 #include <plugin_api.h>
 #include <string.h>
 #include "libiec61850/iec61850_server.h"
@@ -35,6 +36,26 @@ static string protocol_config = QUOTE({
     }
 });
 
+static string lazy_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 0,
+            "control_objects" : "lazy"
+        }
+    }
+});
+
 // PLUGIN DEFAULT EXCHANGED DATA CONF
 
 static string exchanged_data = QUOTE({
@@ -805,6 +826,103 @@ TEST_F(ControlTest, SingleCommandDirectEnhanced) {
     IedModel_destroy(model);
 }
 
+static std::chrono::steady_clock::time_point selectTime;
+static std::chrono::steady_clock::time_point operateTime;
+
+static void
+selectStateChangedHandler(ControlAction action, void* parameter, bool isSelected, SelectStateChangedReason reason)
+{
+    if (isSelected)
+        selectTime = std::chrono::steady_clock::now();
+}
+
+static ControlHandlerResult
+controlHandlerForLatency(ControlAction action, void* parameter, MmsValue* value, bool test)
+{
+    operateTime = std::chrono::steady_clock::now();
+
+    return controlHandlerForBinaryOutput(action, parameter, value, test);
+}
+
+TEST_F(ControlTest, SingleCommandSelectOperateLatency) {
+    iec61850->setJsonConfig(protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+
+    /* SPCSO2 is sbo-with-normal-security */
+    auto spcso2 = (DataObject*) IedModel_getModelNodeByObjectReference(model, "simpleIOGenericIO/GGIO1.SPCSO2");
+    auto pair = new std::pair<IedServer, DataAttribute*>(server, (DataAttribute*) IedModel_getModelNodeByObjectReference(model, "simpleIOGenericIO/GGIO1.SPCSO2.stVal"));
+    IedServer_setControlHandler(server, spcso2, (ControlHandler) controlHandlerForLatency, pair);
+    IedServer_setSelectStateChangedHandler(server, spcso2, selectStateChangedHandler, nullptr);
+
+    IedServer_start(server,10002);
+
+    iec61850->start();
+    Thread_sleep(1000); 
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);  
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->m_connection || IedConnection_getState(iec61850->m_client->m_active_connection->m_connection) != IED_STATE_CONNECTED) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            delete pair;
+            FAIL() << "Connection not established within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    selectTime = std::chrono::steady_clock::time_point();
+    operateTime = std::chrono::steady_clock::time_point();
+
+    auto params = new PLUGIN_PARAMETER*[1];
+    params[0] = new PLUGIN_PARAMETER;
+    params[0]->name = std::string("Pivot");
+    params[0]->value = std::string(R"({"GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"q":{"test":0}, "t":{"SecondSinceEpoch":1700566837, "FractionOfSecond":15921577}, "ctlVal":1}, "Identifier":"TS2", "Select":{"stVal":1}}})");
+    ASSERT_TRUE(iec61850->operation("PivotCommand", 1, params));
+
+    delete params[0];
+    delete[] params;
+
+    timeout = std::chrono::seconds(3);  
+    start = std::chrono::high_resolution_clock::now();
+    while (ingestCallbackCalled != 1) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            delete pair;
+            FAIL() << "Callback not called within timeout";
+        }
+        Thread_sleep(10); 
+    }
+
+    ASSERT_NE(selectTime, std::chrono::steady_clock::time_point());
+    ASSERT_NE(operateTime, std::chrono::steady_clock::time_point());
+
+    /* the operate is sent from the select response, not from a later tick */
+    auto selectToOperate = std::chrono::duration_cast<std::chrono::microseconds>(operateTime - selectTime).count();
+    ASSERT_LT(selectToOperate, 1000)
+        << "select -> operate: " << selectToOperate << " us";
+
+    Datapoint* commandResponse = storedReading->getReadingData()[0];
+    Datapoint* gtic = getChild(*commandResponse,"GTIC");
+    Datapoint* cause = getChild(*gtic,"Cause");
+
+    int expectedStVal = 7;
+    verifyDatapoint(cause, "stVal", &expectedStVal);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+    delete pair;
+}
+
 TEST_F(ControlTest, SingleCommandSetValue) {
     iec61850->setJsonConfig(protocol_config, exchanged_data, tls_config);
 
@@ -1118,4 +1236,953 @@ TEST_F(ControlTest, WriteOperations) {
     IedServer_stop(server);
     IedServer_destroy(server);
     IedModel_destroy(model);
-}
\ No newline at end of file
+}
+
+static long
+residentPages()
+{
+    long size = 0;
+    long resident = 0;
+
+    FILE* statm = fopen("/proc/self/statm", "r");
+
+    if (statm) {
+        if (fscanf(statm, "%ld %ld", &size, &resident) != 2)
+            resident = 0;
+        fclose(statm);
+    }
+
+    return resident;
+}
+
+/* RSS growth allowed between the two checkpoints of a soak test, far
+ * below what one allocation kept per operation would add */
+static const long maxPageGrowth = 256;
+
+TEST_F(ControlTest, CommandSoak) {
+    iec61850->setJsonConfig(protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+    IedServer_start(server,10002);
+
+    iec61850->start();
+    Thread_sleep(1000); 
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);  
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->m_connection || IedConnection_getState(iec61850->m_client->m_active_connection->m_connection) != IED_STATE_CONNECTED) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    const int commands = 2000;
+    long pagesBefore = 0;
+
+    auto params = new PLUGIN_PARAMETER*[1];
+    params[0] = new PLUGIN_PARAMETER;
+    params[0]->name = std::string("Pivot");
+
+    for (int i = 0; i < commands; i++) {
+        /* after the first allocations of the connection */
+        if (i == 100)
+            pagesBefore = residentPages();
+
+        params[0]->value = std::string(R"({"GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"ctlVal":)") + (i % 2 ? "1" : "0") + R"(}, "Identifier":"TS1", "Select":{"stVal":0}}})";
+
+        /* the object is released right after ActCon was sent */
+        int attempts = 0;
+        while (!iec61850->operation("PivotCommand", 1, params) && attempts++ < 1000)
+            Thread_sleep(1);
+        ASSERT_LT(attempts, 1000);
+
+        timeout = std::chrono::seconds(3);  
+        start = std::chrono::high_resolution_clock::now();
+        while (ingestCallbackCalled != i + 1) {
+            auto now = std::chrono::high_resolution_clock::now();
+            if (now - start > timeout) {
+                IedServer_stop(server);
+                IedServer_destroy(server);
+                IedModel_destroy(model);
+                FAIL() << "Callback not called within timeout";
+                break;
+            }
+            Thread_sleep(1); 
+        }
+
+        for (auto reading : storedReadings)
+            delete reading;
+        storedReadings.clear();
+        storedReading = nullptr;
+    }
+
+    Thread_sleep(100);
+
+    IEC61850ClientConnection* connection = iec61850->m_client->m_active_connection;
+
+    /* nothing is kept per command */
+    ASSERT_EQ(iec61850->m_client->m_commandTracker.size(), 0);
+    ASSERT_EQ(connection->m_commandTimers->size(), 0);
+
+    delete params[0];
+    delete[] params;
+
+    long pagesAfter = residentPages();
+    ASSERT_LT(pagesAfter - pagesBefore, maxPageGrowth)
+        << "resident pages after " << commands << " commands: "
+        << pagesBefore << " -> " << pagesAfter;
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
+
+TEST_F(ControlTest, WriteSoak) {
+    iec61850->setJsonConfig(protocol_config, exchanged_data_3 , tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/iec61850fledgetest.cfg");
+    IedServer server = IedServer_create(model);
+    IedServer_start(server,10002);
+
+    iec61850->start();
+    Thread_sleep(1000); 
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);  
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->m_connection || IedConnection_getState(iec61850->m_client->m_active_connection->m_connection) != IED_STATE_CONNECTED) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    IEC61850ClientConnection* connection = iec61850->m_client->m_active_connection;
+
+    const int writes = 10000;
+    long pagesBefore = 0;
+
+    auto params = new PLUGIN_PARAMETER*[1];
+    params[0] = new PLUGIN_PARAMETER;
+    params[0]->name = std::string("Pivot");
+
+    for (int i = 0; i < writes; i++) {
+        if (i == 100)
+            pagesBefore = residentPages();
+
+        params[0]->value = std::string(R"({"GTIC":{"ComingFrom":"iec61850", "IngTyp":{"setVal":)") + std::to_string(i % 100) + R"(}, "Identifier":"SG3"}})";
+
+        /* a write is rejected while all the write contexts are in use */
+        int attempts = 0;
+        while (!iec61850->operation("PivotCommand", 1, params) && attempts++ < 1000)
+            Thread_sleep(1);
+        ASSERT_LT(attempts, 1000);
+    }
+
+    delete params[0];
+    delete[] params;
+
+    start = std::chrono::high_resolution_clock::now();
+    for (auto& context : connection->m_writeContexts) {
+        while (context.busy && std::chrono::high_resolution_clock::now() - start < std::chrono::seconds(3))
+            Thread_sleep(1);
+        ASSERT_FALSE(context.busy);
+    }
+
+    /* nothing is kept per write */
+    ASSERT_EQ(iec61850->m_client->m_commandTracker.size(), 0);
+
+    long pagesAfter = residentPages();
+    ASSERT_LT(pagesAfter - pagesBefore, maxPageGrowth)
+        << "resident pages after " << writes << " writes: "
+        << pagesBefore << " -> " << pagesAfter;
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
+
+TEST_F(ControlTest, LazyControlObject) {
+    iec61850->setJsonConfig(lazy_protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+    IedServer_start(server,10002);
+
+    iec61850->start();
+    Thread_sleep(1000); 
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);  
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    IEC61850ClientConnection* connection = iec61850->m_client->m_active_connection;
+
+    /* nothing is read for the control objects at bring-up */
+    ASSERT_TRUE(connection->m_controlObjects.empty());
+
+    auto params = new PLUGIN_PARAMETER*[1];
+    params[0] = new PLUGIN_PARAMETER;
+    params[0]->name = std::string("Pivot");
+    params[0]->value = std::string(R"({"GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"q":{"test":0}, "t":{"SecondSinceEpoch":1700566837, "FractionOfSecond":15921577}, "ctlVal":1}, "Identifier":"TS1", "Select":{"stVal":0}}})");
+    ASSERT_TRUE(iec61850->operation("PivotCommand", 1, params));
+
+    delete params[0];
+    delete[] params;
+
+    timeout = std::chrono::seconds(3);  
+    start = std::chrono::high_resolution_clock::now();
+    while (ingestCallbackCalled != 1) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Callback not called within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    Datapoint* commandResponse = storedReading->getReadingData()[0];
+    Datapoint* gtic = getChild(*commandResponse,"GTIC");
+    Datapoint* cause = getChild(*gtic,"Cause");
+
+    int expectedStVal = 7;
+    verifyDatapoint(cause, "stVal", &expectedStVal);
+
+    /* created by the first command, the other ones are not */
+    ASSERT_EQ(connection->m_controlObjects.size(), 1);
+    ASSERT_EQ(connection->m_controlObjects.count("simpleIOGenericIO/GGIO1.SPCSO1"), 1);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
+
+static ControlHandlerResult
+controlHandlerFailed(ControlAction action, void* parameter, MmsValue* value, bool test)
+{
+    return CONTROL_RESULT_FAILED;
+}
+
+static int terminationCalls = 0;
+
+static ControlHandlerResult
+controlHandlerFailedLater(ControlAction action, void* parameter, MmsValue* value, bool test)
+{
+    /* accepted first, the operation fails afterwards */
+    if (terminationCalls++ == 0)
+        return CONTROL_RESULT_WAITING;
+
+    return CONTROL_RESULT_FAILED;
+}
+
+TEST_F(ControlTest, OperateFailedNegativeAck) {
+    iec61850->setJsonConfig(protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+
+    /* SPCSO1 is direct-with-normal-security */
+    auto spcso1 = (DataObject*) IedModel_getModelNodeByObjectReference(model, "simpleIOGenericIO/GGIO1.SPCSO1");
+    IedServer_setControlHandler(server, spcso1, (ControlHandler) controlHandlerFailed, nullptr);
+
+    IedServer_start(server,10002);
+
+    iec61850->start();
+    Thread_sleep(1000); 
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);  
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    auto params = new PLUGIN_PARAMETER*[1];
+    params[0] = new PLUGIN_PARAMETER;
+    params[0]->name = std::string("Pivot");
+    params[0]->value = std::string(R"({"GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"ctlVal":1}, "Identifier":"TS1"}})");
+    ASSERT_TRUE(iec61850->operation("PivotCommand", 1, params));
+
+    delete params[0];
+    delete[] params;
+
+    timeout = std::chrono::seconds(3);  
+    start = std::chrono::high_resolution_clock::now();
+    while (ingestCallbackCalled != 1) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Callback not called within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    /* ActCon- */
+    Datapoint* gtic = getChild(*storedReading->getReadingData()[0], "GTIC");
+    int expectedStVal = 7;
+    verifyDatapoint(getChild(*gtic, "Cause"), "stVal", &expectedStVal);
+    int negative = 1;
+    verifyDatapoint(getChild(*gtic, "Confirmation"), "stVal", &negative);
+
+    ASSERT_EQ(iec61850->m_client->m_commandTracker.size(), 0);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
+
+TEST_F(ControlTest, TerminationErrorNegativeAck) {
+    iec61850->setJsonConfig(protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+
+    /* SPCSO3 is direct-with-enhanced-security */
+    auto spcso3 = (DataObject*) IedModel_getModelNodeByObjectReference(model, "simpleIOGenericIO/GGIO1.SPCSO3");
+    terminationCalls = 0;
+    IedServer_setControlHandler(server, spcso3, (ControlHandler) controlHandlerFailedLater, nullptr);
+
+    IedServer_start(server,10002);
+
+    iec61850->start();
+    Thread_sleep(1000); 
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);  
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    auto params = new PLUGIN_PARAMETER*[1];
+    params[0] = new PLUGIN_PARAMETER;
+    params[0]->name = std::string("Pivot");
+    params[0]->value = std::string(R"({"GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"ctlVal":1}, "Identifier":"TS3"}})");
+    ASSERT_TRUE(iec61850->operation("PivotCommand", 1, params));
+
+    delete params[0];
+    delete[] params;
+
+    timeout = std::chrono::seconds(3);  
+    start = std::chrono::high_resolution_clock::now();
+    while (ingestCallbackCalled != 2) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Callback not called within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    /* ActCon+, then ActTerm- from the CommandTermination- */
+    Datapoint* gtic = getChild(*storedReadings[0]->getReadingData()[0], "GTIC");
+    int expectedStVal = 7;
+    verifyDatapoint(getChild(*gtic, "Cause"), "stVal", &expectedStVal);
+    ASSERT_EQ(getChild(*gtic, "Confirmation"), nullptr);
+
+    gtic = getChild(*storedReadings[1]->getReadingData()[0], "GTIC");
+    expectedStVal = 10;
+    verifyDatapoint(getChild(*gtic, "Cause"), "stVal", &expectedStVal);
+    int negative = 1;
+    verifyDatapoint(getChild(*gtic, "Confirmation"), "stVal", &negative);
+
+    ASSERT_EQ(iec61850->m_client->m_commandTracker.size(), 0);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
+
+TEST_F(ControlTest, OperateAfterSelectNegativeAck) {
+    iec61850->setJsonConfig(protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+    IedServer_start(server,10002);
+
+    iec61850->start();
+    Thread_sleep(1000); 
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);  
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    IEC61850ClientConnection* connection = iec61850->m_client->m_active_connection;
+
+    /* SPCSO2 is sbo-with-normal-security */
+    const char* objRef = "simpleIOGenericIO/GGIO1.SPCSO2";
+    ASSERT_EQ(connection->m_controlObjects.count(objRef), 1);
+    IEC61850ClientConnection::ControlObjectStruct* cos = connection->m_controlObjects[objRef];
+
+    /* the operate following the select goes to a connection that is not
+     * open, so it cannot be sent */
+    IedClientError error;
+    MmsVariableSpecification* spec = IedConnection_getVariableSpecification(connection->m_connection, &error, objRef, IEC61850_FC_CO);
+    ASSERT_NE(spec, nullptr);
+    IedConnection offline = IedConnection_create();
+    ControlObjectClient offlineClient = ControlObjectClient_createEx(objRef, offline, CONTROL_MODEL_SBO_NORMAL, spec);
+    MmsVariableSpecification_destroy(spec);
+    ASSERT_NE(offlineClient, nullptr);
+
+    ControlObjectClient client = cos->client;
+    MmsValue* value = cos->value;
+    MmsValue* ctlVal = MmsValue_newBoolean(true);
+
+    uint64_t commandId = iec61850->m_client->m_commandTracker.add("TS2", R"({"GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"ctlVal":1}, "Identifier":"TS2"}})");
+    IEC61850ClientConnection::ControlContext* context = &cos->contexts[0];
+    context->commandId = commandId;
+    cos->commandId = commandId;
+    cos->client = offlineClient;
+    cos->value = ctlVal;
+    cos->state = IEC61850ClientConnection::CONTROL_WAIT_FOR_SELECT;
+    cos->requests++;
+
+    /* positive select response */
+    IEC61850ClientConnection::controlActionHandler(0, context, IED_ERROR_OK, CONTROL_ACTION_TYPE_SELECT, true);
+
+    cos->client = client;
+    cos->value = value;
+
+    /* ActCon- right away */
+    ASSERT_EQ(ingestCallbackCalled, 1);
+    Datapoint* gtic = getChild(*storedReading->getReadingData()[0], "GTIC");
+    int expectedStVal = 7;
+    verifyDatapoint(getChild(*gtic, "Cause"), "stVal", &expectedStVal);
+    int negative = 1;
+    verifyDatapoint(getChild(*gtic, "Confirmation"), "stVal", &negative);
+
+    ASSERT_EQ(cos->commandId, IEC61850CommandTracker::NO_COMMAND);
+    ASSERT_EQ(iec61850->m_client->m_commandTracker.size(), 0);
+
+    ControlObjectClient_destroy(offlineClient);
+    IedConnection_destroy(offline);
+    MmsValue_delete(ctlVal);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
+
+TEST_F(ControlTest, CommandBatch) {
+    iec61850->setJsonConfig(protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+
+    /* SPCSO2 is sbo-with-normal-security, SPCSO3 direct-with-enhanced-security */
+    auto spcso2 = (DataObject*) IedModel_getModelNodeByObjectReference(model, "simpleIOGenericIO/GGIO1.SPCSO2");
+    auto pair2 = new std::pair<IedServer, DataAttribute*>(server, (DataAttribute*) IedModel_getModelNodeByObjectReference(model, "simpleIOGenericIO/GGIO1.SPCSO2.stVal"));
+    IedServer_setControlHandler(server, spcso2, (ControlHandler) controlHandlerForBinaryOutput, pair2);
+    auto spcso3 = (DataObject*) IedModel_getModelNodeByObjectReference(model, "simpleIOGenericIO/GGIO1.SPCSO3");
+    auto pair3 = new std::pair<IedServer, DataAttribute*>(server, (DataAttribute*) IedModel_getModelNodeByObjectReference(model, "simpleIOGenericIO/GGIO1.SPCSO3.stVal"));
+    IedServer_setControlHandler(server, spcso3, (ControlHandler) controlHandlerForBinaryOutput, pair3);
+
+    IedServer_start(server,10002);
+
+    iec61850->start();
+    Thread_sleep(1000); 
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);  
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            delete pair2;
+            delete pair3;
+            FAIL() << "Connection not established within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    /* Q2 selects and operates the object of Q1 again once Q1 is confirmed,
+     * Q4 comes after it, Q3 is sent at once */
+    auto params = new PLUGIN_PARAMETER*[1];
+    params[0] = new PLUGIN_PARAMETER;
+    params[0]->name = std::string("Pivot");
+    params[0]->value = std::string(R"({"PivotCommandBatch":{"Identifier":"BAY1", "Commands":[
+        {"Id":"Q1", "GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"ctlVal":1}, "Identifier":"TS2"}},
+        {"Id":"Q2", "After":["Q1"], "GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"ctlVal":0}, "Identifier":"TS2"}},
+        {"Id":"Q3", "GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"ctlVal":1}, "Identifier":"TS1"}},
+        {"Id":"Q4", "After":["Q2"], "GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"ctlVal":1}, "Identifier":"TS3"}}]}})");
+    ASSERT_TRUE(iec61850->operation("PivotCommandBatch", 1, params));
+
+    /* ActCon of Q1, Q2, Q3, ActCon and ActTerm of Q4, then the batch */
+    timeout = std::chrono::seconds(5);  
+    start = std::chrono::high_resolution_clock::now();
+    while (ingestCallbackCalled != 6) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            delete pair2;
+            delete pair3;
+            FAIL() << "Callback not called within timeout";
+        }
+        Thread_sleep(10); 
+    }
+
+    int actCon = 7;
+    int actTerm = 10;
+    int positive = 0;
+    int negative = 1;
+    int confirmed = 4;
+    int none = 0;
+    int ts2Acks = 0;
+
+    for (auto reading : storedReadings) {
+        Datapoint* gtic = getChild(*reading->getReadingData()[0], "GTIC");
+
+        if (reading->getAssetName() == "TS2") {
+            ts2Acks++;
+            verifyDatapoint(getChild(*gtic, "Cause"), "stVal", &actCon);
+            ASSERT_FALSE(hasChild(*gtic, "Confirmation"));
+        }
+    }
+
+    ASSERT_EQ(ts2Acks, 2);
+
+    Reading* batchAck = storedReadings.back();
+    ASSERT_EQ(batchAck->getAssetName(), "BAY1");
+    Datapoint* gtic = getChild(*batchAck->getReadingData()[0], "GTIC");
+    verifyDatapoint(getChild(*gtic, "Cause"), "stVal", &actTerm);
+    verifyDatapoint(getChild(*gtic, "Confirmation"), "stVal", &positive);
+    Datapoint* batchDp = getChild(*gtic, "Batch");
+    verifyDatapoint(batchDp, "Confirmed", &confirmed);
+    verifyDatapoint(batchDp, "Failed", &none);
+    verifyDatapoint(batchDp, "Skipped", &none);
+
+    int done = 1;
+    Datapoint* commands = getChild(*batchDp, "Commands");
+    verifyDatapoint(commands, "Q1", &done);
+    verifyDatapoint(commands, "Q2", &done);
+    verifyDatapoint(commands, "Q3", &done);
+    verifyDatapoint(commands, "Q4", &done);
+
+    /* Q2 has been operated after Q1 */
+    ASSERT_FALSE(MmsValue_getBoolean(IedServer_getAttributeValue(server, pair2->second)));
+    ASSERT_TRUE(MmsValue_getBoolean(IedServer_getAttributeValue(server, pair3->second)));
+    ASSERT_EQ(iec61850->m_client->m_commandTracker.size(), 0);
+
+    /* the failure of X skips Y */
+    params[0]->value = std::string(R"({"PivotCommandBatch":{"Identifier":"BAY2", "Commands":[
+        {"Id":"X", "GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"ctlVal":1}, "Identifier":"TSX"}},
+        {"Id":"Y", "After":["X"], "GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"ctlVal":1}, "Identifier":"TS1"}}]}})");
+    ASSERT_TRUE(iec61850->operation("PivotCommandBatch", 1, params));
+
+    delete params[0];
+    delete[] params;
+
+    start = std::chrono::high_resolution_clock::now();
+    while (ingestCallbackCalled != 7) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            delete pair2;
+            delete pair3;
+            FAIL() << "Callback not called within timeout";
+        }
+        Thread_sleep(10); 
+    }
+
+    ASSERT_EQ(storedReading->getAssetName(), "BAY2");
+    gtic = getChild(*storedReading->getReadingData()[0], "GTIC");
+    verifyDatapoint(getChild(*gtic, "Confirmation"), "stVal", &negative);
+    batchDp = getChild(*gtic, "Batch");
+    verifyDatapoint(batchDp, "Confirmed", &none);
+    verifyDatapoint(batchDp, "Failed", &done);
+    verifyDatapoint(batchDp, "Skipped", &done);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+    delete pair2;
+    delete pair3;
+}
+
+static string exchanged_data_without_ts2 = QUOTE({
+ "exchanged_data": {
+  "datapoints": [
+   {
+    "pivot_id": "TS1",
+    "label": "TS1",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "simpleIOGenericIO/GGIO1.SPCSO1",
+      "cdc": "SpcTyp"
+     }
+    ]
+   },
+   {
+    "pivot_id": "TS3",
+    "label": "TS3",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "simpleIOGenericIO/GGIO1.SPCSO3",
+      "cdc": "SpcTyp"
+     }
+    ]
+   }
+  ]
+ }
+});
+
+TEST_F(ControlTest, ReconfigureRetiresControl) {
+    iec61850->setJsonConfig(protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/simpleIO_control_tests.cfg");
+    IedServer server = IedServer_create(model);
+    IedServer_start(server,10002);
+
+    iec61850->start();
+    Thread_sleep(1000); 
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);  
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    IEC61850ClientConnection* connection = iec61850->m_client->m_active_connection;
+
+    const char* objRef = "simpleIOGenericIO/GGIO1.SPCSO2";
+    ASSERT_EQ(connection->m_controlObjects.count(objRef), 1);
+    IEC61850ClientConnection::ControlObjectStruct* cos = connection->m_controlObjects[objRef];
+
+    /* a response to the object is still outstanding */
+    cos->requests++;
+
+    ASSERT_TRUE(iec61850->reconfigure(protocol_config, exchanged_data_without_ts2, tls_config));
+
+    ASSERT_EQ(connection->m_controlObjects.count(objRef), 0);
+    ASSERT_EQ(connection->m_retiredControls.size(), 1);
+    ASSERT_EQ(connection->m_controlObjects.count("simpleIOGenericIO/GGIO1.SPCSO1"), 1);
+
+    /* kept until the response has come */
+    Thread_sleep(200);
+    ASSERT_EQ(connection->m_retiredControls.size(), 1);
+
+    cos->requests--;
+
+    start = std::chrono::high_resolution_clock::now();
+    timeout = std::chrono::seconds(5);
+    while (!connection->m_retiredControls.empty()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Retired control object not destroyed within timeout";
+        }
+        Thread_sleep(10); 
+    }
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
+
+static string exchanged_data_settings = QUOTE({
+ "exchanged_data": {
+  "datapoints": [
+   {
+    "pivot_id": "SP1",
+    "label": "SP1",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "settingProt/FSCH1.SchdReuse",
+      "cdc": "SpgTyp"
+     }
+    ]
+   },
+   {
+    "pivot_id": "SP2",
+    "label": "SP2",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "settingProt/FSCH1.ValASG001",
+      "cdc": "AsgTyp"
+     }
+    ]
+   },
+   {
+    "pivot_id": "SP3",
+    "label": "SP3",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "settingProt/FSCH1.SchdPrio",
+      "cdc": "IngTyp"
+     }
+    ]
+   },
+   {
+    "pivot_id": "SE1",
+    "label": "SE1",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "settingProt/PTOC1.StrVal",
+      "cdc": "AsgTyp"
+     }
+    ]
+   },
+   {
+    "pivot_id": "SE2",
+    "label": "SE2",
+    "protocols": [
+     {
+      "name": "iec61850",
+      "objref": "settingProt/PTOC1.TmMult",
+      "cdc": "IngTyp"
+     }
+    ]
+   }
+  ]
+ }
+});
+
+static int confirmedEditSg = 0;
+static float confirmedStrVal = 0;
+static int32_t confirmedTmMult = 0;
+static DataAttribute* strVal = nullptr;
+static DataAttribute* tmMult = nullptr;
+
+static bool
+editSettingGroupChangedHandler(void* parameter, SettingGroupControlBlock* sgcb, uint8_t newEditSg, ClientConnection connection)
+{
+    return true;
+}
+
+/* the edited values are in the SE data until the edit is confirmed */
+static void
+editSettingGroupConfirmationHandler(void* parameter, SettingGroupControlBlock* sgcb, uint8_t editSg)
+{
+    auto server = (IedServer) parameter;
+
+    confirmedEditSg = editSg;
+    confirmedStrVal = MmsValue_toFloat(IedServer_getAttributeValue(server, strVal));
+    confirmedTmMult = MmsValue_toInt32(IedServer_getAttributeValue(server, tmMult));
+}
+
+TEST_F(ControlTest, SettingBatch) {
+    iec61850->setJsonConfig(protocol_config, exchanged_data_settings, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx("../tests/data/setting_batch_tests.cfg");
+    IedServer server = IedServer_create(model);
+    IedServer_setWriteAccessPolicy(server, IEC61850_FC_SP, ACCESS_POLICY_ALLOW);
+    IedServer_setWriteAccessPolicy(server, IEC61850_FC_SE, ACCESS_POLICY_ALLOW);
+
+    strVal = (DataAttribute*) IedModel_getModelNodeByObjectReference(model, "settingProt/PTOC1.StrVal.setMag.f");
+    tmMult = (DataAttribute*) IedModel_getModelNodeByObjectReference(model, "settingProt/PTOC1.TmMult.setVal");
+
+    SettingGroupControlBlock* sgcb = LogicalDevice_getSettingGroupControlBlock(IedModel_getDeviceByInst(model, "Prot"));
+    IedServer_setEditSettingGroupChangedHandler(server, sgcb, editSettingGroupChangedHandler, nullptr);
+    IedServer_setEditSettingGroupConfirmationHandler(server, sgcb, editSettingGroupConfirmationHandler, server);
+
+    IedServer_start(server,10002);
+
+    iec61850->start();
+    Thread_sleep(1000); 
+
+    auto start = std::chrono::high_resolution_clock::now();
+    auto timeout = std::chrono::seconds(10);  
+    while (!iec61850->m_client->m_active_connection || !iec61850->m_client->m_active_connection->Connected()) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Connection not established within timeout";
+            break;
+        }
+        Thread_sleep(10); 
+    }
+
+    /* without setting group the SP values are written directly */
+    auto params = new PLUGIN_PARAMETER*[1];
+    params[0] = new PLUGIN_PARAMETER;
+    params[0]->name = std::string("Pivot");
+    params[0]->value = std::string(R"({"PivotSettingBatch":{"Identifier":"PROFILE1", "Settings":[
+        {"GTIC":{"ComingFrom":"iec61850", "SpgTyp":{"setVal":1}, "Identifier":"SP1"}},
+        {"GTIC":{"ComingFrom":"iec61850", "AsgTyp":{"setMag":{"f":1.5}}, "Identifier":"SP2"}},
+        {"GTIC":{"ComingFrom":"iec61850", "IngTyp":{"setVal":7}, "Identifier":"SP3"}}]}})");
+    ASSERT_TRUE(iec61850->operation("PivotSettingBatch", 1, params));
+
+    timeout = std::chrono::seconds(5);  
+    start = std::chrono::high_resolution_clock::now();
+    while (ingestCallbackCalled != 1) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Callback not called within timeout";
+        }
+        Thread_sleep(10); 
+    }
+
+    int actTerm = 10;
+    int positive = 0;
+    int negative = 1;
+    int written = 1;
+    int none = 0;
+    int three = 3;
+    int two = 2;
+
+    ASSERT_EQ(storedReading->getAssetName(), "PROFILE1");
+    Datapoint* gtic = getChild(*storedReading->getReadingData()[0], "GTIC");
+    verifyDatapoint(getChild(*gtic, "Cause"), "stVal", &actTerm);
+    verifyDatapoint(getChild(*gtic, "Confirmation"), "stVal", &positive);
+    Datapoint* batchDp = getChild(*gtic, "Batch");
+    verifyDatapoint(batchDp, "Written", &three);
+    verifyDatapoint(batchDp, "Failed", &none);
+    Datapoint* settings = getChild(*batchDp, "Settings");
+    verifyDatapoint(settings, "SP1", &written);
+    verifyDatapoint(settings, "SP2", &written);
+    verifyDatapoint(settings, "SP3", &written);
+
+    ASSERT_TRUE(MmsValue_getBoolean(IedServer_getAttributeValue(server, (DataAttribute*) IedModel_getModelNodeByObjectReference(model, "settingProt/FSCH1.SchdReuse.setVal"))));
+    ASSERT_EQ(MmsValue_toFloat(IedServer_getAttributeValue(server, (DataAttribute*) IedModel_getModelNodeByObjectReference(model, "settingProt/FSCH1.ValASG001.setMag.f"))), 1.5f);
+    ASSERT_EQ(MmsValue_toInt32(IedServer_getAttributeValue(server, (DataAttribute*) IedModel_getModelNodeByObjectReference(model, "settingProt/FSCH1.SchdPrio.setVal"))), 7);
+
+    /* with setting group the SE values are written in an edit session */
+    params[0]->value = std::string(R"({"PivotSettingBatch":{"Identifier":"PROFILE2", "SettingGroup":2, "Settings":[
+        {"GTIC":{"ComingFrom":"iec61850", "AsgTyp":{"setMag":{"f":2.5}}, "Identifier":"SE1"}},
+        {"GTIC":{"ComingFrom":"iec61850", "IngTyp":{"setVal":4}, "Identifier":"SE2"}}]}})");
+    ASSERT_TRUE(iec61850->operation("PivotSettingBatch", 1, params));
+
+    start = std::chrono::high_resolution_clock::now();
+    while (ingestCallbackCalled != 2) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Callback not called within timeout";
+        }
+        Thread_sleep(10); 
+    }
+
+    ASSERT_EQ(confirmedEditSg, 2);
+    ASSERT_EQ(confirmedStrVal, 2.5f);
+    ASSERT_EQ(confirmedTmMult, 4);
+
+    ASSERT_EQ(storedReading->getAssetName(), "PROFILE2");
+    gtic = getChild(*storedReading->getReadingData()[0], "GTIC");
+    verifyDatapoint(getChild(*gtic, "Confirmation"), "stVal", &positive);
+    batchDp = getChild(*gtic, "Batch");
+    verifyDatapoint(batchDp, "Written", &two);
+    verifyDatapoint(batchDp, "Failed", &none);
+    settings = getChild(*batchDp, "Settings");
+    verifyDatapoint(settings, "SE1", &written);
+    verifyDatapoint(settings, "SE2", &written);
+
+    /* the IED has two groups, the edit of a third one is refused */
+    confirmedEditSg = 0;
+    params[0]->value = std::string(R"({"PivotSettingBatch":{"Identifier":"PROFILE3", "SettingGroup":3, "Settings":[
+        {"GTIC":{"ComingFrom":"iec61850", "IngTyp":{"setVal":5}, "Identifier":"SE2"}}]}})");
+    ASSERT_TRUE(iec61850->operation("PivotSettingBatch", 1, params));
+
+    delete params[0];
+    delete[] params;
+
+    start = std::chrono::high_resolution_clock::now();
+    while (ingestCallbackCalled != 3) {
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - start > timeout) {
+            IedServer_stop(server);
+            IedServer_destroy(server);
+            IedModel_destroy(model);
+            FAIL() << "Callback not called within timeout";
+        }
+        Thread_sleep(10); 
+    }
+
+    ASSERT_EQ(confirmedEditSg, 0);
+
+    ASSERT_EQ(storedReading->getAssetName(), "PROFILE3");
+    gtic = getChild(*storedReading->getReadingData()[0], "GTIC");
+    verifyDatapoint(getChild(*gtic, "Confirmation"), "stVal", &negative);
+    batchDp = getChild(*gtic, "Batch");
+    verifyDatapoint(batchDp, "Written", &none);
+    verifyDatapoint(batchDp, "Failed", &written);
+    settings = getChild(*batchDp, "Settings");
+    verifyDatapoint(settings, "SE2", &none);
+
+    IedServer_stop(server);
+    IedServer_destroy(server);
+    IedModel_destroy(model);
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <iec61850_command_batch.hpp>
+
+using namespace std;
+
+TEST (CommandBatchTest, Parse)
+{
+    IEC61850CommandBatch batch;
+
+    ASSERT_TRUE (batch.parse (
+        R"({"PivotCommandBatch":{"Identifier":"BAY1", "Sequential":true, "Commands":[
+            {"Id":"Q0", "GTIC":{"SpcTyp":{"ctlVal":0}, "Identifier":"TS1"}},
+            {"GTIC":{"DpcTyp":{"ctlVal":1}, "Identifier":"TS2"}},
+            {"Id":"Q9", "After":["Q0"], "GTIC":{"SpcTyp":{"ctlVal":1}, "Identifier":"TS3"}}]}})"));
+
+    ASSERT_EQ (batch.identifier (), "BAY1");
+    ASSERT_EQ (batch.size (), 3);
+    ASSERT_EQ (batch.step (1).key, "1");
+    ASSERT_EQ (batch.step (0).json,
+               R"({"GTIC":{"SpcTyp":{"ctlVal":0},"Identifier":"TS1"}})");
+
+    /* sequential: each command also waits for the previous one */
+    ASSERT_EQ (batch.step (2).waitingFor, 2);
+
+    ASSERT_FALSE (IEC61850CommandBatch ().parse (
+        R"({"PivotCommandBatch":{"Commands":[]}})"));
+    ASSERT_FALSE (IEC61850CommandBatch ().parse (
+        R"({"PivotCommandBatch":{"Commands":[{"Id":"Q0"}]}})"));
+
+    /* only earlier commands can be waited for */
+    ASSERT_FALSE (IEC61850CommandBatch ().parse (
+        R"({"PivotCommandBatch":{"Commands":[
+            {"Id":"Q0", "After":["Q1"], "GTIC":{}},
+            {"Id":"Q1", "GTIC":{}}]}})"));
+    ASSERT_FALSE (IEC61850CommandBatch ().parse (
+        R"({"PivotCommandBatch":{"Commands":[
+            {"Id":"Q0", "GTIC":{}}, {"Id":"Q0", "GTIC":{}}]}})"));
+}
+
+TEST (CommandBatchTest, ParallelAndOrdered)
+{
+    IEC61850CommandBatch batch;
+
+    /* Q2 closes after the two isolators, the earthing switch is apart */
+    ASSERT_TRUE (batch.addStep ("Q1", "{}", {}));
+    ASSERT_TRUE (batch.addStep ("Q9", "{}", {}));
+    ASSERT_TRUE (batch.addStep ("Q2", "{}", { "Q1", "Q9" }));
+    ASSERT_TRUE (batch.addStep ("Q8", "{}", {}));
+    ASSERT_FALSE (batch.addStep ("Q3", "{}", { "Q4" }));
+    ASSERT_FALSE (batch.addStep ("Q1", "{}", {}));
+
+    vector<size_t> steps = batch.start ();
+    ASSERT_EQ (steps, vector<size_t> ({ 0, 1, 3 }));
+    ASSERT_EQ (batch.count (IEC61850CommandBatch::RUNNING), 3);
+
+    ASSERT_TRUE (batch.done (0, true).empty ());
+    /* a result is only taken once */
+    ASSERT_TRUE (batch.done (0, false).empty ());
+    ASSERT_TRUE (batch.done (3, true).empty ());
+
+    steps = batch.done (1, true);
+    ASSERT_EQ (steps, vector<size_t> ({ 2 }));
+    ASSERT_FALSE (batch.finished ());
+
+    ASSERT_TRUE (batch.done (2, true).empty ());
+    ASSERT_TRUE (batch.finished ());
+    ASSERT_EQ (batch.count (IEC61850CommandBatch::CONFIRMED), 4);
+}
+
+TEST (CommandBatchTest, FailureSkipsDependents)
+{
+    IEC61850CommandBatch batch;
+
+    ASSERT_TRUE (batch.addStep ("A", "{}", {}));
+    ASSERT_TRUE (batch.addStep ("B", "{}", { "A" }));
+    ASSERT_TRUE (batch.addStep ("C", "{}", { "B" }));
+    ASSERT_TRUE (batch.addStep ("D", "{}", {}));
+
+    ASSERT_EQ (batch.start ().size (), 2);
+
+    ASSERT_TRUE (batch.done (0, false).empty ());
+    ASSERT_EQ (batch.step (1).state, IEC61850CommandBatch::SKIPPED);
+    ASSERT_EQ (batch.step (2).state, IEC61850CommandBatch::SKIPPED);
+    ASSERT_FALSE (batch.finished ());
+
+    ASSERT_TRUE (batch.done (3, true).empty ());
+    ASSERT_TRUE (batch.finished ());
+    ASSERT_EQ (batch.count (IEC61850CommandBatch::FAILED), 1);
+    ASSERT_EQ (batch.count (IEC61850CommandBatch::SKIPPED), 2);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <iec61850_command_tracker.hpp>
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST (CommandTrackerTest, AddAndRemove)
+{
+    IEC61850CommandTracker tracker;
+
+    uint64_t first = tracker.add ("TS1", "{\"GTIC\":{\"Identifier\":\"TS1\"}}");
+    uint64_t second = tracker.add ("TS1", "{\"GTIC\":{\"Identifier\":\"TS1\"}}");
+
+    ASSERT_NE (first, IEC61850CommandTracker::NO_COMMAND);
+    ASSERT_NE (first, second);
+    ASSERT_EQ (tracker.size (), 2);
+
+    IEC61850CommandTracker::Command command;
+    ASSERT_TRUE (tracker.get (first, command));
+    ASSERT_EQ (command.label, "TS1");
+
+    ASSERT_TRUE (tracker.remove (first));
+    ASSERT_FALSE (tracker.remove (first));
+    ASSERT_FALSE (tracker.get (first, command));
+    ASSERT_TRUE (tracker.get (second, command));
+    ASSERT_EQ (tracker.size (), 1);
+}
+
+/* commands sent by one thread per object, acknowledged by other threads */
+TEST (CommandTrackerTest, ParallelCommands)
+{
+    const int objects = 16;
+    const int commandsPerObject = 5000;
+
+    IEC61850CommandTracker tracker;
+
+    vector<vector<uint64_t> > ids (objects);
+    vector<atomic<uint64_t> > inFlight (objects);
+    atomic<int> rejected (0);
+    atomic<int> acknowledged (0);
+
+    for (auto& id : inFlight)
+        id = IEC61850CommandTracker::NO_COMMAND;
+
+    vector<thread> senders;
+
+    for (int o = 0; o < objects; o++)
+    {
+        senders.emplace_back ([&, o] () {
+            string label = "TS" + to_string (o);
+
+            for (int i = 0; i < commandsPerObject; i++)
+            {
+                uint64_t id = tracker.add (label, "{}");
+                uint64_t idle = IEC61850CommandTracker::NO_COMMAND;
+
+                /* one command per object, like a control object */
+                while (!inFlight[o].compare_exchange_strong (idle, id))
+                {
+                    idle = IEC61850CommandTracker::NO_COMMAND;
+                    rejected++;
+                    this_thread::yield ();
+                }
+
+                ids[o].push_back (id);
+            }
+        });
+    }
+
+    vector<thread> ackers;
+
+    for (int a = 0; a < 4; a++)
+    {
+        ackers.emplace_back ([&, a] () {
+            while (acknowledged < objects * commandsPerObject)
+            {
+                for (int o = a; o < objects; o += 4)
+                {
+                    uint64_t id = inFlight[o];
+
+                    if (id == IEC61850CommandTracker::NO_COMMAND)
+                        continue;
+
+                    IEC61850CommandTracker::Command command;
+                    ASSERT_TRUE (tracker.get (id, command));
+                    ASSERT_EQ (command.label, "TS" + to_string (o));
+
+                    ASSERT_TRUE (tracker.remove (id));
+                    inFlight[o] = IEC61850CommandTracker::NO_COMMAND;
+                    acknowledged++;
+                }
+            }
+        });
+    }
+
+    for (auto& t : senders)
+        t.join ();
+
+    for (auto& t : ackers)
+        t.join ();
+
+    set<uint64_t> unique;
+
+    for (const auto& objectIds : ids)
+        unique.insert (objectIds.begin (), objectIds.end ());
+
+    ASSERT_EQ (acknowledged, objects * commandsPerObject);
+    ASSERT_EQ (unique.size (), (size_t)acknowledged);
+    ASSERT_EQ (tracker.size (), 0);
+
+    printf ("%d commands acknowledged, %d attempts while in progress\n",
+            acknowledged.load (), rejected.load ());
+}
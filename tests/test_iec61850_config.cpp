@@ -34,6 +34,172 @@ static string protocol_config = QUOTE({
     }
 });
 
+static string multi_ied_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 0
+        },
+        "ieds" : [
+            {
+                "transport_layer" : {
+                    "ied_name" : "IED2",
+                    "connections" : [
+                        {
+                            "ip_addr" : "127.0.0.1",
+                            "port" : 10003
+                        }
+                    ]
+                },
+                "application_layer" : {
+                    "polling_interval" : 1000
+                }
+            }
+        ]
+    }
+});
+
+static string multi_ied_exchanged_data = QUOTE({
+    "exchanged_data" : {
+        "datapoints" : [
+            {
+                "pivot_type" : "SpsTyp",
+                "label" : "TS1",
+                "pivot_id" : "TS1",
+                "protocols" : [
+                    {
+                        "name" : "iec61850",
+                        "objref" : "simpleIOGenericIO/GGIO1.SPCSO1",
+                        "cdc" : "SpsTyp"
+                    }
+                ]
+            },
+            {
+                "pivot_type" : "SpsTyp",
+                "label" : "TS2",
+                "pivot_id" : "TS2",
+                "protocols" : [
+                    {
+                        "name" : "iec61850",
+                        "ied" : "IED2",
+                        "objref" : "simpleIOGenericIO/GGIO1.SPCSO1",
+                        "cdc" : "SpsTyp"
+                    }
+                ]
+            },
+            {
+                "pivot_type" : "SpsTyp",
+                "label" : "TS3",
+                "pivot_id" : "TS3",
+                "protocols" : [
+                    {
+                        "name" : "iec61850",
+                        "ied" : "IED3",
+                        "objref" : "simpleIOGenericIO/GGIO1.SPCSO2",
+                        "cdc" : "SpsTyp"
+                    }
+                ]
+            }
+        ]
+    }
+});
+
+static string bringup_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 0,
+            "bringup_window" : 4,
+            "keep_datasets" : true,
+            "control_objects" : "prewarm",
+            "resync_gi_interval" : 0,
+            "gi_concurrency" : 2,
+            "gi_spacing" : 0,
+            "gi_priority" : [ "PROT", 1, "CTRL" ]
+        }
+    }
+});
+
+static string command_timeouts_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 0,
+            "command_timeouts" : {
+                "select" : 2000,
+                "act_con" : -1,
+                "act_term" : 5000,
+                "ApcTyp" : {
+                    "act_term" : 60000
+                },
+                "SpcTyp" : {
+                    "select" : 0,
+                    "act_con" : "1000"
+                },
+                "XyzTyp" : {
+                    "select" : 100
+                }
+            }
+        }
+    }
+});
+
+static string wrong_bringup_protocol_config = QUOTE({
+    "protocol_stack" : {
+        "name" : "iec61850client",
+        "version" : "0.0.1",
+        "transport_layer" : {
+            "ied_name" : "IED1",
+            "connections" : [
+                {
+                    "ip_addr" : "127.0.0.1",
+                    "port" : 10002
+                }
+            ]
+        },
+        "application_layer" : {
+            "polling_interval" : 0,
+            "bringup_window" : 0,
+            "keep_datasets" : "yes",
+            "control_objects" : "later",
+            "resync_gi_interval" : -1,
+            "gi_concurrency" : 0,
+            "gi_spacing" : "10",
+            "gi_priority" : "PROT"
+        }
+    }
+});
+
 static string wrong_protocol_config_1 = QUOTE({
     "protocol_stack" : {
         "name" : "iec61850client",
@@ -797,6 +963,24 @@ static string tls_config = QUOTE({
     }
 });
 
+static string tls_session_config = QUOTE({
+    "tls_conf" : {
+        "private_key" : "server-key.pem",
+        "own_cert" : "server.cer",
+        "renegotiation_time" : 0,
+        "session_resumption_interval" : 600
+    }
+});
+
+static string wrong_tls_session_config = QUOTE({
+    "tls_conf" : {
+        "private_key" : "server-key.pem",
+        "own_cert" : "server.cer",
+        "renegotiation_time" : "60",
+        "session_resumption_interval" : -1
+    }
+});
+
 class ConfigTest : public testing::Test
 {
 protected:
@@ -1227,4 +1411,147 @@ TEST_F(ConfigTest, TestCommaSeparatedBytes) {
 
     testStr = "0x00,0x01,0xG2,0x03"; 
     ASSERT_THROW(config->parseOsiSelector(testStr, selectorValue, sizeof(selectorValue)), ConfigurationException);
-}
\ No newline at end of file
+}
+
+TEST_F(ConfigTest, ProtocolConfigMultipleIeds) {
+
+    std::vector<IEC61850ClientConfig*> configs = IEC61850ClientConfig::importIedConfigs(multi_ied_protocol_config, multi_ied_exchanged_data, "{}");
+
+    ASSERT_EQ(configs.size(), 2);
+
+    ASSERT_EQ(configs[0]->iedName(), "IED1");
+    ASSERT_EQ(configs[1]->iedName(), "IED2");
+
+    ASSERT_TRUE(configs[0]->m_protocolConfigComplete);
+    ASSERT_TRUE(configs[1]->m_protocolConfigComplete);
+
+    ASSERT_EQ(configs[0]->GetConnections().size(), 1);
+    ASSERT_EQ(configs[0]->GetConnections()[0]->tcpPort, 10002);
+    ASSERT_EQ(configs[1]->GetConnections().size(), 1);
+    ASSERT_EQ(configs[1]->GetConnections()[0]->tcpPort, 10003);
+    ASSERT_EQ(configs[1]->getPollingInterval(), 1000);
+
+    ASSERT_NE(configs[0]->getExchangeDefinitionByLabel("TS1"), nullptr);
+    ASSERT_EQ(configs[0]->getExchangeDefinitionByLabel("TS2"), nullptr);
+    ASSERT_NE(configs[1]->getExchangeDefinitionByLabel("TS2"), nullptr);
+    ASSERT_EQ(configs[1]->getExchangeDefinitionByLabel("TS1"), nullptr);
+
+    ASSERT_EQ(configs[0]->getExchangeDefinitionByLabel("TS3"), nullptr);
+    ASSERT_EQ(configs[1]->getExchangeDefinitionByLabel("TS3"), nullptr);
+
+    for (auto config : configs)
+        delete config;
+}
+
+TEST_F(ConfigTest, ProtocolConfigBringUp) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_EQ(config->bringUpWindow(), 8);
+    ASSERT_FALSE(config->keepDatasets());
+    ASSERT_EQ(config->controlObjects(), CONTROLS_AT_BRINGUP);
+    ASSERT_EQ(config->resyncGiInterval(), 10000);
+    ASSERT_EQ(config->giConcurrency(), 4);
+    ASSERT_EQ(config->giSpacing(), 50);
+    ASSERT_TRUE(config->giPriorities().empty());
+
+    config->importProtocolConfig(bringup_protocol_config);
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->bringUpWindow(), 4);
+    ASSERT_TRUE(config->keepDatasets());
+    ASSERT_EQ(config->controlObjects(), CONTROLS_PREWARM);
+    ASSERT_EQ(config->resyncGiInterval(), 0);
+    ASSERT_EQ(config->giConcurrency(), 2);
+    ASSERT_EQ(config->giSpacing(), 0);
+    ASSERT_EQ(config->giPriorities().size(), 2);
+    ASSERT_EQ(config->giPriorities()[1], "CTRL");
+
+    delete config;
+
+    config = new IEC61850ClientConfig();
+
+    config->importProtocolConfig(wrong_bringup_protocol_config);
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+    ASSERT_EQ(config->bringUpWindow(), 8);
+    ASSERT_FALSE(config->keepDatasets());
+    ASSERT_EQ(config->controlObjects(), CONTROLS_AT_BRINGUP);
+    ASSERT_EQ(config->resyncGiInterval(), 10000);
+    ASSERT_EQ(config->giConcurrency(), 4);
+    ASSERT_EQ(config->giSpacing(), 50);
+    ASSERT_TRUE(config->giPriorities().empty());
+
+    delete config;
+}
+
+TEST_F(ConfigTest, ProtocolConfigCommandTimeouts) {
+
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    ASSERT_EQ(config->commandTimeouts(SPC).select, 10000);
+    ASSERT_EQ(config->commandTimeouts(SPC).actCon, 10000);
+    ASSERT_EQ(config->commandTimeouts(SPC).actTerm, 30000);
+    ASSERT_EQ(config->commandTimeouts(-1).actTerm, 30000);
+
+    config->importProtocolConfig(command_timeouts_protocol_config);
+
+    ASSERT_TRUE(config->m_protocolConfigComplete);
+
+    ASSERT_EQ(config->commandTimeouts(DPC).select, 2000);
+    ASSERT_EQ(config->commandTimeouts(DPC).actCon, 10000);
+    ASSERT_EQ(config->commandTimeouts(DPC).actTerm, 5000);
+
+    ASSERT_EQ(config->commandTimeouts(APC).select, 2000);
+    ASSERT_EQ(config->commandTimeouts(APC).actTerm, 60000);
+
+    ASSERT_EQ(config->commandTimeouts(SPC).select, 0);
+    ASSERT_EQ(config->commandTimeouts(SPC).actCon, 10000);
+    ASSERT_EQ(config->commandTimeouts(SPC).actTerm, 5000);
+
+    ASSERT_EQ(config->commandTimeouts(-1).select, 2000);
+
+    delete config;
+}
+
+TEST_F(ConfigTest, TlsConfigSessionSettings)
+{
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+
+    config->importTlsConfig(tls_session_config);
+
+    ASSERT_EQ(config->tlsRenegotiationTime(), 0);
+    ASSERT_EQ(config->tlsSessionResumptionInterval(), 600);
+
+    delete config;
+
+    config = new IEC61850ClientConfig();
+
+    config->importTlsConfig(wrong_tls_session_config);
+
+    ASSERT_EQ(config->tlsRenegotiationTime(), 60000);
+    ASSERT_EQ(config->tlsSessionResumptionInterval(), 21600);
+
+    delete config;
+}
+
+TEST_F(ConfigTest, ConfigDiff)
+{
+    IEC61850ClientConfig* config = new IEC61850ClientConfig();
+    config->importProtocolConfig(bringup_protocol_config);
+
+    IEC61850ClientConfig* sameConfig = new IEC61850ClientConfig();
+    sameConfig->importProtocolConfig(bringup_protocol_config);
+
+    ASSERT_TRUE(config->diff(*sameConfig).empty());
+
+    /* a different bring-up window needs a new association */
+    IEC61850ClientConfig* newConfig = new IEC61850ClientConfig();
+    newConfig->importProtocolConfig(wrong_bringup_protocol_config);
+
+    ASSERT_TRUE(config->diff(*newConfig).restart);
+
+    delete config;
+    delete sameConfig;
+    delete newConfig;
+}
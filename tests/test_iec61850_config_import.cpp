@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <iec61850_client_config.hpp>
+#include <chrono>
+
+using namespace std;
+
+static string
+createExchangeConfig (int points)
+{
+    string config = "{\"exchanged_data\":{\"name\":\"iec61850\",\"version\":"
+                    "\"1.0\",\"datapoints\":[";
+
+    for (int i = 0; i < points; i++)
+    {
+        if (i > 0)
+            config += ",";
+
+        string index = to_string (i);
+
+        config += "{\"label\":\"TS" + index + "\",\"pivot_id\":\"ID-" + index
+                  + "\",\"pivot_type\":\"SpsTyp\",\"protocols\":[{\"name\":"
+                    "\"iec104\",\"address\":\"45-"
+                  + index
+                  + "\",\"typeid\":\"M_SP_NA_1\"},{\"name\":\"iec61850\","
+                    "\"objref\":\"simpleIOGenericIO/GGIO"
+                  + to_string (i / 64) + ".Ind" + to_string (i % 64)
+                  + "\",\"cdc\":\"SpsTyp\"}]}";
+    }
+
+    config += "]}}";
+
+    return config;
+}
+
+TEST (ConfigImportTest, ExchangeConfig)
+{
+    IEC61850ClientConfig config;
+
+    config.importExchangeConfig (createExchangeConfig (3));
+
+    ASSERT_EQ (config.ExchangeDefinition ().size (), 3);
+
+    auto def = config.getExchangeDefinitionByLabel ("TS2");
+    ASSERT_NE (def, nullptr);
+    ASSERT_EQ (def->id, "ID-2");
+    ASSERT_EQ (def->objRef, "simpleIOGenericIO/GGIO0.Ind2");
+    ASSERT_EQ (def->cdcType, SPS);
+}
+
+TEST (ConfigImportTest, InvalidExchangeConfig)
+{
+    IEC61850ClientConfig config;
+
+    /* syntax error after valid datapoints -> nothing is imported */
+    string exchangeConfig = createExchangeConfig (3);
+    exchangeConfig.insert (exchangeConfig.size () - 3, "\n,}");
+
+    config.importExchangeConfig (exchangeConfig);
+    ASSERT_EQ (config.ExchangeDefinition ().size (), 0);
+
+    /* an invalid datapoint stops the import */
+    exchangeConfig = createExchangeConfig (3);
+    exchangeConfig.insert (exchangeConfig.size () - 3,
+                           ",{\"pivot_id\":\"ID-3\",\"protocols\":[]},"
+                           "{\"label\":\"TS4\",\"pivot_id\":\"ID-4\","
+                           "\"protocols\":[]}");
+
+    config.importExchangeConfig (exchangeConfig);
+    ASSERT_EQ (config.ExchangeDefinition ().size (), 3);
+    ASSERT_EQ (config.getExchangeDefinitionByLabel ("TS4"), nullptr);
+
+    config.importExchangeConfig ("{\"exchanged_data\":{\"datapoints\":{}}}");
+    ASSERT_EQ (config.ExchangeDefinition ().size (), 0);
+
+    config.importExchangeConfig ("[]");
+    ASSERT_EQ (config.ExchangeDefinition ().size (), 0);
+}
+
+/* about 100 MB of JSON, run with --gtest_also_run_disabled_tests */
+TEST (ConfigImportTest, DISABLED_ImportBenchmark)
+{
+    for (int points : { 10000, 100000, 500000 })
+    {
+        string exchangeConfig = createExchangeConfig (points);
+
+        IEC61850ClientConfig config;
+
+        auto start = chrono::steady_clock::now ();
+
+        config.importExchangeConfig (exchangeConfig);
+
+        auto elapsed = chrono::duration_cast<chrono::milliseconds> (
+                           chrono::steady_clock::now () - start)
+                           .count ();
+
+        ASSERT_EQ (config.ExchangeDefinition ().size (), (size_t)points);
+
+        printf ("%d datapoints (%d MB) imported in %ld ms\n", points,
+                (int)(exchangeConfig.size () >> 20), (long)elapsed);
+    }
+}
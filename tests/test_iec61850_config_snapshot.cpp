@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <iec61850_client_config.hpp>
+#include <iec61850_config_snapshot.hpp>
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+static string
+createExchangeConfig (int points)
+{
+    string config = "{\"exchanged_data\":{\"datapoints\":[";
+
+    for (int i = 0; i < points; i++)
+    {
+        if (i > 0)
+            config += ",";
+
+        string index = to_string (i);
+
+        config += "{\"label\":\"TM" + index + "\",\"pivot_id\":\"ID-" + index
+                  + "\",\"protocols\":[{\"name\":\"iec61850\",\"objref\":"
+                    "\"simpleIOGenericIO/GGIO"
+                  + to_string (i / 64) + ".AnIn" + to_string (i % 64)
+                  + "\",\"cdc\":\"MvTyp\"}]}";
+    }
+
+    config += "]}}";
+
+    return config;
+}
+
+class ConfigSnapshotTest : public testing::Test
+{
+  protected:
+    const char* fileName = "config_snapshot_test.bin";
+
+    void
+    TearDown () override
+    {
+        remove (fileName);
+    }
+};
+
+TEST_F (ConfigSnapshotTest, SaveAndLoad)
+{
+    string exchangeConfig = createExchangeConfig (100);
+
+    IEC61850ClientConfig config;
+    vector<IEC61850ClientConfig*> configs{ &config };
+
+    uint64_t hash = IEC61850ConfigSnapshot::configHash (exchangeConfig, configs);
+
+    {
+        IEC61850ConfigSnapshot snapshot (fileName);
+
+        ASSERT_FALSE (snapshot.load (hash, configs));
+        ASSERT_TRUE (config.importExchangeConfig (exchangeConfig));
+        ASSERT_TRUE (snapshot.save (hash, configs));
+    }
+
+    IEC61850ClientConfig loaded;
+    vector<IEC61850ClientConfig*> loadedConfigs{ &loaded };
+
+    IEC61850ConfigSnapshot snapshot (fileName);
+
+    ASSERT_FALSE (snapshot.load (hash + 1, loadedConfigs));
+    ASSERT_TRUE (snapshot.load (hash, loadedConfigs));
+
+    ASSERT_EQ (loaded.ExchangeDefinition ().size (), 100);
+    ASSERT_TRUE (loaded.ExchangeDefinition ()[0]->polled);
+
+    auto def = loaded.getExchangeDefinitionByLabel ("TM70");
+    ASSERT_NE (def, nullptr);
+    ASSERT_EQ (def->id, "ID-70");
+    ASSERT_EQ (def->objRef, "simpleIOGenericIO/GGIO1.AnIn6");
+    ASSERT_EQ (def->cdcType, MV);
+    ASSERT_FALSE (def->hasIntValue);
+    ASSERT_EQ (loaded.getExchangeDefinitionByPivotId ("ID-70"), def);
+    ASSERT_EQ (loaded.getExchangeDefinitionByObjRef (def->objRef), def);
+    ASSERT_EQ (loaded.getExchangeDefinitionByLabel ("TM100"), nullptr);
+
+    /* a corrupted image is rejected */
+    FILE* file = fopen (fileName, "r+b");
+    ASSERT_NE (file, nullptr);
+    fseek (file, -10, SEEK_END);
+    fputc ('#', file);
+    fclose (file);
+
+    ASSERT_FALSE (snapshot.load (hash, loadedConfigs));
+    ASSERT_EQ (loaded.ExchangeDefinition ().size (), 0);
+}
+
+TEST_F (ConfigSnapshotTest, LoadBenchmark)
+{
+    const int points = 100000;
+
+    string exchangeConfig = createExchangeConfig (points);
+
+    IEC61850ClientConfig config;
+    vector<IEC61850ClientConfig*> configs{ &config };
+
+    auto start = chrono::steady_clock::now ();
+
+    ASSERT_TRUE (config.importExchangeConfig (exchangeConfig));
+
+    auto parsed = chrono::steady_clock::now ();
+
+    uint64_t hash = IEC61850ConfigSnapshot::configHash (exchangeConfig, configs);
+    IEC61850ConfigSnapshot snapshot (fileName);
+    ASSERT_TRUE (snapshot.save (hash, configs));
+
+    IEC61850ClientConfig loaded;
+    vector<IEC61850ClientConfig*> loadedConfigs{ &loaded };
+
+    auto loadStart = chrono::steady_clock::now ();
+
+    hash = IEC61850ConfigSnapshot::configHash (exchangeConfig, loadedConfigs);
+    ASSERT_TRUE (snapshot.load (hash, loadedConfigs));
+
+    auto loadEnd = chrono::steady_clock::now ();
+
+    ASSERT_EQ (loaded.ExchangeDefinition ().size (), (size_t)points);
+
+    printf ("%d datapoints: JSON import %ld ms, snapshot load %ld ms\n",
+            points,
+            (long)chrono::duration_cast<chrono::milliseconds> (parsed - start)
+                .count (),
+            (long)chrono::duration_cast<chrono::milliseconds> (loadEnd
+                                                               - loadStart)
+                .count ());
+}
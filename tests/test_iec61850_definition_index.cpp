@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <iec61850_client_config.hpp>
+#include <iec61850_definition_index.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using namespace std;
+
+static atomic<size_t> allocations (0);
+
+/* counts the allocations of the whole test program */
+void*
+operator new (size_t size)
+{
+    allocations++;
+
+    void* p = malloc (size ? size : 1);
+
+    if (!p)
+        throw bad_alloc ();
+
+    return p;
+}
+
+void
+operator delete (void* p) noexcept
+{
+    free (p);
+}
+
+static shared_ptr<DataExchangeDefinition>
+createDefinition (int i)
+{
+    auto def = make_shared<DataExchangeDefinition> ();
+
+    def->label = "TS" + to_string (i);
+    def->id = "ID-" + to_string (i);
+    def->objRef = "simpleIOGenericIO/GGIO" + to_string (i / 64) + ".Ind"
+                  + to_string (i % 64);
+    def->cdcType = SPS;
+
+    return def;
+}
+
+TEST (DefinitionIndexTest, Lookup)
+{
+    IEC61850DefinitionIndex index;
+
+    ASSERT_EQ (index.get (IEC61850DefinitionIndex::LABEL, "TS1"), nullptr);
+
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_EQ (index.add (createDefinition (i)), (uint32_t)i);
+    }
+
+    DataExchangeDefinition* def
+        = index.get (IEC61850DefinitionIndex::LABEL, "TS42");
+
+    ASSERT_NE (def, nullptr);
+    ASSERT_EQ (def->id, "ID-42");
+    ASSERT_EQ (index.get (IEC61850DefinitionIndex::PIVOT_ID, "ID-42"), def);
+    ASSERT_EQ (index.get (IEC61850DefinitionIndex::OBJ_REF, def->objRef), def);
+    ASSERT_EQ (index.definition (42), def);
+
+    /* lookup from a range of a larger buffer */
+    const char* buffer = "simpleIOGenericIO/GGIO0.Ind5.stVal";
+    ASSERT_EQ (index.get (IEC61850DefinitionIndex::OBJ_REF, buffer,
+                          strlen ("simpleIOGenericIO/GGIO0.Ind5")),
+               index.definition (5));
+
+    ASSERT_EQ (index.get (IEC61850DefinitionIndex::LABEL, "TS100"), nullptr);
+    ASSERT_EQ (index.get (IEC61850DefinitionIndex::LABEL, "TS4"),
+               index.definition (4));
+    ASSERT_EQ (index.definition (100), nullptr);
+
+    /* first definition for a key wins */
+    auto duplicate = createDefinition (200);
+    duplicate->id = "ID-7";
+    uint32_t id = index.add (duplicate);
+
+    ASSERT_EQ (index.get (IEC61850DefinitionIndex::PIVOT_ID, "ID-7"),
+               index.definition (7));
+    ASSERT_EQ (index.get (IEC61850DefinitionIndex::LABEL, "TS200"),
+               index.definition (id));
+
+    index.clear ();
+
+    ASSERT_EQ (index.size (), 0);
+    ASSERT_EQ (index.get (IEC61850DefinitionIndex::LABEL, "TS42"), nullptr);
+}
+
+TEST (DefinitionIndexTest, LookupBenchmark)
+{
+    const int count = 100000;
+
+    IEC61850DefinitionIndex index;
+    /* dataset entries of the reports, LD/LN.DO.attribute[FC] */
+    vector<string> entries;
+    vector<string> labels;
+
+    for (int i = 0; i < count; i++)
+    {
+        auto def = createDefinition (i);
+        entries.push_back (def->objRef + ".stVal[ST]");
+        labels.push_back (def->label);
+        index.add (def);
+    }
+
+    size_t allocationsBefore = allocations;
+    auto start = chrono::steady_clock::now ();
+
+    size_t found = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const string& entry = entries[i];
+
+        if (index.get (IEC61850DefinitionIndex::OBJ_REF, entry.data (),
+                       entry.rfind ('.')))
+            found++;
+        if (index.get (IEC61850DefinitionIndex::LABEL, labels[i]))
+            found++;
+    }
+
+    auto elapsed = chrono::duration_cast<chrono::microseconds> (
+                       chrono::steady_clock::now () - start)
+                       .count ();
+
+    ASSERT_EQ (found, (size_t)count * 2);
+    ASSERT_EQ (allocations - allocationsBefore, (size_t)0);
+
+    printf ("%d definitions: %d lookups in %ld us (%.1f ns/lookup)\n", count,
+            count * 2, (long)elapsed, elapsed * 1000.0 / (count * 2));
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <iec61850_entryid_store.hpp>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+static MmsValue*
+createEntryId (uint8_t value)
+{
+    uint8_t buffer[8];
+    memset (buffer, value, sizeof (buffer));
+
+    MmsValue* entryId = MmsValue_newOctetString (8, 8);
+    MmsValue_setOctetString (entryId, buffer, 8);
+
+    return entryId;
+}
+
+static uint8_t
+entryIdValue (MmsValue* entryId)
+{
+    return MmsValue_getOctetStringBuffer (entryId)[0];
+}
+
+class EntryIdStoreTest : public testing::Test
+{
+  protected:
+    const char* fileName = "entryid_store_test.dat";
+
+    void
+    TearDown () override
+    {
+        remove (fileName);
+    }
+};
+
+TEST_F (EntryIdStoreTest, PersistAcrossRestart)
+{
+    {
+        IEC61850EntryIdStore store (fileName);
+
+        ASSERT_TRUE (store.open ({ "simpleIOGenericIO/LLN0.BR.EventsBRCB01",
+                                   "simpleIOGenericIO/LLN0.BR.EventsBRCB02" }));
+
+        ASSERT_EQ (store.get ("simpleIOGenericIO/LLN0.BR.EventsBRCB01"),
+                   nullptr);
+
+        for (uint8_t i = 1; i <= 3; i++)
+        {
+            MmsValue* entryId = createEntryId (i);
+            store.set ("simpleIOGenericIO/LLN0.BR.EventsBRCB01", entryId);
+            MmsValue_delete (entryId);
+        }
+
+        MmsValue* entryId = createEntryId (7);
+        store.set ("simpleIOGenericIO/LLN0.BR.EventsBRCB02", entryId);
+        store.set ("simpleIOGenericIO/LLN0.BR.Unknown", entryId);
+        MmsValue_delete (entryId);
+
+        store.clear ("simpleIOGenericIO/LLN0.BR.EventsBRCB02");
+    }
+
+    IEC61850EntryIdStore store (fileName);
+
+    /* RCB02 removed from the configuration, RCB03 added */
+    ASSERT_TRUE (store.open ({ "simpleIOGenericIO/LLN0.BR.EventsBRCB03",
+                               "simpleIOGenericIO/LLN0.BR.EventsBRCB01" }));
+
+    MmsValue* entryId = store.get ("simpleIOGenericIO/LLN0.BR.EventsBRCB01");
+    ASSERT_NE (entryId, nullptr);
+    ASSERT_EQ (MmsValue_getOctetStringSize (entryId), 8);
+    ASSERT_EQ (entryIdValue (entryId), 3);
+    MmsValue_delete (entryId);
+
+    ASSERT_EQ (store.get ("simpleIOGenericIO/LLN0.BR.EventsBRCB02"), nullptr);
+    ASSERT_EQ (store.get ("simpleIOGenericIO/LLN0.BR.EventsBRCB03"), nullptr);
+}
+
+TEST_F (EntryIdStoreTest, TornWriteKeepsPreviousEntryId)
+{
+    {
+        IEC61850EntryIdStore store (fileName);
+        ASSERT_TRUE (store.open ({ "simpleIOGenericIO/LLN0.BR.EventsBRCB01" }));
+
+        for (uint8_t i = 1; i <= 2; i++)
+        {
+            MmsValue* entryId = createEntryId (i);
+            store.set ("simpleIOGenericIO/LLN0.BR.EventsBRCB01", entryId);
+            MmsValue_delete (entryId);
+        }
+    }
+
+    /* corrupt the byte before the end of the file: the last record's
+     * second slot, which holds the latest EntryID */
+    FILE* file = fopen (fileName, "r+b");
+    ASSERT_NE (file, nullptr);
+    fseek (file, -6, SEEK_END);
+    fputc (0xFF, file);
+    fclose (file);
+
+    IEC61850EntryIdStore store (fileName);
+    ASSERT_TRUE (store.open ({ "simpleIOGenericIO/LLN0.BR.EventsBRCB01" }));
+
+    MmsValue* entryId = store.get ("simpleIOGenericIO/LLN0.BR.EventsBRCB01");
+    ASSERT_NE (entryId, nullptr);
+    ASSERT_EQ (entryIdValue (entryId), 1);
+    MmsValue_delete (entryId);
+}
+
+TEST_F (EntryIdStoreTest, ReopenKeepsEntryIdsInMemory)
+{
+    /* the file cannot be created, the store is kept in memory */
+    IEC61850EntryIdStore store ("no_such_dir/entryid_store_test.dat");
+
+    ASSERT_FALSE (store.open ({ "simpleIOGenericIO/LLN0.BR.EventsBRCB01" }));
+
+    MmsValue* entryId = createEntryId (5);
+    store.set ("simpleIOGenericIO/LLN0.BR.EventsBRCB01", entryId);
+    MmsValue_delete (entryId);
+
+    /* reconfiguration adding an RCB */
+    ASSERT_FALSE (store.open ({ "simpleIOGenericIO/LLN0.BR.EventsBRCB01",
+                                "simpleIOGenericIO/LLN0.BR.EventsBRCB02" }));
+
+    entryId = store.get ("simpleIOGenericIO/LLN0.BR.EventsBRCB01");
+    ASSERT_NE (entryId, nullptr);
+    ASSERT_EQ (entryIdValue (entryId), 5);
+    MmsValue_delete (entryId);
+
+    ASSERT_EQ (store.get ("simpleIOGenericIO/LLN0.BR.EventsBRCB02"), nullptr);
+}
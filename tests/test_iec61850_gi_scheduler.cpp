@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <iec61850_gi_scheduler.hpp>
+
+using namespace std;
+
+TEST (GiSchedulerTest, PriorityAndSpacing)
+{
+    IEC61850GiScheduler scheduler (2, 100, { "PROT", "CTRL" });
+
+    scheduler.request ("MEAS/LLN0.RP.urcb01");
+    scheduler.request ("CTRL/LLN0.RP.urcb01");
+    scheduler.request ("PROT2/LLN0.BR.brcb01");
+    scheduler.request ("MEAS/LLN0.RP.urcb02");
+    scheduler.request ("PROT1/LLN0.BR.brcb01");
+    scheduler.request ("MEAS/LLN0.RP.urcb01");
+
+    ASSERT_EQ (scheduler.pending (), 5);
+
+    vector<string> due = scheduler.due (1000);
+    ASSERT_EQ (due.size (), 1);
+    ASSERT_EQ (due[0], "PROT2/LLN0.BR.brcb01");
+
+    /* spacing */
+    ASSERT_TRUE (scheduler.due (1050).empty ());
+
+    due = scheduler.due (1100);
+    ASSERT_EQ (due.size (), 1);
+    ASSERT_EQ (due[0], "PROT1/LLN0.BR.brcb01");
+
+    /* concurrency */
+    ASSERT_TRUE (scheduler.due (1200).empty ());
+    ASSERT_EQ (scheduler.outstanding (), 2);
+
+    scheduler.done ("PROT2/LLN0.BR.brcb01");
+
+    due = scheduler.due (1200);
+    ASSERT_EQ (due.size (), 1);
+    ASSERT_EQ (due[0], "CTRL/LLN0.RP.urcb01");
+
+    scheduler.done ("PROT1/LLN0.BR.brcb01");
+    scheduler.done ("CTRL/LLN0.RP.urcb01");
+
+    ASSERT_EQ (scheduler.due (1300)[0], "MEAS/LLN0.RP.urcb01");
+    ASSERT_EQ (scheduler.due (1400)[0], "MEAS/LLN0.RP.urcb02");
+    ASSERT_EQ (scheduler.pending (), 0);
+}
+
+TEST (GiSchedulerTest, NoSpacing)
+{
+    IEC61850GiScheduler scheduler (3, 0, {});
+
+    scheduler.request ("LD/LLN0.RP.urcb01");
+    scheduler.request ("LD/LLN0.RP.urcb02");
+    scheduler.request ("LD/LLN0.RP.urcb03");
+    scheduler.request ("LD/LLN0.RP.urcb04");
+
+    vector<string> due = scheduler.due (0);
+    ASSERT_EQ (due.size (), 3);
+    ASSERT_EQ (due[0], "LD/LLN0.RP.urcb01");
+
+    /* a GI requested while one is outstanding on the same RCB waits */
+    scheduler.request ("LD/LLN0.RP.urcb01");
+    scheduler.done ("LD/LLN0.RP.urcb02");
+
+    due = scheduler.due (0);
+    ASSERT_EQ (due.size (), 1);
+    ASSERT_EQ (due[0], "LD/LLN0.RP.urcb04");
+
+    scheduler.clear ();
+    ASSERT_EQ (scheduler.pending (), 0);
+    ASSERT_EQ (scheduler.outstanding (), 0);
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <iec61850_model_cache.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+static MmsVariableSpecification*
+createSpec (const char* name, MmsType type)
+{
+    auto spec = static_cast<MmsVariableSpecification*> (
+        calloc (1, sizeof (MmsVariableSpecification)));
+    spec->name = strdup (name);
+    spec->type = type;
+    return spec;
+}
+
+static MmsVariableSpecification*
+createSpsSpec ()
+{
+    MmsVariableSpecification* spec = createSpec ("SPCSO1", MMS_STRUCTURE);
+
+    spec->typeSpec.structure.elementCount = 3;
+    spec->typeSpec.structure.elements
+        = static_cast<MmsVariableSpecification**> (
+            calloc (3, sizeof (MmsVariableSpecification*)));
+
+    spec->typeSpec.structure.elements[0] = createSpec ("stVal", MMS_BOOLEAN);
+
+    MmsVariableSpecification* q = createSpec ("q", MMS_BIT_STRING);
+    q->typeSpec.bitString = -13;
+    spec->typeSpec.structure.elements[1] = q;
+
+    MmsVariableSpecification* t = createSpec ("t", MMS_UTC_TIME);
+    spec->typeSpec.structure.elements[2] = t;
+
+    return spec;
+}
+
+class ModelCacheTest : public testing::Test
+{
+  protected:
+    const char* fileName = "model_cache_test.json";
+
+    void
+    TearDown () override
+    {
+        remove (fileName);
+    }
+};
+
+TEST_F (ModelCacheTest, SaveAndLoad)
+{
+    IEC61850ModelCache::Revisions revisions;
+    revisions["simpleIOGenericIO"] = "1/2";
+
+    {
+        IEC61850ModelCache cache (fileName);
+
+        ASSERT_FALSE (cache.load ());
+        ASSERT_FALSE (cache.matches (revisions));
+
+        cache.reset (revisions);
+
+        MmsVariableSpecification* spec = createSpsSpec ();
+        cache.setSpec ("simpleIOGenericIO/GGIO1.SPCSO1", IEC61850_FC_ST,
+                       spec);
+        MmsVariableSpecification_destroy (spec);
+
+        cache.setCtlModel ("simpleIOGenericIO/GGIO1.SPCSO1",
+                           CONTROL_MODEL_SBO_ENHANCED);
+        cache.setDatasetDirectory (
+            "simpleIOGenericIO/LLN0.Events",
+            { "simpleIOGenericIO/GGIO1.SPCSO1[ST]",
+              "simpleIOGenericIO/GGIO1.SPCSO2[ST]" });
+
+        ASSERT_TRUE (cache.save ());
+    }
+
+    IEC61850ModelCache cache (fileName);
+
+    ASSERT_TRUE (cache.load ());
+    ASSERT_TRUE (cache.matches (revisions));
+
+    revisions["simpleIOGenericIO"] = "2/2";
+    ASSERT_FALSE (cache.matches (revisions));
+
+    ASSERT_EQ (cache.getSpec ("simpleIOGenericIO/GGIO1.SPCSO1",
+                              IEC61850_FC_MX),
+               nullptr);
+
+    MmsVariableSpecification* spec
+        = cache.getSpec ("simpleIOGenericIO/GGIO1.SPCSO1", IEC61850_FC_ST);
+
+    ASSERT_NE (spec, nullptr);
+    ASSERT_EQ (spec->type, MMS_STRUCTURE);
+    ASSERT_STREQ (spec->name, "SPCSO1");
+    ASSERT_EQ (spec->typeSpec.structure.elementCount, 3);
+    ASSERT_STREQ (spec->typeSpec.structure.elements[1]->name, "q");
+    ASSERT_EQ (spec->typeSpec.structure.elements[1]->type, MMS_BIT_STRING);
+    ASSERT_EQ (spec->typeSpec.structure.elements[1]->typeSpec.bitString, -13);
+    ASSERT_NE (MmsVariableSpecification_getNamedVariableRecursive (spec, "t"),
+               nullptr);
+    MmsVariableSpecification_destroy (spec);
+
+    ControlModel model;
+    ASSERT_TRUE (
+        cache.getCtlModel ("simpleIOGenericIO/GGIO1.SPCSO1", model));
+    ASSERT_EQ (model, CONTROL_MODEL_SBO_ENHANCED);
+    ASSERT_FALSE (
+        cache.getCtlModel ("simpleIOGenericIO/GGIO1.SPCSO2", model));
+
+    std::vector<std::string> entries;
+    ASSERT_TRUE (
+        cache.getDatasetDirectory ("simpleIOGenericIO/LLN0.Events", entries));
+    ASSERT_EQ (entries.size (), 2);
+    ASSERT_EQ (entries[1], "simpleIOGenericIO/GGIO1.SPCSO2[ST]");
+}
+
+TEST_F (ModelCacheTest, CorruptedFile)
+{
+    FILE* file = fopen (fileName, "w");
+    ASSERT_NE (file, nullptr);
+    fputs ("{\"version\":1,\"specs\":{\"x\":[", file);
+    fclose (file);
+
+    IEC61850ModelCache cache (fileName);
+
+    ASSERT_FALSE (cache.load ());
+
+    IEC61850ModelCache::Revisions revisions;
+    revisions["simpleIOGenericIO"] = "1";
+    ASSERT_FALSE (cache.matches (revisions));
+}
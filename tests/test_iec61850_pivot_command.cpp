@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <iec61850_pivot_command.hpp>
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+static bool
+decode (IEC61850PivotCommand& command, string& json)
+{
+    return command.decode (&json[0]);
+}
+
+TEST (PivotCommandTest, Decode)
+{
+    IEC61850PivotCommand command;
+
+    string json
+        = R"({"GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"q":{"test":0}, "t":{"SecondSinceEpoch":1700566837, "FractionOfSecond":8388608}, "ctlVal":1}, "Identifier":"TS1", "Select":{"stVal":1}}})";
+
+    ASSERT_TRUE (decode (command, json));
+    ASSERT_EQ (string (command.identifier, command.identifierLength), "TS1");
+    ASSERT_EQ (command.cdcType, SPC);
+    ASSERT_STREQ (command.cdcName, "SpcTyp");
+    ASSERT_EQ (command.value ().type, IEC61850PivotCommand::Value::INTEGER);
+    ASSERT_EQ (command.value ().intValue, 1);
+
+    json = R"({"GTIC":{"BscTyp":{"ctlVal":"lower"}, "Identifier":"TS4"}})";
+
+    ASSERT_TRUE (decode (command, json));
+    ASSERT_EQ (command.cdcType, BSC);
+    ASSERT_EQ (command.value ().type, IEC61850PivotCommand::Value::STRING);
+    ASSERT_EQ (string (command.value ().str, command.value ().length),
+               "lower");
+
+    json = R"({"GTIC":{"ApcTyp":{"ctlVal":0.2}, "Identifier":"TM1"}})";
+
+    ASSERT_TRUE (decode (command, json));
+    ASSERT_EQ (command.value ().type, IEC61850PivotCommand::Value::FLOAT);
+    ASSERT_DOUBLE_EQ (command.value ().floatValue, 0.2);
+
+    json = R"({"GTIC":{"Identifier":"SP1", "AsgTyp":{"setMag":{"f":1.2}}}})";
+
+    ASSERT_TRUE (decode (command, json));
+    ASSERT_EQ (command.cdcType, ASG);
+    ASSERT_DOUBLE_EQ (command.value ().floatValue, 1.2);
+
+    /* the value of the cdc is used, not ctlVal */
+    json = R"({"GTIC":{"Identifier":"SP2", "IngTyp":{"ctlVal":3, "setVal":7}}})";
+
+    ASSERT_TRUE (decode (command, json));
+    ASSERT_EQ (command.cdcType, ING);
+    ASSERT_EQ (command.value ().intValue, 7);
+
+    /* unknown elements, arrays and a second cdc are skipped */
+    json = R"({"GTIC":{"Extra":[{"SpcTyp":{"ctlVal":1}}], "DpcTyp":{"ctlVal":2}, "SpcTyp":{"ctlVal":0}, "Identifier":"TS2"}, "Other":{"Identifier":"X"}})";
+
+    ASSERT_TRUE (decode (command, json));
+    ASSERT_EQ (command.cdcType, DPC);
+    ASSERT_EQ (command.value ().intValue, 2);
+    ASSERT_EQ (string (command.identifier, command.identifierLength), "TS2");
+
+    json = R"({"GTIC":{"Identifier":"TS1"}})";
+
+    ASSERT_TRUE (decode (command, json));
+    ASSERT_EQ (command.cdcType, -1);
+
+    json = R"({"GTIC":{"SpcTyp":{"ctlVal":1}})";
+
+    ASSERT_FALSE (decode (command, json));
+}
+
+TEST (PivotCommandTest, DecodeBenchmark)
+{
+    const int count = 100000;
+
+    const string json
+        = R"({"GTIC":{"ComingFrom":"iec61850", "SpcTyp":{"q":{"test":0}, "t":{"SecondSinceEpoch":1700566837, "FractionOfSecond":15921577}, "ctlVal":1}, "Identifier":"TS1", "Select":{"stVal":0}}})";
+
+    IEC61850PivotCommand command;
+    int decoded = 0;
+
+    auto start = chrono::steady_clock::now ();
+
+    for (int i = 0; i < count; i++)
+    {
+        string buffer = json;
+
+        if (command.decode (&buffer[0]) && command.cdcType == SPC)
+            decoded++;
+    }
+
+    auto elapsed = chrono::duration_cast<chrono::microseconds> (
+                       chrono::steady_clock::now () - start)
+                       .count ();
+
+    ASSERT_EQ (decoded, count);
+
+    printf ("%d commands decoded in %ld us (%.1f ns/command)\n", count,
+            (long)elapsed, elapsed * 1000.0 / count);
+}
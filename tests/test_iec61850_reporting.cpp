@@ -595,6 +595,9 @@ TEST_F (ReportingTest, ReportingWithStaticDataset)
     double expectedMagVal = 1.2;
     verifyDatapoint (mag, "f", &expectedMagVal);
 
+    ASSERT_GT (
+        iec61850->m_client->m_active_connection->timeToFirstReport (), 0);
+
      iec61850->stop ();
      delete iec61850;
 
@@ -770,6 +773,87 @@ TEST_F (ReportingTest, ReportingGI)
     IedModel_destroy (model);
 }
 
+TEST_F (ReportingTest, ReportingRequestGI)
+{
+    iec61850->setJsonConfig (protocol_config_2, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/simpleIO_direct_control.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    Thread_sleep (1000);
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (5);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->m_connection
+           || IedConnection_getState (
+                  iec61850->m_client->m_active_connection->m_connection)
+                  != IED_STATE_CONNECTED)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    timeout = std::chrono::seconds (3);
+    start = std::chrono::high_resolution_clock::now ();
+    while (ingestCallbackCalled != 12)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    /* GI on demand through the plugin operation */
+    ASSERT_TRUE (iec61850->operation ("RequestGI", 0, nullptr));
+
+    start = std::chrono::high_resolution_clock::now ();
+    while (ingestCallbackCalled != 24)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "GI not answered within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_EQ (storedReadings.size (), 24);
+
+    iec61850->stop ();
+    delete iec61850;
+
+    for (auto reading : storedReadings)
+    {
+        delete reading;
+    }
+    storedReadings.clear ();
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
 TEST_F (ReportingTest, ReportingSetpointCommand)
 {
     iec61850->setJsonConfig (protocol_config, exchanged_data, tls_config);
@@ -1245,6 +1329,172 @@ TEST_F (ReportingTest, ReconfigureDynamicDataset)
     IedModel_destroy (model);
 }
 
+TEST_F (ReportingTest, ReconfigureInPlace)
+{
+    iec61850->setJsonConfig (protocol_config, exchanged_data, tls_config);
+
+    IedModel* model = ConfigFileParser_createModelFromConfigFileEx (
+        "../tests/data/simpleIO_direct_control.cfg");
+
+    IedServer server = IedServer_create (model);
+
+    IedServer_start (server, 10002);
+    iec61850->start ();
+
+    Thread_sleep (1000);
+
+    auto start = std::chrono::high_resolution_clock::now ();
+    auto timeout = std::chrono::seconds (5);
+    while (!iec61850->m_client->m_active_connection
+           || !iec61850->m_client->m_active_connection->m_connection
+           || IedConnection_getState (
+                  iec61850->m_client->m_active_connection->m_connection)
+                  != IED_STATE_CONNECTED)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Connection not established within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    Quality q = 0;
+    Quality_setValidity (&q, QUALITY_VALIDITY_INVALID);
+
+    IedServer_updateQuality (
+        server,
+        (DataAttribute*)IedModel_getModelNodeByObjectReference (
+            model, "simpleIOGenericIO/GGIO1.AnIn1.q"),
+        q);
+
+    timeout = std::chrono::seconds (3);
+    start = std::chrono::high_resolution_clock::now ();
+    while (ingestCallbackCalled != 1)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_FALSE (storedReadings.empty ());
+    ASSERT_EQ (storedReadings.size (), 1);
+    Datapoint* commandResponse = storedReadings[0]->getReadingData ()[0];
+    verifyDatapoint (commandResponse, "GTIM");
+    Datapoint* gtim = getChild (*commandResponse, "GTIM");
+
+    verifyDatapoint (gtim, "MvTyp");
+    Datapoint* MV = getChild (*gtim, "MvTyp");
+
+    verifyDatapoint (MV, "q");
+    Datapoint* qDp = getChild (*MV, "q");
+
+    std::string expectedValidity = "invalid";
+
+    verifyDatapoint (qDp, "Validity", &expectedValidity);
+
+    IedConnection connection
+        = iec61850->m_client->m_active_connection->m_connection;
+
+    /* dataset and RCBs change, the association is kept */
+    ASSERT_TRUE (
+        iec61850->reconfigure (protocol_config_3, exchanged_data, tls_config));
+
+    start = std::chrono::high_resolution_clock::now ();
+    timeout = std::chrono::seconds (5);
+    while (iec61850->m_client->m_active_connection->m_connectionState
+           != IEC61850ClientConnection::CON_STATE_CONNECTED)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Reconfiguration not applied within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_EQ (iec61850->m_client->m_active_connection->m_connection,
+               connection);
+
+    q = 0;
+    Quality_setValidity (&q, QUALITY_VALIDITY_INVALID);
+
+    IedServer_updateQuality (
+        server,
+        (DataAttribute*)IedModel_getModelNodeByObjectReference (
+            model, "simpleIOGenericIO/GGIO1.SPCSO1.q"),
+        q);
+    
+    timeout = std::chrono::seconds (3);
+    start = std::chrono::high_resolution_clock::now ();
+    while (ingestCallbackCalled != 2)
+    {
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Callback not called within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    ASSERT_EQ (storedReadings.size (), 2);
+
+    /* the replaced configurations are deleted once no report uses them */
+    ASSERT_TRUE (
+        iec61850->reconfigure (protocol_config_3, exchanged_data, tls_config));
+
+    start = std::chrono::high_resolution_clock::now ();
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock (
+                iec61850->m_client->connectionsMutex);
+
+            if (iec61850->m_client->m_retiredConfigs.empty ())
+                break;
+        }
+
+        auto now = std::chrono::high_resolution_clock::now ();
+        if (now - start > timeout)
+        {
+            IedServer_stop (server);
+            IedServer_destroy (server);
+            IedModel_destroy (model);
+            FAIL () << "Replaced configurations not deleted within timeout";
+        }
+        Thread_sleep (10);
+    }
+
+    iec61850->stop ();
+
+    delete iec61850;
+
+    for (auto reading : storedReadings)
+    {
+        delete reading;
+    }
+    storedReadings.clear ();
+
+    IedServer_stop (server);
+    IedServer_destroy (server);
+    IedModel_destroy (model);
+}
+
 TEST_F (ReportingTest, ReportingIndividualAttributes)
 {
     iec61850->setJsonConfig (protocol_config_4, exchanged_data_2, tls_config);
@@ -1394,4 +1644,34 @@ TEST_F (ReportingTest, ReportingIndividualAttributes)
      IedServer_stop (server);
      IedServer_destroy (server);
      IedModel_destroy (model);
-}
\ No newline at end of file
+}
+TEST (ReportSequenceTest, GapDetection)
+{
+    IEC61850ClientConnection::ReportSequence sequence;
+
+    /* URCB, SeqNum wraps at 255 */
+    ASSERT_FALSE (sequence.update (254, false, 0, false));
+    ASSERT_FALSE (sequence.update (255, false, 0, false));
+    ASSERT_FALSE (sequence.update (0, false, 0, false));
+    ASSERT_TRUE (sequence.update (2, false, 0, false));
+    ASSERT_EQ (sequence.gaps, 1);
+
+    /* segmented report */
+    ASSERT_FALSE (sequence.update (3, true, 0, true));
+    ASSERT_FALSE (sequence.update (3, true, 1, true));
+    ASSERT_FALSE (sequence.update (3, true, 2, false));
+    ASSERT_FALSE (sequence.update (4, false, 0, false));
+
+    /* missing middle segment */
+    ASSERT_FALSE (sequence.update (5, true, 0, true));
+    ASSERT_TRUE (sequence.update (5, true, 2, false));
+
+    /* missing last segment */
+    ASSERT_FALSE (sequence.update (6, true, 0, true));
+    ASSERT_TRUE (sequence.update (7, false, 0, false));
+
+    /* missing first segment */
+    ASSERT_TRUE (sequence.update (8, true, 1, false));
+
+    ASSERT_EQ (sequence.gaps, 4);
+}
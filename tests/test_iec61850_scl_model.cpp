@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include <iec61850_client_config.hpp>
+#include <iec61850_model_cache.hpp>
+#include <iec61850_scl_model.hpp>
+#include <cstdio>
+
+using namespace std;
+
+static const char* scl = R"(<?xml version="1.0" encoding="UTF-8"?>
+<SCL xmlns="http://www.iec.ch/61850/2003/SCL">
+  <!-- reduced model of the simpleIO example -->
+  <Header id="simpleIO" />
+  <IED name="simpleIO">
+    <AccessPoint name="accessPoint1">
+      <Server>
+        <Authentication />
+        <LDevice inst="GenericIO">
+          <LN0 lnClass="LLN0" lnType="LLN01" inst="">
+            <DataSet name="Events">
+              <FCDA ldInst="GenericIO" lnClass="GGIO" lnInst="1"
+                    doName="SPCSO1" daName="stVal" fc="ST" />
+              <FCDA ldInst="GenericIO" lnClass="GGIO" lnInst="1"
+                    doName="AnIn1" fc="MX" />
+            </DataSet>
+            <DOI name="NamPlt">
+              <DAI name="configRev"><Val>7</Val></DAI>
+            </DOI>
+          </LN0>
+          <LN lnClass="GGIO" lnType="GGIO1" inst="1">
+            <DOI name="SPCSO1">
+              <DAI name="ctlModel"><Val>sbo-with-enhanced-security</Val></DAI>
+            </DOI>
+          </LN>
+        </LDevice>
+      </Server>
+    </AccessPoint>
+  </IED>
+  <DataTypeTemplates>
+    <LNodeType id="LLN01" lnClass="LLN0">
+      <DO name="NamPlt" type="LPL_0" />
+    </LNodeType>
+    <LNodeType id="GGIO1" lnClass="GGIO">
+      <DO name="AnIn1" type="MV_1" />
+      <DO name="SPCSO1" type="SPC_1" />
+      <DO name="SPCSO2" type="SPC_1" />
+    </LNodeType>
+    <DOType id="LPL_0" cdc="LPL">
+      <DA name="vendor" bType="VisString255" fc="DC" />
+      <DA name="configRev" bType="VisString255" fc="DC" />
+    </DOType>
+    <DOType id="MV_1" cdc="MV">
+      <DA name="mag" bType="Struct" type="AnalogueValue_1" fc="MX" />
+      <DA name="q" bType="Quality" fc="MX" />
+      <DA name="t" bType="Timestamp" fc="MX" />
+    </DOType>
+    <DOType id="SPC_1" cdc="SPC">
+      <DA name="stVal" bType="BOOLEAN" fc="ST" />
+      <DA name="q" bType="Quality" fc="ST" />
+      <DA name="t" bType="Timestamp" fc="ST" />
+      <DA name="Oper" bType="Struct" type="SPCOperate_1" fc="CO" />
+      <DA name="ctlModel" bType="Enum" type="CtlModels" fc="CF">
+        <Val>direct-with-normal-security</Val>
+      </DA>
+    </DOType>
+    <DAType id="AnalogueValue_1">
+      <BDA name="f" bType="FLOAT32" />
+    </DAType>
+    <DAType id="SPCOperate_1">
+      <BDA name="ctlVal" bType="BOOLEAN" />
+      <BDA name="origin" bType="Struct" type="Originator_1" />
+      <BDA name="ctlNum" bType="INT8U" />
+      <BDA name="T" bType="Timestamp" />
+      <BDA name="Test" bType="BOOLEAN" />
+      <BDA name="Check" bType="Check" />
+    </DAType>
+    <DAType id="Originator_1">
+      <BDA name="orCat" bType="Enum" type="OrCat" />
+      <BDA name="orIdent" bType="Octet64" />
+    </DAType>
+  </DataTypeTemplates>
+</SCL>
+)";
+
+static const char* exchangeConfig = R"({
+    "exchanged_data": {
+        "datapoints": [
+            {
+                "label": "TS1",
+                "pivot_id": "TS1",
+                "protocols": [
+                    {
+                        "name": "iec61850",
+                        "objref": "simpleIOGenericIO/GGIO1.SPCSO1",
+                        "cdc": "SpcTyp"
+                    }
+                ]
+            },
+            {
+                "label": "TM1",
+                "pivot_id": "TM1",
+                "protocols": [
+                    {
+                        "name": "iec61850",
+                        "objref": "simpleIOGenericIO/GGIO1.AnIn1",
+                        "cdc": "MvTyp"
+                    }
+                ]
+            }
+        ]
+    }
+})";
+
+TEST (SclModelTest, Parse)
+{
+    IEC61850SclModel model;
+
+    ASSERT_FALSE (model.parse ("<SCL><IED", "simpleIO"));
+    ASSERT_TRUE (model.parse (scl, "simpleIO"));
+
+    ASSERT_EQ (model.revisions ().size (), 1);
+    ASSERT_EQ (model.revisions ().at ("simpleIOGenericIO"), "7");
+
+    MmsVariableSpecification* spec
+        = model.getSpec ("simpleIOGenericIO/GGIO1.SPCSO1", IEC61850_FC_ST);
+
+    ASSERT_NE (spec, nullptr);
+    ASSERT_EQ (spec->type, MMS_STRUCTURE);
+    ASSERT_STREQ (spec->name, "SPCSO1");
+    ASSERT_EQ (spec->typeSpec.structure.elementCount, 3);
+    ASSERT_STREQ (spec->typeSpec.structure.elements[0]->name, "stVal");
+    ASSERT_EQ (spec->typeSpec.structure.elements[0]->type, MMS_BOOLEAN);
+    ASSERT_EQ (spec->typeSpec.structure.elements[1]->type, MMS_BIT_STRING);
+    ASSERT_EQ (spec->typeSpec.structure.elements[1]->typeSpec.bitString, 13);
+    ASSERT_EQ (spec->typeSpec.structure.elements[2]->type, MMS_UTC_TIME);
+    MmsVariableSpecification_destroy (spec);
+
+    spec = model.getSpec ("simpleIOGenericIO/GGIO1.SPCSO1", IEC61850_FC_CO);
+
+    ASSERT_NE (spec, nullptr);
+    ASSERT_EQ (spec->typeSpec.structure.elementCount, 1);
+
+    MmsVariableSpecification* oper = spec->typeSpec.structure.elements[0];
+    ASSERT_STREQ (oper->name, "Oper");
+    ASSERT_EQ (oper->typeSpec.structure.elementCount, 6);
+    ASSERT_EQ (oper->typeSpec.structure.elements[1]->type, MMS_STRUCTURE);
+    ASSERT_EQ (oper->typeSpec.structure.elements[2]->type, MMS_UNSIGNED);
+    ASSERT_EQ (oper->typeSpec.structure.elements[5]->typeSpec.bitString, 2);
+    MmsVariableSpecification_destroy (spec);
+
+    ASSERT_EQ (model.getSpec ("simpleIOGenericIO/GGIO1.SPCSO1",
+                              IEC61850_FC_MX),
+               nullptr);
+    ASSERT_EQ (model.getSpec ("simpleIOGenericIO/GGIO2.SPCSO1",
+                              IEC61850_FC_ST),
+               nullptr);
+
+    /* logical node: one component per data object with MX attributes */
+    spec = model.getSpec ("simpleIOGenericIO/GGIO1", IEC61850_FC_MX);
+
+    ASSERT_NE (spec, nullptr);
+    ASSERT_STREQ (spec->name, "MX");
+    ASSERT_EQ (spec->typeSpec.structure.elementCount, 1);
+
+    MmsVariableSpecification* mag = spec->typeSpec.structure.elements[0]
+                                        ->typeSpec.structure.elements[0];
+    ASSERT_STREQ (mag->name, "mag");
+    ASSERT_EQ (mag->typeSpec.structure.elements[0]->type, MMS_FLOAT);
+    ASSERT_EQ (
+        mag->typeSpec.structure.elements[0]->typeSpec.floatingpoint.formatWidth,
+        32);
+    MmsVariableSpecification_destroy (spec);
+
+    ControlModel ctlModel;
+    ASSERT_TRUE (
+        model.getCtlModel ("simpleIOGenericIO/GGIO1.SPCSO1", ctlModel));
+    ASSERT_EQ (ctlModel, CONTROL_MODEL_SBO_ENHANCED);
+    ASSERT_TRUE (
+        model.getCtlModel ("simpleIOGenericIO/GGIO1.SPCSO2", ctlModel));
+    ASSERT_EQ (ctlModel, CONTROL_MODEL_DIRECT_NORMAL);
+
+    vector<string> entries;
+    ASSERT_TRUE (
+        model.getDatasetDirectory ("simpleIOGenericIO/LLN0.Events", entries));
+    ASSERT_EQ (entries.size (), 2);
+    ASSERT_EQ (entries[0], "simpleIOGenericIO/GGIO1.SPCSO1.stVal[ST]");
+    ASSERT_EQ (entries[1], "simpleIOGenericIO/GGIO1.AnIn1[MX]");
+}
+
+
+TEST (SclModelTest, Malformed)
+{
+    IEC61850SclModel model;
+    string sclText (scl);
+
+    /* closing tags have to match the open element */
+    ASSERT_FALSE (model.parse ("<SCL><IED name=\"simpleIO\"></LN></SCL>",
+                               "simpleIO"));
+    ASSERT_FALSE (model.parse ("<SCL><IED name=\"simpleIO\"></SCL></IED>",
+                               "simpleIO"));
+    ASSERT_FALSE (model.parse ("<SCL><IED name=\"simpleIO\"></IEDX></SCL>",
+                               "simpleIO"));
+
+    string mismatched = sclText;
+    mismatched.replace (mismatched.find ("</LDevice>"), 10, "</LN0>");
+    ASSERT_FALSE (model.parse (mismatched, "simpleIO"));
+
+    /* numeric character references are decoded */
+    string decimal = sclText;
+    decimal.replace (decimal.find ("<Val>7</Val>"), 12, "<Val>&#55;</Val>");
+    ASSERT_TRUE (model.parse (decimal, "simpleIO"));
+    ASSERT_EQ (model.revisions ().at ("simpleIOGenericIO"), "7");
+
+    IEC61850SclModel hexModel;
+    string hex = sclText;
+    hex.replace (hex.find ("<Val>7</Val>"), 12, "<Val>&#x37;&#xe9;</Val>");
+    ASSERT_TRUE (hexModel.parse (hex, "simpleIO"));
+    ASSERT_EQ (hexModel.revisions ().at ("simpleIOGenericIO"), "7\xc3\xa9");
+}
+TEST (SclModelTest, SeedCache)
+{
+    const char* fileName = "scl_model_test.json";
+
+    IEC61850SclModel model;
+    ASSERT_TRUE (model.parse (scl, ""));
+
+    IEC61850ClientConfig config;
+    ASSERT_TRUE (config.importExchangeConfig (exchangeConfig));
+
+    IEC61850ModelCache cache (fileName);
+    ASSERT_TRUE (model.seed (cache, config));
+
+    /* the revisions read online also contain paramRev */
+    IEC61850ModelCache::Revisions revisions;
+    revisions["simpleIOGenericIO"] = "7/3";
+    ASSERT_TRUE (cache.matches (revisions));
+
+    revisions["simpleIOGenericIO"] = "8/3";
+    ASSERT_FALSE (cache.matches (revisions));
+
+    MmsVariableSpecification* spec
+        = cache.getSpec ("simpleIOGenericIO/GGIO1.AnIn1", IEC61850_FC_MX);
+    ASSERT_NE (spec, nullptr);
+    MmsVariableSpecification_destroy (spec);
+
+    spec = cache.getSpec ("simpleIOGenericIO/GGIO1", IEC61850_FC_ST);
+    ASSERT_NE (spec, nullptr);
+    MmsVariableSpecification_destroy (spec);
+
+    ControlModel ctlModel;
+    ASSERT_TRUE (
+        cache.getCtlModel ("simpleIOGenericIO/GGIO1.SPCSO1", ctlModel));
+    ASSERT_EQ (ctlModel, CONTROL_MODEL_SBO_ENHANCED);
+
+    remove (fileName);
+}
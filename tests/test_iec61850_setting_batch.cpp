@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <iec61850_setting_batch.hpp>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+TEST (SettingBatchTest, MmsReference)
+{
+    string domain;
+    string item;
+
+    ASSERT_TRUE (IEC61850SettingBatch::mmsReference (
+        "simpleIOGenericIO/GGIO1.AnOut1.setMag.f", "SP", domain, item));
+    ASSERT_EQ (domain, "simpleIOGenericIO");
+    ASSERT_EQ (item, "GGIO1$SP$AnOut1$setMag$f");
+
+    ASSERT_TRUE (IEC61850SettingBatch::mmsReference ("PROT/PTOC1.StrVal.setVal",
+                                                     "SE", domain, item));
+    ASSERT_EQ (domain, "PROT");
+    ASSERT_EQ (item, "PTOC1$SE$StrVal$setVal");
+
+    ASSERT_FALSE (IEC61850SettingBatch::mmsReference ("GGIO1.AnOut1", "SP",
+                                                      domain, item));
+    ASSERT_FALSE (IEC61850SettingBatch::mmsReference ("LD/GGIO1", "SP",
+                                                      domain, item));
+    ASSERT_FALSE (IEC61850SettingBatch::mmsReference ("/GGIO1.AnOut1", "SP",
+                                                      domain, item));
+}
+
+TEST (SettingBatchTest, Parse)
+{
+    IEC61850SettingBatch batch;
+    vector<string> commands;
+
+    ASSERT_TRUE (batch.parse (
+        R"({"PivotSettingBatch":{"Identifier":"PROFILE1", "SettingGroup":2, "Settings":[{"GTIC":{"Identifier":"SP1", "AsgTyp":{"setMag":{"f":1.5}}}}, {"GTIC":{"Identifier":"SP2", "IngTyp":{"setVal":3}}}]}})",
+        commands));
+
+    ASSERT_EQ (batch.identifier (), "PROFILE1");
+    ASSERT_EQ (batch.settingGroup (), 2);
+    ASSERT_EQ (commands.size (), 2);
+    ASSERT_EQ (commands[0],
+               R"({"GTIC":{"Identifier":"SP1","AsgTyp":{"setMag":{"f":1.5}}}})");
+
+    /* without setting group the settings are written directly */
+    IEC61850SettingBatch direct;
+    commands.clear ();
+
+    ASSERT_TRUE (direct.parse (
+        R"({"PivotSettingBatch":{"Settings":[{"GTIC":{"Identifier":"SP1"}}]}})",
+        commands));
+    ASSERT_EQ (direct.settingGroup (), 0);
+
+    IEC61850SettingBatch invalid;
+
+    ASSERT_FALSE (invalid.parse (
+        R"({"PivotSettingBatch":{"SettingGroup":0, "Settings":[{"GTIC":{}}]}})",
+        commands));
+    ASSERT_FALSE (
+        invalid.parse (R"({"PivotSettingBatch":{"Settings":[]}})", commands));
+    ASSERT_FALSE (invalid.parse (
+        R"({"PivotSettingBatch":{"Settings":[{"Identifier":"SP1"}]}})",
+        commands));
+}
+
+TEST (SettingBatchTest, Add)
+{
+    IEC61850SettingBatch batch;
+    vector<string> commands;
+
+    ASSERT_TRUE (batch.parse (
+        R"({"PivotSettingBatch":{"SettingGroup":1, "Settings":[{"GTIC":{}}]}})",
+        commands));
+
+    ASSERT_TRUE (batch.add ("SP1", "PROT/PTOC1.StrVal", ASG,
+                            DatapointValue (1.5)));
+    ASSERT_TRUE (
+        batch.add ("SP2", "PROT/PTOC1.TmMult", ING, DatapointValue (3L)));
+    ASSERT_FALSE (
+        batch.add ("SP3", "PROT/PTOC1.Op", SPC, DatapointValue (1L)));
+    ASSERT_FALSE (
+        batch.add ("SP4", "PTOC1.StrVal", ASG, DatapointValue (1.0)));
+
+    ASSERT_EQ (batch.settings.size (), 2);
+    ASSERT_EQ (batch.settings[0].item, "PTOC1$SE$StrVal$setMag$f");
+    ASSERT_FLOAT_EQ (MmsValue_toFloat (batch.settings[0].value), 1.5);
+    ASSERT_EQ (batch.settings[1].item, "PTOC1$SE$TmMult$setVal");
+    ASSERT_EQ (MmsValue_toInt32 (batch.settings[1].value), 3);
+    ASSERT_EQ (batch.written (), 0);
+}
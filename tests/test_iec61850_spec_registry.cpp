@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <iec61850_spec_registry.hpp>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+static MmsVariableSpecification*
+createSpec (const char* name, MmsType type)
+{
+    auto spec = static_cast<MmsVariableSpecification*> (
+        calloc (1, sizeof (MmsVariableSpecification)));
+    spec->name = strdup (name);
+    spec->type = type;
+    return spec;
+}
+
+static MmsVariableSpecification*
+createStructSpec (const char* name, int count)
+{
+    MmsVariableSpecification* spec = createSpec (name, MMS_STRUCTURE);
+
+    spec->typeSpec.structure.elementCount = count;
+    spec->typeSpec.structure.elements
+        = static_cast<MmsVariableSpecification**> (
+            calloc (count, sizeof (MmsVariableSpecification*)));
+
+    return spec;
+}
+
+static MmsVariableSpecification*
+createSpsSpec (const char* name)
+{
+    MmsVariableSpecification* spec = createStructSpec (name, 3);
+
+    spec->typeSpec.structure.elements[0] = createSpec ("stVal", MMS_BOOLEAN);
+
+    MmsVariableSpecification* q = createSpec ("q", MMS_BIT_STRING);
+    q->typeSpec.bitString = -13;
+    spec->typeSpec.structure.elements[1] = q;
+
+    spec->typeSpec.structure.elements[2] = createSpec ("t", MMS_UTC_TIME);
+
+    return spec;
+}
+
+static MmsVariableSpecification*
+createMvSpec (const char* name)
+{
+    MmsVariableSpecification* spec = createStructSpec (name, 3);
+
+    MmsVariableSpecification* mag = createStructSpec ("mag", 1);
+    MmsVariableSpecification* f = createSpec ("f", MMS_FLOAT);
+    f->typeSpec.floatingpoint.formatWidth = 32;
+    f->typeSpec.floatingpoint.exponentWidth = 8;
+    mag->typeSpec.structure.elements[0] = f;
+
+    spec->typeSpec.structure.elements[0] = mag;
+
+    MmsVariableSpecification* q = createSpec ("q", MMS_BIT_STRING);
+    q->typeSpec.bitString = -13;
+    spec->typeSpec.structure.elements[1] = q;
+
+    spec->typeSpec.structure.elements[2] = createSpec ("t", MMS_UTC_TIME);
+
+    return spec;
+}
+
+TEST (SpecRegistryTest, InternIdenticalTypes)
+{
+    IEC61850SpecRegistry registry;
+
+    MmsVariableSpecification* ind1 = createSpsSpec ("Ind1");
+    MmsVariableSpecification* ind2 = createSpsSpec ("Ind2");
+    MmsVariableSpecification* mv = createMvSpec ("AnIn1");
+
+    const IEC61850SpecType* type1 = registry.intern (ind1);
+    const IEC61850SpecType* type2 = registry.intern (ind2);
+    const IEC61850SpecType* type3 = registry.intern (mv);
+
+    MmsVariableSpecification_destroy (ind1);
+    MmsVariableSpecification_destroy (ind2);
+    MmsVariableSpecification_destroy (mv);
+
+    ASSERT_NE (type1, nullptr);
+    ASSERT_EQ (type1, type2);
+    ASSERT_NE (type1, type3);
+    ASSERT_EQ (registry.size (), 2);
+
+    ASSERT_EQ (type1->refCount, 2);
+    ASSERT_EQ (type1->value, 0);
+    ASSERT_EQ (type1->quality, 1);
+    ASSERT_EQ (type1->timestamp, 2);
+    ASSERT_EQ (type1->valueF, -1);
+
+    ASSERT_EQ (type3->value, 0);
+    ASSERT_EQ (type3->valueF, 0);
+    ASSERT_EQ (type3->valueI, -1);
+    ASSERT_EQ (type3->posVal, -1);
+
+    registry.release (type1);
+    ASSERT_EQ (registry.size (), 2);
+    registry.release (type2);
+    ASSERT_EQ (registry.size (), 1);
+    registry.release (type3);
+    ASSERT_EQ (registry.size (), 0);
+
+    ASSERT_EQ (registry.intern (nullptr), nullptr);
+}
+
+TEST (SpecRegistryTest, SignatureIgnoresTopLevelName)
+{
+    MmsVariableSpecification* ind1 = createSpsSpec ("Ind1");
+    MmsVariableSpecification* ind2 = createSpsSpec ("Ind2");
+    MmsVariableSpecification* other = createSpsSpec ("Ind3");
+
+    other->typeSpec.structure.elements[1]->typeSpec.bitString = -14;
+
+    ASSERT_EQ (IEC61850SpecRegistry::signature (ind1),
+               IEC61850SpecRegistry::signature (ind2));
+    ASSERT_NE (IEC61850SpecRegistry::signature (ind1),
+               IEC61850SpecRegistry::signature (other));
+
+    MmsVariableSpecification_destroy (ind1);
+    MmsVariableSpecification_destroy (ind2);
+    MmsVariableSpecification_destroy (other);
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <iec61850_timer_wheel.hpp>
+
+using namespace std;
+
+TEST (TimerWheelTest, ScheduleAndExpire)
+{
+    IEC61850TimerWheel wheel (10, 8);
+
+    wheel.schedule (1, 0, 1050);
+    wheel.schedule (2, 1, 1100);
+    wheel.schedule (3, 2, 1025);
+
+    ASSERT_EQ (wheel.size (), 3);
+    ASSERT_TRUE (wheel.expire (1000).empty ());
+
+    vector<IEC61850TimerWheel::Timer> expired = wheel.expire (1030);
+    ASSERT_EQ (expired.size (), 1);
+    ASSERT_EQ (expired[0].key, 3);
+    ASSERT_EQ (expired[0].tag, 2);
+    ASSERT_EQ (expired[0].deadline, 1025);
+
+    /* rescheduled with the tag of the next step */
+    wheel.schedule (1, 3, 1200);
+    wheel.cancel (2);
+
+    ASSERT_TRUE (wheel.expire (1150).empty ());
+    ASSERT_EQ (wheel.size (), 1);
+
+    expired = wheel.expire (1200);
+    ASSERT_EQ (expired.size (), 1);
+    ASSERT_EQ (expired[0].key, 1);
+    ASSERT_EQ (expired[0].tag, 3);
+    ASSERT_EQ (wheel.size (), 0);
+}
+
+TEST (TimerWheelTest, LongDeadlinesAndPauses)
+{
+    IEC61850TimerWheel wheel (10, 8);
+
+    ASSERT_TRUE (wheel.expire (1000).empty ());
+
+    /* several turns of the wheel */
+    wheel.schedule (1, 0, 1500);
+    wheel.schedule (2, 0, 1010);
+
+    for (uint64_t time = 1000; time < 1500; time += 10)
+    {
+        vector<IEC61850TimerWheel::Timer> expired = wheel.expire (time);
+
+        for (const auto& timer : expired)
+            ASSERT_EQ (timer.key, 2);
+    }
+
+    ASSERT_EQ (wheel.size (), 1);
+    ASSERT_EQ (wheel.expire (1500).size (), 1);
+
+    /* overdue when scheduled, and expiry after a long pause */
+    wheel.schedule (3, 0, 900);
+    wheel.schedule (4, 0, 1600);
+    wheel.schedule (5, 0, 1530);
+
+    vector<IEC61850TimerWheel::Timer> expired = wheel.expire (5000);
+    ASSERT_EQ (expired.size (), 3);
+    ASSERT_EQ (wheel.size (), 0);
+
+    wheel.schedule (6, 0, 5100);
+    wheel.clear ();
+    ASSERT_TRUE (wheel.expire (6000).empty ());
+}